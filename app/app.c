@@ -4,13 +4,74 @@
  * 1. 应用程序生命周期管理
  * 2. 协调各个模块的工作
  * 3. 处理核心业务逻辑
+ * 4. 事件驱动的主循环：没有需要重绘的区域时阻塞等待事件，不再固定轮询
  */
 
 #include "main.h"
+#include "app.h"
 #include "window.h"
 #include "main_window.h"
 #include "event.h"
 #include "renderer.h"
+#include "texture_manager.h"
+#include "profiler.h"
+
+// 主循环统计
+static AppFrameStats g_frame_stats;
+
+// 处理一个SDL事件（收到退出请求时返回 false）
+static bool app_dispatch_event(struct Window *window, MainWindow *main_window, SDL_Event *event) {
+    // 处理退出事件
+    if (event->type == SDL_EVENT_QUIT) {
+        printf("[DEBUG] Quit event received\n");
+        window->is_running = false;
+        return false;
+    }
+    
+    // 处理ESC键退出
+    if (event->type == SDL_EVENT_KEY_DOWN && 
+        event->key.scancode == SDL_SCANCODE_ESCAPE) {
+        printf("[DEBUG] ESC key pressed\n");
+        window->is_running = false;
+        return false;
+    }
+    
+    // 将事件传递给主窗口处理
+    Uint64 start = profiler_begin();
+    main_window_handle_event(main_window, event);
+    profiler_end(PROFILE_EVENTS, start);
+    return true;
+}
+
+// 绘制一帧并记录耗时
+static void app_draw_frame(struct Window *window, MainWindow *main_window) {
+    Uint64 start = profiler_begin();
+
+    window_clear(window);           // 清除渲染器
+    window_draw(window);            // 绘制窗口背景内容
+    main_window_draw(main_window);  // 绘制主窗口内容
+    Uint64 present_start = profiler_begin();
+    window_present(window);         // 呈现渲染结果
+    profiler_end(PROFILE_PRESENT, present_start);
+    texture_manager_end_frame(window->textures); // 纹理超出上限时淘汰本帧未使用的纹理
+
+    profiler_end(PROFILE_FRAME, start);
+    profiler_end_frame();
+    Uint64 elapsed = SDL_GetTicksNS() - start;
+    g_frame_stats.frames++;
+    g_frame_stats.last_frame_time_ns = elapsed;
+    g_frame_stats.total_frame_time_ns += elapsed;
+    if (elapsed > g_frame_stats.max_frame_time_ns) {
+        g_frame_stats.max_frame_time_ns = elapsed;
+    }
+}
+
+// 读取主循环统计
+void app_get_frame_stats(AppFrameStats *stats) {
+    if (stats) {
+        *stats = g_frame_stats;
+    }
+}
 
 // 应用程序主循环
 void app_run(struct Window *window, MainWindow *main_window) {
@@ -31,36 +92,38 @@ void app_run(struct Window *window, MainWindow *main_window) {
     // 主循环
     while (window->is_running) {
         
-        // 处理SDL事件
+        // 有区域需要重绘时不等待；否则阻塞到下一个事件或定时任务（光标闪烁等）
+        int timeout = window->dirty ? 0 : main_window_next_timeout(main_window);
+
         SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            // 处理退出事件
-            if (event.type == SDL_EVENT_QUIT) {
-                printf("[DEBUG] Quit event received\n");
-                window->is_running = false;
-                break;
-            }
-            
-            // 处理ESC键退出
-            if (event.type == SDL_EVENT_KEY_DOWN && 
-                event.key.scancode == SDL_SCANCODE_ESCAPE) {
-                printf("[DEBUG] ESC key pressed\n");
-                window->is_running = false;
-                break;
-            }
-            
-            // 将事件传递给主窗口处理
-            main_window_handle_event(main_window, &event);
+        bool has_event;
+        if (timeout == 0) {
+            has_event = SDL_PollEvent(&event);
+        } else {
+            has_event = SDL_WaitEventTimeout(&event, timeout);
+            g_frame_stats.wakeups++;
         }
         
-        // 绘制界面
-        window_clear(window);           // 清除渲染器
-        window_draw(window);            // 绘制窗口背景内容
-        main_window_draw(main_window);  // 绘制主窗口内容
-        window_present(window);         // 呈现渲染结果
+        // 处理本次唤醒时已到达的全部事件（鼠标移动等连续输入合并到同一帧）
+        while (has_event && app_dispatch_event(window, main_window, &event)) {
+            has_event = SDL_PollEvent(&event);
+        }
+        if (!window->is_running) {
+            break;
+        }
+        
+        // 合并后台任务的结果（目录加载等），推进定时任务
+        Uint64 update_start = profiler_begin();
+        main_window_update(main_window);
+        profiler_end(PROFILE_UPDATE, update_start);
         
-        // 限制帧率
-        SDL_Delay(16); // 约60FPS
+        // 只在有组件标记为需要重绘时绘制界面
+        if (window->dirty) {
+            app_draw_frame(window, main_window);
+            window->dirty = 0;
+        } else if (timeout != 0) {
+            // 被唤醒但没有任何可见变化（例如鼠标在空白处移动）
+            g_frame_stats.idle_wakeups++;
+        }
     }
 }
-
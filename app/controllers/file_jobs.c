@@ -0,0 +1,602 @@
+/*
+ * 文件操作任务队列
+ * 职责：
+ * 1. 在后台线程执行复制、移动、删除，不阻塞UI主循环
+ * 2. 按提交顺序执行，同时最多执行 FILE_JOB_WORKERS 个任务
+ * 3. 一个任务的全部源路径作为一批执行：按源目录分组，小文件分批处理，大文件和目录并行处理
+ * 4. 按数据块报告进度，支持暂停、继续和取消
+ * 5. 任务结束时发送唤醒事件，由UI线程取走并释放
+ */
+
+#include "file_jobs.h"
+#include "file_system.h"
+#include "fs_tree.h"
+#include "path_list.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 文件操作任务
+struct FileJob {
+    FileJobQueue *queue;     // 所属队列
+    FileJobType type;        // 操作类型
+    PathList *sources;       // 源路径
+    int count;               // 源路径数
+    char *target_dir;        // 目标目录（删除任务为NULL）
+
+    // 状态由队列互斥锁保护；暂停和取消在持锁时修改，检查点不持锁读取
+    FileJobState state;      // 状态
+    SDL_AtomicInt paused;    // 是否请求暂停
+    SDL_AtomicInt cancelled; // 是否请求取消
+
+    // 进度计数由遍历线程直接更新，不经过队列互斥锁（64位计数由自旋锁保护）
+    SDL_SpinLock progress_lock;
+    Uint64 bytes_done;       // 已处理的字节数
+    Uint64 bytes_total;      // 总字节数
+    Uint64 items_done;       // 已处理的文件和目录数（包括目录树中的）
+    SDL_AtomicInt files_done; // 已处理的源路径数
+    SDL_AtomicInt errors;    // 失败的源路径数
+    SDL_AtomicInt current;   // 最近完成的源路径序号
+};
+
+// 一次批量操作的上下文（进度回调和完成回调共用）
+typedef struct {
+    FileJob *job;
+    char **sources;          // 本次操作的源路径
+    const int *map;          // 本次操作的序号对应的任务源路径序号（为NULL时相同）
+    bool *copied;            // 跨文件系统移动时记录复制成功的源路径（删除源之后才算完成）
+} FileJobBatch;
+
+// 文件操作任务队列
+struct FileJobQueue {
+    SDL_Mutex *mutex;                       // 保护任务列表和任务的状态
+    SDL_Condition *changed;                 // 有新任务、任务继续或需要退出
+    FileJob **jobs;                         // 任务（按提交顺序）
+    int count;                              // 任务数
+    int capacity;                           // 任务容量
+    SDL_Thread *threads[FILE_JOB_WORKERS];  // 后台线程
+    int worker_count;                       // 后台线程数
+    SDL_AtomicInt shutdown;                 // 是否退出（持锁时设置）
+};
+
+// 唤醒事件类型（0表示尚未注册）
+static SDL_AtomicInt g_event_type;
+
+// 唤醒事件类型（首次调用时注册，失败返回0）
+Uint32 file_job_event_type(void) {
+    Uint32 type = (Uint32)SDL_GetAtomicInt(&g_event_type);
+    if (type != 0) {
+        return type;
+    }
+
+    // 多个线程同时注册时只保留一个（多注册的编号不再使用）
+    Uint32 registered = SDL_RegisterEvents(1);
+    if (registered == 0) {
+        printf("[ERROR] Failed to register file job event: %s\n", SDL_GetError());
+        return 0;
+    }
+    SDL_CompareAndSwapAtomicInt(&g_event_type, 0, (int)registered);
+    return (Uint32)SDL_GetAtomicInt(&g_event_type);
+}
+
+// 唤醒UI主循环（任务结束时发送；事件队列已满时UI线程在下一次进度刷新时取走）
+static void file_job_wake(void) {
+    Uint32 type = file_job_event_type();
+    if (type == 0) {
+        return;
+    }
+
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = type;
+    SDL_PushEvent(&event);
+}
+
+// 是否已结束
+static bool file_job_is_finished(FileJobState state) {
+    return state == FILE_JOB_DONE || state == FILE_JOB_FAILED || state == FILE_JOB_CANCELLED;
+}
+
+// 释放任务
+static void file_job_free(FileJob *job) {
+    if (!job) {
+        return;
+    }
+    path_list_free(job->sources);
+    free(job->target_dir);
+    free(job);
+}
+
+// 任务是否已取消或队列正在退出
+static bool file_job_stopped(FileJob *job) {
+    return SDL_GetAtomicInt(&job->cancelled) || SDL_GetAtomicInt(&job->queue->shutdown);
+}
+
+// 检查点：暂停时在此等待，返回是否继续（调用时未持有锁）
+static bool file_job_checkpoint(FileJob *job) {
+    FileJobQueue *queue = job->queue;
+
+    // 没有暂停请求时不加锁（每个数据块都会经过这里）
+    if (!SDL_GetAtomicInt(&job->paused)) {
+        return !file_job_stopped(job);
+    }
+
+    SDL_LockMutex(queue->mutex);
+    if (SDL_GetAtomicInt(&job->paused) && !file_job_stopped(job)) {
+        job->state = FILE_JOB_PAUSED;
+        while (SDL_GetAtomicInt(&job->paused) && !file_job_stopped(job)) {
+            SDL_WaitCondition(queue->changed, queue->mutex);
+        }
+        job->state = FILE_JOB_RUNNING;
+    }
+    bool proceed = !file_job_stopped(job);
+    SDL_UnlockMutex(queue->mutex);
+    return proceed;
+}
+
+// 目录树操作的进度回调（由多个遍历线程并发调用）
+static bool file_job_tree_progress(Uint64 bytes, Uint64 items, void *user_data) {
+    FileJob *job = ((FileJobBatch*)user_data)->job;
+
+    SDL_LockSpinlock(&job->progress_lock);
+    job->bytes_done += bytes;
+    job->items_done += items;
+    SDL_UnlockSpinlock(&job->progress_lock);
+
+    return file_job_checkpoint(job);
+}
+
+// 统计时只响应暂停和取消
+static bool file_job_measure_progress(Uint64 bytes, Uint64 items, void *user_data) {
+    (void)bytes;
+    (void)items;
+    return file_job_checkpoint(((FileJobBatch*)user_data)->job);
+}
+
+// 一个源路径完成（由遍历线程调用）
+static void file_job_source_done(int index, bool success, void *user_data) {
+    FileJobBatch *batch = (FileJobBatch*)user_data;
+    FileJob *job = batch->job;
+
+    if (success && batch->copied) {
+        batch->copied[index] = true;
+        return;
+    }
+
+    FSError error = fs_get_last_error();
+    // 取消导致的失败不算错误
+    bool stop = file_job_stopped(job);
+    bool failed = !success && !stop;
+    SDL_SetAtomicInt(&job->current, batch->map ? batch->map[index] : index);
+    if (failed) {
+        SDL_AddAtomicInt(&job->errors, 1);
+    }
+    if (success || !stop) {
+        SDL_AddAtomicInt(&job->files_done, 1);
+    }
+
+    if (failed) {
+        printf("[ERROR] File job failed on %s: %s\n", batch->sources[index], fs_get_error_string(error));
+    }
+}
+
+// 同一文件系统上的移动逐个重命名，无法重命名的源路径移到数组前部，返回其数量
+static int file_job_rename_all(FileJob *job, char **sources, int *map) {
+    int remaining = 0;
+
+    for (int i = 0; i < job->count; i++) {
+        if (!file_job_checkpoint(job)) {
+            return 0;
+        }
+
+        const char *filename = fs_get_filename(sources[i]);
+        char *dst = filename ? fs_combine_path(job->target_dir, filename) : NULL;
+        if (dst && fs_rename(sources[i], dst)) {
+            SDL_LockSpinlock(&job->progress_lock);
+            job->items_done++;
+            SDL_UnlockSpinlock(&job->progress_lock);
+            SDL_AddAtomicInt(&job->files_done, 1);
+            SDL_SetAtomicInt(&job->current, i);
+        } else if (dst && fs_get_last_error() == FS_ERROR_CROSS_DEVICE) {
+            // 跨文件系统，复制后删除
+            sources[remaining] = sources[i];
+            map[remaining] = i;
+            remaining++;
+        } else {
+            // 其它错误（目标目录非空、移到自身之内、没有权限）不能改为复制，记为失败
+            if (!dst) {
+                fs_set_error(FS_ERROR_UNKNOWN);
+            }
+            FileJobBatch failed = {job, sources, NULL, NULL};
+            file_job_source_done(i, false, &failed);
+        }
+        free(dst);
+    }
+    return remaining;
+}
+
+// 执行任务：全部源路径作为一批交给目录树操作
+static void file_job_run(FileJob *job) {
+    char **sources = path_list_expand(job->sources);
+    int *map = job->type == FILE_JOB_MOVE ? (int*)malloc(sizeof(int) * (size_t)job->count) : NULL;
+    bool *copied = job->type == FILE_JOB_MOVE ? (bool*)calloc((size_t)job->count, sizeof(bool)) : NULL;
+    if (!sources || (job->type == FILE_JOB_MOVE && (!map || !copied))) {
+        SDL_SetAtomicInt(&job->errors, job->count);
+        SDL_SetAtomicInt(&job->files_done, job->count);
+        free(sources);
+        free(map);
+        free(copied);
+        return;
+    }
+
+    FileJobBatch batch = {job, sources, NULL, NULL};
+    int count = job->count;
+    if (job->type == FILE_JOB_DELETE) {
+        fs_tree_delete_batch((const char *const *)sources, count, file_job_tree_progress,
+                             file_job_source_done, &batch, NULL);
+    } else {
+        if (job->type == FILE_JOB_MOVE) {
+            count = file_job_rename_all(job, sources, map);
+            batch.map = map;
+            batch.copied = copied;
+        }
+
+        // 复制前统计全部源路径的字节数（目录需要遍历整个目录树）
+        bool proceed = count > 0 && file_job_checkpoint(job);
+        if (proceed) {
+            FSTreeStats stats;
+            fs_tree_measure_batch((const char *const *)sources, count, file_job_measure_progress, NULL, &batch, &stats);
+            SDL_LockSpinlock(&job->progress_lock);
+            job->bytes_total += stats.bytes;
+            SDL_UnlockSpinlock(&job->progress_lock);
+            proceed = !file_job_stopped(job);
+        }
+        if (proceed) {
+            fs_tree_copy_batch((const char *const *)sources, count, job->target_dir, file_job_tree_progress,
+                               file_job_source_done, &batch, NULL);
+        }
+
+        // 移动时全部复制成功的源路径才删除
+        if (proceed && job->type == FILE_JOB_MOVE && file_job_checkpoint(job)) {
+            int copied_count = 0;
+            for (int i = 0; i < count; i++) {
+                if (copied[i]) {
+                    sources[copied_count] = sources[i];
+                    map[copied_count] = map[i];
+                    copied_count++;
+                }
+            }
+            batch.copied = NULL;
+            if (copied_count > 0) {
+                fs_tree_delete_batch((const char *const *)sources, copied_count, file_job_tree_progress,
+                                     file_job_source_done, &batch, NULL);
+            }
+        }
+    }
+
+    // 报告的字节数与统计的不一致时（文件在执行期间变化）以统计的大小为准
+    // （此时遍历线程已全部结束，只有本线程写入）
+    if (!file_job_stopped(job) && SDL_GetAtomicInt(&job->errors) == 0) {
+        SDL_LockSpinlock(&job->progress_lock);
+        if (job->bytes_done < job->bytes_total) {
+            job->bytes_done = job->bytes_total;
+        }
+        SDL_UnlockSpinlock(&job->progress_lock);
+    }
+
+    free(sources);
+    free(map);
+    free(copied);
+}
+
+// 后台线程入口：按提交顺序取第一个排队且未暂停的任务
+static int SDLCALL file_job_worker(void *data) {
+    FileJobQueue *queue = (FileJobQueue*)data;
+
+    SDL_LockMutex(queue->mutex);
+    for (;;) {
+        FileJob *job = NULL;
+        while (!SDL_GetAtomicInt(&queue->shutdown)) {
+            for (int i = 0; i < queue->count; i++) {
+                FileJob *candidate = queue->jobs[i];
+                if (candidate->state == FILE_JOB_QUEUED && !SDL_GetAtomicInt(&candidate->paused)) {
+                    job = candidate;
+                    break;
+                }
+            }
+            if (job) {
+                break;
+            }
+            SDL_WaitCondition(queue->changed, queue->mutex);
+        }
+        if (SDL_GetAtomicInt(&queue->shutdown)) {
+            break;
+        }
+
+        job->state = FILE_JOB_RUNNING;
+        SDL_UnlockMutex(queue->mutex);
+
+        file_job_run(job);
+
+        SDL_LockMutex(queue->mutex);
+        if (file_job_stopped(job)) {
+            job->state = FILE_JOB_CANCELLED;
+        } else {
+            job->state = SDL_GetAtomicInt(&job->errors) > 0 ? FILE_JOB_FAILED : FILE_JOB_DONE;
+        }
+        // 设置结束状态之后不再访问任务（UI线程随时可能释放）
+        file_job_wake();
+    }
+    SDL_UnlockMutex(queue->mutex);
+    return 0;
+}
+
+// 创建任务队列并启动后台线程
+FileJobQueue* file_job_queue_new(void) {
+    FileJobQueue *queue = (FileJobQueue*)calloc(1, sizeof(FileJobQueue));
+    if (!queue) {
+        return NULL;
+    }
+
+    queue->mutex = SDL_CreateMutex();
+    queue->changed = SDL_CreateCondition();
+    if (!queue->mutex || !queue->changed) {
+        file_job_queue_free(queue);
+        return NULL;
+    }
+
+    // 后台线程按顺序执行任务、在暂停时等待，目录树由每次操作自己的遍历线程并行处理；
+    // 任务不能作为共享线程池任务提交：线程池的调用线程要等待整批完成，而提交任务的是UI线程
+    // 线程创建失败时用已创建的线程继续工作
+    for (int i = 0; i < FILE_JOB_WORKERS; i++) {
+        queue->threads[i] = SDL_CreateThread(file_job_worker, "file_job", queue);
+        if (!queue->threads[i]) {
+            printf("[ERROR] Failed to create file job worker: %s\n", SDL_GetError());
+            break;
+        }
+        queue->worker_count++;
+    }
+    if (queue->worker_count == 0) {
+        file_job_queue_free(queue);
+        return NULL;
+    }
+
+    return queue;
+}
+
+// 取消全部任务，等待后台线程退出后释放队列
+void file_job_queue_free(FileJobQueue *queue) {
+    if (!queue) {
+        return;
+    }
+
+    if (queue->mutex) {
+        SDL_LockMutex(queue->mutex);
+        SDL_SetAtomicInt(&queue->shutdown, 1);
+        for (int i = 0; i < queue->count; i++) {
+            SDL_SetAtomicInt(&queue->jobs[i]->cancelled, 1);
+        }
+        if (queue->changed) {
+            SDL_BroadcastCondition(queue->changed);
+        }
+        SDL_UnlockMutex(queue->mutex);
+    }
+    for (int i = 0; i < queue->worker_count; i++) {
+        SDL_WaitThread(queue->threads[i], NULL);
+    }
+
+    for (int i = 0; i < queue->count; i++) {
+        file_job_free(queue->jobs[i]);
+    }
+    free(queue->jobs);
+    if (queue->changed) {
+        SDL_DestroyCondition(queue->changed);
+    }
+    if (queue->mutex) {
+        SDL_DestroyMutex(queue->mutex);
+    }
+    free(queue);
+}
+
+// 提交任务
+FileJob* file_job_queue_submit(FileJobQueue *queue, FileJobType type,
+                               const char *const *sources, int count, const char *target_dir) {
+    if (!sources || count <= 0) {
+        return NULL;
+    }
+
+    PathList *list = path_list_new();
+    if (!list) {
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!path_list_add(list, sources[i])) {
+            path_list_free(list);
+            return NULL;
+        }
+    }
+    FileJob *job = file_job_queue_submit_list(queue, type, list, target_dir);
+    path_list_free(list);
+    return job;
+}
+
+// 提交任务（复制路径列表）
+FileJob* file_job_queue_submit_list(FileJobQueue *queue, FileJobType type,
+                                    const PathList *sources, const char *target_dir) {
+    int count = path_list_count(sources);
+    if (!queue || count <= 0 || (type != FILE_JOB_DELETE && !target_dir)) {
+        return NULL;
+    }
+
+    FileJob *job = (FileJob*)calloc(1, sizeof(FileJob));
+    if (!job) {
+        return NULL;
+    }
+    job->queue = queue;
+    job->type = type;
+    job->state = FILE_JOB_QUEUED;
+    job->count = count;
+    job->sources = path_list_copy(sources);
+    if (!job->sources) {
+        file_job_free(job);
+        return NULL;
+    }
+    if (type != FILE_JOB_DELETE) {
+        job->target_dir = strdup(target_dir);
+        if (!job->target_dir) {
+            file_job_free(job);
+            return NULL;
+        }
+    }
+
+    SDL_LockMutex(queue->mutex);
+    if (queue->count >= queue->capacity) {
+        int capacity = queue->capacity > 0 ? queue->capacity * 2 : 8;
+        FileJob **jobs = (FileJob**)realloc(queue->jobs, sizeof(FileJob*) * (size_t)capacity);
+        if (!jobs) {
+            SDL_UnlockMutex(queue->mutex);
+            file_job_free(job);
+            return NULL;
+        }
+        queue->jobs = jobs;
+        queue->capacity = capacity;
+    }
+    queue->jobs[queue->count++] = job;
+    SDL_BroadcastCondition(queue->changed);
+    SDL_UnlockMutex(queue->mutex);
+
+    return job;
+}
+
+// 队列中的任务数
+int file_job_queue_count(FileJobQueue *queue) {
+    if (!queue) {
+        return 0;
+    }
+    SDL_LockMutex(queue->mutex);
+    int count = queue->count;
+    SDL_UnlockMutex(queue->mutex);
+    return count;
+}
+
+// 第 index 个任务
+FileJob* file_job_queue_get(FileJobQueue *queue, int index) {
+    if (!queue) {
+        return NULL;
+    }
+    SDL_LockMutex(queue->mutex);
+    FileJob *job = index >= 0 && index < queue->count ? queue->jobs[index] : NULL;
+    SDL_UnlockMutex(queue->mutex);
+    return job;
+}
+
+// 是否有排队或执行中的任务
+bool file_job_queue_is_busy(FileJobQueue *queue) {
+    if (!queue) {
+        return false;
+    }
+    bool busy = false;
+    SDL_LockMutex(queue->mutex);
+    for (int i = 0; i < queue->count && !busy; i++) {
+        busy = !file_job_is_finished(queue->jobs[i]->state);
+    }
+    SDL_UnlockMutex(queue->mutex);
+    return busy;
+}
+
+// 释放已结束的任务
+int file_job_queue_collect(FileJobQueue *queue) {
+    if (!queue) {
+        return 0;
+    }
+
+    int freed = 0;
+    SDL_LockMutex(queue->mutex);
+    int kept = 0;
+    for (int i = 0; i < queue->count; i++) {
+        FileJob *job = queue->jobs[i];
+        if (file_job_is_finished(job->state)) {
+            file_job_free(job);
+            freed++;
+        } else {
+            queue->jobs[kept++] = job;
+        }
+    }
+    queue->count = kept;
+    SDL_UnlockMutex(queue->mutex);
+    return freed;
+}
+
+// 暂停或继续任务
+void file_job_set_paused(FileJob *job, bool paused) {
+    if (!job) {
+        return;
+    }
+    FileJobQueue *queue = job->queue;
+    SDL_LockMutex(queue->mutex);
+    SDL_SetAtomicInt(&job->paused, paused ? 1 : 0);
+    // 排队中的任务暂停后不会被取走，继续后需要唤醒后台线程
+    if (!paused) {
+        SDL_BroadcastCondition(queue->changed);
+    }
+    SDL_UnlockMutex(queue->mutex);
+}
+
+// 取消任务
+void file_job_cancel(FileJob *job) {
+    if (!job) {
+        return;
+    }
+    FileJobQueue *queue = job->queue;
+    SDL_LockMutex(queue->mutex);
+    SDL_SetAtomicInt(&job->cancelled, 1);
+    if (job->state == FILE_JOB_QUEUED) {
+        job->state = FILE_JOB_CANCELLED;
+    }
+    // 唤醒暂停中的任务
+    SDL_BroadcastCondition(queue->changed);
+    SDL_UnlockMutex(queue->mutex);
+}
+
+// 任务类型
+FileJobType file_job_type(const FileJob *job) {
+    return job ? job->type : FILE_JOB_COPY;
+}
+
+// 读取第 index 个源路径
+size_t file_job_source(const FileJob *job, int index, char *buffer, size_t size) {
+    if (!job) {
+        if (buffer && size > 0) {
+            buffer[0] = '\0';
+        }
+        return 0;
+    }
+    return path_list_get(job->sources, index, buffer, size);
+}
+
+// 读取任务进度
+void file_job_get_progress(const FileJob *job, FileJobProgress *progress) {
+    if (!progress) {
+        return;
+    }
+    memset(progress, 0, sizeof(*progress));
+    if (!job) {
+        return;
+    }
+
+    // 只有状态需要互斥锁，进度计数原子读取（SDL 原子操作和自旋锁需要非 const 指针）
+    FileJob *j = (FileJob*)job;
+    SDL_LockMutex(j->queue->mutex);
+    progress->state = j->state;
+    SDL_UnlockMutex(j->queue->mutex);
+    progress->paused = SDL_GetAtomicInt(&j->paused) != 0;
+    SDL_LockSpinlock(&j->progress_lock);
+    progress->bytes_done = j->bytes_done;
+    progress->bytes_total = j->bytes_total;
+    progress->items_done = j->items_done;
+    SDL_UnlockSpinlock(&j->progress_lock);
+    progress->files_done = SDL_GetAtomicInt(&j->files_done);
+    progress->files_total = j->count;
+    progress->errors = SDL_GetAtomicInt(&j->errors);
+    progress->current = SDL_GetAtomicInt(&j->current);
+}
@@ -7,8 +7,12 @@
  * 4. 撤销/重做支持
  */
 
+#include "file_ops.h"
 #include "file_system.h"
 #include "file_item.h"
+#include "file_jobs.h"
+#include "fs_tree.h"
+#include "path_list.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -22,7 +26,7 @@ typedef enum {
 
 // 剪贴板数据结构
 typedef struct {
-    char *file_path;           // 文件路径
+    PathList *paths;           // 文件路径（按选中顺序）
     ClipboardOperation op;     // 操作类型
     bool is_valid;            // 是否有效
 } ClipboardData;
@@ -30,63 +34,99 @@ typedef struct {
 // 全局剪贴板数据
 static ClipboardData g_clipboard = {NULL, CLIPBOARD_NONE, false};
 
+// 后台任务队列（为NULL时同步执行）
+static FileJobQueue *g_job_queue = NULL;
+
+// 设置后台任务队列
+void file_ops_set_job_queue(FileJobQueue *queue) {
+    g_job_queue = queue;
+}
+
 // 清空剪贴板
 static void clipboard_clear(void) {
-    if (g_clipboard.file_path) {
-        free(g_clipboard.file_path);
-        g_clipboard.file_path = NULL;
-    }
+    path_list_clear(g_clipboard.paths);
     g_clipboard.op = CLIPBOARD_NONE;
     g_clipboard.is_valid = false;
 }
 
-// 复制文件到剪贴板
-bool file_ops_copy(const char *file_path) {
-    if (!file_path || !fs_path_exists(file_path)) {
-        printf("[ERROR] Invalid file path for copy: %s\n", file_path ? file_path : "NULL");
+// 释放剪贴板
+void file_ops_clear_clipboard(void) {
+    path_list_free(g_clipboard.paths);
+    g_clipboard.paths = NULL;
+    g_clipboard.op = CLIPBOARD_NONE;
+    g_clipboard.is_valid = false;
+}
+
+// 把一组文件放入剪贴板
+static bool clipboard_set(const char *const *paths, int count, ClipboardOperation op) {
+    if (!paths || count <= 0) {
+        printf("[ERROR] No files to put in clipboard\n");
         return false;
     }
 
     clipboard_clear();
-    
-    g_clipboard.file_path = strdup(file_path);
-    if (!g_clipboard.file_path) {
+    if (!g_clipboard.paths) {
+        g_clipboard.paths = path_list_new();
+    }
+    if (!g_clipboard.paths) {
         printf("[ERROR] Failed to allocate memory for clipboard\n");
         return false;
     }
-    
-    g_clipboard.op = CLIPBOARD_COPY;
+    for (int i = 0; i < count; i++) {
+        if (!paths[i] || !path_list_add(g_clipboard.paths, paths[i])) {
+            printf("[ERROR] Failed to add path to clipboard: %s\n", paths[i] ? paths[i] : "NULL");
+            clipboard_clear();
+            return false;
+        }
+    }
+
+    g_clipboard.op = op;
     g_clipboard.is_valid = true;
-    
-    printf("[INFO] File copied to clipboard: %s\n", file_path);
+
+    printf("[INFO] %d file(s) %s to clipboard (%zu bytes)\n", count, op == CLIPBOARD_CUT ? "cut" : "copied",
+           path_list_encoded_size(g_clipboard.paths));
     return true;
 }
 
+// 复制文件到剪贴板
+bool file_ops_copy(const char *file_path) {
+    if (!file_path || !fs_path_exists(file_path)) {
+        printf("[ERROR] Invalid file path for copy: %s\n", file_path ? file_path : "NULL");
+        return false;
+    }
+    return clipboard_set(&file_path, 1, CLIPBOARD_COPY);
+}
+
 // 剪切文件到剪贴板
 bool file_ops_cut(const char *file_path) {
     if (!file_path || !fs_path_exists(file_path)) {
         printf("[ERROR] Invalid file path for cut: %s\n", file_path ? file_path : "NULL");
         return false;
     }
+    return clipboard_set(&file_path, 1, CLIPBOARD_CUT);
+}
 
-    clipboard_clear();
-    
-    g_clipboard.file_path = strdup(file_path);
-    if (!g_clipboard.file_path) {
-        printf("[ERROR] Failed to allocate memory for clipboard\n");
-        return false;
+// 复制一组文件到剪贴板
+bool file_ops_copy_paths(const char *const *paths, int count) {
+    return clipboard_set(paths, count, CLIPBOARD_COPY);
+}
+
+// 剪切一组文件到剪贴板
+bool file_ops_cut_paths(const char *const *paths, int count) {
+    return clipboard_set(paths, count, CLIPBOARD_CUT);
+}
+
+// 同步粘贴时一个源路径完成
+static void paste_source_done(int index, bool success, void *user_data) {
+    char **sources = (char**)user_data;
+    if (!success) {
+        printf("[ERROR] Failed to copy file: %s\n", sources[index]);
     }
-    
-    g_clipboard.op = CLIPBOARD_CUT;
-    g_clipboard.is_valid = true;
-    
-    printf("[INFO] File cut to clipboard: %s\n", file_path);
-    return true;
 }
 
 // 粘贴文件从剪贴板
 bool file_ops_paste(const char *target_dir) {
-    if (!g_clipboard.is_valid || !g_clipboard.file_path) {
+    if (!file_ops_has_clipboard_data()) {
         printf("[ERROR] No file in clipboard to paste\n");
         return false;
     }
@@ -96,43 +136,57 @@ bool file_ops_paste(const char *target_dir) {
         return false;
     }
     
-    // 获取源文件名
-    const char *filename = fs_get_filename(g_clipboard.file_path);
-    if (!filename) {
-        printf("[ERROR] Failed to get filename from path: %s\n", g_clipboard.file_path);
-        return false;
+    int count = path_list_count(g_clipboard.paths);
+
+    // 有任务队列时全部文件作为一个任务在后台执行，进度由任务面板显示
+    if (g_job_queue) {
+        FileJobType type = g_clipboard.op == CLIPBOARD_CUT ? FILE_JOB_MOVE : FILE_JOB_COPY;
+        if (!file_job_queue_submit_list(g_job_queue, type, g_clipboard.paths, target_dir)) {
+            printf("[ERROR] Failed to queue paste of %d file(s) -> %s\n", count, target_dir);
+            return false;
+        }
+        printf("[INFO] Paste queued: %d file(s) -> %s\n", count, target_dir);
+        // 剪切的文件已交给移动任务，清空剪贴板
+        if (g_clipboard.op == CLIPBOARD_CUT) {
+            clipboard_clear();
+        }
+        return true;
     }
-    
-    // 构建目标路径
-    char *target_path = fs_combine_path(target_dir, filename);
-    if (!target_path) {
-        printf("[ERROR] Failed to combine target path\n");
+
+    char **sources = path_list_expand(g_clipboard.paths);
+    if (!sources) {
+        printf("[ERROR] Failed to allocate memory for paste\n");
         return false;
     }
-    
-    bool success = false;
-    
+
+    bool success = true;
     if (g_clipboard.op == CLIPBOARD_COPY) {
-        // 复制操作
-        success = fs_copy_file(g_clipboard.file_path, target_path);
+        // 复制操作（一批执行，目录连同其中的内容）
+        success = fs_tree_copy_batch((const char *const *)sources, count, target_dir,
+                                     NULL, paste_source_done, sources, NULL);
         if (success) {
-            printf("[INFO] File copied successfully: %s -> %s\n", g_clipboard.file_path, target_path);
-        } else {
-            printf("[ERROR] Failed to copy file: %s -> %s\n", g_clipboard.file_path, target_path);
+            printf("[INFO] %d file(s) copied successfully -> %s\n", count, target_dir);
         }
     } else if (g_clipboard.op == CLIPBOARD_CUT) {
-        // 剪切操作（移动文件）
-        success = fs_move_file(g_clipboard.file_path, target_path);
+        // 剪切操作（逐个移动文件）
+        for (int i = 0; i < count; i++) {
+            const char *filename = fs_get_filename(sources[i]);
+            char *target_path = filename ? fs_combine_path(target_dir, filename) : NULL;
+            if (target_path && fs_move_file(sources[i], target_path)) {
+                printf("[INFO] File moved successfully: %s -> %s\n", sources[i], target_path);
+            } else {
+                printf("[ERROR] Failed to move file: %s -> %s\n", sources[i], target_path ? target_path : target_dir);
+                success = false;
+            }
+            free(target_path);
+        }
+        // 剪切操作完成后清空剪贴板
         if (success) {
-            printf("[INFO] File moved successfully: %s -> %s\n", g_clipboard.file_path, target_path);
-            // 剪切操作完成后清空剪贴板
             clipboard_clear();
-        } else {
-            printf("[ERROR] Failed to move file: %s -> %s\n", g_clipboard.file_path, target_path);
         }
     }
     
-    free(target_path);
+    free(sources);
     return success;
 }
 
@@ -143,7 +197,19 @@ bool file_ops_delete(const char *file_path) {
         return false;
     }
     
-    bool success = fs_delete_file(file_path);
+    // 有任务队列时在后台执行
+    if (g_job_queue) {
+        const char *sources[1] = {file_path};
+        if (!file_job_queue_submit(g_job_queue, FILE_JOB_DELETE, sources, 1, NULL)) {
+            printf("[ERROR] Failed to queue delete: %s\n", file_path);
+            return false;
+        }
+        printf("[INFO] Delete queued: %s\n", file_path);
+        return true;
+    }
+
+    // 目录连同其中的内容一起删除
+    bool success = fs_tree_delete(file_path, NULL, NULL, NULL);
     if (success) {
         printf("[INFO] File deleted successfully: %s\n", file_path);
     } else {
@@ -153,6 +219,41 @@ bool file_ops_delete(const char *file_path) {
     return success;
 }
 
+// 同步删除时一个路径完成
+static void delete_path_done(int index, bool success, void *user_data) {
+    const char *const *paths = (const char *const *)user_data;
+    if (!success) {
+        printf("[ERROR] Failed to delete file: %s\n", paths[index]);
+    }
+}
+
+// 删除一组文件
+bool file_ops_delete_paths(const char *const *paths, int count) {
+    if (!paths || count <= 0) {
+        printf("[ERROR] No files to delete\n");
+        return false;
+    }
+    if (count == 1) {
+        return file_ops_delete(paths[0]);
+    }
+
+    // 有任务队列时全部文件作为一个任务在后台执行
+    if (g_job_queue) {
+        if (!file_job_queue_submit(g_job_queue, FILE_JOB_DELETE, paths, count, NULL)) {
+            printf("[ERROR] Failed to queue delete of %d file(s)\n", count);
+            return false;
+        }
+        printf("[INFO] Delete queued: %d file(s)\n", count);
+        return true;
+    }
+
+    bool success = fs_tree_delete_batch(paths, count, NULL, delete_path_done, (void*)paths, NULL);
+    if (success) {
+        printf("[INFO] %d file(s) deleted successfully\n", count);
+    }
+    return success;
+}
+
 // 重命名文件
 bool file_ops_rename(const char *old_path, const char *new_name) {
     if (!old_path || !new_name || !fs_path_exists(old_path)) {
@@ -196,7 +297,12 @@ bool file_ops_rename(const char *old_path, const char *new_name) {
 
 // 检查剪贴板是否有数据
 bool file_ops_has_clipboard_data(void) {
-    return g_clipboard.is_valid && g_clipboard.file_path != NULL;
+    return g_clipboard.is_valid && path_list_count(g_clipboard.paths) > 0;
+}
+
+// 剪贴板中的文件数
+int file_ops_get_clipboard_count(void) {
+    return g_clipboard.is_valid ? path_list_count(g_clipboard.paths) : 0;
 }
 
 // 获取剪贴板操作类型
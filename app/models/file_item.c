@@ -9,14 +9,59 @@
 
 #include "file_item.h"
 #include "file_system.h"
+#include "dir_scanner.h"
+#include "sort.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+// 压缩阈值：删除留下的字节数至少达到该值，并且超过已用字节数的一半
+#define FILE_LIST_COMPACT_MIN_DEAD (64 * 1024)
+
+// 文件名哈希索引中的空槽位和删除标记
+#define NAME_INDEX_EMPTY   (-1)
+#define NAME_INDEX_REMOVED (-2)
+
+// 增量变更标记（FileColumns.mark）
+enum {
+    DELTA_MARK_NONE = 0,     // 未变化
+    DELTA_MARK_SEEN,         // 重新扫描时确认仍然存在
+    DELTA_MARK_MOVED,        // 新增或排序、过滤相关字段变化，需要重新定位
+    DELTA_MARK_REMOVED       // 已删除
+};
+
+// 分批重新扫描的状态
+struct FileListRescan {
+    bool pending;            // 有尚未提交的变更
+    bool sorted;             // 本批变更开始前 order 是否有序
+    bool partial;            // 没有从 file_list_rescan_begin 开始（不能据此判断删除）
+    DirScanEntry *added;     // 名称不在列表中的目录项（结束时按 inode 识别改名）
+    size_t *added_names;     // 暂存目录项名称在 names 中的偏移
+    int added_count;         // 暂存的目录项数量
+    int added_capacity;      // 暂存数组容量
+    char *names;             // 暂存目录项的名称存储区
+    size_t names_used;       // 名称存储区已用字节数
+    size_t names_capacity;   // 名称存储区容量
+};
+
+// 释放重新扫描状态
+static void file_list_rescan_free(FileList *list) {
+    struct FileListRescan *rescan = list->rescan;
+    if (!rescan) {
+        return;
+    }
+    free(rescan->added);
+    free(rescan->added_names);
+    free(rescan->names);
+    free(rescan);
+    list->rescan = NULL;
+}
 
 // 创建文件项
 FileItem* file_item_new(const char *path) {
-    if (!path || !fs_path_exists(path)) {
+    // 一次 stat 同时完成存在性检查和元数据读取
+    struct stat st;
+    if (!path || stat(path, &st) != 0) {
         return NULL;
     }
 
@@ -44,22 +89,17 @@ FileItem* file_item_new(const char *path) {
     }
 
     // 获取文件信息
-    struct stat st;
-    if (stat(path, &st) == 0) {
-        item->type = get_file_type(&st);
-        item->size = st.st_size;
-        item->modified_time = st.st_mtime;
-        item->created_time = st.st_ctime;
-        item->accessed_time = st.st_atime;
-    } else {
-        item->type = FILE_TYPE_UNKNOWN;
-    }
+    item->type = get_file_type(&st);
+    item->size = st.st_size;
+    item->modified_time = st.st_mtime;
+    item->created_time = st.st_ctime;
+    item->accessed_time = st.st_atime;
 
     // 检查是否为隐藏文件
     item->is_hidden = fs_is_hidden(path);
     item->is_selected = false;
     item->icon = NULL;
-    item->next = NULL;
+    item->index = -1;
 
     return item;
 }
@@ -79,9 +119,7 @@ void file_item_free(FileItem *item) {
     if (item->display_name) {
         free(item->display_name);
     }
-    if (item->icon) {
-        SDL_DestroyTexture(item->icon);
-    }
+    // 图标属于图标缓存，文件项不拥有
 
     free(item);
     item = NULL;
@@ -94,10 +132,24 @@ FileList* file_list_new(void) {
         return NULL;
     }
 
-    list->head = NULL;
-    list->tail = NULL;
+    list->items = NULL;
     list->count = 0;
+    list->capacity = 0;
+    list->order = NULL;
+    list->visible = NULL;
+    list->visible_count = 0;
+    list->show_hidden = false;
+    list->has_parent_item = false;
+    list->name_rank_valid = false;
+    list->is_sorted = false;
+    list->sort_key = SORT_KEY_NAME;
+    list->sort_descending = false;
+    list->name_index = NULL;
+    list->name_index_capacity = 0;
+    list->name_index_used = 0;
+    list->name_index_valid = false;
     list->current_dir = NULL;
+    arena_init(&list->arena, 0);
 
     return list;
 }
@@ -110,6 +162,25 @@ void file_list_free(FileList *list) {
 
     // 释放所有文件项
     file_list_clear(list);
+    free(list->items);
+    free(list->order);
+    free(list->visible);
+    free(list->columns.size);
+    free(list->columns.modified_time);
+    free(list->columns.type);
+    free(list->columns.hidden);
+    free(list->columns.name_offset);
+    free(list->columns.visible_pos);
+    free(list->columns.key_offset);
+    free(list->columns.ext_offset);
+    free(list->columns.key_prefix);
+    free(list->columns.name_rank);
+    free(list->columns.mark);
+    free(list->columns.inode);
+    free(list->columns.name_pool);
+    free(list->columns.key_pool);
+    free(list->name_index);
+    arena_destroy(&list->arena);
 
     // 释放当前目录
     if (list->current_dir) {
@@ -121,8 +192,8 @@ void file_list_free(FileList *list) {
     list = NULL;
 }
 
-// 加载目录内容
-bool file_list_load_directory(FileList *list, const char *dir_path) {
+// 开始加载目录（清空列表并设置当前目录，不读取目录内容）
+bool file_list_begin_load(FileList *list, const char *dir_path) {
     if (!list || !dir_path) {
         return false;
     }
@@ -130,18 +201,16 @@ bool file_list_load_directory(FileList *list, const char *dir_path) {
     // 清空当前列表
     file_list_clear(list);
 
-    // 设置当前目录
+    // 设置当前目录（先复制，dir_path 可能就是 list->current_dir）
+    char *new_dir = strdup(dir_path);
+    if (!new_dir) {
+        return false;
+    }
     if (list->current_dir) {
         free(list->current_dir);
-        list->current_dir = NULL;
-    }
-    list->current_dir = strdup(dir_path);
-
-    // 打开目录
-    DIR *dir = fs_open_directory(dir_path);
-    if (!dir) {
-        return false;
     }
+    list->current_dir = new_dir;
+    dir_path = new_dir;
 
     // 添加返回上级目录的项目（除非是驱动器列表）
     size_t dir_len = strlen(dir_path);
@@ -152,82 +221,1117 @@ bool file_list_load_directory(FileList *list, const char *dir_path) {
            dir_path, dir_len, is_root ? "true" : "false");
     
     if (!is_root) {
-        FileItem *parent_item = (FileItem*)calloc(1, sizeof(FileItem));
+        // 临时使用当前路径，实际处理在打开时
+        FileItem *parent_item = file_list_alloc_item(list, dir_path, "..", NULL);
         if (parent_item) {
-            parent_item->name = strdup("..");
-            parent_item->display_name = strdup("..");
-            parent_item->path = strdup(dir_path); // 临时使用当前路径，实际处理在打开时
             parent_item->type = FILE_TYPE_DIRECTORY;
-            parent_item->size = 0;
-            parent_item->is_hidden = false;
-            parent_item->next = NULL;
             file_list_add_item(list, parent_item);
+            list->has_parent_item = (list->count == 1);
         }
     }
 
-    // 读取目录内容
-    struct dirent *entry;
-    while ((entry = fs_read_directory(dir)) != NULL) {
-        // 跳过 . 和 ..
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue;
-        }
+    return true;
+}
 
-        // 构建完整路径
-        char *full_path = fs_combine_path(dir_path, entry->d_name);
-        if (!full_path) {
-            continue;
-        }
+// 在列表的分配器中创建文件项（name 为NULL时取路径中的文件名，display_name 为NULL时与 name 相同）
+FileItem* file_list_alloc_item(FileList *list, const char *path, const char *name, const char *display_name) {
+    if (!list || !path) {
+        return NULL;
+    }
+
+    FileItem *item = (FileItem*)arena_calloc(&list->arena, sizeof(FileItem));
+    if (!item) {
+        return NULL;
+    }
+
+    item->path = arena_strdup(&list->arena, path);
+    if (!item->path) {
+        return NULL;
+    }
+
+    // 文件名直接指向路径末尾，不再单独复制
+    item->name = name ? arena_strdup(&list->arena, name) : (char*)fs_get_filename(item->path);
+    item->display_name = display_name ? arena_strdup(&list->arena, display_name) : item->name;
+    if (!item->name || !item->display_name) {
+        return NULL;
+    }
+
+    item->index = -1;
+    return item;
+}
+
+// 在分配器中拼接当前目录下的完整路径，name_offset 返回文件名在路径中的起始位置
+static char* file_list_make_path(FileList *list, const char *name, size_t name_len, size_t *name_offset) {
+    const char *dir = list->current_dir;
+    size_t dir_len = strlen(dir);
+#ifdef _WIN32
+    bool need_sep = dir_len > 0 && dir[dir_len - 1] != '\\' && dir[dir_len - 1] != '/';
+    const char sep = '\\';
+#else
+    bool need_sep = dir_len > 0 && dir[dir_len - 1] != '/';
+    const char sep = '/';
+#endif
+    *name_offset = dir_len + (need_sep ? 1 : 0);
+    char *path = (char*)arena_alloc(&list->arena, *name_offset + name_len + 1);
+    if (!path) {
+        return NULL;
+    }
+    memcpy(path, dir, dir_len);
+    if (need_sep) {
+        path[dir_len] = sep;
+    }
+    memcpy(path + *name_offset, name, name_len);
+    path[*name_offset + name_len] = '\0';
+    return path;
+}
+
+// 将扫描得到的目录项追加到列表
+bool file_list_add_entry(FileList *list, const DirScanEntry *entry) {
+    if (!list || !list->current_dir || !entry || !entry->name) {
+        return false;
+    }
+
+    FileItem *item = (FileItem*)arena_alloc(&list->arena, sizeof(FileItem));
+    if (!item) {
+        return false;
+    }
+
+    // 路径一次写入分配器，name 和 display_name 都指向路径中的文件名部分
+    size_t name_offset = 0;
+    char *path = file_list_make_path(list, entry->name, entry->name_len, &name_offset);
+    if (!path) {
+        return false;
+    }
+
+    item->path = path;
+    item->name = path + name_offset;
+    item->display_name = item->name;
+    item->type = entry->type;
+    if (entry->has_stat) {
+        item->size = entry->size;
+        item->modified_time = entry->modified_time;
+        item->created_time = entry->created_time;
+        item->accessed_time = entry->accessed_time;
+    } else {
+        item->size = 0;
+        item->modified_time = 0;
+        item->created_time = 0;
+        item->accessed_time = 0;
+    }
+    item->is_hidden = entry->is_hidden;
+    item->is_selected = false;
+    item->icon = NULL;
+
+    int index = list->count;
+    file_list_add_item(list, item);
+    if (list->count > index) {
+        list->columns.inode[index] = entry->inode;
+    }
+    return true;
+}
+
+// 目录扫描回调：把每个目录项追加到列表
+static bool file_list_scan_callback(const DirScanEntry *entry, void *user_data) {
+    file_list_add_entry((FileList*)user_data, entry);
+    return true;
+}
 
-        // 创建文件项
-        FileItem *item = file_item_new(full_path);
-        free(full_path); // 释放临时路径
+// 加载目录内容
+bool file_list_load_directory(FileList *list, const char *dir_path) {
+    if (!file_list_begin_load(list, dir_path)) {
+        return false;
+    }
+
+    // 一次遍历读取目录内容，元数据由扫描器一并提供
+    bool result = dir_scan(dir_path, DIR_SCAN_STAT, file_list_scan_callback, list);
+    if (!result) {
+        printf("[ERROR] Failed to scan directory: %s\n", dir_path);
+        file_list_clear(list);
+    }
+
+    return result;
+}
+
+// 按新容量重新分配数组（失败时保留原数组）
+static bool grow_array(void **array, int capacity, size_t elem_size) {
+    void *grown = realloc(*array, (size_t)capacity * elem_size);
+    if (!grown) {
+        return false;
+    }
+    *array = grown;
+    return true;
+}
+
+// 确保 items、可见数组和各元数据列至少能容纳 needed 项（按倍数扩容）
+static bool file_list_reserve(FileList *list, int needed) {
+    if (needed <= list->capacity) {
+        return true;
+    }
+
+    int new_capacity = list->capacity > 0 ? list->capacity : 64;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+
+    // 任何一列扩容失败都不更新容量，已扩大的数组在下次扩容时继续使用
+    FileColumns *cols = &list->columns;
+    if (!grow_array((void**)&list->items, new_capacity, sizeof(FileItem*)) ||
+        !grow_array((void**)&list->order, new_capacity, sizeof(int)) ||
+        !grow_array((void**)&list->visible, new_capacity, sizeof(int)) ||
+        !grow_array((void**)&cols->size, new_capacity, sizeof(uint64_t)) ||
+        !grow_array((void**)&cols->modified_time, new_capacity, sizeof(time_t)) ||
+        !grow_array((void**)&cols->type, new_capacity, sizeof(uint8_t)) ||
+        !grow_array((void**)&cols->hidden, new_capacity, sizeof(uint8_t)) ||
+        !grow_array((void**)&cols->name_offset, new_capacity, sizeof(uint32_t)) ||
+        !grow_array((void**)&cols->visible_pos, new_capacity, sizeof(int)) ||
+        !grow_array((void**)&cols->key_offset, new_capacity, sizeof(uint32_t)) ||
+        !grow_array((void**)&cols->ext_offset, new_capacity, sizeof(uint16_t)) ||
+        !grow_array((void**)&cols->key_prefix, new_capacity, sizeof(uint64_t)) ||
+        !grow_array((void**)&cols->name_rank, new_capacity, sizeof(uint32_t)) ||
+        !grow_array((void**)&cols->mark, new_capacity, sizeof(uint8_t)) ||
+        !grow_array((void**)&cols->inode, new_capacity, sizeof(uint64_t))) {
+        return false;
+    }
+
+    list->capacity = new_capacity;
+    return true;
+}
 
-        if (item) {
-            // 添加到列表
-            file_list_add_item(list, item);
+// 确保字符串池还能容纳 needed 字节（偏移用32位保存，总量不能超过 UINT32_MAX）
+static bool pool_reserve(char **pool, size_t *capacity, size_t used, size_t needed) {
+    if (used + needed <= *capacity) {
+        return true;
+    }
+
+    size_t new_capacity = *capacity > 0 ? *capacity : 4096;
+    while (new_capacity < used + needed) {
+        new_capacity *= 2;
+    }
+    if (new_capacity > UINT32_MAX) {
+        return false;
+    }
+
+    char *grown = (char*)realloc(*pool, new_capacity);
+    if (!grown) {
+        return false;
+    }
+
+    *pool = grown;
+    *capacity = new_capacity;
+    return true;
+}
+
+// 把文件名追加到名称池，返回偏移（失败返回 UINT32_MAX）
+static uint32_t file_list_pool_name(FileList *list, const char *name) {
+    FileColumns *cols = &list->columns;
+    size_t len = strlen(name) + 1;
+
+    if (!pool_reserve(&cols->name_pool, &cols->name_pool_capacity, cols->name_pool_used, len)) {
+        return UINT32_MAX;
+    }
+
+    uint32_t offset = (uint32_t)cols->name_pool_used;
+    memcpy(cols->name_pool + offset, name, len);
+    cols->name_pool_used += len;
+    return offset;
+}
+
+// 生成排序键并写入键池（每次加载只生成一次，重新排序时直接复用）
+static bool file_list_pool_key(FileList *list, int index, const char *name) {
+    FileColumns *cols = &list->columns;
+    size_t max_len = SORT_NAME_KEY_MAX(strlen(name));
+
+    if (!pool_reserve(&cols->key_pool, &cols->key_pool_capacity, cols->key_pool_used, max_len)) {
+        return false;
+    }
+
+    char *key = cols->key_pool + cols->key_pool_used;
+    size_t ext_offset = 0;
+    size_t key_len = sort_make_name_key(name, key, &ext_offset);
+
+    cols->key_offset[index] = (uint32_t)cols->key_pool_used;
+    cols->ext_offset[index] = (uint16_t)(ext_offset < UINT16_MAX ? ext_offset : key_len);
+    cols->key_prefix[index] = sort_key_prefix(key);
+    cols->key_pool_used += key_len + 1;
+    return true;
+}
+
+// 文件名哈希（FNV-1a）
+static uint32_t name_hash(const char *name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char*)name; *p; p++) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    return hash;
+}
+
+// 把下标放入哈希索引（调用方保证负载不超过一半）
+static void name_index_put(FileList *list, int index) {
+    int mask = list->name_index_capacity - 1;
+    int slot = (int)(name_hash(file_list_column_name(list, index)) & (uint32_t)mask);
+    while (list->name_index[slot] != NAME_INDEX_EMPTY) {
+        slot = (slot + 1) & mask;
+    }
+    list->name_index[slot] = index;
+    list->name_index_used++;
+}
+
+// 从哈希索引中删除文件名（留下删除标记）
+static void name_index_remove(FileList *list, const char *name) {
+    if (!list->name_index_valid) {
+        return;
+    }
+
+    int mask = list->name_index_capacity - 1;
+    int slot = (int)(name_hash(name) & (uint32_t)mask);
+    for (;;) {
+        int index = list->name_index[slot];
+        if (index == NAME_INDEX_EMPTY) {
+            return;
         }
+        if (index >= 0 && strcmp(file_list_column_name(list, index), name) == 0) {
+            list->name_index[slot] = NAME_INDEX_REMOVED;
+            return;
+        }
+        slot = (slot + 1) & mask;
     }
+}
 
-    // 关闭目录
-    fs_close_directory(dir);
+// 重建哈希索引（".." 不加入索引）
+static bool name_index_build(FileList *list) {
+    int capacity = 64;
+    while (capacity < list->count * 2 + 2) {
+        capacity *= 2;
+    }
+    if (capacity > list->name_index_capacity) {
+        int *table = (int*)realloc(list->name_index, sizeof(int) * (size_t)capacity);
+        if (!table) {
+            list->name_index_valid = false;
+            return false;
+        }
+        list->name_index = table;
+        list->name_index_capacity = capacity;
+    }
 
+    for (int i = 0; i < list->name_index_capacity; i++) {
+        list->name_index[i] = NAME_INDEX_EMPTY;
+    }
+    list->name_index_used = 0;
+    for (int i = list->has_parent_item ? 1 : 0; i < list->count; i++) {
+        name_index_put(list, i);
+    }
+    list->name_index_valid = true;
     return true;
 }
 
-// 添加文件项到列表
+// 添加文件项到列表（文件项由 file_list_alloc_item 分配）
 void file_list_add_item(FileList *list, FileItem *item) {
-    if (!list || !item) {
+    if (!list || !item || !item->name) {
         return;
     }
 
-    // 添加到链表尾部
-    if (list->tail) {
-        list->tail->next = item;
-    } else {
-        list->head = item;
+    // 添加到数组尾部
+    if (!file_list_reserve(list, list->count + 1)) {
+        printf("[ERROR] Failed to grow file list\n");
+        return;
+    }
+
+    int index = list->count;
+    uint32_t name_offset = file_list_pool_name(list, item->name);
+    if (name_offset == UINT32_MAX || !file_list_pool_key(list, index, item->name)) {
+        printf("[ERROR] Failed to grow file name pool\n");
+        return;
     }
 
-    list->tail = item;
     list->count++;
+    list->items[index] = item;
+    item->index = index;
+
+    // 同步元数据列
+    FileColumns *cols = &list->columns;
+    cols->size[index] = item->size;
+    cols->modified_time[index] = item->modified_time;
+    cols->type[index] = (uint8_t)item->type;
+    cols->hidden[index] = item->is_hidden ? 1 : 0;
+    cols->name_offset[index] = name_offset;
+    cols->inode[index] = 0;
+
+    // 新项追加到显示顺序末尾（排序由调用方在合适的时机进行）
+    list->order[index] = index;
+    list->name_rank_valid = false;
+    list->is_sorted = false;
+    cols->mark[index] = DELTA_MARK_NONE;
+
+    // 哈希索引已建立时同步加入，负载过高时留到下次查找再重建
+    if (list->name_index_valid && !(list->has_parent_item && index == 0)) {
+        if ((list->name_index_used + 1) * 2 > list->name_index_capacity) {
+            list->name_index_valid = false;
+        } else {
+            name_index_put(list, index);
+        }
+    }
+
+    // 可见数组与 items 同容量，直接追加
+    if (!item->is_hidden || list->show_hidden) {
+        cols->visible_pos[index] = list->visible_count;
+        list->visible[list->visible_count++] = index;
+    } else {
+        cols->visible_pos[index] = -1;
+    }
 }
 
-// 清空文件列表
+// 清空文件列表（文件项和字符串随分配器一次性释放，数组容量保留复用）
 void file_list_clear(FileList *list) {
     if (!list) {
         return;
     }
 
-    FileItem *current = list->head;
-    while (current) {
-        FileItem *next = current->next;
-        file_item_free(current);
-        current = next;
+    list->count = 0;
+    list->visible_count = 0;
+    list->has_parent_item = false;
+    list->name_rank_valid = false;
+    list->is_sorted = false;
+    list->name_index_valid = false;
+    file_list_rescan_free(list);
+    list->columns.name_pool_used = 0;
+    list->columns.key_pool_used = 0;
+    list->columns.name_pool_dead = 0;
+    list->columns.key_pool_dead = 0;
+    list->arena_dead = 0;
+    list->generation++;
+    arena_reset(&list->arena);
+}
+
+// 按下标获取文件项（越界返回NULL）
+FileItem* file_list_get(const FileList *list, int index) {
+    if (!list || index < 0 || index >= list->count) {
+        return NULL;
     }
+    return list->items[index];
+}
 
-    list->head = NULL;
-    list->tail = NULL;
-    list->count = 0;
+// 按可见下标获取文件项（越界返回NULL）
+FileItem* file_list_get_visible(const FileList *list, int visible_index) {
+    if (!list || visible_index < 0 || visible_index >= list->visible_count) {
+        return NULL;
+    }
+    return list->items[list->visible[visible_index]];
+}
+
+// 获取文件项的可见下标（不可见时返回-1）
+int file_list_visible_index_of(const FileList *list, const FileItem *item) {
+    if (!list || !item || item->index < 0 || item->index >= list->count) {
+        return -1;
+    }
+    // 校验该项确实属于这个列表
+    if (list->items[item->index] != item) {
+        return -1;
+    }
+    return list->columns.visible_pos[item->index];
+}
+
+// 按下标获取名称池中的文件名（与 items[index]->name 内容相同）
+const char* file_list_column_name(const FileList *list, int index) {
+    if (!list || index < 0 || index >= list->count) {
+        return NULL;
+    }
+    return list->columns.name_pool + list->columns.name_offset[index];
+}
+
+// 设置是否显示隐藏文件并重建可见数组
+void file_list_set_show_hidden(FileList *list, bool show_hidden) {
+    if (!list) {
+        return;
+    }
+
+    list->show_hidden = show_hidden;
+    file_list_rebuild_visible(list);
+}
+
+// 按 order 重建可见数组
+void file_list_rebuild_visible(FileList *list) {
+    if (!list) {
+        return;
+    }
+
+    // 只读取 hidden 列，不访问文件项本身
+    const uint8_t *hidden = list->columns.hidden;
+    const int *order = list->order;
+    int *visible_pos = list->columns.visible_pos;
+    int *visible = list->visible;
+    int count = list->count;
+    int visible_count = 0;
+    uint8_t hide_mask = list->show_hidden ? 0 : 1;
+
+    for (int i = 0; i < count; i++) {
+        int index = order[i];
+        int keep = (hidden[index] & hide_mask) == 0;
+        visible[visible_count] = index;
+        visible_pos[index] = keep ? visible_count : -1;
+        visible_count += keep;
+    }
+
+    list->visible_count = visible_count;
+}
+
+// 按文件名查找文件项下标（不存在返回-1，首次调用时建立哈希索引）
+int file_list_find(FileList *list, const char *name) {
+    if (!list || !name) {
+        return -1;
+    }
+
+    if (!list->name_index_valid && !name_index_build(list)) {
+        // 内存不足时退回线性查找
+        for (int i = list->has_parent_item ? 1 : 0; i < list->count; i++) {
+            if (strcmp(file_list_column_name(list, i), name) == 0) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    int mask = list->name_index_capacity - 1;
+    int slot = (int)(name_hash(name) & (uint32_t)mask);
+    for (;;) {
+        int index = list->name_index[slot];
+        if (index == NAME_INDEX_EMPTY) {
+            return -1;
+        }
+        if (index >= 0 && strcmp(file_list_column_name(list, index), name) == 0) {
+            return index;
+        }
+        slot = (slot + 1) & mask;
+    }
+}
+
+// 用目录项更新已有文件项，排序或过滤相关字段变化时返回 true
+static bool file_list_update_metadata(FileList *list, int index, const DirScanEntry *entry) {
+    FileItem *item = list->items[index];
+    FileColumns *cols = &list->columns;
+
+    // 没有元数据时只更新类型和隐藏属性
+    size_t size = entry->has_stat ? entry->size : item->size;
+    time_t modified_time = entry->has_stat ? entry->modified_time : item->modified_time;
+    if (entry->inode != 0) {
+        cols->inode[index] = entry->inode;
+    }
+    bool moved = item->type != entry->type ||
+                 item->size != size ||
+                 item->modified_time != modified_time ||
+                 item->is_hidden != entry->is_hidden;
+
+    item->type = entry->type;
+    item->size = size;
+    item->modified_time = modified_time;
+    if (entry->has_stat) {
+        item->created_time = entry->created_time;
+        item->accessed_time = entry->accessed_time;
+    }
+    item->is_hidden = entry->is_hidden;
+
+    cols->size[index] = item->size;
+    cols->modified_time[index] = item->modified_time;
+    cols->type[index] = (uint8_t)item->type;
+    cols->hidden[index] = item->is_hidden ? 1 : 0;
+    return moved;
+}
+
+// 按目录项新建或更新文件项并打上标记，返回下标（失败返回-1）
+static int file_list_upsert(FileList *list, const DirScanEntry *entry) {
+    int index = file_list_find(list, entry->name);
+    if (index < 0) {
+        int count = list->count;
+        if (!file_list_add_entry(list, entry) || list->count == count) {
+            return -1;
+        }
+        list->columns.mark[count] = DELTA_MARK_MOVED;
+        return count;
+    }
+
+    uint8_t *mark = &list->columns.mark[index];
+    if (file_list_update_metadata(list, index, entry) || *mark == DELTA_MARK_REMOVED) {
+        *mark = DELTA_MARK_MOVED;
+    } else if (*mark == DELTA_MARK_NONE) {
+        *mark = DELTA_MARK_SEEN;
+    }
+    return index;
+}
+
+// 把下标为 index 的文件项改为目录项的名称（对象保持不变，名称、路径和排序键重新生成），返回下标（失败返回-1）
+// 新的路径、名称和排序键不比原来长时写回原位置，否则另行分配，原来的空间记为已删除
+static int file_list_rename_index(FileList *list, int index, const DirScanEntry *entry) {
+    FileColumns *cols = &list->columns;
+    FileItem *item = list->items[index];
+
+    // 目标名称已存在时被覆盖
+    int target = file_list_find(list, entry->name);
+    if (target >= 0) {
+        name_index_remove(list, entry->name);
+        cols->mark[target] = DELTA_MARK_REMOVED;
+    }
+
+    // 先申请全部空间，失败时文件项保持不变
+    size_t path_len = strlen(item->path);
+    size_t old_name_len = strlen(item->name);
+    bool name_in_path = item->name >= item->path && item->name + old_name_len == item->path + path_len;
+    bool reuse_path = name_in_path && entry->name_len <= old_name_len;
+    size_t name_offset = 0;
+    char *path = reuse_path ? item->path : file_list_make_path(list, entry->name, entry->name_len, &name_offset);
+    size_t old_pool_len = strlen(cols->name_pool + cols->name_offset[index]);
+    size_t old_key_len = strlen(cols->key_pool + cols->key_offset[index]);
+    if (!path ||
+        (entry->name_len > old_pool_len &&
+         !pool_reserve(&cols->name_pool, &cols->name_pool_capacity, cols->name_pool_used, entry->name_len + 1)) ||
+        !pool_reserve(&cols->key_pool, &cols->key_pool_capacity, cols->key_pool_used, SORT_NAME_KEY_MAX(entry->name_len))) {
+        printf("[ERROR] Failed to rename list item: %s\n", item->name);
+        return -1;
+    }
+
+    // 旧名称在覆盖之前移出哈希索引
+    name_index_remove(list, item->name);
+
+    // 路径：同一目录下只替换文件名部分
+    if (reuse_path) {
+        memcpy(item->name, entry->name, entry->name_len);
+        item->name[entry->name_len] = '\0';
+        list->arena_dead += old_name_len - entry->name_len;
+    } else {
+        list->arena_dead += path_len + 1 + (name_in_path ? 0 : old_name_len + 1);
+        item->path = path;
+        item->name = path + name_offset;
+    }
+    item->display_name = item->name;
+
+    // 名称池
+    if (entry->name_len <= old_pool_len) {
+        memcpy(cols->name_pool + cols->name_offset[index], entry->name, entry->name_len);
+        cols->name_pool[cols->name_offset[index] + entry->name_len] = '\0';
+        cols->name_pool_dead += old_pool_len - entry->name_len;
+    } else {
+        cols->name_offset[index] = (uint32_t)cols->name_pool_used;
+        memcpy(cols->name_pool + cols->name_pool_used, entry->name, entry->name_len);
+        cols->name_pool[cols->name_pool_used + entry->name_len] = '\0';
+        cols->name_pool_used += entry->name_len + 1;
+        cols->name_pool_dead += old_pool_len + 1;
+    }
+
+    // 排序键：先在键池末尾生成，长度不超过原来的键时移回原位置
+    char *key = cols->key_pool + cols->key_pool_used;
+    size_t ext_offset = 0;
+    size_t key_len = sort_make_name_key(item->name, key, &ext_offset);
+    if (key_len <= old_key_len) {
+        key = cols->key_pool + cols->key_offset[index];
+        memcpy(key, cols->key_pool + cols->key_pool_used, key_len + 1);
+        cols->key_pool_dead += old_key_len - key_len;
+    } else {
+        cols->key_offset[index] = (uint32_t)cols->key_pool_used;
+        cols->key_pool_used += key_len + 1;
+        cols->key_pool_dead += old_key_len + 1;
+    }
+    cols->ext_offset[index] = (uint16_t)(ext_offset < UINT16_MAX ? ext_offset : key_len);
+    cols->key_prefix[index] = sort_key_prefix(key);
+
+    if (list->name_index_valid) {
+        if ((list->name_index_used + 1) * 2 > list->name_index_capacity) {
+            list->name_index_valid = false;
+        } else {
+            name_index_put(list, index);
+        }
+    }
+
+    file_list_update_metadata(list, index, entry);
+    cols->mark[index] = DELTA_MARK_MOVED;
+    return index;
+}
+
+// 按改名变更更新文件项，旧名称不在列表中时按新增处理，返回下标（失败返回-1）
+static int file_list_rename(FileList *list, const char *old_name, const DirScanEntry *entry) {
+    int index = file_list_find(list, old_name);
+    if (index < 0 || strcmp(old_name, entry->name) == 0) {
+        return file_list_upsert(list, entry);
+    }
+    return file_list_rename_index(list, index, entry);
+}
+
+// 清除增量标记；分批重新扫描进行中时保留"已出现"标记，结束时据此判断删除
+static void file_list_reset_marks(FileList *list) {
+    uint8_t *mark = list->columns.mark;
+    if (!list->rescan) {
+        memset(mark, DELTA_MARK_NONE, (size_t)list->count);
+        return;
+    }
+    for (int i = 0; i < list->count; i++) {
+        if (mark[i] != DELTA_MARK_NONE) {
+            mark[i] = DELTA_MARK_SEEN;
+        }
+    }
+}
+
+// 文件项在分配器中占用的字节数（文件项本身和路径，以及不在路径中的名称）
+static size_t file_list_item_bytes(const FileItem *item) {
+    size_t path_len = strlen(item->path);
+    size_t bytes = sizeof(FileItem) + path_len + 1;
+    if (item->name < item->path || item->name > item->path + path_len) {
+        bytes += strlen(item->name) + 1;
+    }
+    if (item->display_name != item->name &&
+        (item->display_name < item->path || item->display_name > item->path + path_len)) {
+        bytes += strlen(item->display_name) + 1;
+    }
+    return bytes;
+}
+
+// 记录被删除的文件项留下的空间
+static void file_list_retire_item(FileList *list, int index) {
+    FileColumns *cols = &list->columns;
+    list->arena_dead += file_list_item_bytes(list->items[index]);
+    cols->name_pool_dead += strlen(cols->name_pool + cols->name_offset[index]) + 1;
+    cols->key_pool_dead += strlen(cols->key_pool + cols->key_offset[index]) + 1;
+}
+
+// 提交标记的增量变更：移除已删除项，把变化项插入排序位置，重建可见数组并清除标记
+// sorted 为变更开始前 order 是否有序（追加新项会清除 list->is_sorted）
+static void file_list_commit_deltas(FileList *list, bool sorted) {
+    FileColumns *cols = &list->columns;
+    uint8_t *mark = cols->mark;
+    int count = list->count;
+
+    // 1. 从显示顺序中取出已删除项和需要重新定位的项（未排序时变化项留在原位）
+    int kept = 0;
+    int moved_count = 0;
+    int removed_count = 0;
+    for (int i = 0; i < count; i++) {
+        int index = list->order[i];
+        if (mark[index] == DELTA_MARK_REMOVED) {
+            removed_count++;
+        } else if (sorted && mark[index] == DELTA_MARK_MOVED) {
+            moved_count++;
+        } else {
+            list->order[kept++] = index;
+        }
+    }
+
+    // 2. 压缩存储：删除项之后的文件项前移，新下标暂存在 visible_pos 中（稍后重建）
+    if (removed_count > 0) {
+        int *remap = cols->visible_pos;
+        int write = 0;
+        for (int i = 0; i < count; i++) {
+            if (mark[i] == DELTA_MARK_REMOVED) {
+                file_list_retire_item(list, i);
+                list->items[i]->index = -1;
+                remap[i] = -1;
+                continue;
+            }
+            remap[i] = write;
+            if (write != i) {
+                list->items[write] = list->items[i];
+                list->items[write]->index = write;
+                cols->size[write] = cols->size[i];
+                cols->modified_time[write] = cols->modified_time[i];
+                cols->type[write] = cols->type[i];
+                cols->hidden[write] = cols->hidden[i];
+                cols->name_offset[write] = cols->name_offset[i];
+                cols->key_offset[write] = cols->key_offset[i];
+                cols->ext_offset[write] = cols->ext_offset[i];
+                cols->key_prefix[write] = cols->key_prefix[i];
+                cols->name_rank[write] = cols->name_rank[i];
+                cols->inode[write] = cols->inode[i];
+                mark[write] = mark[i];
+            }
+            write++;
+        }
+
+        for (int i = 0; i < kept; i++) {
+            list->order[i] = remap[list->order[i]];
+        }
+        if (list->name_index_valid) {
+            for (int i = 0; i < list->name_index_capacity; i++) {
+                int index = list->name_index[i];
+                if (index >= 0) {
+                    list->name_index[i] = remap[index] >= 0 ? remap[index] : NAME_INDEX_REMOVED;
+                }
+            }
+        }
+        list->count = write;
+        count = write;
+    }
+
+    // 3. 变化项按当前排序插回显示顺序
+    if (sorted) {
+        int *moved = moved_count > 0 ? (int*)malloc(sizeof(int) * (size_t)moved_count) : NULL;
+        int n = 0;
+        for (int i = 0; i < count; i++) {
+            if (mark[i] != DELTA_MARK_MOVED) {
+                continue;
+            }
+            if (moved) {
+                moved[n++] = i;
+            } else {
+                list->order[kept++] = i;
+            }
+        }
+
+        if (moved_count > 0 && !moved) {
+            // 内存不足时整体重新排序
+            printf("[ERROR] Failed to allocate delta buffer, re-sorting %d items\n", count);
+            file_list_reset_marks(list);
+            sort_file_list(list, (SortKey)list->sort_key, list->sort_descending);
+            return;
+        }
+
+        sort_insert_indices(list, kept, moved, n);
+        list->is_sorted = true;
+        free(moved);
+    } else if (removed_count > 0) {
+        list->name_rank_valid = false;
+    }
+
+    file_list_reset_marks(list);
+    file_list_rebuild_visible(list);
+}
+
+// 批量应用增量变更：已排序时变更项按当前排序二分插入，较多时排序后一次合并
+bool file_list_apply_deltas(FileList *list, const FileListDelta *deltas, int count) {
+    if (!list || (!deltas && count > 0)) {
+        return false;
+    }
+
+    bool sorted = list->is_sorted;
+    bool result = true;
+    for (int i = 0; i < count; i++) {
+        const DirScanEntry *entry = deltas[i].entry;
+        if (!entry || !entry->name) {
+            continue;
+        }
+
+        if (deltas[i].type == FILE_LIST_DELTA_REMOVE) {
+            int index = file_list_find(list, entry->name);
+            if (index >= 0) {
+                list->columns.mark[index] = DELTA_MARK_REMOVED;
+            }
+        } else if (deltas[i].type == FILE_LIST_DELTA_RENAME && deltas[i].old_name) {
+            if (file_list_rename(list, deltas[i].old_name, entry) < 0) {
+                result = false;
+            }
+        } else if (file_list_upsert(list, entry) < 0) {
+            result = false;
+        }
+    }
+
+    file_list_commit_deltas(list, sorted);
+    return result;
+}
+
+// 字符串位于旧路径中时指向新路径的相同位置，否则单独复制
+static char* file_list_move_string(Arena *arena, const char *old_path, size_t path_len, char *path, const char *str) {
+    if (str >= old_path && str <= old_path + path_len) {
+        return path + (str - old_path);
+    }
+    return arena_strdup(arena, str);
+}
+
+// 把存活文件项按下标顺序复制到新的分配器，释放旧分配器（失败时保持原样）
+static bool file_list_compact_arena(FileList *list) {
+    FileItem **moved = (FileItem**)malloc(sizeof(FileItem*) * (size_t)(list->count > 0 ? list->count : 1));
+    if (!moved) {
+        return false;
+    }
+
+    Arena arena;
+    arena_init(&arena, list->arena.block_size);
+    for (int i = 0; i < list->count; i++) {
+        const FileItem *old = list->items[i];
+        size_t path_len = strlen(old->path);
+        FileItem *item = (FileItem*)arena_alloc(&arena, sizeof(FileItem));
+        char *path = arena_strndup(&arena, old->path, path_len);
+        if (!item || !path) {
+            arena_destroy(&arena);
+            free(moved);
+            return false;
+        }
+
+        *item = *old;
+        item->path = path;
+        item->name = file_list_move_string(&arena, old->path, path_len, path, old->name);
+        item->display_name = old->display_name == old->name ? item->name :
+                             file_list_move_string(&arena, old->path, path_len, path, old->display_name);
+        if (!item->name || !item->display_name) {
+            arena_destroy(&arena);
+            free(moved);
+            return false;
+        }
+        moved[i] = item;
+    }
+
+    memcpy(list->items, moved, sizeof(FileItem*) * (size_t)list->count);
+    free(moved);
+    arena_destroy(&list->arena);
+    list->arena = arena;
+    list->arena_dead = 0;
+    list->generation++;
+    return true;
+}
+
+// 按存活文件项的偏移重建字符串池（失败时保持原样）
+static void file_list_compact_pool(FileList *list, char **pool, size_t *used, size_t *capacity,
+                                   size_t *dead, uint32_t *offsets) {
+    size_t size = 0;
+    for (int i = 0; i < list->count; i++) {
+        size += strlen(*pool + offsets[i]) + 1;
+    }
+
+    char *compact = (char*)malloc(size > 0 ? size : 1);
+    if (!compact) {
+        return;
+    }
+    size_t write = 0;
+    for (int i = 0; i < list->count; i++) {
+        const char *str = *pool + offsets[i];
+        size_t len = strlen(str) + 1;
+        memcpy(compact + write, str, len);
+        offsets[i] = (uint32_t)write;
+        write += len;
+    }
+
+    free(*pool);
+    *pool = compact;
+    *used = write;
+    *capacity = size > 0 ? size : 1;
+    *dead = 0;
+}
+
+// 删除留下的空间是否需要回收
+static bool file_list_should_compact(size_t dead, size_t used) {
+    return dead >= FILE_LIST_COMPACT_MIN_DEAD && dead * 2 > used;
+}
+
+// 删除留下的空间超过已用空间一半时，按存活文件项重建分配器和字符串池
+bool file_list_compact(FileList *list) {
+    if (!list) {
+        return false;
+    }
+
+    FileColumns *cols = &list->columns;
+    if (file_list_should_compact(cols->name_pool_dead, cols->name_pool_used)) {
+        file_list_compact_pool(list, &cols->name_pool, &cols->name_pool_used, &cols->name_pool_capacity,
+                               &cols->name_pool_dead, cols->name_offset);
+    }
+    if (file_list_should_compact(cols->key_pool_dead, cols->key_pool_used)) {
+        file_list_compact_pool(list, &cols->key_pool, &cols->key_pool_used, &cols->key_pool_capacity,
+                               &cols->key_pool_dead, cols->key_offset);
+    }
+    if (!file_list_should_compact(list->arena_dead, arena_used(&list->arena))) {
+        return false;
+    }
+    if (!file_list_compact_arena(list)) {
+        printf("[ERROR] Failed to compact file list storage\n");
+        return false;
+    }
+    return true;
+}
+
+// 开始分批重新扫描（已有的重新扫描状态被丢弃）
+void file_list_rescan_begin(FileList *list) {
+    if (!list) {
+        return;
+    }
+
+    file_list_rescan_free(list);
+    list->rescan = (struct FileListRescan*)calloc(1, sizeof(struct FileListRescan));
+    if (!list->rescan) {
+        printf("[ERROR] Failed to allocate rescan state\n");
+    }
+}
+
+// 暂存名称不在列表中的目录项，结束时再判断是新增还是改名
+static bool file_list_rescan_defer(struct FileListRescan *rescan, const DirScanEntry *entry) {
+    if (rescan->added_count >= rescan->added_capacity) {
+        int capacity = rescan->added_capacity > 0 ? rescan->added_capacity * 2 : 64;
+        DirScanEntry *added = (DirScanEntry*)realloc(rescan->added, sizeof(DirScanEntry) * (size_t)capacity);
+        if (!added) {
+            return false;
+        }
+        rescan->added = added;
+
+        size_t *names = (size_t*)realloc(rescan->added_names, sizeof(size_t) * (size_t)capacity);
+        if (!names) {
+            return false;
+        }
+        rescan->added_names = names;
+        rescan->added_capacity = capacity;
+    }
+
+    if (!pool_reserve(&rescan->names, &rescan->names_capacity, rescan->names_used, entry->name_len + 1)) {
+        return false;
+    }
+
+    // 名称在结束时才能确定地址，先记录偏移
+    memcpy(rescan->names + rescan->names_used, entry->name, entry->name_len + 1);
+    rescan->added[rescan->added_count] = *entry;
+    rescan->added_names[rescan->added_count] = rescan->names_used;
+    rescan->added_count++;
+    rescan->names_used += entry->name_len + 1;
+    return true;
+}
+
+// 记录一项重新扫描得到的目录项：已有文件项就地更新（inode、大小、修改时间都相同时只标记为已出现）
+void file_list_rescan_add(FileList *list, const DirScanEntry *entry) {
+    if (!list || !entry || !entry->name) {
+        return;
+    }
+
+    // 没有调用 file_list_rescan_begin 时只应用新增和更新
+    if (!list->rescan) {
+        file_list_rescan_begin(list);
+        if (!list->rescan) {
+            return;
+        }
+        list->rescan->partial = true;
+    }
+
+    struct FileListRescan *rescan = list->rescan;
+    if (!rescan->pending) {
+        rescan->sorted = list->is_sorted;
+        rescan->pending = true;
+    }
+
+    if (entry->inode == 0 || file_list_find(list, entry->name) >= 0 ||
+        !file_list_rescan_defer(rescan, entry)) {
+        file_list_upsert(list, entry);
+    }
+}
+
+// 提交已记录的变化
+void file_list_rescan_commit(FileList *list) {
+    if (!list || !list->rescan || !list->rescan->pending) {
+        return;
+    }
+
+    file_list_commit_deltas(list, list->rescan->sorted);
+    list->rescan->pending = false;
+}
+
+// 哈希 inode 编号（64位混合）
+static uint32_t inode_hash(uint64_t inode) {
+    inode ^= inode >> 33;
+    inode *= 0xff51afd7ed558ccdULL;
+    inode ^= inode >> 33;
+    return (uint32_t)inode;
+}
+
+// 把暂存的新名称按 inode 和修改时间对应到本轮没有出现的文件项，作为改名处理
+static void file_list_rescan_match_renames(FileList *list, struct FileListRescan *rescan) {
+    FileColumns *cols = &list->columns;
+    int candidates = 0;
+    for (int i = list->has_parent_item ? 1 : 0; i < list->count; i++) {
+        if (cols->mark[i] == DELTA_MARK_NONE && cols->inode[i] != 0) {
+            candidates++;
+        }
+    }
+    if (candidates == 0) {
+        return;
+    }
+
+    int capacity = 16;
+    while (capacity < candidates * 2) {
+        capacity *= 2;
+    }
+    int *table = (int*)malloc(sizeof(int) * (size_t)capacity);
+    if (!table) {
+        // 内存不足时全部按新增和删除处理
+        return;
+    }
+    memset(table, 0xff, sizeof(int) * (size_t)capacity);
+
+    uint32_t mask = (uint32_t)capacity - 1;
+    for (int i = list->has_parent_item ? 1 : 0; i < list->count; i++) {
+        if (cols->mark[i] != DELTA_MARK_NONE || cols->inode[i] == 0) {
+            continue;
+        }
+        uint32_t slot = inode_hash(cols->inode[i]) & mask;
+        while (table[slot] >= 0) {
+            slot = (slot + 1) & mask;
+        }
+        table[slot] = i;
+    }
+
+    for (int i = 0; i < rescan->added_count; i++) {
+        DirScanEntry *entry = &rescan->added[i];
+        uint32_t slot = inode_hash(entry->inode) & mask;
+        for (; table[slot] >= 0; slot = (slot + 1) & mask) {
+            int index = table[slot];
+            // 改名不改变大小和修改时间，inode 被新文件复用时通常不同
+            if (cols->inode[index] != entry->inode || cols->mark[index] != DELTA_MARK_NONE ||
+                list->items[index]->type != entry->type ||
+                (entry->has_stat && (cols->modified_time[index] != entry->modified_time ||
+                                     cols->size[index] != entry->size))) {
+                continue;
+            }
+            if (file_list_rename_index(list, index, entry) >= 0) {
+                entry->name = NULL;
+            }
+            break;
+        }
+    }
+    free(table);
+}
+
+// 结束重新扫描并提交：complete 为真时本轮没有出现的文件项已被删除（".." 除外）
+void file_list_rescan_end(FileList *list, bool complete) {
+    if (!list || !list->rescan) {
+        return;
+    }
+
+    struct FileListRescan *rescan = list->rescan;
+    bool sorted = rescan->pending ? rescan->sorted : list->is_sorted;
+    bool full = complete && !rescan->partial;
+
+    for (int i = 0; i < rescan->added_count; i++) {
+        rescan->added[i].name = rescan->names + rescan->added_names[i];
+    }
+    if (full) {
+        file_list_rescan_match_renames(list, rescan);
+    }
+    for (int i = 0; i < rescan->added_count; i++) {
+        if (rescan->added[i].name) {
+            file_list_upsert(list, &rescan->added[i]);
+        }
+    }
+
+    if (full) {
+        for (int i = list->has_parent_item ? 1 : 0; i < list->count; i++) {
+            if (list->columns.mark[i] == DELTA_MARK_NONE) {
+                list->columns.mark[i] = DELTA_MARK_REMOVED;
+            }
+        }
+    }
+
+    // 先结束重新扫描，提交时清除全部标记
+    file_list_rescan_free(list);
+    file_list_commit_deltas(list, sorted);
+}
+
+// 重新扫描回调：记录目录项
+static bool file_list_rescan_callback(const DirScanEntry *entry, void *user_data) {
+    file_list_rescan_add((FileList*)user_data, entry);
+    return true;
+}
+
+// 重新扫描当前目录，只把与列表的差异作为增量变更应用
+bool file_list_rescan_directory(FileList *list) {
+    if (!list || !list->current_dir) {
+        return false;
+    }
+
+    file_list_rescan_begin(list);
+    bool result = dir_scan(list->current_dir, DIR_SCAN_STAT, file_list_rescan_callback, list);
+    if (!result) {
+        printf("[ERROR] Failed to rescan directory: %s\n", list->current_dir);
+    }
+
+    // 扫描失败时只保留已读到的新增和更新
+    file_list_rescan_end(list, result);
+    return result;
 }
 
 // 获取文件类型
@@ -0,0 +1,225 @@
+/*
+ * 多选集合模块
+ * 职责：
+ * 1. 用位图记录可见项的选中状态（每项一位）
+ * 2. 范围选择、全选、清空按64位字批量设置，与字数成正比
+ * 3. 维护选中数，按位图跳过未选中的字遍历选中项
+ */
+
+#include "selection.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 每个字的位数
+#define SELECTION_WORD_BITS 64
+
+// 字中置位的个数
+static int selection_popcount(Uint64 word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// 最低置位的位置（word 不为0）
+static int selection_lowest_bit(Uint64 word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+// 容纳 count 位需要的字数
+static int selection_word_count(int count) {
+    return (count + SELECTION_WORD_BITS - 1) / SELECTION_WORD_BITS;
+}
+
+// 从 first 到 last（包含）的位在所在字中的掩码（两者在同一个字中）
+static Uint64 selection_mask(int first, int last) {
+    int lo = first % SELECTION_WORD_BITS;
+    int hi = last % SELECTION_WORD_BITS;
+    Uint64 upper = hi == SELECTION_WORD_BITS - 1 ? ~0ULL : ((1ULL << (hi + 1)) - 1);
+    return upper & ~((1ULL << lo) - 1);
+}
+
+// 设置一个字中 mask 部分的位，并更新选中数
+static void selection_apply(Selection *sel, int word, Uint64 mask, bool selected) {
+    Uint64 old = sel->words[word];
+    Uint64 value = selected ? (old | mask) : (old & ~mask);
+    sel->selected += selection_popcount(value) - selection_popcount(old);
+    sel->words[word] = value;
+}
+
+// 初始化
+void selection_init(Selection *sel) {
+    if (!sel) {
+        return;
+    }
+    sel->words = NULL;
+    sel->word_capacity = 0;
+    sel->count = 0;
+    sel->selected = 0;
+    sel->anchor = -1;
+}
+
+// 释放位图
+void selection_destroy(Selection *sel) {
+    if (!sel) {
+        return;
+    }
+    free(sel->words);
+    selection_init(sel);
+}
+
+// 设置项目数
+bool selection_resize(Selection *sel, int count) {
+    if (!sel || count < 0) {
+        return false;
+    }
+
+    int words = selection_word_count(count);
+    if (words > sel->word_capacity) {
+        int capacity = sel->word_capacity > 0 ? sel->word_capacity : 16;
+        while (capacity < words) {
+            capacity *= 2;
+        }
+        Uint64 *grown = (Uint64*)realloc(sel->words, sizeof(Uint64) * (size_t)capacity);
+        if (!grown) {
+            return false;
+        }
+        // 新增的字清零，之后扩大项目数时不必再清
+        memset(grown + sel->word_capacity, 0, sizeof(Uint64) * (size_t)(capacity - sel->word_capacity));
+        sel->words = grown;
+        sel->word_capacity = capacity;
+    }
+
+    // 缩小时清除超出部分，保证有效位之外始终为0
+    if (count < sel->count) {
+        selection_set_range(sel, count, sel->count - 1, false);
+    }
+    sel->count = count;
+    if (sel->anchor >= count) {
+        sel->anchor = -1;
+    }
+    return true;
+}
+
+// 取消全部选择
+void selection_clear(Selection *sel) {
+    if (!sel || !sel->words) {
+        return;
+    }
+    memset(sel->words, 0, sizeof(Uint64) * (size_t)selection_word_count(sel->count));
+    sel->selected = 0;
+}
+
+// 全选
+void selection_select_all(Selection *sel) {
+    if (!sel || sel->count == 0) {
+        return;
+    }
+    int words = selection_word_count(sel->count);
+    memset(sel->words, 0xFF, sizeof(Uint64) * (size_t)words);
+    // 最后一个字只保留有效位
+    int tail = sel->count % SELECTION_WORD_BITS;
+    if (tail != 0) {
+        sel->words[words - 1] = (1ULL << tail) - 1;
+    }
+    sel->selected = sel->count;
+}
+
+// 是否选中
+bool selection_contains(const Selection *sel, int index) {
+    if (!sel || index < 0 || index >= sel->count) {
+        return false;
+    }
+    return (sel->words[index / SELECTION_WORD_BITS] >> (index % SELECTION_WORD_BITS)) & 1;
+}
+
+// 设置单个项目的选中状态
+void selection_set(Selection *sel, int index, bool selected) {
+    if (!sel || index < 0 || index >= sel->count) {
+        return;
+    }
+    selection_apply(sel, index / SELECTION_WORD_BITS, 1ULL << (index % SELECTION_WORD_BITS), selected);
+}
+
+// 切换单个项目的选中状态
+void selection_toggle(Selection *sel, int index) {
+    selection_set(sel, index, !selection_contains(sel, index));
+}
+
+// 设置 first 到 last 之间项目的选中状态
+void selection_set_range(Selection *sel, int first, int last, bool selected) {
+    if (!sel || sel->count == 0) {
+        return;
+    }
+    if (first > last) {
+        int swap = first;
+        first = last;
+        last = swap;
+    }
+    if (first < 0) {
+        first = 0;
+    }
+    if (last >= sel->count) {
+        last = sel->count - 1;
+    }
+    if (first > last) {
+        return;
+    }
+
+    int first_word = first / SELECTION_WORD_BITS;
+    int last_word = last / SELECTION_WORD_BITS;
+    if (first_word == last_word) {
+        selection_apply(sel, first_word, selection_mask(first, last), selected);
+        return;
+    }
+
+    // 两端的字部分设置，中间的字整字设置
+    selection_apply(sel, first_word, selection_mask(first, first_word * SELECTION_WORD_BITS + SELECTION_WORD_BITS - 1), selected);
+    for (int word = first_word + 1; word < last_word; word++) {
+        selection_apply(sel, word, ~0ULL, selected);
+    }
+    selection_apply(sel, last_word, selection_mask(last_word * SELECTION_WORD_BITS, last), selected);
+}
+
+// 选中的项目数
+int selection_count(const Selection *sel) {
+    return sel ? sel->selected : 0;
+}
+
+// 从 from 开始的第一个选中项
+int selection_next(const Selection *sel, int from) {
+    if (!sel || sel->selected == 0) {
+        return -1;
+    }
+    if (from < 0) {
+        from = 0;
+    }
+    if (from >= sel->count) {
+        return -1;
+    }
+
+    int words = selection_word_count(sel->count);
+    int word = from / SELECTION_WORD_BITS;
+    // 第一个字去掉 from 之前的位
+    Uint64 bits = sel->words[word] & ~((1ULL << (from % SELECTION_WORD_BITS)) - 1);
+    while (bits == 0) {
+        if (++word >= words) {
+            return -1;
+        }
+        bits = sel->words[word];
+    }
+    return word * SELECTION_WORD_BITS + selection_lowest_bit(bits);
+}
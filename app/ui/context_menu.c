@@ -9,6 +9,7 @@
 
 #include "context_menu.h"
 #include "renderer.h"
+#include "ui_renderer.h"
 #include "file_ops.h"
 #include "file_list.h"
 #include <string.h>
@@ -129,7 +130,6 @@ static void calculate_menu_size(ContextMenu *menu) {
         return;
     }
     
-    TTF_Font *font = menu->window->font;
     int max_width = MENU_MIN_WIDTH;
     int total_height = MENU_PADDING * 2;
     
@@ -140,7 +140,7 @@ static void calculate_menu_size(ContextMenu *menu) {
         } else if (item->type == MENU_ITEM_ACTION && item->text) {
             // 计算文本宽度
             int text_width, text_height;
-            if (TTF_GetStringSize(font, item->text, strlen(item->text), &text_width, &text_height)) {
+            if (ui_text_size(menu->window, item->text, strlen(item->text), &text_width, &text_height)) {
                 int item_width = text_width + MENU_PADDING * 2;
                 if (item_width > max_width) {
                     max_width = item_width;
@@ -204,6 +204,8 @@ void context_menu_show_for_file(ContextMenu *menu, FileItem *item, int x, int y)
     }
     
     menu->target_item = item;
+    menu->target_generation = menu->file_list_view && menu->file_list_view->files ?
+                              menu->file_list_view->files->generation : 0;
     create_file_menu_items(menu, item);
     calculate_menu_size(menu);
     
@@ -219,6 +221,7 @@ void context_menu_show_for_file(ContextMenu *menu, FileItem *item, int x, int y)
     }
     
     menu->visible = true;
+    window_invalidate(menu->window, UI_DIRTY_CONTEXT_MENU);
 }
 
 // 显示空白区域右键菜单
@@ -243,6 +246,7 @@ void context_menu_show_for_blank(ContextMenu *menu, int x, int y) {
     }
     
     menu->visible = true;
+    window_invalidate(menu->window, UI_DIRTY_CONTEXT_MENU);
 }
 
 // 隐藏菜单
@@ -251,6 +255,10 @@ void context_menu_hide(ContextMenu *menu) {
         return;
     }
     
+    // 菜单直接画在合成后的面板上，隐藏后重新合成即可
+    if (menu->visible) {
+        window_invalidate(menu->window, UI_DIRTY_CONTEXT_MENU);
+    }
     menu->visible = false;
     menu->target_item = NULL;
 }
@@ -344,22 +352,10 @@ void context_menu_draw(ContextMenu *menu) {
         if (item->type == MENU_ITEM_ACTION && item->text) {
             // 绘制菜单项文本
             SDL_Color text_color = item->enabled ? MENU_TEXT_COLOR : MENU_DISABLED_COLOR;
-            SDL_Surface *text_surface = TTF_RenderText_Blended(font, item->text, 0, text_color);
-            
-            if (text_surface) {
-                SDL_Texture *text_texture = SDL_CreateTextureFromSurface(renderer, text_surface);
-                if (text_texture) {
-                    SDL_FRect text_rect = {
-                        menu->x + MENU_PADDING,
-                        item_y + (MENU_ITEM_HEIGHT - text_surface->h) / 2,
-                        text_surface->w,
-                        text_surface->h
-                    };
-                    SDL_RenderTexture(renderer, text_texture, NULL, &text_rect);
-                    SDL_DestroyTexture(text_texture);
-                }
-                SDL_DestroySurface(text_surface);
-            }
+            ui_text_draw(menu->window, item->text, 0,
+                         menu->x + MENU_PADDING,
+                         item_y + (MENU_ITEM_HEIGHT - TTF_GetFontHeight(font)) / 2,
+                         text_color, 0);
             
             item_y += MENU_ITEM_HEIGHT;
         } else if (item->type == MENU_ITEM_SEPARATOR) {
@@ -373,6 +369,56 @@ void context_menu_draw(ContextMenu *menu) {
         
         item = item->next;
     }
+    
+    // 提交菜单文字
+    ui_text_flush(menu->window);
+}
+
+// 菜单作用的文件项：目标项已选中时为全部选中项，否则只有目标项（不含 ".."），调用者释放数组
+static FileItem** context_menu_get_targets(ContextMenu *menu, int *count) {
+    *count = 0;
+    if (!menu->target_item || !menu->target_item->path) {
+        return NULL;
+    }
+
+    FileListView *view = menu->file_list_view;
+    if (view && view->files) {
+        int index = file_list_visible_index_of(view->files, menu->target_item);
+        if (file_list_view_is_selected(view, index)) {
+            return file_list_view_get_selected_items(view, count);
+        }
+    }
+
+    if (strcmp(menu->target_item->name, "..") == 0) {
+        return NULL;
+    }
+    FileItem **items = (FileItem**)malloc(sizeof(FileItem*));
+    if (!items) {
+        printf("[ERROR] Failed to allocate menu target list\n");
+        return NULL;
+    }
+    items[0] = menu->target_item;
+    *count = 1;
+    return items;
+}
+
+// 目标文件项的路径数组（指向文件项自身的路径，文件列表刷新前有效），调用者释放数组
+static const char** context_menu_get_target_paths(ContextMenu *menu, int *count) {
+    FileItem **items = context_menu_get_targets(menu, count);
+    if (!items) {
+        return NULL;
+    }
+    const char **paths = (const char**)malloc(sizeof(const char*) * (size_t)*count);
+    if (paths) {
+        for (int i = 0; i < *count; i++) {
+            paths[i] = items[i]->path;
+        }
+    } else {
+        printf("[ERROR] Failed to allocate menu target paths\n");
+        *count = 0;
+    }
+    free(items);
+    return paths;
 }
 
 // 执行菜单动作
@@ -381,6 +427,16 @@ void context_menu_execute_action(ContextMenu *menu, MenuAction action) {
         return;
     }
     
+    // 菜单打开期间列表被清空或压缩时目标文件项已重新分配，被删除的文件项也不再操作
+    FileListView *view = menu->file_list_view;
+    if (menu->target_item && view && view->files &&
+        (view->files->generation != menu->target_generation || menu->target_item->index < 0)) {
+        printf("Target file no longer exists\n");
+        menu->target_item = NULL;
+    }
+
+    int count = 0;
+    
     switch (action) {
         case ACTION_OPEN:
             printf("Executing action: Open\n");
@@ -388,34 +444,29 @@ void context_menu_execute_action(ContextMenu *menu, MenuAction action) {
             break;
             
         case ACTION_COPY:
-            if (menu->target_item && menu->target_item->path) {
-                if (file_ops_copy(menu->target_item->path)) {
-                    printf("File copied to clipboard: %s\n", menu->target_item->path);
-                } else {
-                    printf("Failed to copy file: %s\n", menu->target_item->path);
-                }
-            } else {
-                printf("No target file selected for copy\n");
+        case ACTION_CUT: {
+            // 作用于全部选中项
+            const char **paths = context_menu_get_target_paths(menu, &count);
+            if (!paths) {
+                printf("No target file selected for %s\n", action == ACTION_COPY ? "copy" : "cut");
+                break;
             }
-            break;
-            
-        case ACTION_CUT:
-            if (menu->target_item && menu->target_item->path) {
-                if (file_ops_cut(menu->target_item->path)) {
-                    printf("File cut to clipboard: %s\n", menu->target_item->path);
-                } else {
-                    printf("Failed to cut file: %s\n", menu->target_item->path);
-                }
+            bool copied = action == ACTION_COPY ? file_ops_copy_paths(paths, count) :
+                                                  file_ops_cut_paths(paths, count);
+            if (copied) {
+                printf("%d file(s) %s to clipboard\n", count, action == ACTION_COPY ? "copied" : "cut");
             } else {
-                printf("No target file selected for cut\n");
+                printf("Failed to %s %d file(s)\n", action == ACTION_COPY ? "copy" : "cut", count);
             }
+            free(paths);
             break;
+        }
             
         case ACTION_PASTE:
             if (file_ops_has_clipboard_data()) {
                 const char *target_dir = menu->current_dir ? menu->current_dir : ".";
                 if (file_ops_paste(target_dir)) {
-                    printf("File pasted successfully to: %s\n", target_dir);
+                    printf("Paste started to: %s\n", target_dir);
                     // TODO: 刷新文件列表
                 } else {
                     printf("Failed to paste file to: %s\n", target_dir);
@@ -425,24 +476,22 @@ void context_menu_execute_action(ContextMenu *menu, MenuAction action) {
             }
             break;
             
-        case ACTION_DELETE:
-            if (menu->target_item && menu->target_item->path) {
-                // 跳过 ".." 目录项
-                if (strcmp(menu->target_item->name, "..") == 0) {
-                    printf("Cannot delete parent directory entry\n");
-                    break;
-                }
-                
-                if (file_ops_delete(menu->target_item->path)) {
-                    printf("File deleted successfully: %s\n", menu->target_item->path);
-                    // TODO: 刷新文件列表
-                } else {
-                    printf("Failed to delete file: %s\n", menu->target_item->path);
-                }
-            } else {
+        case ACTION_DELETE: {
+            // 作用于全部选中项（".." 目录项已跳过），作为一个任务删除
+            const char **paths = context_menu_get_target_paths(menu, &count);
+            if (!paths) {
                 printf("No target file selected for delete\n");
+                break;
             }
+            if (file_ops_delete_paths(paths, count)) {
+                printf("Delete started: %d file(s)\n", count);
+                // TODO: 刷新文件列表
+            } else {
+                printf("Failed to delete %d file(s)\n", count);
+            }
+            free(paths);
             break;
+        }
             
         case ACTION_RENAME:
             if (menu->target_item && menu->target_item->path) {
@@ -455,21 +504,8 @@ void context_menu_execute_action(ContextMenu *menu, MenuAction action) {
                 // 开始内联编辑重命名
                 if (menu->file_list_view && menu->file_list_view->files) {
                     // 找到目标文件在可见文件列表中的索引
-                    int item_index = -1;
-                    int visible_index = 0;
-                    FileItem *current_item = menu->file_list_view->files->head;
-                    
-                    while (current_item) {
-                        // 只计算可见项目的索引
-                        if (!current_item->is_hidden || menu->file_list_view->show_hidden) {
-                            if (current_item == menu->target_item) {
-                                item_index = visible_index;
-                                break;
-                            }
-                            visible_index++;
-                        }
-                        current_item = current_item->next;
-                    }
+                    int item_index = file_list_visible_index_of(menu->file_list_view->files,
+                                                                menu->target_item);
                     
                     if (item_index >= 0) {
                         printf("开始重命名文件: %s\n", menu->target_item->name);
@@ -485,14 +521,34 @@ void context_menu_execute_action(ContextMenu *menu, MenuAction action) {
             }
             break;
             
-        case ACTION_PROPERTIES:
-            if (menu->target_item && menu->target_item->path) {
-                printf("Showing properties for: %s\n", menu->target_item->path);
-                // TODO: 实现属性对话框
-            } else {
+        case ACTION_PROPERTIES: {
+            FileItem **items = context_menu_get_targets(menu, &count);
+            if (!items) {
                 printf("No target file selected for properties\n");
+                break;
             }
+            if (count == 1) {
+                printf("Showing properties for: %s\n", items[0]->path);
+            } else {
+                // 多选时汇总文件数、目录数和文件总大小（目录大小不递归统计）
+                int directories = 0;
+                size_t total_size = 0;
+                for (int i = 0; i < count; i++) {
+                    if (items[i]->type == FILE_TYPE_DIRECTORY) {
+                        directories++;
+                    } else {
+                        total_size += items[i]->size;
+                    }
+                }
+                char size_text[32];
+                get_size_string(total_size, size_text, sizeof(size_text));
+                printf("Showing properties for %d items: %d file(s), %d folder(s), %s\n",
+                       count, count - directories, directories, size_text);
+            }
+            // TODO: 实现属性对话框
+            free(items);
             break;
+        }
             
         case ACTION_NEW_FOLDER:
             printf("New folder functionality requires UI input dialog\n");
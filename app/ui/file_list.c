@@ -2,7 +2,7 @@
  * 文件列表视图模块
  * 职责：
  * 1. 实现文件列表显示（详细信息、图标、列表等视图模式）
- * 2. 文件项的选择和高亮
+ * 2. 文件项的选择和高亮（单击、Ctrl 切换、Shift 范围选择、Ctrl+A 全选）
  * 3. 拖放操作支持
  * 4. 右键菜单支持
  * 5. 文件排序和过滤
@@ -19,7 +19,12 @@
 #include "file_list.h"
 #include "file_item.h"
 #include "renderer.h"
+#include "ui_renderer.h"
 #include "file_ops.h"
+#include "dir_loader.h"
+#include "file_watcher.h"
+#include "sort.h"
+#include "thumbnail.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -39,10 +44,12 @@
 #define DEFAULT_ITEM_WIDTH 100
 #define DEFAULT_ITEM_HEIGHT 80
 #define DEFAULT_LIST_ITEM_HEIGHT 30
-
-// 图标路径
-#define FOLDER_ICON_PATH "images/folder.png"
-#define FILE_ICON_PATH "images/file.png"
+// 编辑时光标闪烁间隔（毫秒）
+#define FILE_LIST_BLINK_INTERVAL 500
+// 后台加载期间主循环最长等待时间（毫秒）
+#define FILE_LIST_LOADER_POLL_INTERVAL 100
+// 每次更新最多上传的缩略图数（其余留到下一次更新，避免一帧内上传过多）
+#define FILE_LIST_THUMBNAIL_UPLOADS 16
 
 // Helper functions for formatting file size and time
 static void format_file_size(uint64_t size, char *buffer, size_t buffer_size) {
@@ -72,6 +79,242 @@ static void format_time(time_t time_value, char *buffer, size_t buffer_size) {
     }
 }
 
+// 文件列表的网格布局：项目 i 位于第 i / columns 行、第 i % columns 列
+// 可见行由滚动偏移直接算出，绘制和命中测试只处理这些行，与目录大小无关
+typedef struct {
+    int columns;             // 每行项目数（列表和详细信息视图为1）
+    int cell_x;              // 第一个单元格左上角（窗口坐标，未滚动时）
+    int cell_y;
+    int cell_width;          // 列距
+    int cell_height;         // 行距
+    int padding;             // 项目内容相对单元格的缩进
+    int content_top;         // 内容区域顶部（详细信息视图在表头之下）
+    int rows;                // 总行数
+} FileListLayout;
+
+// 详细信息视图表头高度
+#define DETAILS_HEADER_HEIGHT 30
+
+// 计算当前视图模式的网格布局
+static void file_list_view_get_layout(FileListView *view, FileListLayout *layout) {
+    int count = view->files ? view->files->visible_count : 0;
+
+    if (view->view_mode == VIEW_MODE_ICONS) {
+        // 单元格为项目四周各留5像素，绘制选中背景时整格填充
+        layout->cell_width = view->item_width + 10;
+        layout->cell_height = view->item_height + 10;
+        layout->cell_x = view->viewport.x + 5;
+        layout->cell_y = view->viewport.y + 5;
+        layout->padding = 5;
+        layout->content_top = view->viewport.y;
+        layout->columns = (view->viewport.w - 10) / layout->cell_width;
+        if (layout->columns < 1) {
+            layout->columns = 1;
+        }
+    } else {
+        int header_height = (view->view_mode == VIEW_MODE_DETAILS) ? DETAILS_HEADER_HEIGHT : 0;
+        layout->cell_width = view->viewport.w;
+        layout->cell_height = view->item_height;
+        layout->cell_x = view->viewport.x;
+        layout->cell_y = view->viewport.y + 5 + header_height;
+        layout->padding = 0;
+        layout->content_top = view->viewport.y + 5 + header_height;
+        layout->columns = 1;
+    }
+
+    layout->rows = (count + layout->columns - 1) / layout->columns;
+}
+
+// 项目内容左上角（窗口坐标，x 可以为NULL）
+static void file_list_view_item_origin(FileListView *view, const FileListLayout *layout, int index,
+                                       int *x, int *y) {
+    int row = index / layout->columns;
+    int column = index % layout->columns;
+    if (x) {
+        *x = layout->cell_x + column * layout->cell_width + layout->padding;
+    }
+    *y = layout->cell_y + row * layout->cell_height - view->scroll_offset_y + layout->padding;
+}
+
+// 与窗口纵向区间 [top, bottom) 相交的项目下标范围 [*first, *end)
+static void file_list_view_visible_range(FileListView *view, const FileListLayout *layout,
+                                         int top, int bottom, int *first, int *end) {
+    int count = view->files->visible_count;
+    *first = 0;
+    *end = 0;
+
+    int rel_top = top - layout->cell_y + view->scroll_offset_y;
+    int rel_bottom = bottom - layout->cell_y + view->scroll_offset_y;
+    if (count == 0 || rel_bottom <= 0 || bottom <= top) {
+        return;
+    }
+
+    int first_row = rel_top > 0 ? rel_top / layout->cell_height : 0;
+    int last_row = (rel_bottom - 1) / layout->cell_height;
+    if (first_row >= layout->rows) {
+        return;
+    }
+    if (last_row >= layout->rows) {
+        last_row = layout->rows - 1;
+    }
+
+    *first = first_row * layout->columns;
+    *end = (last_row + 1) * layout->columns;
+    if (*end > count) {
+        *end = count;
+    }
+}
+
+// 当前裁剪区域内需要绘制的项目范围（裁剪区域为空时范围为空）
+static void file_list_view_clip_range(FileListView *view, const FileListLayout *layout, int *first, int *end) {
+    SDL_Rect clip = view->viewport;
+    SDL_Renderer *renderer = view->window->renderer;
+    if (SDL_RenderClipEnabled(renderer)) {
+        SDL_GetRenderClipRect(renderer, &clip);
+    }
+    file_list_view_visible_range(view, layout, clip.y, clip.y + clip.h, first, end);
+}
+
+// 窗口坐标处的项目下标（没有项目时返回-1）
+static int file_list_view_index_at(FileListView *view, int x, int y) {
+    FileListLayout layout;
+    file_list_view_get_layout(view, &layout);
+    if (y < layout.content_top || y >= view->viewport.y + view->viewport.h) {
+        return -1;
+    }
+
+    int rel_x = x - layout.cell_x;
+    int rel_y = y - layout.cell_y + view->scroll_offset_y;
+    if (rel_x < 0 || rel_y < 0) {
+        return -1;
+    }
+
+    int column = rel_x / layout.cell_width;
+    if (column >= layout.columns) {
+        return -1;
+    }
+    int index = (rel_y / layout.cell_height) * layout.columns + column;
+    return index < view->files->visible_count ? index : -1;
+}
+
+// 视图排序方式对应的排序关键字
+static SortKey sort_key_for_mode(SortMode mode) {
+    switch (mode) {
+        case SORT_BY_SIZE:          return SORT_KEY_SIZE;
+        case SORT_BY_TYPE:          return SORT_KEY_TYPE;
+        case SORT_BY_DATE_MODIFIED: return SORT_KEY_DATE;
+        case SORT_BY_NAME:
+        default:                    return SORT_KEY_NAME;
+    }
+}
+
+// 选中项和编辑项（按对象记录，列表重排或增量更新后据此恢复下标）
+typedef struct {
+    FileItem *selected;
+    FileItem *editing;
+    FileItem *anchor;        // 范围选择的起点
+    bool marked;             // 是否由这一次保存把选中状态记录到文件项的 is_selected
+} ViewSelection;
+
+// 标记文件列表需要重绘
+static void file_list_view_invalidate(FileListView *view) {
+    window_invalidate(view->window, UI_DIRTY_FILE_LIST);
+    // 内容、顺序或滚动位置可能变化，下一次更新时重新请求缩略图
+    view->thumbnail_first = -1;
+}
+
+// 标记编辑框需要重绘（编辑框还没有绘制过时重绘整个列表）
+static void file_list_view_invalidate_edit(FileListView *view) {
+    if (view->edit_rect.w > 0) {
+        window_invalidate_rect(view->window, UI_DIRTY_FILE_LIST, &view->edit_rect);
+    } else {
+        file_list_view_invalidate(view);
+    }
+}
+
+// 记录编辑框区域（包含边框）
+static void file_list_view_set_edit_rect(FileListView *view, const SDL_FRect *rect) {
+    view->edit_rect.x = (int)SDL_floorf(rect->x) - 1;
+    view->edit_rect.y = (int)SDL_floorf(rect->y) - 1;
+    view->edit_rect.w = (int)SDL_ceilf(rect->w) + 2;
+    view->edit_rect.h = (int)SDL_ceilf(rect->h) + 2;
+}
+
+// 重新开始光标闪烁周期（编辑内容或光标位置变化后光标立即可见）
+static void file_list_view_reset_blink(FileListView *view) {
+    view->last_blink_time = SDL_GetTicks();
+    view->cursor_visible = true;
+    file_list_view_invalidate_edit(view);
+}
+
+// 多选集合的项目数与可见项数保持一致（加载期间可见项不断增加）
+static void file_list_view_sync_selection(FileListView *view) {
+    int count = view->files ? view->files->visible_count : 0;
+    if (view->selection.count != count) {
+        selection_resize(&view->selection, count);
+    }
+}
+
+// 记录当前选中项和编辑项（选中集合记录到文件项的 is_selected，只有最外层保存记录）
+static ViewSelection file_list_view_save_selection(FileListView *view) {
+    ViewSelection saved;
+    saved.selected = file_list_get_visible(view->files, view->selected_index);
+    saved.editing = view->is_editing ? file_list_get_visible(view->files, view->editing_index) : NULL;
+    saved.anchor = file_list_get_visible(view->files, view->selection.anchor);
+    saved.marked = !view->selection_saved;
+    if (saved.marked) {
+        for (int i = selection_next(&view->selection, 0); i >= 0; i = selection_next(&view->selection, i + 1)) {
+            FileItem *item = file_list_get_visible(view->files, i);
+            if (item) {
+                item->is_selected = true;
+            }
+        }
+        view->selection_saved = true;
+    }
+    return saved;
+}
+
+// 恢复选中项和编辑项的可见下标（文件项已删除或被隐藏时为-1）
+static void file_list_view_restore_selection(FileListView *view, const ViewSelection *saved) {
+    if (saved->selected) {
+        view->selected_index = file_list_visible_index_of(view->files, saved->selected);
+    }
+    if (saved->editing) {
+        view->editing_index = file_list_visible_index_of(view->files, saved->editing);
+    }
+    if (!saved->marked) {
+        return;
+    }
+
+    // 按文件项的标记重建位图，然后清除全部标记（包括被隐藏的文件项）
+    FileList *list = view->files;
+    file_list_view_sync_selection(view);
+    selection_clear(&view->selection);
+    for (int i = 0; i < list->visible_count; i++) {
+        FileItem *item = list->items[list->visible[i]];
+        if (item->is_selected) {
+            selection_set(&view->selection, i, true);
+        }
+    }
+    for (int i = 0; i < list->count; i++) {
+        list->items[i]->is_selected = false;
+    }
+    view->selection.anchor = saved->anchor ? file_list_visible_index_of(list, saved->anchor) : -1;
+    view->selection_saved = false;
+}
+
+// 按当前排序方式排序，选中项和编辑项按对象保持不变
+static void file_list_view_apply_sort(FileListView *view) {
+    ViewSelection saved = file_list_view_save_selection(view);
+    bool sorted = sort_file_list(view->files, sort_key_for_mode(view->sort_mode), false);
+
+    // 排序失败时也要恢复，否则选中标记留在文件项上，之后的保存和恢复都被跳过
+    file_list_view_restore_selection(view, &saved);
+    if (sorted) {
+        file_list_view_invalidate(view);
+    }
+}
+
 // 目录变更回调函数类型 - 用于通知toolbar
 
 
@@ -88,6 +331,95 @@ void file_list_view_set_mode(FileListView *view, ViewMode mode);
 // 刷新文件列表
 void file_list_view_refresh(FileListView *view);
 
+// 停止监控当前目录，丢弃尚未应用的变更
+static void file_list_view_stop_watching(FileListView *view) {
+    file_watcher_batch_free(view->deferred_changes);
+    view->deferred_changes = NULL;
+    file_watcher_stop(view->watcher);
+    view->watcher = NULL;
+}
+
+// 把一批目录变更作为增量应用到列表，选中项和编辑项按对象保持不变
+static void file_list_view_apply_changes(FileListView *view, FileWatchBatch *batch) {
+    if (batch->flags & FILE_WATCH_BATCH_RESCAN) {
+        // 事件有丢失，监控线程分批送来重新扫描的目录项，按 inode 和修改时间比对
+        // 比对中删除和改名的文件项在下面压缩时回收，反复重新扫描时列表占用的内存不会增长
+        ViewSelection saved = file_list_view_save_selection(view);
+        if (batch->flags & FILE_WATCH_BATCH_FIRST) {
+            file_list_rescan_begin(view->files);
+        }
+        for (int i = 0; i < batch->count; i++) {
+            file_list_rescan_add(view->files, &batch->changes[i].entry);
+        }
+        if (batch->flags & FILE_WATCH_BATCH_LAST) {
+            file_list_rescan_end(view->files, !(batch->flags & FILE_WATCH_BATCH_INCOMPLETE));
+        } else {
+            file_list_rescan_commit(view->files);
+        }
+        if (!view->files->is_sorted) {
+            file_list_view_apply_sort(view);
+        }
+        file_list_view_restore_selection(view, &saved);
+    } else if (batch->count > 0) {
+        FileListDelta *deltas = (FileListDelta*)malloc(sizeof(FileListDelta) * (size_t)batch->count);
+        if (deltas) {
+            for (int i = 0; i < batch->count; i++) {
+                const FileWatchChange *change = &batch->changes[i];
+                deltas[i].entry = &change->entry;
+                deltas[i].old_name = change->old_name;
+                switch (change->action) {
+                    case FILE_WATCH_ADDED:   deltas[i].type = FILE_LIST_DELTA_INSERT; break;
+                    case FILE_WATCH_REMOVED: deltas[i].type = FILE_LIST_DELTA_REMOVE; break;
+                    case FILE_WATCH_RENAMED: deltas[i].type = FILE_LIST_DELTA_RENAME; break;
+                    case FILE_WATCH_MODIFIED:
+                    default:                 deltas[i].type = FILE_LIST_DELTA_UPDATE; break;
+                }
+            }
+
+            ViewSelection saved = file_list_view_save_selection(view);
+            file_list_apply_deltas(view->files, deltas, batch->count);
+            if (!view->files->is_sorted) {
+                file_list_view_apply_sort(view);
+            }
+            file_list_view_restore_selection(view, &saved);
+            free(deltas);
+        } else {
+            file_list_view_refresh(view);
+        }
+    }
+
+    // 删除和改名留下的空间较多时重建列表存储（选中状态按下标记录，不受文件项移动影响）
+    file_list_compact(view->files);
+    file_list_view_invalidate(view);
+
+    file_watcher_batch_done(view->watcher, batch);
+}
+
+// 处理目录监控送来的变更事件（不是监控事件时返回 false）
+bool file_list_view_handle_watch_event(FileListView *view, SDL_Event *event) {
+    Uint32 event_type = file_watcher_event_type();
+    if (!view || !event || event_type == 0 || event->type != event_type) {
+        return false;
+    }
+
+    FileWatchBatch *batch = (FileWatchBatch*)event->user.data1;
+    if (!view->watcher || event->user.code != file_watcher_id(view->watcher)) {
+        // 已停止的监控器送来的批次
+        file_watcher_batch_free(batch);
+        return true;
+    }
+
+    // 加载尚未完成时先保存，监控线程在应用之前不会发送下一批
+    if (view->loader) {
+        file_watcher_batch_free(view->deferred_changes);
+        view->deferred_changes = batch;
+        return true;
+    }
+
+    file_list_view_apply_changes(view, batch);
+    return true;
+}
+
 // 创建文件列表视图
 FileListView* file_list_view_new(struct Window *window) {
     if (!window) {
@@ -115,6 +447,9 @@ FileListView* file_list_view_new(struct Window *window) {
     view->item_width = DEFAULT_ITEM_WIDTH;
     view->item_height = DEFAULT_ITEM_HEIGHT;
     view->selected_index = -1;
+    selection_init(&view->selection);
+    view->thumbnail_first = -1;
+    view->thumbnail_end = -1;
     
     view->current_path = NULL;
     
@@ -149,12 +484,106 @@ FileListView* file_list_view_new(struct Window *window) {
     return view;
 }
 
+// 获取文件项的图标（图标类别按扩展名查表，每个类别每种尺寸只在图标缓存中持有一次引用）
+static SDL_Texture* file_list_view_icon(FileListView *view, const FileItem *item, IconSize size) {
+    IconCache *cache = view->window ? view->window->icon_cache : NULL;
+    if (!cache) {
+        return NULL;
+    }
+
+    IconClass icon_class = icon_cache_classify(cache, item->name, item->type);
+    Uint32 bit = 1u << icon_class;
+    if (view->icon_refs[size] & bit) {
+        return icon_cache_texture(cache, icon_class, size);
+    }
+
+    SDL_Texture *icon = icon_cache_acquire(cache, icon_class, size);
+    if (icon) {
+        view->icon_refs[size] |= bit;
+    }
+    return icon;
+}
+
+// 释放视图持有的全部图标引用
+static void file_list_view_release_icons(FileListView *view) {
+    IconCache *cache = view->window ? view->window->icon_cache : NULL;
+    for (int size = 0; size < ICON_SIZE_COUNT; size++) {
+        for (int icon_class = 0; icon_class < ICON_CLASS_COUNT; icon_class++) {
+            if (view->icon_refs[size] & (1u << icon_class)) {
+                icon_cache_release(cache, (IconClass)icon_class, (IconSize)size);
+            }
+        }
+        view->icon_refs[size] = 0;
+    }
+}
+
+// 按可见范围请求缩略图：可见项目从上到下优先，再向上下各预取一屏，离视口越近越先解码
+// 范围没有变化时不重新请求；不在图标视图时取消全部排队的请求
+static void file_list_view_request_thumbnails(FileListView *view, ThumbnailCache *cache) {
+    int first = 0;
+    int end = 0;
+    if (view->view_mode == VIEW_MODE_ICONS && view->files) {
+        FileListLayout layout;
+        file_list_view_get_layout(view, &layout);
+        file_list_view_visible_range(view, &layout, view->viewport.y,
+                                     view->viewport.y + view->viewport.h, &first, &end);
+    }
+    if (first == view->thumbnail_first && end == view->thumbnail_end) {
+        return;
+    }
+    view->thumbnail_first = first;
+    view->thumbnail_end = end;
+
+    int visible = end - first;
+    int lo = first - visible > 0 ? first - visible : 0;
+    int hi = end + visible;
+    if (view->files && hi > view->files->visible_count) {
+        hi = view->files->visible_count;
+    }
+
+    thumbnail_cache_begin_requests(cache);
+    for (int index = lo; index < hi; index++) {
+        FileItem *item = file_list_get_visible(view->files, index);
+        if (!item || !item->path ||
+            icon_cache_classify(view->window->icon_cache, item->name, item->type) != ICON_CLASS_IMAGE) {
+            continue;
+        }
+
+        int priority = index - first;
+        if (index < first) {
+            priority = visible + (first - index);
+        } else if (index >= end) {
+            priority = visible + (index - end + 1);
+        }
+        thumbnail_cache_request(cache, item->path, priority);
+    }
+    thumbnail_cache_end_requests(cache);
+}
+
+// 上传解码完成的缩略图并更新请求
+static void file_list_view_update_thumbnails(FileListView *view) {
+    ThumbnailCache *cache = view->window ? view->window->thumbnails : NULL;
+    if (!cache) {
+        return;
+    }
+
+    if (thumbnail_cache_upload(cache, FILE_LIST_THUMBNAIL_UPLOADS) > 0 &&
+        view->view_mode == VIEW_MODE_ICONS) {
+        window_invalidate(view->window, UI_DIRTY_FILE_LIST);
+    }
+    file_list_view_request_thumbnails(view, cache);
+}
+
 // 释放文件列表视图
 void file_list_view_free(FileListView *view) {
     if (!view) {
         return;
     }
 
+    // 停止后台加载和目录监控
+    file_list_view_cancel_loading(view);
+    file_list_view_stop_watching(view);
+
     // 释放文件列表
     if (view->files) {
         file_list_free(view->files);
@@ -165,34 +594,57 @@ void file_list_view_free(FileListView *view) {
         free(view->current_path);
     }
     
-    if (view->folder_icon) {
-        SDL_DestroyTexture(view->folder_icon);
-    }
-    
-    if (view->file_icon) {
-        SDL_DestroyTexture(view->file_icon);
-    }
+    // 释放持有的图标引用
+    file_list_view_release_icons(view);
     
     // 释放编辑缓冲区
     if (view->edit_buffer) {
         free(view->edit_buffer);
     }
-    
+
+    selection_destroy(&view->selection);
     free(view);
 }
 
-// 加载目录
+// 加载目录（后台线程扫描，目录项逐批合并到列表中）
 bool file_list_view_load_directory(FileListView *view, const char *path) {
     if (!view || !path) {
         return false;
     }
 
+    // 目录不可访问时直接失败，保持原有返回语义
+    if (!fs_is_directory(path)) {
+        return false;
+    }
+
+    // 先复制路径，path 可能就是 view->current_path
+    char *new_path = strdup(path);
+    if (!new_path) {
+        return false;
+    }
+
+    // 导航离开时取消上一次尚未完成的加载，并停止监控旧目录
+    file_list_view_cancel_loading(view);
+    file_list_view_stop_watching(view);
+
     // 重置滚动位置和选择
     view->scroll_offset_y = 0;
     view->selected_index = -1;
+    selection_resize(&view->selection, 0);
 
-    // 加载目录内容
-    bool result = file_list_load_directory(view->files, path);
+    // 清空列表并启动后台扫描（先开始监控，扫描期间的变更在加载完成后应用）
+    bool result = file_list_begin_load(view->files, new_path);
+    if (result) {
+        view->watcher = file_watcher_start(new_path);
+        view->loader = dir_loader_start(new_path);
+        if (!view->loader) {
+            // 无法创建线程时退回同步加载
+            result = file_list_load_directory(view->files, new_path);
+            if (result) {
+                file_list_view_apply_sort(view);
+            }
+        }
+    }
     
     // 如果成功加载，保存当前路径并通知目录变更
     if (result) {
@@ -200,44 +652,125 @@ bool file_list_view_load_directory(FileListView *view, const char *path) {
         if (view->current_path) {
             free(view->current_path);
         }
-        view->current_path = strdup(path);
+        view->current_path = new_path;
         
         // 调用目录变更回调
         if (view->on_directory_changed) {
-            view->on_directory_changed(view, path);
+            view->on_directory_changed(view, new_path);
         }
+        file_list_view_invalidate(view);
+    } else {
+        free(new_path);
     }
     
     return result;
 }
 
-// 加载图标
-bool file_list_view_load_icons(FileListView *view) {
-    if (!view || !view->window || !view->window->renderer) {
-        return false;
+// 主循环每次唤醒时调用：合并后台加载线程送来的目录项，推进光标闪烁
+void file_list_view_update(FileListView *view) {
+    if (!view) {
+        return;
     }
 
-    // 加载文件夹图标
-    SDL_Surface *folder_surface = IMG_Load(FOLDER_ICON_PATH);
-    if (folder_surface) {
-        view->folder_icon = SDL_CreateTextureFromSurface(view->window->renderer, folder_surface);
-        SDL_DestroySurface(folder_surface);
-    } else {
-        printf("Warning: Failed to load folder icon from %s\n", FOLDER_ICON_PATH);
-        view->folder_icon = NULL;
+    // 编辑时光标每 FILE_LIST_BLINK_INTERVAL 毫秒切换一次
+    if (view->is_editing) {
+        Uint64 current_time = SDL_GetTicks();
+        if (current_time - view->last_blink_time >= FILE_LIST_BLINK_INTERVAL) {
+            view->cursor_visible = !view->cursor_visible;
+            view->last_blink_time = current_time;
+            file_list_view_invalidate_edit(view);
+        }
     }
 
-    // 加载文件图标
-    SDL_Surface *file_surface = IMG_Load(FILE_ICON_PATH);
-    if (file_surface) {
-        view->file_icon = SDL_CreateTextureFromSurface(view->window->renderer, file_surface);
-        SDL_DestroySurface(file_surface);
-    } else {
-        printf("Warning: Failed to load file icon from %s\n", FILE_ICON_PATH);
-        view->file_icon = NULL;
+    // 上传后台解码完成的缩略图，按可见范围更新请求
+    file_list_view_update_thumbnails(view);
+
+    if (!view->loader) {
+        return;
+    }
+
+    DirLoadBatch *batch;
+    while ((batch = dir_loader_pop(view->loader)) != NULL) {
+        for (int i = 0; i < batch->count; i++) {
+            file_list_add_entry(view->files, &batch->entries[i]);
+        }
+        dir_loader_batch_free(batch);
+        file_list_view_invalidate(view);
+    }
+
+    bool success = true;
+    if (dir_loader_is_done(view->loader, &success)) {
+        if (!success) {
+            printf("[ERROR] Failed to load directory: %s\n",
+                   view->current_path ? view->current_path : "NULL");
+        }
+        dir_loader_cancel(view->loader);
+        view->loader = NULL;
+
+        // 全部目录项到齐后排序一次
+        file_list_view_apply_sort(view);
+
+        // 应用扫描期间收到的变更
+        if (view->deferred_changes) {
+            struct FileWatchBatch *batch = view->deferred_changes;
+            view->deferred_changes = NULL;
+            file_list_view_apply_changes(view, batch);
+        }
+    }
+}
+
+// 距下一次定时更新的毫秒数（没有定时任务时返回-1）
+int file_list_view_next_timeout(FileListView *view) {
+    if (!view) {
+        return -1;
+    }
+
+    int timeout = -1;
+    if (view->is_editing) {
+        Uint64 elapsed = SDL_GetTicks() - view->last_blink_time;
+        timeout = elapsed >= FILE_LIST_BLINK_INTERVAL ? 0 : (int)(FILE_LIST_BLINK_INTERVAL - elapsed);
+    }
+    if (thumbnail_cache_has_pending_uploads(view->window ? view->window->thumbnails : NULL)) {
+        // 还有解码完成的缩略图没有上传
+        timeout = 0;
+    }
+    if (view->loader && (timeout < 0 || timeout > FILE_LIST_LOADER_POLL_INTERVAL)) {
+        // 加载器通过事件唤醒主循环，事件队列已满时靠低频轮询兜底
+        timeout = FILE_LIST_LOADER_POLL_INTERVAL;
+    }
+    return timeout;
+}
+
+// 是否正在后台加载目录
+bool file_list_view_is_loading(FileListView *view) {
+    return view && view->loader != NULL;
+}
+
+// 取消正在进行的后台加载
+void file_list_view_cancel_loading(FileListView *view) {
+    if (!view || !view->loader) {
+        return;
+    }
+
+    dir_loader_cancel(view->loader);
+    view->loader = NULL;
+}
+
+// 加载图标
+bool file_list_view_load_icons(FileListView *view) {
+    if (!view || !view->window || !view->window->icon_cache) {
+        return false;
     }
 
-    return (view->folder_icon != NULL && view->file_icon != NULL);
+    // 预先获取最常用的文件夹和普通文件图标
+    static const FileItem folder_item = { .type = FILE_TYPE_DIRECTORY };
+    static const FileItem file_item = { .type = FILE_TYPE_REGULAR };
+    bool ok = true;
+    for (int size = 0; size < ICON_SIZE_COUNT; size++) {
+        ok = (file_list_view_icon(view, &folder_item, (IconSize)size) != NULL) && ok;
+        ok = (file_list_view_icon(view, &file_item, (IconSize)size) != NULL) && ok;
+    }
+    return ok;
 }
 
 // 设置视图模式
@@ -254,6 +787,7 @@ void file_list_view_set_mode(FileListView *view, ViewMode mode) {
     } else {
         view->item_height = DEFAULT_LIST_ITEM_HEIGHT;
     }
+    file_list_view_invalidate(view);
 }
 
 // 切换到下一个视图模式
@@ -286,7 +820,9 @@ void file_list_view_set_sort(FileListView *view, SortMode sort) {
     }
 
     view->sort_mode = sort;
-    file_list_view_refresh(view);
+
+    // 排序键在加载时已生成，这里只重排不重新读取目录
+    file_list_view_apply_sort(view);
 }
 
 // 设置是否显示隐藏文件
@@ -295,8 +831,15 @@ void file_list_view_set_show_hidden(FileListView *view, bool show_hidden) {
         return;
     }
 
+    // 可见数组重建前记录选中项，隐藏的文件项取消选择
     view->show_hidden = show_hidden;
-    file_list_view_refresh(view);
+    ViewSelection saved = file_list_view_save_selection(view);
+    file_list_set_show_hidden(view->files, show_hidden);
+    file_list_view_restore_selection(view, &saved);
+
+    // 只改变了可见数组，不重新读取目录；可见行数减少时把滚动位置限制在新的范围内
+    file_list_view_invalidate(view);
+    file_list_view_scroll(view, 0);
 }
 
 // 刷新文件列表
@@ -305,33 +848,21 @@ void file_list_view_refresh(FileListView *view) {
         return;
     }
 
-    // 保存当前选中项的路径（如果有）
-    char *selected_path = NULL;
-    FileItem *selected_item = file_list_view_get_selected_item(view);
-    if (selected_item) {
-        selected_path = strdup(selected_item->path);
-    }
-
-    // 重新加载当前目录
-    file_list_load_directory(view->files, view->files->current_dir);
+    // 刷新时以同步方式重新读取，先停止后台加载
+    file_list_view_cancel_loading(view);
 
-    // 应用排序
-    // TODO: 实现排序功能
+    // 重新扫描并只应用差异，未变化的文件项对象保持不变
+    ViewSelection saved = file_list_view_save_selection(view);
+    file_list_rescan_directory(view->files);
 
-    // 恢复选中状态（如果可能）
-    if (selected_path) {
-        int index = 0;
-        FileItem *item = view->files->head;
-        while (item) {
-            if (strcmp(item->path, selected_path) == 0) {
-                file_list_view_select_item(view, index);
-                break;
-            }
-            item = item->next;
-            index++;
-        }
-        free(selected_path);
+    // 加载被中断时列表尚未排序，新增项追加在末尾
+    if (!view->files->is_sorted) {
+        file_list_view_apply_sort(view);
     }
+
+    file_list_view_restore_selection(view, &saved);
+    file_list_compact(view->files);
+    file_list_view_invalidate(view);
 }
 
 // 绘制文件列表
@@ -343,6 +874,7 @@ void file_list_view_draw(FileListView *view) {
     // 获取渲染器和字体
     SDL_Renderer *renderer = view->window->renderer;
     TTF_Font *font = view->window->font;
+    float line_height = font ? (float)TTF_GetFontHeight(font) : 0.0f;
     
     // 文本颜色
     SDL_Color text_color = {0, 0, 0, 255};
@@ -356,7 +888,7 @@ void file_list_view_draw(FileListView *view) {
         view->viewport.w,
         view->viewport.h
     };
-    SDL_SetRenderClipRect(renderer, &viewportRect);
+    ui_set_clip_rect(view->window, &viewportRect);
     
     // 绘制背景
     SDL_FRect bg_rect = {
@@ -369,189 +901,149 @@ void file_list_view_draw(FileListView *view) {
     SDL_RenderFillRect(renderer, &bg_rect);
     
     // 如果没有文件，显示空目录提示
-    if (!view->files->head) {
+    if (view->files->count == 0) {
         // 设置文本颜色
         SDL_Color empty_color = {128, 128, 128, 255};
         const char* empty_text = "Empty folder";
         size_t text_len = strlen(empty_text);
         
         // 渲染"空目录"文本
-        SDL_Surface *text_surface = TTF_RenderText_Blended(font, empty_text, text_len, empty_color);
-        if (text_surface) {
-            SDL_Texture *text_texture = SDL_CreateTextureFromSurface(renderer, text_surface);
-            if (text_texture) {
-                SDL_FRect text_rect = {
-                    0, 0, 
-                    (float)text_surface->w, 
-                    (float)text_surface->h
-                };
-                text_rect.x = (float)view->viewport.x + ((float)view->viewport.w - text_rect.w) / 2;
-                text_rect.y = (float)view->viewport.y + ((float)view->viewport.h - text_rect.h) / 2;
-                
-                SDL_RenderTexture(renderer, text_texture, NULL, &text_rect);
-                SDL_DestroyTexture(text_texture);
-            }
-            SDL_DestroySurface(text_surface);
+        int text_w = 0;
+        int text_h = 0;
+        if (ui_text_size(view->window, empty_text, text_len, &text_w, &text_h)) {
+            float text_x = (float)view->viewport.x + ((float)view->viewport.w - (float)text_w) / 2;
+            float text_y = (float)view->viewport.y + ((float)view->viewport.h - (float)text_h) / 2;
+            ui_text_draw(view->window, empty_text, text_len, text_x, text_y, empty_color, 0);
         }
         
-        // 重置裁剪区域
-        SDL_SetRenderClipRect(renderer, NULL);
+        // 提交文字并重置裁剪区域
+        ui_text_flush(view->window);
+        ui_set_clip_rect(view->window, NULL);
         return;
     }
 
-    // 计算表头高度
+    // 计算表头高度和网格布局
     int header_height = 0;
     if (view->view_mode == VIEW_MODE_DETAILS) {
-        header_height = 30;
+        header_height = DETAILS_HEADER_HEIGHT;
     }
+    FileListLayout layout;
+    file_list_view_get_layout(view, &layout);
     
     // 根据视图模式绘制文件列表
     if (view->view_mode == VIEW_MODE_ICONS) {
-        // 图标视图
-        int x = (int)view->viewport.x + 10;
-        int y = (int)view->viewport.y + 10 - view->scroll_offset_y;
-        int max_x = (int)view->viewport.x + (int)view->viewport.w - view->item_width - 10;
+        // 图标视图：只遍历与裁剪区域相交的行
+        int first = 0;
+        int end = 0;
+        file_list_view_clip_range(view, &layout, &first, &end);
         
-        // 遍历所有文件项
-        int index = 0;
-        FileItem *item = view->files->head;
-        while (item) {
-            // 跳过隐藏文件
-            if (item->is_hidden && !view->show_hidden) {
-                item = item->next;
-                continue;
+        for (int index = first; index < end; index++) {
+            FileItem *item = file_list_get_visible(view->files, index);
+            int x = 0;
+            int y = 0;
+            file_list_view_item_origin(view, &layout, index, &x, &y);
+            
+            // 确定文本颜色
+            bool selected = selection_contains(&view->selection, index);
+            SDL_Color current_text_color = selected ? selected_text_color : text_color;
+            
+            // 绘制选中背景
+            if (selected) {
+                SDL_SetRenderDrawColor(renderer, selected_bg_color.r, selected_bg_color.g, selected_bg_color.b, selected_bg_color.a);
+                SDL_FRect select_rect = {
+                    (float)(x - 5), 
+                    (float)(y - 5), 
+                    (float)(view->item_width + 10), 
+                    (float)(view->item_height + 10)
+                };
+                SDL_RenderFillRect(renderer, &select_rect);
             }
             
-            // 换行处理
-            if (x > max_x) {
-                x = (int)view->viewport.x + 10;
-                y += view->item_height + 10;
+            // 绘制图标
+            int thumb_w = 0;
+            int thumb_h = 0;
+            SDL_Texture *thumbnail = thumbnail_cache_get(view->window->thumbnails, item->path, &thumb_w, &thumb_h);
+            SDL_Texture *icon = thumbnail ? NULL : file_list_view_icon(view, item, ICON_SIZE_LARGE);
+            if (thumbnail) {
+                // 缩略图等比缩放到图标区域（项目宽 x 32）内居中
+                float scale = SDL_min((float)view->item_width / thumb_w, 32.0f / thumb_h);
+                float draw_w = thumb_w * scale;
+                float draw_h = thumb_h * scale;
+                SDL_FRect thumb_rect = {
+                    (float)x + ((float)view->item_width - draw_w) / 2,
+                    (float)y + (32.0f - draw_h) / 2,
+                    draw_w,
+                    draw_h
+                };
+                SDL_RenderTexture(renderer, thumbnail, NULL, &thumb_rect);
+            } else if (icon) {
+                SDL_FRect icon_rect = {
+                    (float)(x + (view->item_width - 32) / 2), 
+                    (float)y, 
+                    32.0f, 
+                    32.0f
+                };
+                SDL_RenderTexture(renderer, icon, NULL, &icon_rect);
             }
             
-            // 只绘制可见区域内的项目，考虑表头高度
-            int content_start_y = (int)view->viewport.y + header_height;
-            if (y + view->item_height >= content_start_y && y <= (int)view->viewport.y + (int)view->viewport.h) {
-                // 确定文本颜色
-                SDL_Color current_text_color = (index == view->selected_index) ? selected_text_color : text_color;
+            // 绘制文件名或编辑框
+            if (view->is_editing && index == view->editing_index) {
+                // 绘制编辑框
+                SDL_FRect edit_rect = {
+                    (float)(x - 5),
+                    (float)(y + 35),
+                    (float)(view->item_width + 10),
+                    25.0f
+                };
                 
-                // 绘制选中背景
-                if (index == view->selected_index) {
-                    SDL_SetRenderDrawColor(renderer, selected_bg_color.r, selected_bg_color.g, selected_bg_color.b, selected_bg_color.a);
-                    SDL_FRect select_rect = {
-                        (float)(x - 5), 
-                        (float)(y - 5), 
-                        (float)(view->item_width + 10), 
-                        (float)(view->item_height + 10)
-                    };
-                    SDL_RenderFillRect(renderer, &select_rect);
-                }
+                // 绘制编辑框背景
+                file_list_view_set_edit_rect(view, &edit_rect);
+                SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+                SDL_RenderFillRect(renderer, &edit_rect);
                 
-                // 绘制图标
-                SDL_Texture *icon = (item->type == FILE_TYPE_DIRECTORY) ? view->folder_icon : view->file_icon;
-                if (icon) {
-                    SDL_FRect icon_rect = {
-                        (float)(x + (view->item_width - 32) / 2), 
-                        (float)y, 
-                        32.0f, 
-                        32.0f
-                    };
-                    SDL_RenderTexture(renderer, icon, NULL, &icon_rect);
-                }
+                // 绘制编辑框边框
+                SDL_SetRenderDrawColor(renderer, 0, 120, 215, 255);
+                SDL_RenderRect(renderer, &edit_rect);
                 
-                // 绘制文件名或编辑框
-                if (view->is_editing && index == view->editing_index) {
-                    // 绘制编辑框
-                    SDL_FRect edit_rect = {
-                        (float)(x - 5),
-                        (float)(y + 35),
-                        (float)(view->item_width + 10),
-                        25.0f
-                    };
-                    
-                    // 绘制编辑框背景
-                    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-                    SDL_RenderFillRect(renderer, &edit_rect);
-                    
-                    // 绘制编辑框边框
-                    SDL_SetRenderDrawColor(renderer, 0, 120, 215, 255);
-                    SDL_RenderRect(renderer, &edit_rect);
-                    
-                    // 绘制编辑文本
-                    if (view->edit_buffer && strlen(view->edit_buffer) > 0) {
-                        SDL_Color edit_text_color = {0, 0, 0, 255};
-                        size_t edit_len = strlen(view->edit_buffer);
-                        SDL_Surface *edit_surface = TTF_RenderText_Blended(font, view->edit_buffer, edit_len, edit_text_color);
-                        if (edit_surface) {
-                            SDL_Texture *edit_texture = SDL_CreateTextureFromSurface(renderer, edit_surface);
-                            if (edit_texture) {
-                                SDL_FRect edit_text_rect = {
-                                    edit_rect.x + 3,
-                                    edit_rect.y + (edit_rect.h - edit_surface->h) / 2,
-                                    (float)edit_surface->w,
-                                    (float)edit_surface->h
-                                };
-                                
-                                // 限制文本宽度
-                                if (edit_text_rect.w > edit_rect.w - 6) {
-                                    edit_text_rect.w = edit_rect.w - 6;
-                                }
-                                
-                                SDL_RenderTexture(renderer, edit_texture, NULL, &edit_text_rect);
-                                SDL_DestroyTexture(edit_texture);
-                            }
-                            SDL_DestroySurface(edit_surface);
-                        }
+                // 绘制编辑文本
+                if (view->edit_buffer && strlen(view->edit_buffer) > 0) {
+                    SDL_Color edit_text_color = {0, 0, 0, 255};
+                    size_t edit_len = strlen(view->edit_buffer);
+                    int edit_h = 0;
+                    if (ui_text_size(view->window, view->edit_buffer, edit_len, NULL, &edit_h)) {
+                        // 限制文本宽度
+                        ui_text_draw(view->window, view->edit_buffer, edit_len,
+                                     edit_rect.x + 3, edit_rect.y + (edit_rect.h - edit_h) / 2,
+                                     edit_text_color, edit_rect.w - 6);
                     }
-                    
-                    // 绘制光标
-                    Uint32 current_time = SDL_GetTicks();
-                    if (current_time - view->last_blink_time > 500) {
-                        view->cursor_visible = !view->cursor_visible;
-                        view->last_blink_time = current_time;
+                }
+                
+                // 绘制光标（闪烁状态在 file_list_view_update 中切换）
+                if (view->cursor_visible) {
+                    // 计算光标位置
+                    float cursor_x = edit_rect.x + 3;
+                    if (view->edit_buffer && view->edit_cursor_pos > 0) {
+                        // 与绘制使用同一排版计算光标前文字的宽度
+                        int text_w = 0;
+                        ui_text_size(view->window, view->edit_buffer, (size_t)view->edit_cursor_pos, &text_w, NULL);
+                        cursor_x += text_w;
                     }
                     
-                    if (view->cursor_visible) {
-                        // 计算光标位置
-                        float cursor_x = edit_rect.x + 3;
-                        if (view->edit_buffer && view->edit_cursor_pos > 0) {
-                            char temp_char = view->edit_buffer[view->edit_cursor_pos];
-                            view->edit_buffer[view->edit_cursor_pos] = '\0';
-                            
-                            int text_w = 0;
-                            TTF_GetStringSize(font, view->edit_buffer, strlen(view->edit_buffer), &text_w, NULL);
-                            cursor_x += text_w;
-                            
-                            view->edit_buffer[view->edit_cursor_pos] = temp_char;
-                        }
-                        
-                        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-                        SDL_RenderLine(renderer, cursor_x, edit_rect.y + 2, cursor_x, edit_rect.y + edit_rect.h - 2);
-                    }
-                } else {
-                    // 正常绘制文件名
-                    size_t name_len = strlen(item->name);
-                    SDL_Surface *text_surface = TTF_RenderText_Blended(font, item->name, name_len, current_text_color);
-                    if (text_surface) {
-                        SDL_Texture *text_texture = SDL_CreateTextureFromSurface(renderer, text_surface);
-                        if (text_texture) {
-                            SDL_FRect text_rect = {0, 0, 0, 0};
-                            text_rect.w = (text_surface->w > view->item_width) ? (float)view->item_width : (float)text_surface->w;
-                            text_rect.h = (float)text_surface->h;
-                            text_rect.x = (float)x + ((float)view->item_width - text_rect.w) / 2;
-                            text_rect.y = (float)(y + 40);
-                            
-                            SDL_RenderTexture(renderer, text_texture, NULL, &text_rect);
-                            SDL_DestroyTexture(text_texture);
-                        }
-                        SDL_DestroySurface(text_surface);
-                    }
+                    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+                    SDL_RenderLine(renderer, cursor_x, edit_rect.y + 2, cursor_x, edit_rect.y + edit_rect.h - 2);
+                }
+            } else {
+                // 正常绘制文件名
+                size_t name_len = strlen(item->name);
+                int text_w = 0;
+                if (ui_text_size(view->window, item->name, name_len, &text_w, NULL)) {
+                    // 居中显示，超出项宽度的部分裁掉
+                    float text_width = (text_w > view->item_width) ? (float)view->item_width : (float)text_w;
+                    float text_x = (float)x + ((float)view->item_width - text_width) / 2;
+                    ui_text_draw(view->window, item->name, name_len, text_x, (float)(y + 40),
+                                 current_text_color, (float)view->item_width);
                 }
             }
-            
-            // 移动到下一个位置
-            x += view->item_width + 10;
-            index++;
-            item = item->next;
         }
     } else {
         // 列表视图和详细信息视图
@@ -584,59 +1076,26 @@ void file_list_view_draw(FileListView *view) {
             // "名称" 列标题
             const char* name_header = "名称";
             size_t name_header_len = strlen(name_header);
-            SDL_Surface *name_surface = TTF_RenderText_Blended(font, name_header, name_header_len, header_text_color);
-            if (name_surface) {
-                SDL_Texture *name_texture = SDL_CreateTextureFromSurface(renderer, name_surface);
-                if (name_texture) {
-                    SDL_FRect name_rect = {
-                        (float)view->viewport.x + 40,
-                        (float)header_y + ((float)header_height - (float)name_surface->h) / 2,
-                        (float)name_surface->w,
-                        (float)name_surface->h
-                    };
-                    SDL_RenderTexture(renderer, name_texture, NULL, &name_rect);
-                    SDL_DestroyTexture(name_texture);
-                }
-                SDL_DestroySurface(name_surface);
-            }
+            ui_text_draw(view->window, name_header, name_header_len,
+                         (float)view->viewport.x + 40,
+                         (float)header_y + ((float)header_height - line_height) / 2,
+                         header_text_color, 0);
             
             // "大小" 列标题
             const char* size_header = "大小";
             size_t size_header_len = strlen(size_header);
-            SDL_Surface *size_surface = TTF_RenderText_Blended(font, size_header, size_header_len, header_text_color);
-            if (size_surface) {
-                SDL_Texture *size_texture = SDL_CreateTextureFromSurface(renderer, size_surface);
-                if (size_texture) {
-                    SDL_FRect size_rect = {
-                        (float)view->viewport.x + 300,
-                        (float)header_y + ((float)header_height - (float)size_surface->h) / 2,
-                        (float)size_surface->w,
-                        (float)size_surface->h
-                    };
-                    SDL_RenderTexture(renderer, size_texture, NULL, &size_rect);
-                    SDL_DestroyTexture(size_texture);
-                }
-                SDL_DestroySurface(size_surface);
-            }
+            ui_text_draw(view->window, size_header, size_header_len,
+                         (float)view->viewport.x + 300,
+                         (float)header_y + ((float)header_height - line_height) / 2,
+                         header_text_color, 0);
             
             // "修改日期" 列标题
             const char* date_header = "修改日期";
             size_t date_header_len = strlen(date_header);
-            SDL_Surface *date_surface = TTF_RenderText_Blended(font, date_header, date_header_len, header_text_color);
-            if (date_surface) {
-                SDL_Texture *date_texture = SDL_CreateTextureFromSurface(renderer, date_surface);
-                if (date_texture) {
-                    SDL_FRect date_rect = {
-                        (float)view->viewport.x + 450,
-                        (float)header_y + ((float)header_height - (float)date_surface->h) / 2,
-                        (float)date_surface->w,
-                        (float)date_surface->h
-                    };
-                    SDL_RenderTexture(renderer, date_texture, NULL, &date_rect);
-                    SDL_DestroyTexture(date_texture);
-                }
-                SDL_DestroySurface(date_surface);
-            }
+            ui_text_draw(view->window, date_header, date_header_len,
+                         (float)view->viewport.x + 450,
+                         (float)header_y + ((float)header_height - line_height) / 2,
+                         header_text_color, 0);
             
             // 绘制列分隔线
             SDL_SetRenderDrawColor(renderer, 200, 200, 200, 255);
@@ -652,6 +1111,9 @@ void file_list_view_draw(FileListView *view) {
                 (float)(header_y + header_height));
         }
         
+        // 表头文字在切换裁剪区域之前提交
+        ui_text_flush(view->window);
+        
         // 为文件内容设置裁剪区域，避免覆盖表头
         SDL_Rect contentRect = {
             view->viewport.x,
@@ -659,199 +1121,135 @@ void file_list_view_draw(FileListView *view) {
             view->viewport.w,
             view->viewport.h - header_height
         };
-        SDL_SetRenderClipRect(renderer, &contentRect);
+        ui_set_clip_rect(view->window, &contentRect);
+        
+        // 只遍历与裁剪区域相交的行
+        int first = 0;
+        int end = 0;
+        file_list_view_clip_range(view, &layout, &first, &end);
         
-        // 遍历所有文件项
-        int index = 0;
-        FileItem *item = view->files->head;
-        while (item) {
-            // 跳过隐藏文件
-            if (item->is_hidden && !view->show_hidden) {
-                item = item->next;
-                continue;
+        for (int index = first; index < end; index++) {
+            FileItem *item = file_list_get_visible(view->files, index);
+            int y = 0;
+            file_list_view_item_origin(view, &layout, index, NULL, &y);
+            
+            // 确定文本颜色
+            bool selected = selection_contains(&view->selection, index);
+            SDL_Color current_text_color = selected ? selected_text_color : text_color;
+            
+            // 绘制选中背景
+            if (selected) {
+                SDL_SetRenderDrawColor(renderer, selected_bg_color.r, selected_bg_color.g, selected_bg_color.b, selected_bg_color.a);
+                SDL_FRect select_rect = {
+                    (float)view->viewport.x + 5, 
+                    (float)y, 
+                    (float)view->viewport.w - 10, 
+                    (float)view->item_height
+                };
+                SDL_RenderFillRect(renderer, &select_rect);
             }
             
-            // 计算当前项的y坐标
-            int y = (int)view->viewport.y + header_height + 5 + (index * view->item_height) - view->scroll_offset_y;
+            // 绘制图标
+            SDL_Texture *icon = file_list_view_icon(view, item, ICON_SIZE_SMALL);
+            if (icon) {
+                SDL_FRect icon_rect = {
+                    (float)view->viewport.x + 10, 
+                    (float)y + (float)(view->item_height - 16) / 2, 
+                    16.0f, 
+                    16.0f
+                };
+                SDL_RenderTexture(renderer, icon, NULL, &icon_rect);
+            }
             
-            // 只绘制可见区域内的项目，考虑表头高度
-            int content_start_y = (int)view->viewport.y + header_height;
-            if (y + view->item_height >= content_start_y && y <= (int)view->viewport.y + (int)view->viewport.h) {
-                // 确定文本颜色
-                SDL_Color current_text_color = (index == view->selected_index) ? selected_text_color : text_color;
+            // 绘制文件名或编辑框
+            if (view->is_editing && index == view->editing_index) {
+                // 绘制编辑框
+                SDL_FRect edit_rect = {
+                    (float)view->viewport.x + 30,
+                    (float)y + 2,
+                    250.0f,
+                    (float)(view->item_height - 4)
+                };
                 
-                // 绘制选中背景
-                if (index == view->selected_index) {
-                    SDL_SetRenderDrawColor(renderer, selected_bg_color.r, selected_bg_color.g, selected_bg_color.b, selected_bg_color.a);
-                    SDL_FRect select_rect = {
-                        (float)view->viewport.x + 5, 
-                        (float)y, 
-                        (float)view->viewport.w - 10, 
-                        (float)view->item_height
-                    };
-                    SDL_RenderFillRect(renderer, &select_rect);
-                }
+                // 绘制编辑框背景
+                file_list_view_set_edit_rect(view, &edit_rect);
+                SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+                SDL_RenderFillRect(renderer, &edit_rect);
                 
-                // 绘制图标
-                SDL_Texture *icon = (item->type == FILE_TYPE_DIRECTORY) ? view->folder_icon : view->file_icon;
-                if (icon) {
-                    SDL_FRect icon_rect = {
-                        (float)view->viewport.x + 10, 
-                        (float)y + (float)(view->item_height - 16) / 2, 
-                        16.0f, 
-                        16.0f
-                    };
-                    SDL_RenderTexture(renderer, icon, NULL, &icon_rect);
-                }
+                // 绘制编辑框边框
+                SDL_SetRenderDrawColor(renderer, 0, 120, 215, 255);
+                SDL_RenderRect(renderer, &edit_rect);
                 
-                // 绘制文件名或编辑框
-                if (view->is_editing && index == view->editing_index) {
-                    // 绘制编辑框
-                    SDL_FRect edit_rect = {
-                        (float)view->viewport.x + 30,
-                        (float)y + 2,
-                        250.0f,
-                        (float)(view->item_height - 4)
-                    };
-                    
-                    // 绘制编辑框背景
-                    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-                    SDL_RenderFillRect(renderer, &edit_rect);
-                    
-                    // 绘制编辑框边框
-                    SDL_SetRenderDrawColor(renderer, 0, 120, 215, 255);
-                    SDL_RenderRect(renderer, &edit_rect);
-                    
-                    // 绘制编辑文本
-                    if (view->edit_buffer && strlen(view->edit_buffer) > 0) {
-                        SDL_Color edit_text_color = {0, 0, 0, 255};
-                        size_t edit_len = strlen(view->edit_buffer);
-                        SDL_Surface *edit_surface = TTF_RenderText_Blended(font, view->edit_buffer, edit_len, edit_text_color);
-                        if (edit_surface) {
-                            SDL_Texture *edit_texture = SDL_CreateTextureFromSurface(renderer, edit_surface);
-                            if (edit_texture) {
-                                SDL_FRect edit_text_rect = {
-                                    edit_rect.x + 3,
-                                    edit_rect.y + (edit_rect.h - edit_surface->h) / 2,
-                                    (float)edit_surface->w,
-                                    (float)edit_surface->h
-                                };
-                                
-                                // 限制文本宽度
-                                if (edit_text_rect.w > edit_rect.w - 6) {
-                                    edit_text_rect.w = edit_rect.w - 6;
-                                }
-                                
-                                SDL_RenderTexture(renderer, edit_texture, NULL, &edit_text_rect);
-                                SDL_DestroyTexture(edit_texture);
-                            }
-                            SDL_DestroySurface(edit_surface);
-                        }
-                    }
-                    
-                    // 绘制光标
-                    Uint32 current_time = SDL_GetTicks();
-                    if (current_time - view->last_blink_time > 500) {
-                        view->cursor_visible = !view->cursor_visible;
-                        view->last_blink_time = current_time;
-                    }
-                    
-                    if (view->cursor_visible) {
-                        // 计算光标位置
-                        float cursor_x = edit_rect.x + 3;
-                        if (view->edit_buffer && view->edit_cursor_pos > 0) {
-                            char temp_char = view->edit_buffer[view->edit_cursor_pos];
-                            view->edit_buffer[view->edit_cursor_pos] = '\0';
-                            
-                            int text_w = 0;
-                            TTF_GetStringSize(font, view->edit_buffer, strlen(view->edit_buffer), &text_w, NULL);
-                            cursor_x += text_w;
-                            
-                            view->edit_buffer[view->edit_cursor_pos] = temp_char;
-                        }
-                        
-                        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-                        SDL_RenderLine(renderer, cursor_x, edit_rect.y + 2, cursor_x, edit_rect.y + edit_rect.h - 2);
-                    }
-                } else {
-                    // 正常绘制文件名
-                    size_t name_len = strlen(item->name);
-                    SDL_Surface *text_surface = TTF_RenderText_Blended(font, item->name, name_len, current_text_color);
-                    if (text_surface) {
-                        SDL_Texture *text_texture = SDL_CreateTextureFromSurface(renderer, text_surface);
-                        if (text_texture) {
-                            SDL_FRect text_rect = {0, 0, 0, 0};
-                            text_rect.w = (float)text_surface->w;
-                            text_rect.h = (float)text_surface->h;
-                            text_rect.x = (float)view->viewport.x + 35;
-                            text_rect.y = (float)y + ((float)view->item_height - text_rect.h) / 2;
-                            
-                            SDL_RenderTexture(renderer, text_texture, NULL, &text_rect);
-                            SDL_DestroyTexture(text_texture);
-                        }
-                        SDL_DestroySurface(text_surface);
+                // 绘制编辑文本
+                if (view->edit_buffer && strlen(view->edit_buffer) > 0) {
+                    SDL_Color edit_text_color = {0, 0, 0, 255};
+                    size_t edit_len = strlen(view->edit_buffer);
+                    int edit_h = 0;
+                    if (ui_text_size(view->window, view->edit_buffer, edit_len, NULL, &edit_h)) {
+                        // 限制文本宽度
+                        ui_text_draw(view->window, view->edit_buffer, edit_len,
+                                     edit_rect.x + 3, edit_rect.y + (edit_rect.h - edit_h) / 2,
+                                     edit_text_color, edit_rect.w - 6);
                     }
                 }
                 
-                // 详细视图模式下显示文件大小和修改时间
-                if (view->view_mode == VIEW_MODE_DETAILS) {
-                    // 显示文件大小
-                    char size_str[64] = {0};
-                    if (item->type == FILE_TYPE_DIRECTORY) {
-                        strcpy(size_str, "<DIR>");
-                    } else {
-                        // 格式化文件大小
-                        format_file_size(item->size, size_str, sizeof(size_str));
-                    }
-                    
-                    size_t size_len = strlen(size_str);
-                    SDL_Surface *size_surface = TTF_RenderText_Blended(font, size_str, size_len, current_text_color);
-                    if (size_surface) {
-                        SDL_Texture *size_texture = SDL_CreateTextureFromSurface(renderer, size_surface);
-                        if (size_texture) {
-                            SDL_FRect size_rect = {0, 0, 0, 0};
-                            size_rect.w = (float)size_surface->w;
-                            size_rect.h = (float)size_surface->h;
-                            size_rect.x = (float)view->viewport.x + 300;
-                            size_rect.y = (float)y + ((float)view->item_height - size_rect.h) / 2;
-                            
-                            SDL_RenderTexture(renderer, size_texture, NULL, &size_rect);
-                            SDL_DestroyTexture(size_texture);
-                        }
-                        SDL_DestroySurface(size_surface);
+                // 绘制光标（闪烁状态在 file_list_view_update 中切换）
+                if (view->cursor_visible) {
+                    // 计算光标位置
+                    float cursor_x = edit_rect.x + 3;
+                    if (view->edit_buffer && view->edit_cursor_pos > 0) {
+                        // 与绘制使用同一排版计算光标前文字的宽度
+                        int text_w = 0;
+                        ui_text_size(view->window, view->edit_buffer, (size_t)view->edit_cursor_pos, &text_w, NULL);
+                        cursor_x += text_w;
                     }
                     
-                    // 显示修改时间
-                    char time_str[64] = {0};
-                    format_time(item->modified_time, time_str, sizeof(time_str));
-                    
-                    size_t time_len = strlen(time_str);
-                    SDL_Surface *time_surface = TTF_RenderText_Blended(font, time_str, time_len, current_text_color);
-                    if (time_surface) {
-                        SDL_Texture *time_texture = SDL_CreateTextureFromSurface(renderer, time_surface);
-                        if (time_texture) {
-                            SDL_FRect time_rect = {0, 0, 0, 0};
-                            time_rect.w = (float)time_surface->w;
-                            time_rect.h = (float)time_surface->h;
-                            time_rect.x = (float)view->viewport.x + 450;
-                            time_rect.y = (float)y + ((float)view->item_height - time_rect.h) / 2;
-                            
-                            SDL_RenderTexture(renderer, time_texture, NULL, &time_rect);
-                            SDL_DestroyTexture(time_texture);
-                        }
-                        SDL_DestroySurface(time_surface);
-                    }
+                    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+                    SDL_RenderLine(renderer, cursor_x, edit_rect.y + 2, cursor_x, edit_rect.y + edit_rect.h - 2);
+                }
+            } else {
+                // 正常绘制文件名
+                size_t name_len = strlen(item->name);
+                ui_text_draw(view->window, item->name, name_len,
+                             (float)view->viewport.x + 35,
+                             (float)y + ((float)view->item_height - line_height) / 2,
+                             current_text_color, 0);
+            }
+            
+            // 详细视图模式下显示文件大小和修改时间
+            if (view->view_mode == VIEW_MODE_DETAILS) {
+                // 显示文件大小
+                char size_str[64] = {0};
+                if (item->type == FILE_TYPE_DIRECTORY) {
+                    strcpy(size_str, "<DIR>");
+                } else {
+                    // 格式化文件大小
+                    format_file_size(item->size, size_str, sizeof(size_str));
                 }
+                
+                size_t size_len = strlen(size_str);
+                ui_text_draw(view->window, size_str, size_len,
+                             (float)view->viewport.x + 300,
+                             (float)y + ((float)view->item_height - line_height) / 2,
+                             current_text_color, 0);
+                
+                // 显示修改时间
+                char time_str[64] = {0};
+                format_time(item->modified_time, time_str, sizeof(time_str));
+                
+                size_t time_len = strlen(time_str);
+                ui_text_draw(view->window, time_str, time_len,
+                             (float)view->viewport.x + 450,
+                             (float)y + ((float)view->item_height - line_height) / 2,
+                             current_text_color, 0);
             }
             
-            // 移动到下一项
-            index++;
-            item = item->next;
         }
     }
     
-    // 重置裁剪区域
-    SDL_SetRenderClipRect(renderer, NULL);
+    // 提交文字并重置裁剪区域
+    ui_text_flush(view->window);
+    ui_set_clip_rect(view->window, NULL);
 }
 
 // 选择文件项
@@ -860,22 +1258,106 @@ void file_list_view_select_item(FileListView *view, int index) {
         return;
     }
     
-    // 计算可见项目的数量
-    int visible_count = 0;
-    FileItem *item = view->files->head;
-    while (item) {
-        if (!item->is_hidden || view->show_hidden) {
-            visible_count++;
-        }
-        item = item->next;
-    }
-    
     // 确保索引在有效范围内
-    if (index < -1 || index >= visible_count) {
+    if (index < -1 || index >= view->files->visible_count) {
         index = -1; // 无选择
     }
     
+    // 已经只选中这一项时不重绘
+    file_list_view_sync_selection(view);
+    int expected = index >= 0 ? 1 : 0;
+    if (view->selected_index == index && selection_count(&view->selection) == expected &&
+        (index < 0 || selection_contains(&view->selection, index))) {
+        return;
+    }
+
+    selection_clear(&view->selection);
+    selection_set(&view->selection, index, true);
+    view->selection.anchor = index;
     view->selected_index = index;
+    file_list_view_invalidate(view);
+}
+
+// 按修饰键点击文件项：Ctrl 切换单项，Shift 从起点选择到该项（同时按 Ctrl 时追加到已有选择）
+static void file_list_view_click_item(FileListView *view, int index, SDL_Keymod mod) {
+    bool ctrl = (mod & SDL_KMOD_CTRL) != 0;
+    bool shift = (mod & SDL_KMOD_SHIFT) != 0;
+    if (!ctrl && !shift) {
+        file_list_view_select_item(view, index);
+        return;
+    }
+
+    file_list_view_sync_selection(view);
+    if (shift) {
+        int anchor = view->selection.anchor >= 0 ? view->selection.anchor :
+                     (view->selected_index >= 0 ? view->selected_index : index);
+        if (!ctrl) {
+            selection_clear(&view->selection);
+        }
+        selection_set_range(&view->selection, anchor, index, true);
+        view->selection.anchor = anchor;
+    } else {
+        selection_toggle(&view->selection, index);
+        view->selection.anchor = index;
+    }
+    view->selected_index = index;
+    file_list_view_invalidate(view);
+}
+
+// 全选
+void file_list_view_select_all(FileListView *view) {
+    if (!view || !view->files) {
+        return;
+    }
+
+    file_list_view_sync_selection(view);
+    selection_select_all(&view->selection);
+    if (view->selected_index < 0 && view->files->visible_count > 0) {
+        view->selected_index = 0;
+    }
+    view->selection.anchor = view->selected_index;
+    file_list_view_invalidate(view);
+}
+
+// 文件项是否选中
+bool file_list_view_is_selected(FileListView *view, int index) {
+    return view && selection_contains(&view->selection, index);
+}
+
+// 选中的项目数
+int file_list_view_get_selection_count(FileListView *view) {
+    return view ? selection_count(&view->selection) : 0;
+}
+
+// 获取全部选中的文件项
+FileItem** file_list_view_get_selected_items(FileListView *view, int *count) {
+    if (count) {
+        *count = 0;
+    }
+    if (!view || !view->files || !count || selection_count(&view->selection) == 0) {
+        return NULL;
+    }
+
+    FileItem **items = (FileItem**)malloc(sizeof(FileItem*) * (size_t)selection_count(&view->selection));
+    if (!items) {
+        printf("[ERROR] Failed to allocate selected item list\n");
+        return NULL;
+    }
+
+    int n = 0;
+    for (int i = selection_next(&view->selection, 0); i >= 0; i = selection_next(&view->selection, i + 1)) {
+        FileItem *item = file_list_get_visible(view->files, i);
+        // ".." 不参与批量操作
+        if (item && strcmp(item->name, "..") != 0) {
+            items[n++] = item;
+        }
+    }
+    if (n == 0) {
+        free(items);
+        return NULL;
+    }
+    *count = n;
+    return items;
 }
 
 // 获取选中的文件项
@@ -884,25 +1366,7 @@ FileItem* file_list_view_get_selected_item(FileListView *view) {
         return NULL;
     }
     
-    int visible_index = 0;
-    FileItem *item = view->files->head;
-    
-    while (item) {
-        // 跳过隐藏文件（如果需要）
-        if (item->is_hidden && !view->show_hidden) {
-            item = item->next;
-            continue;
-        }
-        
-        if (visible_index == view->selected_index) {
-            return item;
-        }
-        
-        visible_index++;
-        item = item->next;
-    }
-    
-    return NULL;
+    return file_list_get_visible(view->files, view->selected_index);
 }
 
 // 打开选中的文件或目录
@@ -1026,48 +1490,29 @@ void file_list_view_scroll(FileListView *view, int delta) {
         return;
     }
     
-    // 计算最大滚动范围
-    int max_scroll = 0;
-    
-    if (view->view_mode == VIEW_MODE_ICONS) {
-        // 计算图标视图的行数
-        int items_per_row = (view->viewport.w - 20) / (view->item_width + 10);
-        if (items_per_row < 1) items_per_row = 1;
-        
-        int visible_count = 0;
-        FileItem *item = view->files->head;
-        while (item) {
-            if (!item->is_hidden || view->show_hidden) {
-                visible_count++;
-            }
-            item = item->next;
-        }
-        
-        int rows = (visible_count + items_per_row - 1) / items_per_row;
-        max_scroll = rows * (view->item_height + 10) - view->viewport.h + 20;
-    } else {
-        // 列表视图或详细信息视图
-        int visible_count = 0;
-        FileItem *item = view->files->head;
-        while (item) {
-            if (!item->is_hidden || view->show_hidden) {
-                visible_count++;
-            }
-            item = item->next;
-        }
-        
-        max_scroll = visible_count * (view->item_height + 2) - view->viewport.h + 10;
+    // 计算最大滚动范围（按行数计算，底部留5像素边距）
+    FileListLayout layout;
+    file_list_view_get_layout(view, &layout);
+    int content_height = (layout.cell_y - view->viewport.y) + layout.rows * layout.cell_height + 5;
+    int max_scroll = content_height - view->viewport.h;
+    if (max_scroll < 0) {
+        max_scroll = 0;
     }
     
     // 应用滚动偏移
+    int old_offset = view->scroll_offset_y;
     view->scroll_offset_y += delta;
     
     // 限制滚动范围
     if (view->scroll_offset_y < 0) {
         view->scroll_offset_y = 0;
-    } else if (max_scroll > 0 && view->scroll_offset_y > max_scroll) {
+    } else if (view->scroll_offset_y > max_scroll) {
         view->scroll_offset_y = max_scroll;
     }
+
+    if (view->scroll_offset_y != old_offset) {
+        file_list_view_invalidate(view);
+    }
 }
 
 // 加载Windows驱动器列表
@@ -1077,8 +1522,12 @@ void file_list_view_load_drives(FileListView *view) {
     }
     
 #ifdef _WIN32
-    // 清空当前列表
+    // 停止后台加载和目录监控并清空当前列表
+    file_list_view_cancel_loading(view);
+    file_list_view_stop_watching(view);
     file_list_clear(view->files);
+    view->selected_index = -1;
+    selection_resize(&view->selection, 0);
     
     // 设置当前目录为驱动器列表标识
     if (view->files->current_dir) {
@@ -1101,49 +1550,45 @@ void file_list_view_load_drives(FileListView *view) {
                 continue; // 跳过无效驱动器
             }
             
+            // 设置驱动器名称
+            char drive_name[32];
+            sprintf(drive_name, "%c:", drive_letter);
+            
+            // 设置显示名称（包含驱动器类型）
+            char display_name[64];
+            const char *type_str = "";
+            switch (drive_type) {
+                case DRIVE_FIXED:
+                    type_str = " (Local Disk)";
+                    break;
+                case DRIVE_REMOVABLE:
+                    type_str = " (Removable Disk)";
+                    break;
+                case DRIVE_REMOTE:
+                    type_str = " (Network Drive)";
+                    break;
+                case DRIVE_CDROM:
+                    type_str = " (CD-ROM)";
+                    break;
+                case DRIVE_RAMDISK:
+                    type_str = " (RAM Disk)";
+                    break;
+            }
+            sprintf(display_name, "%c:%s", drive_letter, type_str);
+            
             // 创建驱动器项目
-            FileItem *drive_item = (FileItem*)calloc(1, sizeof(FileItem));
+            FileItem *drive_item = file_list_alloc_item(view->files, drive_path, drive_name, display_name);
             if (drive_item) {
-                // 设置驱动器名称
-                char drive_name[32];
-                sprintf(drive_name, "%c:", drive_letter);
-                drive_item->name = strdup(drive_name);
-                
-                // 设置显示名称（包含驱动器类型）
-                char display_name[64];
-                const char *type_str = "";
-                switch (drive_type) {
-                    case DRIVE_FIXED:
-                        type_str = " (Local Disk)";
-                        break;
-                    case DRIVE_REMOVABLE:
-                        type_str = " (Removable Disk)";
-                        break;
-                    case DRIVE_REMOTE:
-                        type_str = " (Network Drive)";
-                        break;
-                    case DRIVE_CDROM:
-                        type_str = " (CD-ROM)";
-                        break;
-                    case DRIVE_RAMDISK:
-                        type_str = " (RAM Disk)";
-                        break;
-                }
-                sprintf(display_name, "%c:%s", drive_letter, type_str);
-                drive_item->display_name = strdup(display_name);
-                
-                // 设置路径
-                drive_item->path = strdup(drive_path);
                 drive_item->type = FILE_TYPE_DIRECTORY;
                 drive_item->size = 0;
                 drive_item->is_hidden = false;
-                drive_item->next = NULL;
                 
                 // 添加到列表
                 file_list_add_item(view->files, drive_item);
             }
         }
     }
+    file_list_view_invalidate(view);
 #endif
 }
 
@@ -1161,18 +1606,7 @@ void file_list_view_start_editing(FileListView *view, int index) {
     }
     
     // 获取要编辑的文件项
-    int visible_count = 0;
-    FileItem *item = view->files->head;
-    while (item) {
-        if (!item->is_hidden || view->show_hidden) {
-            if (visible_count == index) {
-                break;
-            }
-            visible_count++;
-        }
-        item = item->next;
-    }
-    
+    FileItem *item = file_list_get_visible(view->files, index);
     if (!item) {
         return;
     }
@@ -1182,9 +1616,10 @@ void file_list_view_start_editing(FileListView *view, int index) {
         file_list_view_stop_editing(view, false);
     }
     
-    // 设置编辑状态
+    // 设置编辑状态（编辑框位置在下一次绘制时确定）
     view->is_editing = true;
     view->editing_index = index;
+    view->edit_rect = (SDL_Rect){0, 0, 0, 0};
     
     // 分配编辑缓冲区
     const char *filename = item->display_name;
@@ -1203,8 +1638,7 @@ void file_list_view_start_editing(FileListView *view, int index) {
     }
     
     // 初始化光标闪烁
-    view->last_blink_time = SDL_GetTicks();
-    view->cursor_visible = true;
+    file_list_view_reset_blink(view);
     
     // 启用文本输入
     if (view->window && view->window->window) {
@@ -1222,17 +1656,7 @@ void file_list_view_stop_editing(FileListView *view, bool save_changes) {
     
     if (save_changes && view->edit_buffer) {
         // 获取正在编辑的文件项
-        int visible_count = 0;
-        FileItem *item = view->files->head;
-        while (item) {
-            if (!item->is_hidden || view->show_hidden) {
-                if (visible_count == view->editing_index) {
-                    break;
-                }
-                visible_count++;
-            }
-            item = item->next;
-        }
+        FileItem *item = file_list_get_visible(view->files, view->editing_index);
         
         if (item && strlen(view->edit_buffer) > 0) {
             // 构建完整路径
@@ -1262,6 +1686,8 @@ void file_list_view_stop_editing(FileListView *view, bool save_changes) {
     
     view->edit_buffer_size = 0;
     view->edit_cursor_pos = 0;
+    view->edit_rect = (SDL_Rect){0, 0, 0, 0};
+    file_list_view_invalidate(view);
     
     // 停止文本输入
     if (view->window && view->window->window) {
@@ -1301,8 +1727,7 @@ void file_list_view_handle_text_input(FileListView *view, const char *text) {
     view->edit_cursor_pos += text_len;
     
     // 重置光标闪烁
-    view->last_blink_time = SDL_GetTicks();
-    view->cursor_visible = true;
+    file_list_view_reset_blink(view);
 }
 
 // 处理键盘输入
@@ -1377,8 +1802,7 @@ void file_list_view_handle_key_input(FileListView *view, SDL_Scancode scancode)
     }
     
     // 重置光标闪烁
-    view->last_blink_time = SDL_GetTicks();
-    view->cursor_visible = true;
+    file_list_view_reset_blink(view);
 }
 
 // 处理事件
@@ -1412,80 +1836,34 @@ bool file_list_view_handle_event(FileListView *view, SDL_Event *event) {
             if (x >= view->viewport.x && x < view->viewport.x + view->viewport.w &&
                 y >= view->viewport.y && y < view->viewport.y + view->viewport.h) {
                 
-                // 计算点击的项目
-                int clicked_index = -1;
+                // 计算点击的项目（按与绘制一致的网格直接换算行列）
+                int clicked_index = file_list_view_index_at(view, x, y);
                 
-                if (view->view_mode == VIEW_MODE_ICONS) {
-                    // 图标视图 - 使用与绘制逻辑完全一致的坐标计算
-                    int draw_x = (int)view->viewport.x + 10;
-                    int draw_y = (int)view->viewport.y + 10 - view->scroll_offset_y;
-                    int max_x = (int)view->viewport.x + (int)view->viewport.w - view->item_width - 10;
-                    
-                    // 遍历所有文件项，模拟绘制过程
-                    int index = 0;
-                    FileItem *item = view->files->head;
-                    while (item) {
-                        // 跳过隐藏文件
-                        if (item->is_hidden && !view->show_hidden) {
-                            item = item->next;
-                            continue;
-                        }
+                // 验证点击的索引是否有效
+                FileItem *item = file_list_get_visible(view->files, clicked_index);
+                if (item) {
+                    // 处理左键和右键点击
+                    if (event->button.button == SDL_BUTTON_LEFT) {
+                        file_list_view_click_item(view, clicked_index, SDL_GetModState());
                         
-                        // 换行处理（与绘制逻辑一致）
-                        if (draw_x > max_x) {
-                            draw_x = (int)view->viewport.x + 10;
-                            draw_y += view->item_height + 10;
+                        // 检查双击
+                        if (event->button.clicks == 2) {
+                            file_list_view_open_selected(view);
                         }
-                        
-                        // 检查点击是否在当前项目区域内
-                        if (x >= draw_x - 5 && x <= draw_x + view->item_width + 5 &&
-                            y >= draw_y - 5 && y <= draw_y + view->item_height + 5) {
-                            clicked_index = index;
-                            break;
+                    } else if (event->button.button == SDL_BUTTON_RIGHT) {
+                        // 右键点击：点在已选中的项上时保留整个选择（菜单作用于全部选中项），否则只选中该项
+                        if (file_list_view_is_selected(view, clicked_index)) {
+                            view->selected_index = clicked_index;
+                        } else {
+                            file_list_view_select_item(view, clicked_index);
                         }
-                        
-                        // 移动到下一个位置
-                        draw_x += view->item_width + 10;
-                        index++;
-                        item = item->next;
-                    }
-                } else {
-                    // 列表视图或详细信息视图
-                    int content_start_offset = 5;
-                    if (view->view_mode == VIEW_MODE_DETAILS) {
-                        content_start_offset += 30; // 表头高度
-                    }
-                    clicked_index = (y - view->viewport.y + view->scroll_offset_y - content_start_offset) / (view->item_height + 2);
-                }
-                
-                // 验证点击的索引是否有效
-                int visible_count = 0;
-                FileItem *item = view->files->head;
-                while (item) {
-                    if (!item->is_hidden || view->show_hidden) {
-                        if (visible_count == clicked_index) {
-                            // 处理左键和右键点击
-                            if (event->button.button == SDL_BUTTON_LEFT) {
-                                file_list_view_select_item(view, clicked_index);
-                                
-                                // 检查双击
-                                if (event->button.clicks == 2) {
-                                    file_list_view_open_selected(view);
-                                }
-                            } else if (event->button.button == SDL_BUTTON_RIGHT) {
-                                // 右键点击：选中项目并显示右键菜单
-                                file_list_view_select_item(view, clicked_index);
-                                if (view->on_right_click) {
-                                    view->on_right_click(view, x, y, item);
-                                }
-                                printf("右键点击文件: %s\n", item->display_name);
-                            }
-                            
-                            return true;
+                        if (view->on_right_click) {
+                            view->on_right_click(view, x, y, item);
                         }
-                        visible_count++;
+                        printf("右键点击文件: %s\n", item->display_name);
                     }
-                    item = item->next;
+                    
+                    return true;
                 }
                 
                 // 点击空白区域
@@ -1523,8 +1901,16 @@ bool file_list_view_handle_event(FileListView *view, SDL_Event *event) {
                 return true;
             }
             
-            // 键盘事件
+            // 键盘事件（Shift 加方向键从起点扩展选择）
+            bool extend = (event->key.mod & SDL_KMOD_SHIFT) != 0;
             switch (event->key.scancode) {
+                case SDL_SCANCODE_A:
+                    if (event->key.mod & SDL_KMOD_CTRL) {
+                        file_list_view_select_all(view);
+                        return true;
+                    }
+                    break;
+
                 case SDL_SCANCODE_F2:
                     // F2键开始重命名选中的文件
                     if (view->selected_index >= 0) {
@@ -1534,25 +1920,15 @@ bool file_list_view_handle_event(FileListView *view, SDL_Event *event) {
                     
                 case SDL_SCANCODE_UP:
                     if (view->selected_index > 0) {
-                        file_list_view_select_item(view, view->selected_index - 1);
+                        file_list_view_click_item(view, view->selected_index - 1, extend ? SDL_KMOD_SHIFT : SDL_KMOD_NONE);
                     }
                     return true;
                     
-                case SDL_SCANCODE_DOWN: {
-                    int visible_count = 0;
-                    FileItem *item = view->files->head;
-                    while (item) {
-                        if (!item->is_hidden || view->show_hidden) {
-                            visible_count++;
-                        }
-                        item = item->next;
-                    }
-                    
-                    if (view->selected_index < visible_count - 1) {
-                        file_list_view_select_item(view, view->selected_index + 1);
+                case SDL_SCANCODE_DOWN:
+                    if (view->selected_index < view->files->visible_count - 1) {
+                        file_list_view_click_item(view, view->selected_index + 1, extend ? SDL_KMOD_SHIFT : SDL_KMOD_NONE);
                     }
                     return true;
-                }
                 
                 case SDL_SCANCODE_RETURN:
                     file_list_view_open_selected(view);
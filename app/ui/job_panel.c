@@ -0,0 +1,344 @@
+/*
+ * 文件操作进度面板
+ * 职责：
+ * 1. 在窗口右下角显示排队和执行中的文件操作任务及其进度
+ * 2. 暂停、继续和取消任务
+ * 3. 取走已结束的任务并短暂显示结果摘要
+ */
+
+#include "job_panel.h"
+#include "file_system.h"
+#include "ui_renderer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// 颜色常量
+static const SDL_Color JOB_PANEL_BG_COLOR = {255, 255, 255, 240};
+static const SDL_Color JOB_PANEL_BORDER_COLOR = {180, 180, 180, 255};
+static const SDL_Color JOB_PANEL_TEXT_COLOR = {30, 30, 30, 255};
+static const SDL_Color JOB_PANEL_DIM_COLOR = {120, 120, 120, 255};
+static const SDL_Color JOB_PANEL_BUTTON_COLOR = {40, 110, 200, 255};
+static const SDL_Color JOB_PANEL_BAR_BG_COLOR = {225, 225, 225, 255};
+static const SDL_Color JOB_PANEL_BAR_COLOR = {70, 160, 90, 255};
+static const SDL_Color JOB_PANEL_PAUSED_BAR_COLOR = {210, 170, 60, 255};
+
+// 面板布局（窗口坐标）
+typedef struct {
+    SDL_FRect rect;          // 整个面板
+    int rows;                // 显示的任务数
+    int hidden;              // 未显示的任务数
+    bool status;             // 是否显示结果摘要
+    float line_h;            // 行高
+    float row_h;             // 任务行高度（文字 + 进度条）
+} JobPanelLayout;
+
+// 任务类型的显示名称
+static const char* job_panel_type_name(FileJobType type) {
+    switch (type) {
+        case FILE_JOB_MOVE:
+            return "Moving";
+        case FILE_JOB_DELETE:
+            return "Deleting";
+        default:
+            return "Copying";
+    }
+}
+
+// 计算面板布局，没有需要显示的内容时返回 false
+static bool job_panel_layout(JobPanel *panel, JobPanelLayout *layout) {
+    Window *app = panel->app;
+    int count = file_job_queue_count(panel->queue);
+
+    layout->rows = count < JOB_PANEL_MAX_ROWS ? count : JOB_PANEL_MAX_ROWS;
+    layout->hidden = count - layout->rows;
+    layout->status = panel->status_time != 0;
+    if (layout->rows == 0 && !layout->status) {
+        return false;
+    }
+
+    layout->line_h = app->font ? (float)TTF_GetFontHeight(app->font) : 16.0f;
+    layout->row_h = layout->line_h + JOB_PANEL_BAR_HEIGHT + JOB_PANEL_PADDING;
+    float height = JOB_PANEL_PADDING + layout->rows * layout->row_h +
+                   (layout->hidden > 0 ? layout->line_h : 0.0f) +
+                   (layout->status ? layout->line_h : 0.0f) + JOB_PANEL_PADDING;
+
+    int window_w = SDL_WINDOW_WIDTH;
+    int window_h = SDL_WINDOW_HEIGHT;
+    SDL_GetWindowSize(app->window, &window_w, &window_h);
+    layout->rect.w = JOB_PANEL_WIDTH;
+    layout->rect.h = height;
+    layout->rect.x = (float)(window_w - JOB_PANEL_WIDTH - JOB_PANEL_PADDING);
+    layout->rect.y = (float)window_h - height - JOB_PANEL_PADDING;
+    return true;
+}
+
+// 第 row 个任务的暂停和取消按钮
+static void job_panel_buttons(const JobPanelLayout *layout, int row, SDL_FRect *pause, SDL_FRect *cancel) {
+    float y = layout->rect.y + JOB_PANEL_PADDING + row * layout->row_h;
+    float right = layout->rect.x + layout->rect.w - JOB_PANEL_PADDING;
+    *cancel = (SDL_FRect){right - JOB_PANEL_BUTTON_WIDTH, y, JOB_PANEL_BUTTON_WIDTH, layout->line_h};
+    *pause = (SDL_FRect){cancel->x - JOB_PANEL_BUTTON_WIDTH, y, JOB_PANEL_BUTTON_WIDTH, layout->line_h};
+}
+
+// 取走已结束的任务，生成结果摘要
+static void job_panel_collect(JobPanel *panel) {
+    int finished = 0;
+    int files = 0;
+    int errors = 0;
+    int cancelled = 0;
+    FileJobType type = FILE_JOB_COPY;
+
+    int count = file_job_queue_count(panel->queue);
+    for (int i = 0; i < count; i++) {
+        FileJob *job = file_job_queue_get(panel->queue, i);
+        FileJobProgress progress;
+        file_job_get_progress(job, &progress);
+        if (progress.state != FILE_JOB_DONE && progress.state != FILE_JOB_FAILED &&
+            progress.state != FILE_JOB_CANCELLED) {
+            continue;
+        }
+        finished++;
+        files += progress.files_done - progress.errors;
+        errors += progress.errors;
+        cancelled += progress.state == FILE_JOB_CANCELLED;
+        type = file_job_type(job);
+    }
+    if (finished == 0 || file_job_queue_collect(panel->queue) == 0) {
+        return;
+    }
+
+    if (finished == 1 && cancelled == 1) {
+        snprintf(panel->status, sizeof(panel->status), "%s cancelled (%d done)", job_panel_type_name(type), files);
+    } else if (finished == 1) {
+        snprintf(panel->status, sizeof(panel->status), "%s finished: %d done, %d failed",
+                 job_panel_type_name(type), files, errors);
+    } else {
+        snprintf(panel->status, sizeof(panel->status), "%d jobs finished: %d done, %d failed, %d cancelled",
+                 finished, files, errors, cancelled);
+    }
+    printf("[INFO] %s\n", panel->status);
+    panel->status_time = SDL_GetTicks();
+    window_invalidate(panel->app, UI_DIRTY_JOBS);
+}
+
+// 创建文件操作进度面板
+JobPanel* job_panel_new(struct Window *app, FileJobQueue *queue) {
+    if (!app || !queue) {
+        return NULL;
+    }
+
+    JobPanel *panel = (JobPanel*)calloc(1, sizeof(JobPanel));
+    if (!panel) {
+        return NULL;
+    }
+    panel->app = app;
+    panel->queue = queue;
+    return panel;
+}
+
+// 释放文件操作进度面板
+void job_panel_free(JobPanel *panel) {
+    free(panel);
+}
+
+// 处理任务结束事件和面板上的点击
+bool job_panel_handle_event(JobPanel *panel, SDL_Event *event) {
+    if (!panel || !event) {
+        return false;
+    }
+
+    // 任务结束的唤醒事件，结果在 job_panel_update 中取走
+    Uint32 job_event = file_job_event_type();
+    if (job_event != 0 && event->type == job_event) {
+        return true;
+    }
+
+    if (event->type != SDL_EVENT_MOUSE_BUTTON_DOWN || event->button.button != SDL_BUTTON_LEFT || !panel->shown) {
+        return false;
+    }
+
+    JobPanelLayout layout;
+    SDL_FPoint point = {event->button.x, event->button.y};
+    if (!job_panel_layout(panel, &layout) || !SDL_PointInRectFloat(&point, &layout.rect)) {
+        return false;
+    }
+
+    for (int i = 0; i < layout.rows; i++) {
+        SDL_FRect pause;
+        SDL_FRect cancel;
+        job_panel_buttons(&layout, i, &pause, &cancel);
+        FileJob *job = file_job_queue_get(panel->queue, i);
+        FileJobProgress progress;
+        file_job_get_progress(job, &progress);
+
+        if (SDL_PointInRectFloat(&point, &pause)) {
+            // 暂停在下一个数据块生效
+            file_job_set_paused(job, !progress.paused);
+        } else if (SDL_PointInRectFloat(&point, &cancel)) {
+            file_job_cancel(job);
+        } else {
+            continue;
+        }
+        window_invalidate(panel->app, UI_DIRTY_JOBS);
+        break;
+    }
+
+    // 面板上的点击不传给下面的文件列表
+    return true;
+}
+
+// 有任务执行时按刷新间隔标记重绘
+void job_panel_update(JobPanel *panel) {
+    if (!panel) {
+        return;
+    }
+
+    job_panel_collect(panel);
+
+    Uint64 current_time = SDL_GetTicks();
+    if (panel->status_time != 0 && current_time - panel->status_time >= JOB_PANEL_STATUS_DURATION) {
+        panel->status_time = 0;
+        window_invalidate(panel->app, UI_DIRTY_JOBS);
+    }
+
+    if (file_job_queue_count(panel->queue) > 0 &&
+        current_time - panel->last_refresh >= JOB_PANEL_REFRESH_INTERVAL) {
+        panel->last_refresh = current_time;
+        window_invalidate(panel->app, UI_DIRTY_JOBS);
+    } else if (panel->shown && file_job_queue_count(panel->queue) == 0 && panel->status_time == 0) {
+        // 最后一帧显示过面板，重绘一次把它擦掉
+        window_invalidate(panel->app, UI_DIRTY_JOBS);
+    }
+}
+
+// 距下一次刷新的毫秒数
+int job_panel_next_timeout(JobPanel *panel) {
+    if (!panel) {
+        return -1;
+    }
+
+    Uint64 current_time = SDL_GetTicks();
+    int timeout = -1;
+    if (file_job_queue_count(panel->queue) > 0) {
+        Uint64 elapsed = current_time - panel->last_refresh;
+        timeout = elapsed >= JOB_PANEL_REFRESH_INTERVAL ? 0 : (int)(JOB_PANEL_REFRESH_INTERVAL - elapsed);
+    }
+    if (panel->status_time != 0) {
+        Uint64 elapsed = current_time - panel->status_time;
+        int status_timeout = elapsed >= JOB_PANEL_STATUS_DURATION ? 0 : (int)(JOB_PANEL_STATUS_DURATION - elapsed);
+        if (timeout < 0 || status_timeout < timeout) {
+            timeout = status_timeout;
+        }
+    }
+    return timeout;
+}
+
+// 绘制一个任务行
+static void job_panel_draw_row(JobPanel *panel, const JobPanelLayout *layout, int row) {
+    Window *app = panel->app;
+    SDL_Renderer *renderer = app->renderer;
+    FileJob *job = file_job_queue_get(panel->queue, row);
+    FileJobProgress progress;
+    file_job_get_progress(job, &progress);
+
+    float left = layout->rect.x + JOB_PANEL_PADDING;
+    float y = layout->rect.y + JOB_PANEL_PADDING + row * layout->row_h;
+    float text_w = layout->rect.w - JOB_PANEL_PADDING * 2 - JOB_PANEL_BUTTON_WIDTH * 2;
+
+    // 进度比例：字节数已知时按字节，否则按文件数
+    float fraction = 0.0f;
+    if (progress.bytes_total > 0) {
+        fraction = (float)((double)progress.bytes_done / (double)progress.bytes_total);
+    } else if (progress.files_total > 0) {
+        fraction = (float)progress.files_done / (float)progress.files_total;
+    }
+    if (fraction > 1.0f) {
+        fraction = 1.0f;
+    }
+
+    // 1. 类型、当前文件名和百分比
+    char source[1024];
+    const char *name = file_job_source(job, progress.current, source, sizeof(source)) > 0 ? fs_get_filename(source) : NULL;
+    char text[160];
+    if (progress.state == FILE_JOB_QUEUED) {
+        snprintf(text, sizeof(text), "%s %s (queued)", job_panel_type_name(file_job_type(job)), name ? name : "");
+    } else if (progress.bytes_total == 0) {
+        // 删除和同一文件系统上的移动没有字节进度，显示已处理的项目数
+        snprintf(text, sizeof(text), "%s %s  %d/%d  %llu items", job_panel_type_name(file_job_type(job)),
+                 name ? name : "", progress.files_done, progress.files_total,
+                 (unsigned long long)progress.items_done);
+    } else {
+        snprintf(text, sizeof(text), "%s %s  %d/%d  %d%%", job_panel_type_name(file_job_type(job)),
+                 name ? name : "", progress.files_done, progress.files_total, (int)(fraction * 100.0f));
+    }
+    SDL_Color color = progress.state == FILE_JOB_RUNNING ? JOB_PANEL_TEXT_COLOR : JOB_PANEL_DIM_COLOR;
+    ui_text_draw(app, text, 0, left, y, color, text_w);
+
+    // 2. 暂停/继续和取消按钮
+    SDL_FRect pause;
+    SDL_FRect cancel;
+    job_panel_buttons(layout, row, &pause, &cancel);
+    ui_text_draw(app, progress.paused ? "Resume" : "Pause", 0,
+                 pause.x, pause.y, JOB_PANEL_BUTTON_COLOR, pause.w);
+    ui_text_draw(app, "Cancel", 0, cancel.x, cancel.y, JOB_PANEL_BUTTON_COLOR, cancel.w);
+
+    // 3. 进度条
+    SDL_FRect bar = {left, y + layout->line_h + 2.0f, layout->rect.w - JOB_PANEL_PADDING * 2, JOB_PANEL_BAR_HEIGHT};
+    SDL_SetRenderDrawColor(renderer, JOB_PANEL_BAR_BG_COLOR.r, JOB_PANEL_BAR_BG_COLOR.g,
+                           JOB_PANEL_BAR_BG_COLOR.b, JOB_PANEL_BAR_BG_COLOR.a);
+    SDL_RenderFillRect(renderer, &bar);
+    SDL_Color bar_color = progress.state == FILE_JOB_PAUSED ? JOB_PANEL_PAUSED_BAR_COLOR : JOB_PANEL_BAR_COLOR;
+    bar.w *= fraction;
+    SDL_SetRenderDrawColor(renderer, bar_color.r, bar_color.g, bar_color.b, bar_color.a);
+    SDL_RenderFillRect(renderer, &bar);
+}
+
+// 绘制面板
+void job_panel_draw(JobPanel *panel) {
+    if (!panel) {
+        return;
+    }
+
+    JobPanelLayout layout;
+    panel->shown = panel->app->renderer && job_panel_layout(panel, &layout);
+    if (!panel->shown) {
+        return;
+    }
+
+    Window *app = panel->app;
+    SDL_Renderer *renderer = app->renderer;
+
+    // 1. 背景和边框
+    SDL_BlendMode blend_mode;
+    SDL_GetRenderDrawBlendMode(renderer, &blend_mode);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, JOB_PANEL_BG_COLOR.r, JOB_PANEL_BG_COLOR.g,
+                           JOB_PANEL_BG_COLOR.b, JOB_PANEL_BG_COLOR.a);
+    SDL_RenderFillRect(renderer, &layout.rect);
+    SDL_SetRenderDrawBlendMode(renderer, blend_mode);
+    SDL_SetRenderDrawColor(renderer, JOB_PANEL_BORDER_COLOR.r, JOB_PANEL_BORDER_COLOR.g,
+                           JOB_PANEL_BORDER_COLOR.b, JOB_PANEL_BORDER_COLOR.a);
+    SDL_RenderRect(renderer, &layout.rect);
+
+    // 2. 各任务
+    for (int i = 0; i < layout.rows; i++) {
+        job_panel_draw_row(panel, &layout, i);
+    }
+
+    // 3. 未显示的任务数和最近结束的任务摘要
+    float left = layout.rect.x + JOB_PANEL_PADDING;
+    float y = layout.rect.y + JOB_PANEL_PADDING + layout.rows * layout.row_h;
+    float text_w = layout.rect.w - JOB_PANEL_PADDING * 2;
+    if (layout.hidden > 0) {
+        char text[64];
+        snprintf(text, sizeof(text), "%d more queued", layout.hidden);
+        ui_text_draw(app, text, 0, left, y, JOB_PANEL_DIM_COLOR, text_w);
+        y += layout.line_h;
+    }
+    if (layout.status) {
+        ui_text_draw(app, panel->status, 0, left, y, JOB_PANEL_TEXT_COLOR, text_w);
+    }
+
+    // 提交面板文字
+    ui_text_flush(app);
+}
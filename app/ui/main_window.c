@@ -12,8 +12,19 @@
 #include "sidebar.h"
 #include "renderer.h"
 #include "context_menu.h"
+#include "dir_loader.h"
+#include "thumbnail.h"
+#include "ui_renderer.h"
+#include "profiler.h"
+#include "profiler_overlay.h"
+#include "file_jobs.h"
+#include "file_ops.h"
+#include "job_panel.h"
 #include <stdlib.h>
 
+// 面板缓存重绘前的填充颜色（与窗口背景一致）
+static const SDL_Color PANEL_CLEAR_COLOR = {240, 240, 240, 255};
+
 // 右键点击回调函数
 static void on_file_list_right_click(FileListView *view, int x, int y, FileItem *item) {
     // 获取主窗口实例
@@ -118,6 +129,26 @@ MainWindow* main_window_new(Window *a) {
     window->file_list_view->viewport.w = SDL_WINDOW_WIDTH - SIDEBAR_WIDTH;
     window->file_list_view->viewport.h = SDL_WINDOW_HEIGHT - TOOLBAR_HEIGHT;
 
+    // 创建各面板的缓存（失败时该面板每帧直接绘制到窗口）
+    window->file_list_layer = ui_layer_new(a->renderer, a->textures, window->file_list_view->viewport, PANEL_CLEAR_COLOR);
+    window->toolbar_layer = ui_layer_new(a->renderer, a->textures, window->toolbar->rect, PANEL_CLEAR_COLOR);
+    window->sidebar_layer = ui_layer_new(a->renderer, a->textures, window->sidebar->rect, PANEL_CLEAR_COLOR);
+    if (!window->file_list_layer || !window->toolbar_layer || !window->sidebar_layer) {
+        printf("[ERROR] Failed to create panel layers, drawing panels directly\n");
+    }
+
+    // 创建性能计时浮层（失败时没有浮层，不影响其它功能）
+    window->profiler_overlay = profiler_overlay_new(a);
+
+    // 创建文件操作任务队列和进度面板（失败时文件操作在UI线程同步执行）
+    window->job_queue = file_job_queue_new();
+    if (window->job_queue) {
+        window->job_panel = job_panel_new(a, window->job_queue);
+        file_ops_set_job_queue(window->job_queue);
+    } else {
+        printf("[ERROR] Failed to create file job queue, file operations run synchronously\n");
+    }
+
     // 设置用户数据，用于回调函数中获取主窗口实例
     a->user_data = window;
     
@@ -137,6 +168,19 @@ void main_window_free(MainWindow *window) {
         return;
     }
 
+    profiler_overlay_free(window->profiler_overlay);
+
+    // 取消未完成的文件操作并等待后台线程退出
+    file_ops_set_job_queue(NULL);
+    file_ops_clear_clipboard();
+    job_panel_free(window->job_panel);
+    file_job_queue_free(window->job_queue);
+
+    // 释放面板缓存
+    ui_layer_free(window->file_list_layer);
+    ui_layer_free(window->toolbar_layer);
+    ui_layer_free(window->sidebar_layer);
+
     // 释放UI组件
     if (window->file_list_view) {
         file_list_view_free(window->file_list_view);
@@ -161,11 +205,46 @@ bool main_window_handle_event(MainWindow *window, SDL_Event *event) {
         return false;
     }
 
+    // 目录监控事件直接交给文件列表视图
+    if (file_list_view_handle_watch_event(window->file_list_view, event)) {
+        return true;
+    }
+
+    // 性能计时浮层的快捷键（F12）
+    if (profiler_overlay_handle_event(window->profiler_overlay, event)) {
+        return true;
+    }
+
+    // 后台加载器的唤醒事件，目录项在 main_window_update 中合并
+    Uint32 loader_event = dir_loader_event_type();
+    if (loader_event != 0 && event->type == loader_event) {
+        return true;
+    }
+
+    // 缩略图解码完成的唤醒事件，纹理在 main_window_update 中上传
+    Uint32 thumbnail_event = thumbnail_event_type();
+    if (thumbnail_event != 0 && event->type == thumbnail_event) {
+        return true;
+    }
+
+    // 窗口尺寸、显示状态或渲染目标变化后整个窗口重绘
+    if ((event->type >= SDL_EVENT_WINDOW_FIRST && event->type <= SDL_EVENT_WINDOW_LAST) ||
+        event->type == SDL_EVENT_RENDER_TARGETS_RESET ||
+        event->type == SDL_EVENT_RENDER_DEVICE_RESET) {
+        window_invalidate(window->app, UI_DIRTY_ALL);
+        return true;
+    }
+
     // 优先处理右键菜单事件
     if (context_menu_handle_event(window->context_menu, event)) {
         return true;
     }
 
+    // 任务结束事件和进度面板上的点击（面板在文件列表之上）
+    if (job_panel_handle_event(window->job_panel, event)) {
+        return true;
+    }
+
     // 处理工具栏事件
     if (window->toolbar && toolbar_handle_event(window->toolbar, event)) {
         return true;
@@ -184,25 +263,108 @@ bool main_window_handle_event(MainWindow *window, SDL_Event *event) {
     return false;
 }
 
+// 主循环每次唤醒时更新主窗口状态（合并后台加载结果、光标闪烁等）
+void main_window_update(MainWindow *window) {
+    if (!window) {
+        return;
+    }
+
+    file_list_view_update(window->file_list_view);
+    job_panel_update(window->job_panel);
+    profiler_overlay_update(window->profiler_overlay);
+}
+
+// 距下一次定时更新的毫秒数（没有定时任务时返回-1）
+int main_window_next_timeout(MainWindow *window) {
+    if (!window) {
+        return -1;
+    }
+
+    int timeout = file_list_view_next_timeout(window->file_list_view);
+    int overlay_timeout = profiler_overlay_next_timeout(window->profiler_overlay);
+    if (overlay_timeout >= 0 && (timeout < 0 || overlay_timeout < timeout)) {
+        timeout = overlay_timeout;
+    }
+    int job_timeout = job_panel_next_timeout(window->job_panel);
+    if (job_timeout >= 0 && (timeout < 0 || job_timeout < timeout)) {
+        timeout = job_timeout;
+    }
+    return timeout;
+}
+
+// 绘制各面板并计时
+static void main_window_draw_file_list(MainWindow *window) {
+    Uint64 start = profiler_begin();
+    file_list_view_draw(window->file_list_view);
+    profiler_end(PROFILE_FILE_LIST_DRAW, start);
+}
+
+static void main_window_draw_toolbar(MainWindow *window) {
+    Uint64 start = profiler_begin();
+    toolbar_draw(window->toolbar);
+    profiler_end(PROFILE_TOOLBAR_DRAW, start);
+}
+
+static void main_window_draw_sidebar(MainWindow *window) {
+    Uint64 start = profiler_begin();
+    sidebar_draw(window->sidebar);
+    profiler_end(PROFILE_SIDEBAR_DRAW, start);
+}
+
+// 面板需要重绘时开始绘制到它的缓存中（没有缓存或不需要重绘时返回 false）
+static bool main_window_begin_layer(MainWindow *window, struct UiLayer *layer, int panel) {
+    Window *app = window->app;
+    if (!layer || !(app->dirty & (1 << panel))) {
+        return false;
+    }
+    return ui_layer_begin(layer, app, window_dirty_rect(app, panel));
+}
+
 // 绘制主窗口内容
 void main_window_draw(MainWindow *window) {
     if (!window || !window->app || !window->app->renderer) {
         return;
     }
     
-    // 绘制文件列表视图
-    file_list_view_draw(window->file_list_view);
+    // 只重绘标记了变化的面板，且只重绘变化的矩形
+    if (main_window_begin_layer(window, window->file_list_layer, UI_PANEL_FILE_LIST)) {
+        main_window_draw_file_list(window);
+        ui_layer_end(window->file_list_layer, window->app);
+    }
+    if (window->toolbar && main_window_begin_layer(window, window->toolbar_layer, UI_PANEL_TOOLBAR)) {
+        main_window_draw_toolbar(window);
+        ui_layer_end(window->toolbar_layer, window->app);
+    }
+    if (window->sidebar && main_window_begin_layer(window, window->sidebar_layer, UI_PANEL_SIDEBAR)) {
+        main_window_draw_sidebar(window);
+        ui_layer_end(window->sidebar_layer, window->app);
+    }
 
-    // 绘制工具栏
-    if (window->toolbar) {
-        toolbar_draw(window->toolbar);
+    // 合成各面板（没有缓存的面板直接绘制）
+    if (window->file_list_layer) {
+        ui_layer_composite(window->file_list_layer);
+    } else {
+        main_window_draw_file_list(window);
+    }
+
+    if (window->toolbar_layer) {
+        ui_layer_composite(window->toolbar_layer);
+    } else if (window->toolbar) {
+        main_window_draw_toolbar(window);
     }
     
-    // 绘制侧边栏
-    if (window->sidebar) {
-        sidebar_draw(window->sidebar);
+    if (window->sidebar_layer) {
+        ui_layer_composite(window->sidebar_layer);
+    } else if (window->sidebar) {
+        main_window_draw_sidebar(window);
     }
 
+    // 文件操作进度面板在文件列表之上，右键菜单之下
+    job_panel_draw(window->job_panel);
+
     // 绘制右键菜单（最后绘制，确保在最上层）
     context_menu_draw(window->context_menu);
+
+    // 性能计时浮层在所有内容之上
+    profiler_overlay_draw(window->profiler_overlay);
 }
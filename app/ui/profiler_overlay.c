@@ -0,0 +1,228 @@
+/*
+ * 性能计时浮层
+ * 职责：
+ * 1. 显示各计时区段上一帧的耗时、平均和最长耗时
+ * 2. 显示最近的帧耗时直方图
+ * 3. 显示文字、字形、图标、缩略图缓存的命中情况和纹理内存，以及当前目录的监控统计
+ * 4. 导出 Chrome trace JSON
+ */
+
+#include "profiler_overlay.h"
+#include "profiler.h"
+#include "ui_renderer.h"
+#include "icon_cache.h"
+#include "thumbnail.h"
+#include "texture_manager.h"
+#include "main_window.h"
+#include "app.h"
+#include "file_watcher.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// 颜色常量
+static const SDL_Color OVERLAY_BG_COLOR = {20, 20, 20, 210};
+static const SDL_Color OVERLAY_TEXT_COLOR = {230, 230, 230, 255};
+static const SDL_Color OVERLAY_DIM_COLOR = {150, 150, 150, 255};
+static const SDL_Color OVERLAY_BAR_COLOR = {90, 180, 90, 255};
+static const SDL_Color OVERLAY_SLOW_BAR_COLOR = {220, 80, 60, 255};
+static const SDL_Color OVERLAY_BUDGET_COLOR = {220, 200, 80, 255};
+
+// 直方图满量程和帧预算（纳秒）
+#define OVERLAY_HISTOGRAM_RANGE_NS 33333333ull
+#define OVERLAY_FRAME_BUDGET_NS 16666667ull
+
+// 创建性能计时浮层
+ProfilerOverlay* profiler_overlay_new(struct Window *app) {
+    if (!app) {
+        return NULL;
+    }
+
+    ProfilerOverlay *overlay = (ProfilerOverlay*)calloc(1, sizeof(ProfilerOverlay));
+    if (!overlay) {
+        return NULL;
+    }
+    overlay->app = app;
+    return overlay;
+}
+
+// 释放性能计时浮层
+void profiler_overlay_free(ProfilerOverlay *overlay) {
+    free(overlay);
+}
+
+// 处理浮层事件：F12 显示/隐藏，Shift+F12 导出
+bool profiler_overlay_handle_event(ProfilerOverlay *overlay, SDL_Event *event) {
+    if (!overlay || !event || event->type != SDL_EVENT_KEY_DOWN ||
+        event->key.scancode != SDL_SCANCODE_F12 || event->key.repeat) {
+        return false;
+    }
+
+    if (event->key.mod & SDL_KMOD_SHIFT) {
+        profiler_export_chrome_trace(PROFILER_OVERLAY_TRACE_PATH);
+        return true;
+    }
+
+    overlay->visible = !overlay->visible;
+    overlay->last_refresh = SDL_GetTicks();
+    // 浮层直接绘制在面板之上，任意一帧都会重新合成浮层下面的面板
+    window_invalidate(overlay->app, UI_DIRTY_OVERLAY);
+    return true;
+}
+
+// 显示时按刷新间隔标记重绘
+void profiler_overlay_update(ProfilerOverlay *overlay) {
+    if (!overlay || !overlay->visible) {
+        return;
+    }
+
+    Uint64 current_time = SDL_GetTicks();
+    if (current_time - overlay->last_refresh >= PROFILER_OVERLAY_REFRESH_INTERVAL) {
+        overlay->last_refresh = current_time;
+        window_invalidate(overlay->app, UI_DIRTY_OVERLAY);
+    }
+}
+
+// 距下一次刷新的毫秒数
+int profiler_overlay_next_timeout(ProfilerOverlay *overlay) {
+    if (!overlay || !overlay->visible) {
+        return -1;
+    }
+
+    Uint64 elapsed = SDL_GetTicks() - overlay->last_refresh;
+    return elapsed >= PROFILER_OVERLAY_REFRESH_INTERVAL ? 0 : (int)(PROFILER_OVERLAY_REFRESH_INTERVAL - elapsed);
+}
+
+// 绘制一行文字，返回下一行的位置
+static float overlay_line(ProfilerOverlay *overlay, float x, float y, SDL_Color color, const char *text) {
+    ui_text_draw(overlay->app, text, 0, x, y, color, PROFILER_OVERLAY_WIDTH - PROFILER_OVERLAY_PADDING * 2);
+    return y + TTF_GetFontHeight(overlay->app->font);
+}
+
+// 命中率（百分比，没有访问时为0）
+static double overlay_rate(Uint64 hits, Uint64 total) {
+    return total > 0 ? 100.0 * (double)hits / (double)total : 0.0;
+}
+
+// 绘制帧耗时直方图
+static void overlay_draw_histogram(ProfilerOverlay *overlay, SDL_FRect area) {
+    SDL_Renderer *renderer = overlay->app->renderer;
+    Uint64 frames[PROFILER_FRAME_HISTORY];
+    int count = profiler_get_frame_history(frames, PROFILER_FRAME_HISTORY);
+
+    float bar_w = area.w / PROFILER_FRAME_HISTORY;
+    for (int i = 0; i < count; i++) {
+        Uint64 ns = frames[i] < OVERLAY_HISTOGRAM_RANGE_NS ? frames[i] : OVERLAY_HISTOGRAM_RANGE_NS;
+        float bar_h = area.h * (float)ns / (float)OVERLAY_HISTOGRAM_RANGE_NS;
+        SDL_Color color = frames[i] > OVERLAY_FRAME_BUDGET_NS ? OVERLAY_SLOW_BAR_COLOR : OVERLAY_BAR_COLOR;
+        SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+        // 最新的一帧在最右边
+        SDL_FRect bar = {area.x + (PROFILER_FRAME_HISTORY - count + i) * bar_w, area.y + area.h - bar_h,
+                         bar_w > 1.0f ? bar_w - 1.0f : bar_w, bar_h};
+        SDL_RenderFillRect(renderer, &bar);
+    }
+
+    // 60 FPS 预算线
+    float budget_y = area.y + area.h - area.h * (float)OVERLAY_FRAME_BUDGET_NS / (float)OVERLAY_HISTOGRAM_RANGE_NS;
+    SDL_SetRenderDrawColor(renderer, OVERLAY_BUDGET_COLOR.r, OVERLAY_BUDGET_COLOR.g,
+                           OVERLAY_BUDGET_COLOR.b, OVERLAY_BUDGET_COLOR.a);
+    SDL_RenderLine(renderer, area.x, budget_y, area.x + area.w, budget_y);
+}
+
+// 绘制浮层
+void profiler_overlay_draw(ProfilerOverlay *overlay) {
+    if (!overlay || !overlay->visible || !overlay->app->renderer || !overlay->app->font) {
+        return;
+    }
+
+    Window *app = overlay->app;
+    SDL_Renderer *renderer = app->renderer;
+    int line_h = TTF_GetFontHeight(app->font);
+    char text[160];
+
+    // 1. 背景（窗口右上角，半透明）
+    int window_w = SDL_WINDOW_WIDTH;
+    SDL_GetWindowSize(app->window, &window_w, NULL);
+    float x = (float)(window_w > PROFILER_OVERLAY_WIDTH ? window_w - PROFILER_OVERLAY_WIDTH : 0);
+    // 标题、主循环唤醒、各区段（不含整帧）、三行缓存统计、一行目录监控统计
+    int lines = 2 + (PROFILE_SECTION_COUNT - 1) + 3 + 1;
+    SDL_FRect bg_rect = {x, 0.0f, PROFILER_OVERLAY_WIDTH,
+                         (float)(PROFILER_OVERLAY_PADDING * 3 + PROFILER_OVERLAY_HISTOGRAM_HEIGHT + lines * line_h)};
+    SDL_BlendMode blend_mode;
+    SDL_GetRenderDrawBlendMode(renderer, &blend_mode);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, OVERLAY_BG_COLOR.r, OVERLAY_BG_COLOR.g, OVERLAY_BG_COLOR.b, OVERLAY_BG_COLOR.a);
+    SDL_RenderFillRect(renderer, &bg_rect);
+    SDL_SetRenderDrawBlendMode(renderer, blend_mode);
+
+    float left = x + PROFILER_OVERLAY_PADDING;
+    float y = (float)PROFILER_OVERLAY_PADDING;
+
+    // 2. 整帧耗时和直方图
+    ProfileSectionStats stats;
+    profiler_get_section_stats(PROFILE_FRAME, &stats);
+    snprintf(text, sizeof(text), "frame %.2f ms  avg %.2f  max %.2f",
+             stats.frame_ns / 1e6, stats.calls ? stats.total_ns / 1e6 / (double)stats.calls : 0.0,
+             stats.max_ns / 1e6);
+    y = overlay_line(overlay, left, y, OVERLAY_TEXT_COLOR, text);
+
+    // 主循环唤醒次数（idle 为唤醒后没有任何区域需要重绘）
+    AppFrameStats frame_stats;
+    app_get_frame_stats(&frame_stats);
+    snprintf(text, sizeof(text), "loop %llu frames, %llu wakeups, %llu idle",
+             (unsigned long long)frame_stats.frames, (unsigned long long)frame_stats.wakeups,
+             (unsigned long long)frame_stats.idle_wakeups);
+    y = overlay_line(overlay, left, y, OVERLAY_DIM_COLOR, text);
+
+    SDL_FRect histogram = {left, y + PROFILER_OVERLAY_PADDING,
+                           PROFILER_OVERLAY_WIDTH - PROFILER_OVERLAY_PADDING * 2, PROFILER_OVERLAY_HISTOGRAM_HEIGHT};
+    overlay_draw_histogram(overlay, histogram);
+    y = histogram.y + histogram.h + PROFILER_OVERLAY_PADDING;
+
+    // 3. 各区段：上一帧之和 / 平均 / 最长（毫秒）
+    for (int i = PROFILE_FRAME + 1; i < PROFILE_SECTION_COUNT; i++) {
+        profiler_get_section_stats((ProfileSection)i, &stats);
+        snprintf(text, sizeof(text), "%-16s %7.2f %7.2f %7.2f",
+                 profiler_section_name((ProfileSection)i), stats.frame_ns / 1e6,
+                 stats.calls ? stats.total_ns / 1e6 / (double)stats.calls : 0.0, stats.max_ns / 1e6);
+        y = overlay_line(overlay, left, y, stats.calls ? OVERLAY_TEXT_COLOR : OVERLAY_DIM_COLOR, text);
+    }
+
+    // 4. 缓存命中率和纹理内存
+    // 图集存在时所有文字都走图集，文字纹理缓存只在图集创建失败时使用，这里只显示图集统计
+    GlyphAtlasStats glyph_stats;
+    glyph_atlas_get_stats(app->glyph_atlas, &glyph_stats);
+    // 每次提交的四边形数反映批量绘制的效果，重置次数多说明图集页数不够
+    snprintf(text, sizeof(text), "glyphs %d, %d pages, %d resets, %.1f quads/draw",
+             glyph_stats.glyphs, glyph_stats.pages, glyph_stats.resets,
+             glyph_stats.draw_calls > 0 ? (double)glyph_stats.quads / glyph_stats.draw_calls : 0.0);
+    y = overlay_line(overlay, left, y, OVERLAY_TEXT_COLOR, text);
+
+    ThumbnailStats thumb_stats;
+    thumbnail_cache_get_stats(app->thumbnails, &thumb_stats);
+    // decoded 包括从磁盘缓存读取的缩略图
+    snprintf(text, sizeof(text), "thumbs %.1f%% disk hit, %d loaded, %d queued",
+             overlay_rate((Uint64)thumb_stats.disk_hits, (Uint64)thumb_stats.decoded),
+             thumb_stats.decoded, thumb_stats.queued);
+    y = overlay_line(overlay, left, y, OVERLAY_TEXT_COLOR, text);
+
+    IconCacheStats icon_stats;
+    TextureManagerStats texture_stats;
+    icon_cache_get_stats(app->icon_cache, &icon_stats);
+    texture_manager_get_stats(app->textures, &texture_stats);
+    snprintf(text, sizeof(text), "icons %d  textures %.1f/%.0f MB, peak %.1f, %d over",
+             icon_stats.textures, texture_stats.total_bytes / 1048576.0, texture_stats.budget / 1048576.0,
+             texture_stats.peak_bytes / 1048576.0, texture_stats.over_budget_frames);
+    y = overlay_line(overlay, left, y, OVERLAY_TEXT_COLOR, text);
+
+    // 5. 当前目录的监控统计（切换目录时重新计数）
+    MainWindow *main_window = (MainWindow*)app->user_data;
+    FileWatcher *watcher = main_window && main_window->file_list_view ? main_window->file_list_view->watcher : NULL;
+    FileWatcherStats watch_stats;
+    file_watcher_get_stats(watcher, &watch_stats);
+    snprintf(text, sizeof(text), "watch %d events, %d merged, %d dropped, %d rescans",
+             watch_stats.events, watch_stats.coalesced_events, watch_stats.dropped_events, watch_stats.rescans);
+    overlay_line(overlay, left, y, watcher ? OVERLAY_TEXT_COLOR : OVERLAY_DIM_COLOR, text);
+
+    // 提交浮层文字
+    ui_text_flush(app);
+}
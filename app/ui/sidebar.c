@@ -9,11 +9,12 @@
 
 #include "sidebar.h"
 #include "renderer.h"
+#include "ui_renderer.h"
 #include "file_system.h"
 #include "toolbar.h"
+#include "icon_cache.h"
 #include <stdlib.h>
 #include <string.h>
-#include <SDL3_image/SDL_image.h>
 
 // 侧边栏项目高度
 #define SIDEBAR_ITEM_HEIGHT 30
@@ -30,6 +31,7 @@ static void sidebar_add_item(Sidebar *sidebar, SidebarItemType type, const char
 static void sidebar_draw_item(Sidebar *sidebar, int index);
 static int sidebar_get_item_at(Sidebar *sidebar, int x, int y);
 static SDL_Texture* load_icon(Sidebar *sidebar, SidebarItemType type);
+static void release_icon(Sidebar *sidebar, SidebarItem *item);
 static bool get_special_folder_path_wrapper(SpecialFolder folder, char *path, size_t path_size);
 
 // 创建侧边栏
@@ -86,14 +88,32 @@ void sidebar_free(Sidebar *sidebar) {
         if (sidebar->items[i].path) {
             free(sidebar->items[i].path);
         }
-        if (sidebar->items[i].icon) {
-            SDL_DestroyTexture(sidebar->items[i].icon);
-        }
+        release_icon(sidebar, &sidebar->items[i]);
     }
     
     free(sidebar);
 }
 
+// 标记一个项目需要重绘（只重绘该项目所在的矩形）
+static void sidebar_invalidate_item(Sidebar *sidebar, int index) {
+    if (index < 0 || index >= sidebar->item_count) {
+        return;
+    }
+
+    SDL_Rect rect = sidebar->items[index].rect;
+    rect.y -= sidebar->scroll_offset;
+    window_invalidate_rect(sidebar->app, UI_DIRTY_SIDEBAR, &rect);
+}
+
+// 更新悬停项，变化时只重绘新旧两个项目
+static void sidebar_set_hover(Sidebar *sidebar, int index) {
+    if (sidebar->hover_index != index) {
+        sidebar_invalidate_item(sidebar, sidebar->hover_index);
+        sidebar->hover_index = index;
+        sidebar_invalidate_item(sidebar, index);
+    }
+}
+
 // 处理侧边栏事件
 bool sidebar_handle_event(Sidebar *sidebar, SDL_Event *event) {
     if (!sidebar || !event) {
@@ -110,11 +130,11 @@ bool sidebar_handle_event(Sidebar *sidebar, SDL_Event *event) {
             y >= sidebar->rect.y && y < sidebar->rect.y + sidebar->rect.h) {
             
             // 更新悬停项索引
-            sidebar->hover_index = sidebar_get_item_at(sidebar, x, y);
+            sidebar_set_hover(sidebar, sidebar_get_item_at(sidebar, x, y));
             return true;
         } else {
             // 鼠标移出侧边栏区域
-            sidebar->hover_index = -1;
+            sidebar_set_hover(sidebar, -1);
         }
     }
     
@@ -138,6 +158,7 @@ bool sidebar_handle_event(Sidebar *sidebar, SDL_Event *event) {
                     
                     // 更新选中项
                     sidebar->selected_index = index;
+                    window_invalidate(sidebar->app, UI_DIRTY_SIDEBAR);
                     
                     // 调用选中回调
                     if (sidebar->on_item_selected && sidebar->items[index].path) {
@@ -160,6 +181,7 @@ bool sidebar_handle_event(Sidebar *sidebar, SDL_Event *event) {
             y >= sidebar->rect.y && y < sidebar->rect.y + sidebar->rect.h) {
             
             // 更新滚动偏移
+            int old_offset = sidebar->scroll_offset;
             sidebar->scroll_offset -= event->wheel.y * 20; // 滚动速度因子
             
             // 限制滚动范围
@@ -171,7 +193,10 @@ bool sidebar_handle_event(Sidebar *sidebar, SDL_Event *event) {
             } else if (sidebar->scroll_offset > max_scroll) {
                 sidebar->scroll_offset = max_scroll;
             }
-            
+
+            if (sidebar->scroll_offset != old_offset) {
+                window_invalidate(sidebar->app, UI_DIRTY_SIDEBAR);
+            }
             return true;
         }
     }
@@ -213,6 +238,9 @@ void sidebar_draw(Sidebar *sidebar) {
     for (int i = 0; i < sidebar->item_count; i++) {
         sidebar_draw_item(sidebar, i);
     }
+    
+    // 提交项目文字
+    ui_text_flush(sidebar->app);
 }
 
 // 设置项目选中回调
@@ -316,58 +344,31 @@ static void sidebar_add_separator(Sidebar *sidebar) {
     item->rect.h = SIDEBAR_SEPARATOR_HEIGHT;
 }
 
-// 加载图标
+// 侧边栏项目的图标类别
+static IconClass sidebar_icon_class(SidebarItemType type) {
+    return (type == SIDEBAR_ITEM_DRIVE) ? ICON_CLASS_DRIVE : ICON_CLASS_FOLDER;
+}
+
+// 加载图标（从共用的图标缓存获取，持有一次引用）
 static SDL_Texture* load_icon(Sidebar *sidebar, SidebarItemType type) {
-    if (!sidebar || !sidebar->app || !sidebar->app->renderer) {
+    if (!sidebar || !sidebar->app || !sidebar->app->icon_cache) {
         return NULL;
     }
-    
-    SDL_Renderer *renderer = sidebar->app->renderer;
-    SDL_Texture *texture = NULL;
-    
-    // 根据项目类型加载不同的图标
-    const char *icon_path = NULL;
-    
-    switch (type) {
-        case SIDEBAR_ITEM_QUICK_ACCESS:
-            icon_path = "assets/icons/folder.png";
-            break;
-        case SIDEBAR_ITEM_DRIVE:
-            icon_path = "assets/icons/drive.png";
-            break;
-        default:
-            return NULL;
+    if (type != SIDEBAR_ITEM_QUICK_ACCESS && type != SIDEBAR_ITEM_DRIVE) {
+        return NULL;
     }
-    
-    // 加载图标
-    SDL_Surface *surface = IMG_Load(icon_path);
-    if (!surface) {
-        // 如果找不到图标，创建一个简单的彩色方块
-        surface = SDL_CreateSurface(16, 16, SDL_PIXELFORMAT_RGBA32);
-        if (!surface) {
-            return NULL;
-        }
-        
-        // 根据类型设置不同的颜色
-        Uint32 color;
-        const SDL_PixelFormatDetails *format_details = SDL_GetPixelFormatDetails(surface->format);
-        if (type == SIDEBAR_ITEM_QUICK_ACCESS) {
-            color = SDL_MapRGBA(format_details, NULL, 255, 200, 0, 255);  // 黄色文件夹
-        } else {
-            color = SDL_MapRGBA(format_details, NULL, 100, 150, 200, 255); // 蓝色驱动器
-        }
-        
-        // 填充颜色
-        SDL_FillSurfaceRect(surface, NULL, color);
+
+    return icon_cache_acquire(sidebar->app->icon_cache, sidebar_icon_class(type), ICON_SIZE_SMALL);
+}
+
+// 释放项目持有的图标引用
+static void release_icon(Sidebar *sidebar, SidebarItem *item) {
+    if (!item->icon) {
+        return;
     }
-    
-    // 创建纹理
-    texture = SDL_CreateTextureFromSurface(renderer, surface);
-    
-    // 释放表面
-    SDL_DestroySurface(surface);
-    
-    return texture;
+
+    icon_cache_release(sidebar->app->icon_cache, sidebar_icon_class(item->type), ICON_SIZE_SMALL);
+    item->icon = NULL;
 }
 
 // 添加侧边栏项目
@@ -465,38 +466,11 @@ static void sidebar_draw_item(Sidebar *sidebar, int index) {
             SDL_RenderTexture(renderer, item->icon, NULL, &icon_rect);
         }
         
-        // 绘制文本
+        // 绘制文本（加入批次，面板绘制结束时统一提交）
         if (item->name) {
-            // 创建文本表面
-            SDL_Surface *text_surface = TTF_RenderText_Blended(
-                sidebar->app->font,
-                item->name,
-                0, // 使用0表示自动计算字符串长度
-                sidebar->text_color
-            );
-            
-            if (text_surface) {
-                // 创建文本纹理
-                SDL_Texture *text_texture = SDL_CreateTextureFromSurface(renderer, text_surface);
-                
-                if (text_texture) {
-                    // 计算文本位置
-                    SDL_FRect text_rect;
-                    text_rect.x = (float)(draw_rect.x + SIDEBAR_ITEM_PADDING + (item->icon ? 20 : 0)); // 如果有图标，则文本右移
-                    text_rect.y = (float)(draw_rect.y + (draw_rect.h - text_surface->h) / 2);
-                    text_rect.w = (float)text_surface->w;
-                    text_rect.h = (float)text_surface->h;
-                    
-                    // 绘制文本
-                    SDL_RenderTexture(renderer, text_texture, NULL, &text_rect);
-                    
-                    // 释放纹理
-                    SDL_DestroyTexture(text_texture);
-                }
-                
-                // 释放表面
-                SDL_DestroySurface(text_surface);
-            }
+            float text_x = (float)(draw_rect.x + SIDEBAR_ITEM_PADDING + (item->icon ? 20 : 0)); // 如果有图标，则文本右移
+            float text_y = (float)(draw_rect.y + (draw_rect.h - TTF_GetFontHeight(sidebar->app->font)) / 2);
+            ui_text_draw(sidebar->app, item->name, 0, text_x, text_y, sidebar->text_color, 0);
         }
     }
 }
@@ -566,9 +540,7 @@ void sidebar_refresh_drives(Sidebar *sidebar) {
             if (sidebar->items[i].path) {
                 free(sidebar->items[i].path);
             }
-            if (sidebar->items[i].icon) {
-                SDL_DestroyTexture(sidebar->items[i].icon);
-            }
+            release_icon(sidebar, &sidebar->items[i]);
             
             // 移动后面的项目
             for (int j = i; j < sidebar->item_count - 1; j++) {
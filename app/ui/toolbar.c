@@ -591,6 +591,17 @@ void toolbar_free(Toolbar *toolbar) {
     free(toolbar);
 }
 
+// 更新按钮悬停状态，只重绘状态变化的按钮
+static void toolbar_set_hover(Toolbar *toolbar, ToolbarButton *hover_button) {
+    for (int i = 0; i < toolbar->button_count; i++) {
+        bool hovered = (hover_button == &toolbar->buttons[i]);
+        if (toolbar->buttons[i].hovered != hovered) {
+            toolbar->buttons[i].hovered = hovered;
+            window_invalidate_rect(toolbar->app, UI_DIRTY_TOOLBAR, &toolbar->buttons[i].rect);
+        }
+    }
+}
+
 // 处理工具栏事件
 bool toolbar_handle_event(Toolbar *toolbar, SDL_Event *event) {
     if (!toolbar || !event) {
@@ -609,16 +620,12 @@ bool toolbar_handle_event(Toolbar *toolbar, SDL_Event *event) {
                     
                     // 更新按钮悬停状态
                     ToolbarButton *hover_button = find_button_at_point(toolbar, x, y);
-                    for (int i = 0; i < toolbar->button_count; i++) {
-                        toolbar->buttons[i].hovered = (hover_button == &toolbar->buttons[i]);
-                    }
+                    toolbar_set_hover(toolbar, hover_button);
                     
                     return true;
                 } else {
                     // 鼠标移出工具栏区域，清除所有悬停状态
-                    for (int i = 0; i < toolbar->button_count; i++) {
-                        toolbar->buttons[i].hovered = false;
-                    }
+                    toolbar_set_hover(toolbar, NULL);
                 }
             }
             break;
@@ -637,6 +644,7 @@ bool toolbar_handle_event(Toolbar *toolbar, SDL_Event *event) {
                     ToolbarButton *button = find_button_at_point(toolbar, x, y);
                     if (button) {
                         button->pressed = true;
+                        window_invalidate_rect(toolbar->app, UI_DIRTY_TOOLBAR, &button->rect);
                         return true;
                     }
                 }
@@ -653,6 +661,7 @@ bool toolbar_handle_event(Toolbar *toolbar, SDL_Event *event) {
                     ToolbarButton *button = &toolbar->buttons[i];
                     if (button->pressed) {
                         button->pressed = false;
+                        window_invalidate_rect(toolbar->app, UI_DIRTY_TOOLBAR, &button->rect);
                         
                         // 检查鼠标释放是否在按钮区域内
                         if (x >= button->rect.x && x < button->rect.x + button->rect.w &&
@@ -681,8 +690,9 @@ void toolbar_notify_directory_changed(Toolbar *toolbar, const char *path) {
         return;
     }
     
-    // 添加到历史记录
+    // 添加到历史记录（前进/后退按钮状态随之变化）
     add_to_history(toolbar, path);
+    window_invalidate(toolbar->app, UI_DIRTY_TOOLBAR);
 }
 
 // 绘制工具栏
@@ -0,0 +1,220 @@
+/*
+ * 文件列表布局基准测试（只在 FILESCOPE_BENCH 选项打开时编译）
+ * 职责：
+ * 1. 生成同一组合成目录项，分别放入逐项结构体数组和元数据列
+ * 2. 两种布局执行相同的工作：按 order 过滤隐藏文件、统计可见项大小、按大小排序
+ */
+
+#include "layout_bench.h"
+#include "file_item.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 毫秒计时
+static double bench_elapsed_ms(Uint64 start) {
+    return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+// 按大小降序、名称升序比较（逐项结构体布局）
+static int bench_compare_items(const void *a, const void *b) {
+    const FileItem *ia = *(const FileItem* const*)a;
+    const FileItem *ib = *(const FileItem* const*)b;
+    if (ia->size != ib->size) {
+        return ia->size > ib->size ? -1 : 1;
+    }
+    return strcmp(ia->name, ib->name);
+}
+
+// 按大小降序、名称升序比较（元数据列布局）
+static int SDLCALL bench_compare_columns(void *user_data, const void *a, const void *b) {
+    const FileList *list = (const FileList*)user_data;
+    int ia = *(const int*)a;
+    int ib = *(const int*)b;
+    uint64_t sa = list->columns.size[ia];
+    uint64_t sb = list->columns.size[ib];
+    if (sa != sb) {
+        return sa > sb ? -1 : 1;
+    }
+    return strcmp(list->columns.name_pool + list->columns.name_offset[ia],
+                  list->columns.name_pool + list->columns.name_offset[ib]);
+}
+
+// 复制列表中的文件项为单独分配的结构体（与列表的数据完全相同，包括 ".." 项）
+static FileItem* bench_copy_item(const FileItem *source) {
+    FileItem *item = (FileItem*)calloc(1, sizeof(FileItem));
+    if (!item) {
+        return NULL;
+    }
+    item->path = strdup(source->path);
+    item->name = strdup(source->name);
+    item->display_name = strdup(source->display_name ? source->display_name : source->name);
+    item->size = source->size;
+    item->modified_time = source->modified_time;
+    item->type = source->type;
+    item->is_hidden = source->is_hidden;
+    if (!item->path || !item->name || !item->display_name) {
+        file_item_free(item);
+        return NULL;
+    }
+    return item;
+}
+
+// 两种布局使用的数组（项数、顺序和内容相同）
+typedef struct {
+    FileList *list;              // 元数据列布局
+    FileItem **aos;              // 逐项结构体布局
+    int *aos_order;              // 逐项布局的显示顺序（复制自 list->order）
+    int *aos_visible;            // 逐项布局的可见数组
+    int *aos_visible_pos;        // 逐项布局的可见位置
+    FileItem **aos_sorted;       // 逐项布局的排序结果
+    int *soa_sorted;             // 元数据列布局的排序结果
+} LayoutBench;
+
+// 依次测量三项操作并输出
+static void layout_bench_measure(const LayoutBench *bench) {
+    FileList *list = bench->list;
+    FileItem **aos = bench->aos;
+    const int *aos_order = bench->aos_order;
+    int *aos_visible = bench->aos_visible;
+    int *aos_visible_pos = bench->aos_visible_pos;
+    FileItem **aos_sorted = bench->aos_sorted;
+    int *soa_sorted = bench->soa_sorted;
+    int n = list->count;
+
+    const int rounds = 20;
+    Uint64 start;
+
+    // 1. 隐藏文件过滤：两边都按 order 重建可见数组和可见位置，只是读取隐藏标志的位置不同
+    int aos_visible_count = 0;
+    start = SDL_GetPerformanceCounter();
+    for (int r = 0; r < rounds; r++) {
+        aos_visible_count = 0;
+        for (int i = 0; i < n; i++) {
+            int index = aos_order[i];
+            int keep = aos[index]->is_hidden ? 0 : 1;
+            aos_visible[aos_visible_count] = index;
+            aos_visible_pos[index] = keep ? aos_visible_count : -1;
+            aos_visible_count += keep;
+        }
+    }
+    double aos_filter = bench_elapsed_ms(start) / rounds;
+
+    list->show_hidden = false;
+    start = SDL_GetPerformanceCounter();
+    for (int r = 0; r < rounds; r++) {
+        file_list_rebuild_visible(list);
+    }
+    double soa_filter = bench_elapsed_ms(start) / rounds;
+
+    // 2. 可见项总大小：两边都遍历各自的可见数组
+    uint64_t aos_total = 0;
+    start = SDL_GetPerformanceCounter();
+    for (int r = 0; r < rounds; r++) {
+        aos_total = 0;
+        for (int i = 0; i < aos_visible_count; i++) {
+            aos_total += aos[aos_visible[i]]->size;
+        }
+    }
+    double aos_sum = bench_elapsed_ms(start) / rounds;
+
+    uint64_t soa_total = 0;
+    start = SDL_GetPerformanceCounter();
+    for (int r = 0; r < rounds; r++) {
+        soa_total = 0;
+        const uint64_t *size = list->columns.size;
+        const int *visible = list->visible;
+        for (int i = 0; i < list->visible_count; i++) {
+            soa_total += size[visible[i]];
+        }
+    }
+    double soa_sum = bench_elapsed_ms(start) / rounds;
+
+    // 3. 按大小排序：两边排序同样的 n 项
+    memcpy(aos_sorted, aos, sizeof(FileItem*) * (size_t)n);
+    start = SDL_GetPerformanceCounter();
+    SDL_qsort(aos_sorted, (size_t)n, sizeof(FileItem*), bench_compare_items);
+    double aos_sort = bench_elapsed_ms(start);
+
+    for (int i = 0; i < n; i++) {
+        soa_sorted[i] = i;
+    }
+    start = SDL_GetPerformanceCounter();
+    SDL_qsort_r(soa_sorted, (size_t)n, sizeof(int), bench_compare_columns, list);
+    double soa_sort = bench_elapsed_ms(start);
+
+    printf("[BENCH] %-24s %12s %12s\n", "operation", "items (ms)", "columns (ms)");
+    printf("[BENCH] %-24s %12.3f %12.3f\n", "hidden filter", aos_filter, soa_filter);
+    printf("[BENCH] %-24s %12.3f %12.3f\n", "visible size sum", aos_sum, soa_sum);
+    printf("[BENCH] %-24s %12.3f %12.3f\n", "sort by size", aos_sort, soa_sort);
+    // 两种布局的结果必须一致
+    printf("[BENCH] visible %d/%d, total %llu/%llu, first %s/%s\n", aos_visible_count, list->visible_count,
+           (unsigned long long)aos_total, (unsigned long long)soa_total, aos_sorted[0]->name,
+           list->columns.name_pool + list->columns.name_offset[soa_sorted[0]]);
+}
+
+// 比较两种布局在过滤、统计和排序上的耗时
+void layout_bench_run(int count) {
+    if (count <= 0) {
+        return;
+    }
+
+    printf("[BENCH] Building %d synthetic entries\n", count);
+
+    // 新布局：列表的分配器和元数据列
+    FileList *list = file_list_new();
+    if (!list || !file_list_begin_load(list, "/bench")) {
+        printf("[ERROR] Benchmark allocation failed\n");
+        file_list_free(list);
+        return;
+    }
+    uint32_t seed = 12345;
+    char name[64];
+    char path[96];
+    for (int i = 0; i < count; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        snprintf(name, sizeof(name), "%sfile_%08x.dat", (seed >> 28) == 0 ? "." : "", seed);
+        snprintf(path, sizeof(path), "/bench/%s", name);
+
+        FileItem *item = file_list_alloc_item(list, path, NULL, NULL);
+        if (item) {
+            item->size = (size_t)(seed % 1000003u);
+            item->modified_time = (time_t)(seed >> 4);
+            item->type = FILE_TYPE_REGULAR;
+            item->is_hidden = (name[0] == '.');
+            file_list_add_item(list, item);
+        }
+    }
+
+    // 旧布局：从列表复制同样的项目（项数、顺序和内容都相同）
+    int n = list->count;
+    FileItem **aos = (FileItem**)calloc((size_t)n, sizeof(FileItem*));
+    int *aos_order = (int*)malloc(sizeof(int) * (size_t)n);
+    int *aos_visible = (int*)malloc(sizeof(int) * (size_t)n);
+    int *aos_visible_pos = (int*)malloc(sizeof(int) * (size_t)n);
+    FileItem **aos_sorted = (FileItem**)malloc(sizeof(FileItem*) * (size_t)n);
+    int *soa_sorted = (int*)malloc(sizeof(int) * (size_t)n);
+    bool ready = aos && aos_order && aos_visible && aos_visible_pos && aos_sorted && soa_sorted;
+    for (int i = 0; ready && i < n; i++) {
+        aos[i] = bench_copy_item(list->items[i]);
+        ready = aos[i] != NULL;
+    }
+    if (ready) {
+        memcpy(aos_order, list->order, sizeof(int) * (size_t)n);
+        LayoutBench bench = {list, aos, aos_order, aos_visible, aos_visible_pos, aos_sorted, soa_sorted};
+        layout_bench_measure(&bench);
+    } else {
+        printf("[ERROR] Benchmark allocation failed\n");
+    }
+
+    for (int i = 0; aos && i < n; i++) {
+        file_item_free(aos[i]);
+    }
+    free(aos);
+    free(aos_order);
+    free(aos_visible);
+    free(aos_visible_pos);
+    free(aos_sorted);
+    free(soa_sorted);
+    file_list_free(list);
+}
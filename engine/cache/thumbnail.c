@@ -1,8 +1,1218 @@
 /*
  * 缩略图模块
  * 职责：
- * 1. 生成文件缩略图
- * 2. 缓存缩略图
- * 3. 管理缩略图大小
- * 4. 支持不同文件类型的预览
+ * 1. 生成文件缩略图（后台线程用 SDL_image 解码并按区域平均缩小，不阻塞UI主循环）
+ * 2. 缓存缩略图（按路径哈希查找，超出容量时淘汰最久未请求的项）
+ * 3. 管理缩略图大小（按最大边长等比缩小，小图保持原尺寸）
+ * 4. 只为视口内和附近的项目解码，按与视口的距离排序，离开视口的请求被取消
+ * 5. UI线程只负责把解码好的 RGBA 数据上传为纹理，每次更新有数量上限
+ * 6. 缩略图持久化到用户缓存目录的打包文件中（按路径、缩略图尺寸和文件修改时间匹配，
+ *    文件变化后自动失效），超出容量时按最近使用时间压缩
  */
+
+#include "thumbnail.h"
+#include "profiler.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 解码线程数上限
+#define THUMBNAIL_MAX_WORKERS 4
+// 空链接
+#define THUMBNAIL_NONE (-1)
+// 打包文件标识和版本（格式变化时增加版本号，旧文件被重建）
+#define THUMBNAIL_PACK_MAGIC 0x48544346u
+#define THUMBNAIL_PACK_VERSION 1
+// 记录标识和标志
+#define THUMBNAIL_RECORD_MAGIC 0x43455246u
+#define THUMBNAIL_RECORD_DEAD 1u
+// 记录中路径的最大长度（更长的视为损坏）
+#define THUMBNAIL_RECORD_MAX_PATH 4096
+
+// 打包文件头
+typedef struct {
+    Uint32 magic;            // THUMBNAIL_PACK_MAGIC
+    Uint32 version;          // THUMBNAIL_PACK_VERSION
+    Uint32 size;             // 缩略图最大边长
+    Uint32 reserved;
+} ThumbnailPackHeader;
+
+// 打包文件中的一条记录（之后依次是路径和 w*h*4 字节 RGBA 数据）
+typedef struct {
+    Uint32 magic;            // THUMBNAIL_RECORD_MAGIC
+    Uint32 path_len;         // 路径长度（不含结尾的0）
+    Uint64 file_size;        // 生成时的文件大小
+    Sint64 modify_time;      // 生成时的文件修改时间
+    Uint64 last_used;        // 最近使用序号（越大越近）
+    Uint16 w;                // 缩略图宽度
+    Uint16 h;                // 缩略图高度
+    Uint32 flags;            // THUMBNAIL_RECORD_DEAD 表示已被新记录取代
+} ThumbnailRecord;
+
+// 磁盘索引项（每个路径只保留最新的一条记录）
+typedef struct {
+    char *path;              // 文件路径
+    uint32_t hash;           // 路径的哈希
+    Sint64 offset;           // 记录在打包文件中的偏移
+    Uint64 file_size;        // 生成时的文件大小
+    Sint64 modify_time;      // 生成时的文件修改时间
+    Uint64 last_used;        // 最近使用序号
+    int w;                   // 缩略图宽度
+    int h;                   // 缩略图高度
+    int next;                // 同一哈希桶的下一项
+} ThumbnailDiskEntry;
+
+// 磁盘缓存（打包文件 + 内存索引，由解码线程访问）
+typedef struct {
+    SDL_Mutex *mutex;            // 保护以下全部字段和文件读写
+    char *pack_path;             // 打包文件路径（没有可用的缓存目录时为NULL）
+    SDL_IOStream *io;            // 打开的打包文件（未打开或出错停用时为NULL）
+    bool opened;                 // 是否已尝试打开
+    int size;                    // 缩略图最大边长
+    Sint64 max_bytes;            // 打包文件大小上限
+    ThumbnailDiskEntry *entries; // 索引项
+    int count;                   // 索引项数
+    int capacity;                // 索引项容量
+    int *buckets;                // 哈希桶（链表头）
+    int bucket_count;            // 哈希桶数量（2的幂，0表示尚未分配）
+    Sint64 pack_bytes;           // 打包文件已写入的长度
+    Uint64 clock;                // 最近使用序号
+    int hits;                    // 命中次数
+    int writes;                  // 写入记录数
+    int compactions;             // 压缩次数
+} ThumbnailStore;
+
+// 缓存项状态
+enum {
+    THUMBNAIL_EMPTY,         // 空闲槽位
+    THUMBNAIL_QUEUED,        // 排队等待解码
+    THUMBNAIL_DECODING,      // 后台线程正在解码
+    THUMBNAIL_READY,         // 已解码，等待UI线程上传
+    THUMBNAIL_DONE,          // 已上传为纹理
+    THUMBNAIL_FAILED         // 解码失败（不再重试）
+};
+
+// 一个缩略图缓存项
+typedef struct {
+    char *path;              // 文件路径（空闲槽位为NULL，解码期间不会被修改）
+    uint32_t hash;           // 路径的哈希
+    int state;               // 状态（互斥锁保护）
+    int priority;            // 解码优先级，越小越先解码（互斥锁保护）
+    Uint64 generation;       // 最后一次被请求的轮次
+    Uint8 *pixels;           // 解码后的 RGBA 数据（THUMBNAIL_READY 时非空，互斥锁保护）
+    int w;                   // 缩略图宽度
+    int h;                   // 缩略图高度
+    SDL_Texture *texture;    // 上传后的纹理（只由UI线程访问）
+    Uint64 last_used;        // 最近绘制的帧号（纹理管理器，只由UI线程访问）
+    int bucket_next;         // 同一哈希桶的下一项（空闲项为空闲链表的下一项，只由UI线程访问）
+} ThumbnailEntry;
+
+struct ThumbnailCache {
+    SDL_Renderer *renderer;      // 纹理所属的渲染器
+    TextureManager *textures;    // 纹理管理器（可为NULL）
+    int size;                    // 缩略图最大边长
+    ThumbnailEntry *entries;     // 缓存项（容量固定，下标稳定）
+    int capacity;                // 缓存项容量
+    int entry_count;             // 已使用过的槽位数（互斥锁保护）
+    int free_list;               // 空闲槽位链表（只由UI线程访问）
+    int *buckets;                // 哈希桶（链表头，只由UI线程访问）
+    int bucket_count;            // 哈希桶数量（2的幂）
+    Uint64 generation;           // 当前请求轮次（只由UI线程访问）
+
+    SDL_Mutex *mutex;            // 保护缓存项状态、解码结果和以下计数
+    SDL_Condition *work_ready;   // 有新请求或需要退出
+    SDL_Thread **threads;        // 解码线程
+    int worker_count;            // 解码线程数
+    bool shutdown;               // 是否退出
+    int queued;                  // 排队中的请求数
+    int ready;                   // 等待上传的缩略图数
+    SDL_AtomicInt wake_pending;  // 已发送唤醒事件且UI线程尚未上传
+
+    ThumbnailStats stats;        // 累计统计（互斥锁保护）
+    ThumbnailStore store;        // 磁盘缓存（有自己的互斥锁）
+};
+
+// 唤醒事件类型（0表示尚未注册）
+static SDL_AtomicInt g_event_type;
+
+// 唤醒事件类型（首次调用时注册，失败返回0）
+Uint32 thumbnail_event_type(void) {
+    Uint32 type = (Uint32)SDL_GetAtomicInt(&g_event_type);
+    if (type != 0) {
+        return type;
+    }
+
+    // 多个线程同时注册时只保留一个（多注册的编号不再使用）
+    Uint32 registered = SDL_RegisterEvents(1);
+    if (registered == 0) {
+        printf("[ERROR] Failed to register thumbnail event: %s\n", SDL_GetError());
+        return 0;
+    }
+    SDL_CompareAndSwapAtomicInt(&g_event_type, 0, (int)registered);
+    return (Uint32)SDL_GetAtomicInt(&g_event_type);
+}
+
+// 唤醒UI主循环（UI线程上传之前只发送一次）
+static void thumbnail_wake(ThumbnailCache *cache) {
+    if (!SDL_CompareAndSwapAtomicInt(&cache->wake_pending, 0, 1)) {
+        return;
+    }
+
+    Uint32 type = thumbnail_event_type();
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = type;
+    if (type == 0 || !SDL_PushEvent(&event)) {
+        // 事件队列已满，下一张解码完成时重试
+        SDL_SetAtomicInt(&cache->wake_pending, 0);
+    }
+}
+
+// 路径的哈希（FNV-1a）
+static uint32_t thumbnail_hash(const char *path) {
+    uint32_t hash = 2166136261u;
+    for (; *path; path++) {
+        hash ^= (unsigned char)*path;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// 按区域平均把 RGBA 图像缩小到 dw x dh（颜色按 alpha 加权，透明边缘不发黑）
+static void thumbnail_downscale(const Uint8 *src, int sw, int sh, int pitch, Uint8 *dst, int dw, int dh) {
+    for (int dy = 0; dy < dh; dy++) {
+        int y0 = (int)((Sint64)dy * sh / dh);
+        int y1 = (int)((Sint64)(dy + 1) * sh / dh);
+        if (y1 <= y0) {
+            y1 = y0 + 1;
+        }
+
+        for (int dx = 0; dx < dw; dx++) {
+            int x0 = (int)((Sint64)dx * sw / dw);
+            int x1 = (int)((Sint64)(dx + 1) * sw / dw);
+            if (x1 <= x0) {
+                x1 = x0 + 1;
+            }
+
+            Uint64 r = 0, g = 0, b = 0, a = 0;
+            for (int y = y0; y < y1; y++) {
+                const Uint8 *p = src + (size_t)y * pitch + (size_t)x0 * 4;
+                for (int x = x0; x < x1; x++, p += 4) {
+                    r += (Uint64)p[0] * p[3];
+                    g += (Uint64)p[1] * p[3];
+                    b += (Uint64)p[2] * p[3];
+                    a += p[3];
+                }
+            }
+
+            Uint64 area = (Uint64)(x1 - x0) * (Uint64)(y1 - y0);
+            Uint8 *out = dst + ((size_t)dy * dw + dx) * 4;
+            out[0] = a ? (Uint8)(r / a) : 0;
+            out[1] = a ? (Uint8)(g / a) : 0;
+            out[2] = a ? (Uint8)(b / a) : 0;
+            out[3] = (Uint8)(a / area);
+        }
+    }
+}
+
+// 解码图片并缩小到最大边长 size 以内（在解码线程中调用，失败返回NULL）
+static Uint8* thumbnail_decode(const char *path, int size, int *out_w, int *out_h) {
+    SDL_Surface *image = IMG_Load(path);
+    if (!image) {
+        return NULL;
+    }
+
+    SDL_Surface *rgba = SDL_ConvertSurface(image, SDL_PIXELFORMAT_RGBA32);
+    SDL_DestroySurface(image);
+    if (!rgba) {
+        return NULL;
+    }
+
+    int sw = rgba->w;
+    int sh = rgba->h;
+    int dw = sw;
+    int dh = sh;
+    if (sw > size || sh > size) {
+        if (sw >= sh) {
+            dw = size;
+            dh = (int)((Sint64)sh * size / sw);
+        } else {
+            dh = size;
+            dw = (int)((Sint64)sw * size / sh);
+        }
+        if (dw < 1) {
+            dw = 1;
+        }
+        if (dh < 1) {
+            dh = 1;
+        }
+    }
+
+    Uint8 *pixels = NULL;
+    if (dw > 0 && dh > 0) {
+        pixels = (Uint8*)malloc((size_t)dw * dh * 4);
+    }
+    if (pixels && SDL_LockSurface(rgba)) {
+        thumbnail_downscale((const Uint8*)rgba->pixels, sw, sh, rgba->pitch, pixels, dw, dh);
+        SDL_UnlockSurface(rgba);
+        *out_w = dw;
+        *out_h = dh;
+    } else {
+        free(pixels);
+        pixels = NULL;
+    }
+
+    SDL_DestroySurface(rgba);
+    return pixels;
+}
+
+// 用户缓存目录下的打包文件路径（Windows 为 %LOCALAPPDATA%，其他系统为 $XDG_CACHE_HOME 或 ~/.cache）
+static char* thumbnail_store_path(int size) {
+    char dir[1024];
+    dir[0] = '\0';
+#ifdef _WIN32
+    const char *base = getenv("LOCALAPPDATA");
+    if (base && base[0]) {
+        snprintf(dir, sizeof(dir), "%s\\FileScope\\thumbnails\\", base);
+    }
+#else
+    const char *base = getenv("XDG_CACHE_HOME");
+    if (base && base[0]) {
+        snprintf(dir, sizeof(dir), "%s/filescope/thumbnails/", base);
+    } else if ((base = getenv("HOME")) != NULL && base[0]) {
+        snprintf(dir, sizeof(dir), "%s/.cache/filescope/thumbnails/", base);
+    }
+#endif
+    if (dir[0] == '\0') {
+        // 没有缓存目录时放在SDL的应用数据目录中
+        char *pref = SDL_GetPrefPath("FileScope", "FileScope");
+        if (!pref) {
+            return NULL;
+        }
+        snprintf(dir, sizeof(dir), "%sthumbnails/", pref);
+        SDL_free(pref);
+    }
+
+    if (!SDL_CreateDirectory(dir)) {
+        printf("[ERROR] Failed to create thumbnail cache directory %s: %s\n", dir, SDL_GetError());
+        return NULL;
+    }
+
+    // 不同缩略图尺寸使用不同的打包文件
+    char path[1100];
+    snprintf(path, sizeof(path), "%sthumbnails-%d.pack", dir, size);
+    return strdup(path);
+}
+
+// 记录占用的字节数
+static Sint64 thumbnail_record_bytes(size_t path_len, int w, int h) {
+    return (Sint64)sizeof(ThumbnailRecord) + (Sint64)path_len + (Sint64)w * h * 4;
+}
+
+// 在指定偏移读写（失败返回 false）
+static bool thumbnail_store_read_at(SDL_IOStream *io, Sint64 offset, void *data, size_t size) {
+    return SDL_SeekIO(io, offset, SDL_IO_SEEK_SET) == offset && SDL_ReadIO(io, data, size) == size;
+}
+
+static bool thumbnail_store_write_at(SDL_IOStream *io, Sint64 offset, const void *data, size_t size) {
+    return SDL_SeekIO(io, offset, SDL_IO_SEEK_SET) == offset && SDL_WriteIO(io, data, size) == size;
+}
+
+// 查找路径对应的索引项（不存在时返回 THUMBNAIL_NONE）
+static int thumbnail_store_find(ThumbnailStore *store, const char *path, uint32_t hash) {
+    if (store->bucket_count == 0) {
+        return THUMBNAIL_NONE;
+    }
+
+    int index = store->buckets[hash & (store->bucket_count - 1)];
+    while (index != THUMBNAIL_NONE) {
+        ThumbnailDiskEntry *entry = &store->entries[index];
+        if (entry->hash == hash && strcmp(entry->path, path) == 0) {
+            return index;
+        }
+        index = entry->next;
+    }
+    return THUMBNAIL_NONE;
+}
+
+// 按当前索引项重建哈希桶（桶数量不少于索引项数）
+static bool thumbnail_store_rehash(ThumbnailStore *store, int min_buckets) {
+    int bucket_count = store->bucket_count > 0 ? store->bucket_count : 256;
+    while (bucket_count < min_buckets) {
+        bucket_count *= 2;
+    }
+    if (bucket_count != store->bucket_count) {
+        int *buckets = (int*)realloc(store->buckets, sizeof(int) * (size_t)bucket_count);
+        if (!buckets) {
+            return false;
+        }
+        store->buckets = buckets;
+        store->bucket_count = bucket_count;
+    }
+
+    for (int i = 0; i < store->bucket_count; i++) {
+        store->buckets[i] = THUMBNAIL_NONE;
+    }
+    for (int i = 0; i < store->count; i++) {
+        int bucket = (int)(store->entries[i].hash & (store->bucket_count - 1));
+        store->entries[i].next = store->buckets[bucket];
+        store->buckets[bucket] = i;
+    }
+    return true;
+}
+
+// 加入索引项（路径已存在时调用方应更新已有的项），失败返回 THUMBNAIL_NONE
+static int thumbnail_store_add(ThumbnailStore *store, const char *path, uint32_t hash) {
+    if (store->count == store->capacity) {
+        int capacity = store->capacity > 0 ? store->capacity * 2 : 256;
+        ThumbnailDiskEntry *entries = (ThumbnailDiskEntry*)realloc(store->entries,
+                                                                   sizeof(ThumbnailDiskEntry) * (size_t)capacity);
+        if (!entries) {
+            return THUMBNAIL_NONE;
+        }
+        store->entries = entries;
+        store->capacity = capacity;
+    }
+
+    char *path_copy = strdup(path);
+    if (!path_copy) {
+        return THUMBNAIL_NONE;
+    }
+
+    int index = store->count++;
+    ThumbnailDiskEntry *entry = &store->entries[index];
+    memset(entry, 0, sizeof(*entry));
+    entry->path = path_copy;
+    entry->hash = hash;
+
+    if (store->count > store->bucket_count) {
+        if (!thumbnail_store_rehash(store, store->count * 2)) {
+            free(path_copy);
+            store->count--;
+            return THUMBNAIL_NONE;
+        }
+    } else {
+        int bucket = (int)(hash & (store->bucket_count - 1));
+        entry->next = store->buckets[bucket];
+        store->buckets[bucket] = index;
+    }
+    return index;
+}
+
+// 清空索引
+static void thumbnail_store_clear_index(ThumbnailStore *store) {
+    for (int i = 0; i < store->count; i++) {
+        free(store->entries[i].path);
+    }
+    store->count = 0;
+    for (int i = 0; i < store->bucket_count; i++) {
+        store->buckets[i] = THUMBNAIL_NONE;
+    }
+}
+
+// 停用磁盘缓存（读写出错时调用，之后只在内存中缓存）
+static void thumbnail_store_disable(ThumbnailStore *store, const char *reason) {
+    printf("[ERROR] Thumbnail disk cache disabled (%s): %s\n", reason, SDL_GetError());
+    if (store->io) {
+        SDL_CloseIO(store->io);
+        store->io = NULL;
+    }
+    thumbnail_store_clear_index(store);
+}
+
+// 新建空的打包文件
+static SDL_IOStream* thumbnail_store_create(ThumbnailStore *store) {
+    SDL_IOStream *io = SDL_IOFromFile(store->pack_path, "w+b");
+    if (!io) {
+        return NULL;
+    }
+
+    ThumbnailPackHeader header = {THUMBNAIL_PACK_MAGIC, THUMBNAIL_PACK_VERSION, (Uint32)store->size, 0};
+    if (!thumbnail_store_write_at(io, 0, &header, sizeof(header))) {
+        SDL_CloseIO(io);
+        return NULL;
+    }
+    store->pack_bytes = (Sint64)sizeof(header);
+    return io;
+}
+
+// 顺序读取打包文件中的记录头建立索引（遇到损坏的记录时从那里截断）
+static void thumbnail_store_scan(ThumbnailStore *store) {
+    Sint64 offset = (Sint64)sizeof(ThumbnailPackHeader);
+    char path[THUMBNAIL_RECORD_MAX_PATH + 1];
+    ThumbnailRecord record;
+
+    while (thumbnail_store_read_at(store->io, offset, &record, sizeof(record))) {
+        if (record.magic != THUMBNAIL_RECORD_MAGIC || record.path_len == 0 ||
+            record.path_len > THUMBNAIL_RECORD_MAX_PATH ||
+            record.w == 0 || record.h == 0 || record.w > store->size || record.h > store->size ||
+            SDL_ReadIO(store->io, path, record.path_len) != record.path_len) {
+            break;
+        }
+        path[record.path_len] = '\0';
+
+        Sint64 bytes = thumbnail_record_bytes(record.path_len, record.w, record.h);
+        if (!(record.flags & THUMBNAIL_RECORD_DEAD)) {
+            // 同一路径后写入的记录更新
+            uint32_t hash = thumbnail_hash(path);
+            int index = thumbnail_store_find(store, path, hash);
+            if (index == THUMBNAIL_NONE) {
+                index = thumbnail_store_add(store, path, hash);
+            }
+            if (index != THUMBNAIL_NONE) {
+                ThumbnailDiskEntry *entry = &store->entries[index];
+                entry->offset = offset;
+                entry->file_size = record.file_size;
+                entry->modify_time = record.modify_time;
+                entry->last_used = record.last_used;
+                entry->w = record.w;
+                entry->h = record.h;
+            }
+            if (record.last_used > store->clock) {
+                store->clock = record.last_used;
+            }
+        }
+        offset += bytes;
+    }
+
+    // 之后的新记录从最后一条完整记录之后写入
+    store->pack_bytes = offset;
+}
+
+// 打开打包文件并建立索引（第一次访问磁盘缓存时在解码线程中调用，调用方持有锁）
+static void thumbnail_store_open_locked(ThumbnailStore *store) {
+    store->opened = true;
+    if (!store->pack_path) {
+        return;
+    }
+
+    store->io = SDL_IOFromFile(store->pack_path, "r+b");
+    ThumbnailPackHeader header;
+    if (store->io && (!thumbnail_store_read_at(store->io, 0, &header, sizeof(header)) ||
+                      header.magic != THUMBNAIL_PACK_MAGIC || header.version != THUMBNAIL_PACK_VERSION ||
+                      header.size != (Uint32)store->size)) {
+        // 格式不符的旧文件重建
+        SDL_CloseIO(store->io);
+        store->io = NULL;
+    } else if (store->io) {
+        thumbnail_store_scan(store);
+    }
+
+    if (!store->io) {
+        store->io = thumbnail_store_create(store);
+        if (!store->io) {
+            thumbnail_store_disable(store, "open");
+        }
+    }
+}
+
+// 比较两个索引项的最近使用序号（越近越靠前）
+static int SDLCALL thumbnail_store_compare_recent(const void *a, const void *b) {
+    Uint64 ua = ((const ThumbnailDiskEntry*)a)->last_used;
+    Uint64 ub = ((const ThumbnailDiskEntry*)b)->last_used;
+    return (ua < ub) ? 1 : (ua > ub) ? -1 : 0;
+}
+
+// 压缩打包文件：按最近使用顺序保留记录，直到达到上限的四分之三，写入新文件后替换
+static void thumbnail_store_compact_locked(ThumbnailStore *store) {
+    size_t tmp_len = strlen(store->pack_path) + 5;
+    char *tmp_path = (char*)malloc(tmp_len);
+    if (!tmp_path) {
+        return;
+    }
+    snprintf(tmp_path, tmp_len, "%s.tmp", store->pack_path);
+
+    SDL_IOStream *out = SDL_IOFromFile(tmp_path, "w+b");
+    ThumbnailPackHeader header = {THUMBNAIL_PACK_MAGIC, THUMBNAIL_PACK_VERSION, (Uint32)store->size, 0};
+    if (!out || !thumbnail_store_write_at(out, 0, &header, sizeof(header))) {
+        if (out) {
+            SDL_CloseIO(out);
+        }
+        free(tmp_path);
+        thumbnail_store_disable(store, "compact");
+        return;
+    }
+
+    SDL_qsort(store->entries, (size_t)store->count, sizeof(ThumbnailDiskEntry), thumbnail_store_compare_recent);
+
+    Sint64 limit = store->max_bytes / 4 * 3;
+    Sint64 offset = (Sint64)sizeof(header);
+    Uint8 *buffer = NULL;
+    size_t buffer_size = 0;
+    bool ok = true;
+    int kept = 0;
+    int i = 0;
+    for (; i < store->count; i++) {
+        ThumbnailDiskEntry *entry = &store->entries[i];
+        Sint64 bytes = thumbnail_record_bytes(strlen(entry->path), entry->w, entry->h);
+        if (offset + bytes > limit) {
+            free(entry->path);
+            continue;
+        }
+
+        if ((size_t)bytes > buffer_size) {
+            Uint8 *grown = (Uint8*)realloc(buffer, (size_t)bytes);
+            if (!grown) {
+                ok = false;
+                break;
+            }
+            buffer = grown;
+            buffer_size = (size_t)bytes;
+        }
+        if (!thumbnail_store_read_at(store->io, entry->offset, buffer, (size_t)bytes) ||
+            SDL_WriteIO(out, buffer, (size_t)bytes) != (size_t)bytes) {
+            ok = false;
+            break;
+        }
+
+        entry->offset = offset;
+        offset += bytes;
+        store->entries[kept++] = *entry;
+    }
+    // 中途失败时剩余的项不再保留
+    for (; i < store->count; i++) {
+        free(store->entries[i].path);
+    }
+    store->count = kept;
+    free(buffer);
+
+    ok = SDL_CloseIO(out) && ok;
+    if (ok) {
+        // 替换前关闭旧文件（Windows 不能替换打开中的文件）
+        SDL_CloseIO(store->io);
+        store->io = NULL;
+        ok = SDL_RenamePath(tmp_path, store->pack_path);
+        if (ok) {
+            store->io = SDL_IOFromFile(store->pack_path, "r+b");
+            ok = (store->io != NULL);
+        }
+    }
+    if (!ok) {
+        SDL_RemovePath(tmp_path);
+        free(tmp_path);
+        thumbnail_store_disable(store, "compact");
+        return;
+    }
+    free(tmp_path);
+
+    store->pack_bytes = offset;
+    store->compactions++;
+    thumbnail_store_rehash(store, store->count * 2);
+}
+
+// 从磁盘缓存读取缩略图（文件大小或修改时间不一致时视为失效），未命中返回NULL
+static Uint8* thumbnail_store_load(ThumbnailStore *store, const char *path, const SDL_PathInfo *info,
+                                   int *out_w, int *out_h) {
+    SDL_LockMutex(store->mutex);
+    if (!store->opened) {
+        thumbnail_store_open_locked(store);
+    }
+
+    Uint8 *pixels = NULL;
+    int index = store->io ? thumbnail_store_find(store, path, thumbnail_hash(path)) : THUMBNAIL_NONE;
+    if (index != THUMBNAIL_NONE) {
+        ThumbnailDiskEntry *entry = &store->entries[index];
+        if (entry->file_size == info->size && entry->modify_time == info->modify_time) {
+            size_t bytes = (size_t)entry->w * entry->h * 4;
+            Sint64 data_offset = entry->offset + (Sint64)sizeof(ThumbnailRecord) + (Sint64)strlen(entry->path);
+            pixels = (Uint8*)malloc(bytes);
+            if (pixels && !thumbnail_store_read_at(store->io, data_offset, pixels, bytes)) {
+                free(pixels);
+                pixels = NULL;
+            }
+        }
+        if (pixels) {
+            // 更新记录中的最近使用序号，压缩时据此保留
+            entry->last_used = ++store->clock;
+            thumbnail_store_write_at(store->io, entry->offset + (Sint64)offsetof(ThumbnailRecord, last_used),
+                                     &entry->last_used, sizeof(entry->last_used));
+            *out_w = entry->w;
+            *out_h = entry->h;
+            store->hits++;
+        }
+    }
+
+    SDL_UnlockMutex(store->mutex);
+    return pixels;
+}
+
+// 把缩略图追加到磁盘缓存（同一路径的旧记录标记为失效），超出上限时压缩
+static void thumbnail_store_save(ThumbnailStore *store, const char *path, const SDL_PathInfo *info,
+                                 const Uint8 *pixels, int w, int h) {
+    SDL_LockMutex(store->mutex);
+    if (!store->opened) {
+        thumbnail_store_open_locked(store);
+    }
+    if (!store->io) {
+        SDL_UnlockMutex(store->mutex);
+        return;
+    }
+
+    size_t path_len = strlen(path);
+    if (path_len == 0 || path_len > THUMBNAIL_RECORD_MAX_PATH || w > store->size || h > store->size) {
+        SDL_UnlockMutex(store->mutex);
+        return;
+    }
+
+    ThumbnailRecord record;
+    memset(&record, 0, sizeof(record));
+    record.magic = THUMBNAIL_RECORD_MAGIC;
+    record.path_len = (Uint32)path_len;
+    record.file_size = info->size;
+    record.modify_time = info->modify_time;
+    record.last_used = ++store->clock;
+    record.w = (Uint16)w;
+    record.h = (Uint16)h;
+
+    Sint64 offset = store->pack_bytes;
+    size_t pixel_bytes = (size_t)w * h * 4;
+    if (!thumbnail_store_write_at(store->io, offset, &record, sizeof(record)) ||
+        SDL_WriteIO(store->io, path, path_len) != path_len ||
+        SDL_WriteIO(store->io, pixels, pixel_bytes) != pixel_bytes) {
+        thumbnail_store_disable(store, "write");
+        SDL_UnlockMutex(store->mutex);
+        return;
+    }
+    store->pack_bytes = offset + thumbnail_record_bytes(path_len, w, h);
+    store->writes++;
+
+    uint32_t hash = thumbnail_hash(path);
+    int index = thumbnail_store_find(store, path, hash);
+    if (index != THUMBNAIL_NONE) {
+        // 文件已变化，旧记录失效
+        Uint32 dead = THUMBNAIL_RECORD_DEAD;
+        thumbnail_store_write_at(store->io, store->entries[index].offset + (Sint64)offsetof(ThumbnailRecord, flags),
+                                 &dead, sizeof(dead));
+    } else {
+        index = thumbnail_store_add(store, path, hash);
+    }
+    if (index != THUMBNAIL_NONE) {
+        ThumbnailDiskEntry *entry = &store->entries[index];
+        entry->offset = offset;
+        entry->file_size = record.file_size;
+        entry->modify_time = record.modify_time;
+        entry->last_used = record.last_used;
+        entry->w = w;
+        entry->h = h;
+    }
+
+    if (store->pack_bytes > store->max_bytes) {
+        thumbnail_store_compact_locked(store);
+    }
+    SDL_UnlockMutex(store->mutex);
+}
+
+// 解码线程入口：每次取优先级最高的排队项
+static int SDLCALL thumbnail_worker(void *data) {
+    ThumbnailCache *cache = (ThumbnailCache*)data;
+
+    SDL_LockMutex(cache->mutex);
+    for (;;) {
+        while (!cache->shutdown && cache->queued == 0) {
+            SDL_WaitCondition(cache->work_ready, cache->mutex);
+        }
+        if (cache->shutdown) {
+            break;
+        }
+
+        ThumbnailEntry *best = NULL;
+        for (int i = 0; i < cache->entry_count; i++) {
+            ThumbnailEntry *entry = &cache->entries[i];
+            if (entry->state == THUMBNAIL_QUEUED && (!best || entry->priority < best->priority)) {
+                best = entry;
+            }
+        }
+        if (!best) {
+            // 计数与状态不一致时不应发生，避免空转
+            cache->queued = 0;
+            continue;
+        }
+
+        best->state = THUMBNAIL_DECODING;
+        cache->queued--;
+        const char *path = best->path;
+        SDL_UnlockMutex(cache->mutex);
+
+        // 先查磁盘缓存（按路径、文件大小和修改时间匹配），未命中时解码并写回
+        int w = 0;
+        int h = 0;
+        SDL_PathInfo info;
+        bool have_info = SDL_GetPathInfo(path, &info);
+        Uint8 *pixels = have_info ? thumbnail_store_load(&cache->store, path, &info, &w, &h) : NULL;
+        if (!pixels) {
+            Uint64 decode_start = profiler_begin();
+            pixels = thumbnail_decode(path, cache->size, &w, &h);
+            profiler_end(PROFILE_THUMBNAIL_DECODE, decode_start);
+            if (pixels && have_info) {
+                thumbnail_store_save(&cache->store, path, &info, pixels, w, h);
+            }
+        }
+
+        SDL_LockMutex(cache->mutex);
+        if (pixels) {
+            best->pixels = pixels;
+            best->w = w;
+            best->h = h;
+            best->state = THUMBNAIL_READY;
+            cache->ready++;
+            cache->stats.decoded++;
+        } else {
+            best->state = THUMBNAIL_FAILED;
+            cache->stats.failed++;
+        }
+        SDL_UnlockMutex(cache->mutex);
+
+        if (pixels) {
+            thumbnail_wake(cache);
+        }
+        SDL_LockMutex(cache->mutex);
+    }
+    SDL_UnlockMutex(cache->mutex);
+    return 0;
+}
+
+// 纹理管理器回调（定义在缓存项管理之后）
+static Uint64 thumbnail_cache_oldest(void *owner);
+static void thumbnail_cache_evict(void *owner);
+
+// 创建缩略图缓存并启动解码线程
+ThumbnailCache* thumbnail_cache_new(SDL_Renderer *renderer, TextureManager *textures,
+                                    int size, int capacity, size_t disk_budget) {
+    if (!renderer) {
+        return NULL;
+    }
+
+    ThumbnailCache *cache = (ThumbnailCache*)calloc(1, sizeof(ThumbnailCache));
+    if (!cache) {
+        return NULL;
+    }
+
+    cache->renderer = renderer;
+    cache->textures = textures;
+    cache->size = size > 0 ? size : THUMBNAIL_DEFAULT_SIZE;
+    cache->capacity = capacity > 0 ? capacity : THUMBNAIL_DEFAULT_CAPACITY;
+    cache->free_list = THUMBNAIL_NONE;
+    cache->bucket_count = 16;
+    while (cache->bucket_count < cache->capacity * 2) {
+        cache->bucket_count *= 2;
+    }
+
+    cache->entries = (ThumbnailEntry*)calloc((size_t)cache->capacity, sizeof(ThumbnailEntry));
+    cache->buckets = (int*)malloc(sizeof(int) * (size_t)cache->bucket_count);
+    cache->mutex = SDL_CreateMutex();
+    cache->work_ready = SDL_CreateCondition();
+    if (!cache->entries || !cache->buckets || !cache->mutex || !cache->work_ready) {
+        thumbnail_cache_free(cache);
+        return NULL;
+    }
+    for (int i = 0; i < cache->bucket_count; i++) {
+        cache->buckets[i] = THUMBNAIL_NONE;
+    }
+
+    // 磁盘缓存在第一次解码时打开，找不到缓存目录时只在内存中缓存
+    cache->store.size = cache->size;
+    cache->store.max_bytes = (Sint64)(disk_budget > 0 ? disk_budget : THUMBNAIL_DISK_DEFAULT_BUDGET);
+    cache->store.mutex = SDL_CreateMutex();
+    if (!cache->store.mutex) {
+        thumbnail_cache_free(cache);
+        return NULL;
+    }
+    cache->store.pack_path = thumbnail_store_path(cache->size);
+
+    // 解码以IO和解压为主，使用一半核心，留给UI线程和目录加载
+    // 不使用共享线程池：线程池按批次执行且调用线程要等待整批完成，UI线程不能等待解码；
+    // 解码线程每次按视口距离重新挑选请求，常驻的解码批次也会让排序退化为单线程执行
+    int workers = SDL_GetNumLogicalCPUCores() / 2;
+    if (workers < 1) {
+        workers = 1;
+    }
+    if (workers > THUMBNAIL_MAX_WORKERS) {
+        workers = THUMBNAIL_MAX_WORKERS;
+    }
+    cache->threads = (SDL_Thread**)calloc((size_t)workers, sizeof(SDL_Thread*));
+    if (!cache->threads) {
+        thumbnail_cache_free(cache);
+        return NULL;
+    }
+
+    // 线程创建失败时用已创建的线程继续工作
+    for (int i = 0; i < workers; i++) {
+        cache->threads[i] = SDL_CreateThread(thumbnail_worker, "thumbnail", cache);
+        if (!cache->threads[i]) {
+            printf("[ERROR] Failed to create thumbnail worker: %s\n", SDL_GetError());
+            break;
+        }
+        cache->worker_count++;
+    }
+    if (cache->worker_count == 0) {
+        thumbnail_cache_free(cache);
+        return NULL;
+    }
+
+    texture_manager_register(textures, TEXTURE_CATEGORY_THUMBNAILS, cache,
+                             thumbnail_cache_oldest, thumbnail_cache_evict);
+    return cache;
+}
+
+// 停止解码线程并释放全部缩略图
+void thumbnail_cache_free(ThumbnailCache *cache) {
+    if (!cache) {
+        return;
+    }
+
+    texture_manager_unregister(cache->textures, cache);
+    if (cache->mutex) {
+        SDL_LockMutex(cache->mutex);
+        cache->shutdown = true;
+        if (cache->work_ready) {
+            SDL_BroadcastCondition(cache->work_ready);
+        }
+        SDL_UnlockMutex(cache->mutex);
+    }
+    for (int i = 0; i < cache->worker_count; i++) {
+        SDL_WaitThread(cache->threads[i], NULL);
+    }
+    free(cache->threads);
+
+    if (cache->entries) {
+        for (int i = 0; i < cache->entry_count; i++) {
+            ThumbnailEntry *entry = &cache->entries[i];
+            free(entry->path);
+            free(entry->pixels);
+            if (entry->texture) {
+                SDL_DestroyTexture(entry->texture);
+                texture_manager_untrack(cache->textures, TEXTURE_CATEGORY_THUMBNAILS,
+                                        (size_t)entry->w * (size_t)entry->h * 4);
+            }
+        }
+    }
+    free(cache->entries);
+    free(cache->buckets);
+
+    // 关闭磁盘缓存
+    ThumbnailStore *store = &cache->store;
+    if (store->io) {
+        SDL_CloseIO(store->io);
+    }
+    thumbnail_store_clear_index(store);
+    free(store->entries);
+    free(store->buckets);
+    free(store->pack_path);
+    if (store->mutex) {
+        SDL_DestroyMutex(store->mutex);
+    }
+
+    if (cache->work_ready) {
+        SDL_DestroyCondition(cache->work_ready);
+    }
+    if (cache->mutex) {
+        SDL_DestroyMutex(cache->mutex);
+    }
+    free(cache);
+}
+
+// 查找路径对应的缓存项（只在UI线程调用，不存在时返回 THUMBNAIL_NONE）
+static int thumbnail_find(ThumbnailCache *cache, const char *path, uint32_t hash) {
+    int index = cache->buckets[hash & (cache->bucket_count - 1)];
+    while (index != THUMBNAIL_NONE) {
+        ThumbnailEntry *entry = &cache->entries[index];
+        if (entry->hash == hash && strcmp(entry->path, path) == 0) {
+            return index;
+        }
+        index = entry->bucket_next;
+    }
+    return THUMBNAIL_NONE;
+}
+
+// 移除缓存项（调用方持有互斥锁，缓存项不能处于解码中）
+static void thumbnail_remove_locked(ThumbnailCache *cache, int index) {
+    ThumbnailEntry *entry = &cache->entries[index];
+
+    int *link = &cache->buckets[entry->hash & (cache->bucket_count - 1)];
+    while (*link != index) {
+        link = &cache->entries[*link].bucket_next;
+    }
+    *link = entry->bucket_next;
+
+    if (entry->state == THUMBNAIL_QUEUED) {
+        cache->queued--;
+    } else if (entry->state == THUMBNAIL_READY) {
+        cache->ready--;
+    }
+    if (entry->texture) {
+        SDL_DestroyTexture(entry->texture);
+        texture_manager_untrack(cache->textures, TEXTURE_CATEGORY_THUMBNAILS,
+                                (size_t)entry->w * (size_t)entry->h * 4);
+    }
+    free(entry->pixels);
+    free(entry->path);
+    memset(entry, 0, sizeof(*entry));
+    entry->state = THUMBNAIL_EMPTY;
+    entry->bucket_next = cache->free_list;
+    cache->free_list = index;
+}
+
+// 取得一个空闲槽位，容量已满时淘汰最久未请求的项（调用方持有互斥锁）
+static int thumbnail_alloc_locked(ThumbnailCache *cache) {
+    if (cache->free_list != THUMBNAIL_NONE) {
+        int index = cache->free_list;
+        cache->free_list = cache->entries[index].bucket_next;
+        return index;
+    }
+    if (cache->entry_count < cache->capacity) {
+        return cache->entry_count++;
+    }
+
+    // 本轮已请求的项和正在解码的项不淘汰
+    int victim = THUMBNAIL_NONE;
+    for (int i = 0; i < cache->entry_count; i++) {
+        ThumbnailEntry *entry = &cache->entries[i];
+        if (entry->state == THUMBNAIL_EMPTY || entry->state == THUMBNAIL_DECODING ||
+            entry->generation == cache->generation) {
+            continue;
+        }
+        if (victim == THUMBNAIL_NONE || entry->generation < cache->entries[victim].generation) {
+            victim = i;
+        }
+    }
+    if (victim == THUMBNAIL_NONE) {
+        return THUMBNAIL_NONE;
+    }
+
+    thumbnail_remove_locked(cache, victim);
+    cache->stats.evictions++;
+    cache->free_list = cache->entries[victim].bucket_next;
+    return victim;
+}
+
+// 最久未绘制的纹理所在的项（本轮已请求的项仍在视口附近，不淘汰）
+static int thumbnail_oldest_texture(ThumbnailCache *cache) {
+    int oldest = THUMBNAIL_NONE;
+    for (int i = 0; i < cache->entry_count; i++) {
+        ThumbnailEntry *entry = &cache->entries[i];
+        if (!entry->texture || entry->generation == cache->generation) {
+            continue;
+        }
+        if (oldest == THUMBNAIL_NONE || entry->last_used < cache->entries[oldest].last_used) {
+            oldest = i;
+        }
+    }
+    return oldest;
+}
+
+// 最久未绘制的缩略图纹理的帧号（纹理管理器回调）
+static Uint64 thumbnail_cache_oldest(void *owner) {
+    ThumbnailCache *cache = (ThumbnailCache*)owner;
+    int index = thumbnail_oldest_texture(cache);
+    return index == THUMBNAIL_NONE ? UINT64_MAX : cache->entries[index].last_used;
+}
+
+// 淘汰最久未绘制的缩略图（纹理管理器回调），再次请求时从磁盘缓存读取
+static void thumbnail_cache_evict(void *owner) {
+    ThumbnailCache *cache = (ThumbnailCache*)owner;
+    int index = thumbnail_oldest_texture(cache);
+    if (index == THUMBNAIL_NONE) {
+        return;
+    }
+
+    SDL_LockMutex(cache->mutex);
+    thumbnail_remove_locked(cache, index);
+    cache->stats.evictions++;
+    SDL_UnlockMutex(cache->mutex);
+}
+
+// 开始一轮请求
+void thumbnail_cache_begin_requests(ThumbnailCache *cache) {
+    if (!cache) {
+        return;
+    }
+    cache->generation++;
+}
+
+// 请求一张缩略图
+void thumbnail_cache_request(ThumbnailCache *cache, const char *path, int priority) {
+    if (!cache || !path) {
+        return;
+    }
+
+    uint32_t hash = thumbnail_hash(path);
+    int index = thumbnail_find(cache, path, hash);
+
+    SDL_LockMutex(cache->mutex);
+    if (index != THUMBNAIL_NONE) {
+        // 已有的项只更新轮次和优先级
+        ThumbnailEntry *entry = &cache->entries[index];
+        entry->generation = cache->generation;
+        entry->priority = priority;
+        SDL_UnlockMutex(cache->mutex);
+        return;
+    }
+
+    char *path_copy = strdup(path);
+    index = path_copy ? thumbnail_alloc_locked(cache) : THUMBNAIL_NONE;
+    if (index == THUMBNAIL_NONE) {
+        SDL_UnlockMutex(cache->mutex);
+        free(path_copy);
+        return;
+    }
+
+    ThumbnailEntry *entry = &cache->entries[index];
+    entry->path = path_copy;
+    entry->hash = hash;
+    entry->generation = cache->generation;
+    entry->priority = priority;
+    entry->state = THUMBNAIL_QUEUED;
+    int bucket = (int)(hash & (cache->bucket_count - 1));
+    entry->bucket_next = cache->buckets[bucket];
+    cache->buckets[bucket] = index;
+
+    cache->queued++;
+    cache->stats.requests++;
+    SDL_SignalCondition(cache->work_ready);
+    SDL_UnlockMutex(cache->mutex);
+}
+
+// 结束一轮请求：取消本轮没有再次请求的排队项
+void thumbnail_cache_end_requests(ThumbnailCache *cache) {
+    if (!cache) {
+        return;
+    }
+
+    SDL_LockMutex(cache->mutex);
+    for (int i = 0; i < cache->entry_count; i++) {
+        ThumbnailEntry *entry = &cache->entries[i];
+        if (entry->state == THUMBNAIL_QUEUED && entry->generation != cache->generation) {
+            thumbnail_remove_locked(cache, i);
+            cache->stats.cancelled++;
+        }
+    }
+    SDL_UnlockMutex(cache->mutex);
+}
+
+// 把后台解码完成的缩略图上传为纹理
+int thumbnail_cache_upload(ThumbnailCache *cache, int max_count) {
+    if (!cache) {
+        return 0;
+    }
+
+    int uploaded = 0;
+    SDL_LockMutex(cache->mutex);
+    // 先清除唤醒标记，之后完成的解码会再次唤醒
+    SDL_SetAtomicInt(&cache->wake_pending, 0);
+    while (uploaded < max_count && cache->ready > 0) {
+        ThumbnailEntry *best = NULL;
+        for (int i = 0; i < cache->entry_count; i++) {
+            ThumbnailEntry *entry = &cache->entries[i];
+            if (entry->state == THUMBNAIL_READY && (!best || entry->priority < best->priority)) {
+                best = entry;
+            }
+        }
+        if (!best) {
+            break;
+        }
+
+        // 取出解码结果后释放锁再上传（缓存项只会被UI线程移除）
+        Uint8 *pixels = best->pixels;
+        best->pixels = NULL;
+        best->state = THUMBNAIL_DONE;
+        cache->ready--;
+        SDL_UnlockMutex(cache->mutex);
+
+        SDL_Texture *texture = SDL_CreateTexture(cache->renderer, SDL_PIXELFORMAT_RGBA32,
+                                                 SDL_TEXTUREACCESS_STATIC, best->w, best->h);
+        if (texture && !SDL_UpdateTexture(texture, NULL, pixels, best->w * 4)) {
+            SDL_DestroyTexture(texture);
+            texture = NULL;
+        }
+        if (texture) {
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        } else {
+            printf("[ERROR] Failed to upload thumbnail %s: %s\n", best->path, SDL_GetError());
+        }
+        free(pixels);
+        best->texture = texture;
+        if (texture) {
+            best->last_used = texture_manager_frame(cache->textures);
+            texture_manager_track(cache->textures, TEXTURE_CATEGORY_THUMBNAILS,
+                                  (size_t)best->w * (size_t)best->h * 4);
+        }
+
+        SDL_LockMutex(cache->mutex);
+        if (texture) {
+            cache->stats.uploads++;
+            uploaded++;
+        } else {
+            best->state = THUMBNAIL_FAILED;
+            cache->stats.failed++;
+        }
+    }
+    SDL_UnlockMutex(cache->mutex);
+    return uploaded;
+}
+
+// 是否有已解码但尚未上传的缩略图
+bool thumbnail_cache_has_pending_uploads(ThumbnailCache *cache) {
+    if (!cache) {
+        return false;
+    }
+
+    SDL_LockMutex(cache->mutex);
+    bool pending = cache->ready > 0;
+    SDL_UnlockMutex(cache->mutex);
+    return pending;
+}
+
+// 获取已上传的缩略图（纹理、路径和哈希链只由UI线程修改，不需要加锁）
+SDL_Texture* thumbnail_cache_get(ThumbnailCache *cache, const char *path, int *w, int *h) {
+    if (!cache || !path) {
+        return NULL;
+    }
+
+    int index = thumbnail_find(cache, path, thumbnail_hash(path));
+    if (index == THUMBNAIL_NONE || !cache->entries[index].texture) {
+        return NULL;
+    }
+
+    ThumbnailEntry *entry = &cache->entries[index];
+    entry->last_used = texture_manager_frame(cache->textures);
+    if (w) {
+        *w = entry->w;
+    }
+    if (h) {
+        *h = entry->h;
+    }
+    return entry->texture;
+}
+
+// 读取缓存统计
+void thumbnail_cache_get_stats(ThumbnailCache *cache, ThumbnailStats *stats) {
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    if (!cache) {
+        return;
+    }
+
+    SDL_LockMutex(cache->mutex);
+    *stats = cache->stats;
+    stats->queued = cache->queued;
+    stats->ready = cache->ready;
+    for (int i = 0; i < cache->entry_count; i++) {
+        const ThumbnailEntry *entry = &cache->entries[i];
+        if (entry->state != THUMBNAIL_EMPTY) {
+            stats->entries++;
+        }
+        if (entry->texture) {
+            stats->bytes += (size_t)entry->w * entry->h * 4;
+        }
+    }
+    SDL_UnlockMutex(cache->mutex);
+
+    SDL_LockMutex(cache->store.mutex);
+    stats->disk_hits = cache->store.hits;
+    stats->disk_writes = cache->store.writes;
+    stats->disk_compactions = cache->store.compactions;
+    stats->disk_bytes = cache->store.io ? (size_t)cache->store.pack_bytes : 0;
+    SDL_UnlockMutex(cache->store.mutex);
+}
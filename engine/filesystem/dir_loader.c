@@ -0,0 +1,316 @@
+/*
+ * 后台目录加载模块
+ * 职责：
+ * 1. 在独立线程中扫描目录，避免阻塞UI主循环
+ * 2. 按批次把目录项交给UI线程（单生产者单消费者无锁队列）
+ * 3. 第一批尽量小，保证首屏在一帧内显示
+ * 4. 支持在导航离开时取消加载
+ * 5. 有新数据时发送唤醒事件，UI主循环空闲时不需要轮询
+ */
+
+#include "dir_loader.h"
+#include "profiler.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 队列槽位数量（必须是2的幂）
+#define DIR_LOADER_QUEUE_SIZE 64
+// 第一批目录项数量（足够填满一屏）
+#define DIR_LOADER_FIRST_BATCH 64
+// 后续每批目录项数量
+#define DIR_LOADER_BATCH_SIZE 2048
+// 批次最长积攒时间（毫秒），慢速文件系统上也能逐步显示
+#define DIR_LOADER_BATCH_MAX_MS 16
+
+// 加载状态
+enum {
+    DIR_LOADER_RUNNING,
+    DIR_LOADER_DONE,
+    DIR_LOADER_FAILED
+};
+
+struct DirLoader {
+    char *path;                                  // 目录路径
+    SDL_AtomicInt state;                         // 加载状态
+    SDL_AtomicInt cancelled;                     // 是否已取消
+    SDL_AtomicInt refcount;                      // 引用计数（UI线程 + 后台线程）
+    SDL_AtomicInt head;                          // 消费位置（UI线程写）
+    SDL_AtomicInt tail;                          // 生产位置（后台线程写）
+    SDL_AtomicInt wake_pending;                  // 已发送唤醒事件且UI线程尚未取数据
+    DirLoadBatch *slots[DIR_LOADER_QUEUE_SIZE];  // 队列槽位
+
+    // 以下字段只由后台线程访问
+    DirLoadBatch *current;                       // 正在填充的批次
+    int batch_limit;                             // 当前批次上限
+    Uint64 batch_start;                          // 当前批次开始时间
+};
+
+// 唤醒事件类型（0表示尚未注册）
+static SDL_AtomicInt g_event_type;
+
+// 唤醒事件类型（首次调用时注册，失败返回0）
+Uint32 dir_loader_event_type(void) {
+    Uint32 type = (Uint32)SDL_GetAtomicInt(&g_event_type);
+    if (type != 0) {
+        return type;
+    }
+
+    // 多个线程同时注册时只保留一个（多注册的编号不再使用）
+    Uint32 registered = SDL_RegisterEvents(1);
+    if (registered == 0) {
+        printf("[ERROR] Failed to register directory loader event: %s\n", SDL_GetError());
+        return 0;
+    }
+    SDL_CompareAndSwapAtomicInt(&g_event_type, 0, (int)registered);
+    return (Uint32)SDL_GetAtomicInt(&g_event_type);
+}
+
+// 唤醒UI主循环（UI线程取数据之前只发送一次）
+static void dir_loader_wake(DirLoader *loader) {
+    if (!SDL_CompareAndSwapAtomicInt(&loader->wake_pending, 0, 1)) {
+        return;
+    }
+
+    Uint32 type = dir_loader_event_type();
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = type;
+    if (type == 0 || !SDL_PushEvent(&event)) {
+        // 事件队列已满，下一次发布时重试
+        SDL_SetAtomicInt(&loader->wake_pending, 0);
+    }
+}
+
+// 创建批次
+static DirLoadBatch* batch_new(int capacity) {
+    DirLoadBatch *batch = (DirLoadBatch*)calloc(1, sizeof(DirLoadBatch));
+    if (!batch) {
+        return NULL;
+    }
+
+    batch->capacity = capacity;
+    batch->entries = (DirScanEntry*)malloc(sizeof(DirScanEntry) * capacity);
+    batch->names_capacity = (size_t)capacity * 32;
+    batch->names = (char*)malloc(batch->names_capacity);
+    if (!batch->entries || !batch->names) {
+        dir_loader_batch_free(batch);
+        return NULL;
+    }
+
+    return batch;
+}
+
+// 释放批次
+void dir_loader_batch_free(DirLoadBatch *batch) {
+    if (!batch) {
+        return;
+    }
+
+    free(batch->entries);
+    free(batch->names);
+    free(batch);
+}
+
+// 向批次追加目录项（复制名称）
+static bool batch_append(DirLoadBatch *batch, const DirScanEntry *entry) {
+    size_t needed = entry->name_len + 1;
+    if (batch->names_used + needed > batch->names_capacity) {
+        size_t new_capacity = batch->names_capacity * 2 + needed;
+
+        // 扩容前记录偏移，扩容后重新指向新缓冲区
+        for (int i = 0; i < batch->count; i++) {
+            batch->entries[i].name = (const char*)(uintptr_t)(batch->entries[i].name - batch->names);
+        }
+        char *names = (char*)realloc(batch->names, new_capacity);
+        if (names) {
+            batch->names = names;
+            batch->names_capacity = new_capacity;
+        }
+        for (int i = 0; i < batch->count; i++) {
+            batch->entries[i].name = batch->names + (uintptr_t)batch->entries[i].name;
+        }
+        if (!names) {
+            return false;
+        }
+    }
+
+    char *name = batch->names + batch->names_used;
+    memcpy(name, entry->name, needed);
+    batch->names_used += needed;
+
+    DirScanEntry *dst = &batch->entries[batch->count++];
+    *dst = *entry;
+    dst->name = name;
+    return true;
+}
+
+// 释放一个引用，最后一个引用负责回收
+static void dir_loader_release(DirLoader *loader) {
+    if (SDL_AddAtomicInt(&loader->refcount, -1) != 1) {
+        return;
+    }
+
+    DirLoadBatch *batch;
+    while ((batch = dir_loader_pop(loader)) != NULL) {
+        dir_loader_batch_free(batch);
+    }
+    dir_loader_batch_free(loader->current);
+    free(loader->path);
+    free(loader);
+}
+
+// 发布当前批次到队列（队列满时等待UI线程消费）
+static bool dir_loader_publish(DirLoader *loader) {
+    DirLoadBatch *batch = loader->current;
+    loader->current = NULL;
+    if (!batch || batch->count == 0) {
+        dir_loader_batch_free(batch);
+        return true;
+    }
+
+    int tail = SDL_GetAtomicInt(&loader->tail);
+    while (tail - SDL_GetAtomicInt(&loader->head) >= DIR_LOADER_QUEUE_SIZE) {
+        if (SDL_GetAtomicInt(&loader->cancelled)) {
+            dir_loader_batch_free(batch);
+            return false;
+        }
+        SDL_Delay(1);
+    }
+
+    loader->slots[tail & (DIR_LOADER_QUEUE_SIZE - 1)] = batch;
+    SDL_SetAtomicInt(&loader->tail, tail + 1);
+    dir_loader_wake(loader);
+    return true;
+}
+
+// 扫描回调：积攒目录项，达到上限或超时后发布
+static bool dir_loader_scan_callback(const DirScanEntry *entry, void *user_data) {
+    DirLoader *loader = (DirLoader*)user_data;
+    if (SDL_GetAtomicInt(&loader->cancelled)) {
+        return false;
+    }
+
+    if (!loader->current) {
+        loader->current = batch_new(loader->batch_limit);
+        loader->batch_start = SDL_GetTicks();
+        if (!loader->current) {
+            return false;
+        }
+    }
+
+    if (!batch_append(loader->current, entry)) {
+        return false;
+    }
+
+    if (loader->current->count >= loader->batch_limit ||
+        SDL_GetTicks() - loader->batch_start >= DIR_LOADER_BATCH_MAX_MS) {
+        if (!dir_loader_publish(loader)) {
+            return false;
+        }
+        loader->batch_limit = DIR_LOADER_BATCH_SIZE;
+    }
+
+    return true;
+}
+
+// 后台线程入口
+static int SDLCALL dir_loader_thread(void *data) {
+    DirLoader *loader = (DirLoader*)data;
+
+    loader->batch_limit = DIR_LOADER_FIRST_BATCH;
+    Uint64 scan_start = profiler_begin();
+    bool success = dir_scan(loader->path, DIR_SCAN_STAT, dir_loader_scan_callback, loader);
+    profiler_end(PROFILE_DIR_SCAN, scan_start);
+    if (!SDL_GetAtomicInt(&loader->cancelled)) {
+        success = dir_loader_publish(loader) && success;
+    }
+
+    SDL_SetAtomicInt(&loader->state, success ? DIR_LOADER_DONE : DIR_LOADER_FAILED);
+    if (!SDL_GetAtomicInt(&loader->cancelled)) {
+        // 扫描结束也要唤醒（最后一批已发布但唤醒事件已被取走时）
+        SDL_SetAtomicInt(&loader->wake_pending, 0);
+        dir_loader_wake(loader);
+    }
+    dir_loader_release(loader);
+    return 0;
+}
+
+// 在后台线程开始扫描目录
+DirLoader* dir_loader_start(const char *dir_path) {
+    if (!dir_path) {
+        return NULL;
+    }
+
+    DirLoader *loader = (DirLoader*)calloc(1, sizeof(DirLoader));
+    if (!loader) {
+        return NULL;
+    }
+
+    loader->path = strdup(dir_path);
+    if (!loader->path) {
+        free(loader);
+        return NULL;
+    }
+
+    SDL_SetAtomicInt(&loader->state, DIR_LOADER_RUNNING);
+    SDL_SetAtomicInt(&loader->refcount, 2);
+
+    SDL_Thread *thread = SDL_CreateThread(dir_loader_thread, "dir_loader", loader);
+    if (!thread) {
+        printf("[ERROR] Failed to create directory loader thread: %s\n", SDL_GetError());
+        free(loader->path);
+        free(loader);
+        return NULL;
+    }
+
+    // 线程自行回收，取消时不需要等待慢速文件系统返回
+    SDL_DetachThread(thread);
+    return loader;
+}
+
+// 取出下一批目录项
+DirLoadBatch* dir_loader_pop(DirLoader *loader) {
+    if (!loader) {
+        return NULL;
+    }
+
+    // 先清除唤醒标记再读取生产位置，之后发布的批次会再次唤醒
+    SDL_SetAtomicInt(&loader->wake_pending, 0);
+
+    int head = SDL_GetAtomicInt(&loader->head);
+    if (head == SDL_GetAtomicInt(&loader->tail)) {
+        return NULL;
+    }
+
+    DirLoadBatch *batch = loader->slots[head & (DIR_LOADER_QUEUE_SIZE - 1)];
+    SDL_SetAtomicInt(&loader->head, head + 1);
+    return batch;
+}
+
+// 扫描是否已结束且队列已取空
+bool dir_loader_is_done(DirLoader *loader, bool *success) {
+    if (!loader) {
+        return true;
+    }
+
+    int state = SDL_GetAtomicInt(&loader->state);
+    if (state == DIR_LOADER_RUNNING ||
+        SDL_GetAtomicInt(&loader->head) != SDL_GetAtomicInt(&loader->tail)) {
+        return false;
+    }
+
+    if (success) {
+        *success = (state == DIR_LOADER_DONE);
+    }
+    return true;
+}
+
+// 取消扫描并释放UI线程持有的引用
+void dir_loader_cancel(DirLoader *loader) {
+    if (!loader) {
+        return;
+    }
+
+    SDL_SetAtomicInt(&loader->cancelled, 1);
+    dir_loader_release(loader);
+}
@@ -0,0 +1,233 @@
+/*
+ * 目录枚举模块
+ * 职责：
+ * 1. 批量读取目录项（Linux 下直接使用 getdents64）
+ * 2. 优先使用 d_type 判断类型，尽量避免 stat
+ * 3. 需要元数据时使用 fstatat 相对已打开的目录 fd
+ * 4. 每个目录只打开一次、遍历一次
+ */
+
+#include "dir_scanner.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/syscall.h>
+#else
+#include <dirent.h>
+#endif
+
+// getdents64 每批读取的缓冲区大小
+#define DIR_SCAN_BUFFER_SIZE (64 * 1024)
+
+// 跳过 . 和 ..
+static bool is_dot_entry(const char *name) {
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+// 用 stat 结果填充目录项
+static void fill_entry_from_stat(DirScanEntry *entry, const struct stat *st) {
+    entry->type = get_file_type(st);
+    entry->size = (size_t)st->st_size;
+    entry->modified_time = st->st_mtime;
+    entry->created_time = st->st_ctime;
+    entry->accessed_time = st->st_atime;
+    if (entry->inode == 0) {
+        entry->inode = (uint64_t)st->st_ino;
+    }
+    entry->has_stat = true;
+}
+
+#if defined(__linux__)
+
+// 内核返回的目录项布局
+struct linux_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+// d_type 转换为文件类型，无法判断时返回 FILE_TYPE_UNKNOWN
+static FileType file_type_from_dtype(unsigned char d_type) {
+    switch (d_type) {
+        case DT_REG:  return FILE_TYPE_REGULAR;
+        case DT_DIR:  return FILE_TYPE_DIRECTORY;
+        case DT_LNK:  return FILE_TYPE_SYMLINK;
+        case DT_CHR:
+        case DT_BLK:  return FILE_TYPE_DEVICE;
+        case DT_FIFO: return FILE_TYPE_PIPE;
+        case DT_SOCK: return FILE_TYPE_SOCKET;
+        default:      return FILE_TYPE_UNKNOWN;
+    }
+}
+
+bool dir_scan(const char *dir_path, int flags, DirScanCallback callback, void *user_data) {
+    if (!dir_path || !callback) {
+        return false;
+    }
+
+    int dir_fd = open(dir_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0) {
+        return false;
+    }
+
+    char *buffer = (char*)malloc(DIR_SCAN_BUFFER_SIZE);
+    if (!buffer) {
+        close(dir_fd);
+        return false;
+    }
+
+    bool need_stat = (flags & DIR_SCAN_STAT) != 0;
+    bool no_follow = (flags & DIR_SCAN_NO_FOLLOW) != 0;
+    bool success = true;
+    bool stop = false;
+
+    while (!stop) {
+        long bytes = syscall(SYS_getdents64, dir_fd, buffer, DIR_SCAN_BUFFER_SIZE);
+        if (bytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            success = false;
+            break;
+        }
+        if (bytes == 0) {
+            break;
+        }
+
+        for (long offset = 0; offset < bytes && !stop; ) {
+            struct linux_dirent64 *d = (struct linux_dirent64*)(buffer + offset);
+            offset += d->d_reclen;
+
+            if (is_dot_entry(d->d_name)) {
+                continue;
+            }
+
+            DirScanEntry entry;
+            memset(&entry, 0, sizeof(entry));
+            entry.name = d->d_name;
+            entry.name_len = strlen(d->d_name);
+            entry.inode = d->d_ino;
+            entry.type = file_type_from_dtype(d->d_type);
+            entry.is_hidden = (d->d_name[0] == '.');
+
+            // 仅在需要元数据、类型未知或需要解析符号链接时才 stat
+            bool resolve_link = (entry.type == FILE_TYPE_SYMLINK && !no_follow);
+            if (need_stat || entry.type == FILE_TYPE_UNKNOWN || resolve_link) {
+                struct stat st;
+                int stat_flags = no_follow ? AT_SYMLINK_NOFOLLOW : 0;
+                if (fstatat(dir_fd, d->d_name, &st, stat_flags) == 0 ||
+                    (!no_follow && fstatat(dir_fd, d->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0)) {
+                    fill_entry_from_stat(&entry, &st);
+                }
+            }
+
+            if (!callback(&entry, user_data)) {
+                stop = true;
+            }
+        }
+    }
+
+    free(buffer);
+    close(dir_fd);
+    return success;
+}
+
+#else
+
+// 通用实现：readdir 遍历，复用同一个路径缓冲区，每项最多 stat 一次
+bool dir_scan(const char *dir_path, int flags, DirScanCallback callback, void *user_data) {
+    if (!dir_path || !callback) {
+        return false;
+    }
+
+    DIR *dir = opendir(dir_path);
+    if (!dir) {
+        return false;
+    }
+
+    size_t dir_len = strlen(dir_path);
+    size_t path_capacity = dir_len + 256;
+    char *path = (char*)malloc(path_capacity);
+    if (!path) {
+        closedir(dir);
+        return false;
+    }
+
+    memcpy(path, dir_path, dir_len);
+#ifdef _WIN32
+    if (dir_len > 0 && dir_path[dir_len - 1] != '\\' && dir_path[dir_len - 1] != '/') {
+        path[dir_len++] = '\\';
+    }
+#else
+    if (dir_len > 0 && dir_path[dir_len - 1] != '/') {
+        path[dir_len++] = '/';
+    }
+#endif
+
+    bool no_follow = (flags & DIR_SCAN_NO_FOLLOW) != 0;
+    bool success = true;
+    bool stopped = false;
+    struct dirent *d;
+
+    errno = 0;
+    while ((d = readdir(dir)) != NULL) {
+        if (is_dot_entry(d->d_name)) {
+            continue;
+        }
+
+        size_t name_len = strlen(d->d_name);
+        if (dir_len + name_len + 1 > path_capacity) {
+            path_capacity = (dir_len + name_len + 1) * 2;
+            char *grown = (char*)realloc(path, path_capacity);
+            if (!grown) {
+                success = false;
+                break;
+            }
+            path = grown;
+        }
+        memcpy(path + dir_len, d->d_name, name_len + 1);
+
+        DirScanEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.name = d->d_name;
+        entry.name_len = name_len;
+        entry.type = FILE_TYPE_UNKNOWN;
+        entry.is_hidden = (d->d_name[0] == '.');
+
+        // 该平台没有 d_type，类型和元数据都只能来自这一次 stat
+        struct stat st;
+#ifdef _WIN32
+        (void)no_follow;
+        int stat_result = stat(path, &st);
+#else
+        int stat_result = no_follow ? lstat(path, &st) : stat(path, &st);
+#endif
+        if (stat_result == 0) {
+            fill_entry_from_stat(&entry, &st);
+        }
+
+        if (!callback(&entry, user_data)) {
+            stopped = true;
+            break;
+        }
+        errno = 0;
+    }
+
+    if (!stopped && errno != 0) {
+        success = false;
+    }
+
+    free(path);
+    closedir(dir);
+    return success;
+}
+
+#endif
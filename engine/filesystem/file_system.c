@@ -6,9 +6,16 @@
  * 3. 处理文件系统错误
  * 4. 管理文件系统权限
  *  1. 处理文件操作（复制、剪切、粘贴、删除、重命名）
+ *  2. 文件复制优先使用系统的零拷贝路径（reflink、copy_file_range、sendfile），保留稀疏空洞、权限和修改时间
  */
 
+// copy_file_range、SEEK_DATA/SEEK_HOLE 需要 GNU 扩展
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include "file_system.h"
+#include "fs_tree.h"
 #include "sidebar.h"
 #include <stdlib.h>
 #include <string.h>
@@ -21,10 +28,30 @@
 #ifdef _WIN32
 #include <windows.h>
 #include <shlobj.h>
+#else
+#include <fcntl.h>
 #endif
 
-// 当前错误码
-static FSError last_error = FS_ERROR_NONE;
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#endif
+
+// FICLONE 在较旧的内核头文件中没有定义
+#if defined(__linux__) && !defined(FICLONE)
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+
+// 系统调用不可用时的缓冲区复制块大小（按页对齐分配）
+#define FS_COPY_BUFFER_SIZE (1024 * 1024)
+// 一次 copy_file_range/sendfile 最多传输的字节数
+#define FS_COPY_CHUNK_SIZE (1024 * 1024 * 1024)
+// 有进度回调时每次传输的字节数（决定进度刷新和响应取消的粒度）
+#define FS_COPY_PROGRESS_CHUNK_SIZE (16 * 1024 * 1024)
+
+// 当前错误码（每个线程独立，文件操作任务在后台线程调用）
+static _Thread_local FSError last_error = FS_ERROR_NONE;
 
 // 获取最后一次错误
 FSError fs_get_last_error(void) {
@@ -46,6 +73,12 @@ const char* fs_get_error_string(FSError error) {
             return "Disk is full";
         case FS_ERROR_INVALID_NAME:
             return "Invalid file or directory name";
+        case FS_ERROR_CANCELLED:
+            return "Operation cancelled";
+        case FS_ERROR_CROSS_DEVICE:
+            return "Source and target are on different file systems";
+        case FS_ERROR_TARGET_INSIDE_SOURCE:
+            return "Target folder is inside the source folder";
         case FS_ERROR_UNKNOWN:
         default:
             return "Unknown error";
@@ -53,12 +86,12 @@ const char* fs_get_error_string(FSError error) {
 }
 
 // 设置错误码
-static void fs_set_error(FSError error) {
+void fs_set_error(FSError error) {
     last_error = error;
 }
 
 // 根据系统错误码设置错误
-static void fs_set_error_from_errno(void) {
+void fs_set_error_from_errno(void) {
     switch (errno) {
         case EACCES:
         case EPERM:
@@ -76,6 +109,14 @@ static void fs_set_error_from_errno(void) {
         case EINVAL:
             fs_set_error(FS_ERROR_INVALID_NAME);
             break;
+        case EXDEV:
+            fs_set_error(FS_ERROR_CROSS_DEVICE);
+            break;
+#ifdef ECANCELED
+        case ECANCELED:
+            fs_set_error(FS_ERROR_CANCELLED);
+            break;
+#endif
         default:
             fs_set_error(FS_ERROR_UNKNOWN);
             break;
@@ -382,6 +423,15 @@ bool fs_rename(const char *old_path, const char *new_path) {
     }
 
     if (rename(old_path, new_path) != 0) {
+#ifndef _WIN32
+        // EINVAL 也可能是名称无效（FUSE、CIFS）或重命名 "."、".."，确认目标在源目录之内才报告
+        int error = errno;
+        if (error == EINVAL && fs_tree_target_inside(old_path, new_path)) {
+            fs_set_error(FS_ERROR_TARGET_INSIDE_SOURCE);
+            return false;
+        }
+        errno = error;
+#endif
         fs_set_error_from_errno();
         return false;
     }
@@ -390,64 +440,396 @@ bool fs_rename(const char *old_path, const char *new_path) {
     return true;
 }
 
+#ifdef _WIN32
+// 根据 Windows 错误码设置错误
+void fs_set_error_from_win32(unsigned long code) {
+    switch (code) {
+        case ERROR_ACCESS_DENIED:
+        case ERROR_SHARING_VIOLATION:
+            fs_set_error(FS_ERROR_ACCESS_DENIED);
+            break;
+        case ERROR_FILE_NOT_FOUND:
+        case ERROR_PATH_NOT_FOUND:
+            fs_set_error(FS_ERROR_NOT_FOUND);
+            break;
+        case ERROR_FILE_EXISTS:
+        case ERROR_ALREADY_EXISTS:
+            fs_set_error(FS_ERROR_ALREADY_EXISTS);
+            break;
+        case ERROR_DISK_FULL:
+        case ERROR_HANDLE_DISK_FULL:
+            fs_set_error(FS_ERROR_DISK_FULL);
+            break;
+        case ERROR_INVALID_NAME:
+            fs_set_error(FS_ERROR_INVALID_NAME);
+            break;
+        case ERROR_REQUEST_ABORTED:
+            fs_set_error(FS_ERROR_CANCELLED);
+            break;
+        case ERROR_NOT_SAME_DEVICE:
+            fs_set_error(FS_ERROR_CROSS_DEVICE);
+            break;
+        default:
+            fs_set_error(FS_ERROR_UNKNOWN);
+            break;
+    }
+}
+
+// 复制进度（CopyFileExA 回调把累计字节数换算为增量）
+typedef struct {
+    FSCopyProgress progress;
+    void *user_data;
+    Uint64 reported;
+} FSCopyContext;
+
+// CopyFileExA 的进度回调
+static DWORD CALLBACK fs_copy_progress_routine(LARGE_INTEGER total, LARGE_INTEGER transferred,
+                                               LARGE_INTEGER stream_size, LARGE_INTEGER stream_transferred,
+                                               DWORD stream_number, DWORD reason,
+                                               HANDLE src, HANDLE dst, LPVOID data) {
+    (void)total; (void)stream_size; (void)stream_transferred;
+    (void)stream_number; (void)reason; (void)src; (void)dst;
+    FSCopyContext *ctx = (FSCopyContext*)data;
+    Uint64 done = (Uint64)transferred.QuadPart;
+    Uint64 delta = done > ctx->reported ? done - ctx->reported : 0;
+    ctx->reported = done;
+    return ctx->progress(delta, ctx->user_data) ? PROGRESS_CONTINUE : PROGRESS_CANCEL;
+}
+
 // 复制文件
 bool fs_copy_file(const char *src_path, const char *dst_path) {
+    return fs_copy_file_ex(src_path, dst_path, NULL, NULL);
+}
+
+// 复制文件（系统复制：服务端/块克隆、属性和时间戳由系统保留）
+bool fs_copy_file_ex(const char *src_path, const char *dst_path, FSCopyProgress progress, void *user_data) {
     if (!src_path || !dst_path) {
         fs_set_error(FS_ERROR_INVALID_NAME);
         return false;
     }
 
-    FILE *src = fopen(src_path, "rb");
-    if (!src) {
-        fs_set_error_from_errno();
+    // 大文件绕过系统缓存，避免把缓存中的其它数据挤出去
+    DWORD flags = 0;
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (GetFileAttributesExA(src_path, GetFileExInfoStandard, &attributes) &&
+        (attributes.nFileSizeHigh > 0 || attributes.nFileSizeLow >= 256u * 1024 * 1024)) {
+        flags |= COPY_FILE_NO_BUFFERING;
+    }
+
+    FSCopyContext ctx = {progress, user_data, 0};
+    if (!CopyFileExA(src_path, dst_path, progress ? fs_copy_progress_routine : NULL, &ctx, NULL, flags)) {
+        fs_set_error_from_win32(GetLastError());
         return false;
     }
 
-    FILE *dst = fopen(dst_path, "wb");
-    if (!dst) {
-        fs_set_error_from_errno();
-        fclose(src);
+    fs_set_error(FS_ERROR_NONE);
+    return true;
+}
+#else
+// 复制方式（按尝试顺序）
+typedef enum {
+    FS_COPY_REFLINK,         // 共享数据块（btrfs、xfs 等），不复制数据
+    FS_COPY_RANGE,           // copy_file_range：内核内复制，支持时可由文件系统或设备完成
+    FS_COPY_SENDFILE,        // sendfile：内核内复制
+    FS_COPY_BUFFER           // 用户态缓冲区读写
+} FSCopyMethod;
+
+// 一次复制的状态
+typedef struct {
+    FSCopyMethod method;     // 当前使用的复制方式（不可用时降级）
+    size_t chunk;            // 每次系统调用传输的字节数
+    FSCopyProgress progress; // 进度回调（可为NULL）
+    void *user_data;
+    Uint64 reported;         // 已报告的字节数
+} FSCopyContext;
+
+// 报告新复制的字节数，回调要求取消时设置 ECANCELED 并返回 false
+static bool fs_copy_report(FSCopyContext *ctx, Uint64 copied) {
+    ctx->reported += copied;
+    if (ctx->progress && !ctx->progress(copied, ctx->user_data)) {
+        errno = ECANCELED;
         return false;
     }
+    return true;
+}
 
-    // 复制文件内容
-    char buffer[4096];
-    size_t bytes_read;
-    bool success = true;
+// 写出全部数据（处理部分写入和信号中断）
+static bool fs_write_all(int fd, const char *data, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t written = pwrite(fd, data, size, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= (size_t)written;
+        offset += written;
+    }
+    return true;
+}
+
+// 用缓冲区复制 [offset, offset + length)
+static bool fs_copy_buffered(int src, int dst, off_t offset, off_t length, FSCopyContext *ctx) {
+    void *buffer = NULL;
+    if (posix_memalign(&buffer, 4096, FS_COPY_BUFFER_SIZE) != 0) {
+        errno = ENOMEM;
+        return false;
+    }
 
-    while ((bytes_read = fread(buffer, 1, sizeof(buffer), src)) > 0) {
-        if (fwrite(buffer, 1, bytes_read, dst) != bytes_read) {
-            fs_set_error_from_errno();
+    bool success = true;
+    while (length > 0) {
+        size_t want = length < FS_COPY_BUFFER_SIZE ? (size_t)length : FS_COPY_BUFFER_SIZE;
+        ssize_t got = pread(src, buffer, want, offset);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            success = false;
+            break;
+        }
+        if (got == 0) {
+            // 复制期间源文件被截短
+            break;
+        }
+        if (!fs_write_all(dst, (const char*)buffer, (size_t)got, offset) ||
+            !fs_copy_report(ctx, (Uint64)got)) {
             success = false;
             break;
         }
+        offset += got;
+        length -= got;
+    }
+
+    free(buffer);
+    return success;
+}
+
+// 系统调用在这对文件上不可用（换用下一种方式），而不是真正的IO错误
+static bool fs_copy_unsupported(int error) {
+    return error == ENOSYS || error == EXDEV || error == EINVAL || error == EOPNOTSUPP ||
+           error == ENOTSUP || error == EBADF || error == ETXTBSY;
+}
+
+// 复制 [offset, offset + length)，从当前方式开始依次尝试，不可用时降级并记住
+static bool fs_copy_range(int src, int dst, off_t offset, off_t length, FSCopyContext *ctx) {
+#ifdef __linux__
+    while (length > 0 && ctx->method == FS_COPY_RANGE) {
+        size_t chunk = length < (off_t)ctx->chunk ? (size_t)length : ctx->chunk;
+        loff_t in_offset = offset;
+        loff_t out_offset = offset;
+        ssize_t copied = copy_file_range(src, &in_offset, dst, &out_offset, chunk, 0);
+        if (copied < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (!fs_copy_unsupported(errno)) {
+                return false;
+            }
+            ctx->method = FS_COPY_SENDFILE;
+            break;
+        }
+        if (copied == 0) {
+            return true;
+        }
+        if (!fs_copy_report(ctx, (Uint64)copied)) {
+            return false;
+        }
+        offset += copied;
+        length -= copied;
     }
 
-    if (ferror(src)) {
+    while (length > 0 && ctx->method == FS_COPY_SENDFILE) {
+        size_t chunk = length < (off_t)ctx->chunk ? (size_t)length : ctx->chunk;
+        // sendfile 写到目标文件的当前位置
+        if (lseek(dst, offset, SEEK_SET) < 0) {
+            return false;
+        }
+        off_t in_offset = offset;
+        ssize_t copied = sendfile(dst, src, &in_offset, chunk);
+        if (copied < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (!fs_copy_unsupported(errno)) {
+                return false;
+            }
+            ctx->method = FS_COPY_BUFFER;
+            break;
+        }
+        if (copied == 0) {
+            return true;
+        }
+        if (!fs_copy_report(ctx, (Uint64)copied)) {
+            return false;
+        }
+        offset += copied;
+        length -= copied;
+    }
+#else
+    ctx->method = FS_COPY_BUFFER;
+#endif
+
+    return length <= 0 || fs_copy_buffered(src, dst, offset, length, ctx);
+}
+
+// 复制文件内容：先尝试 reflink，稀疏文件只复制数据段，空洞由最后的 ftruncate 保留
+static bool fs_copy_contents(int src, int dst, const struct stat *st, FSCopyContext *ctx) {
+#ifdef __linux__
+    if (ioctl(dst, FICLONE, src) == 0) {
+        return fs_copy_report(ctx, (Uint64)st->st_size);
+    }
+#endif
+
+    // 分配的块少于文件大小时按数据段复制
+    bool sparse = (off_t)st->st_blocks * 512 < st->st_size;
+    // 整体复制的起点（查找数据段中途失败时，之前的数据段已经复制并计入进度）
+    off_t copy_from = 0;
+#ifdef SEEK_DATA
+    if (sparse) {
+        off_t offset = 0;
+        while (offset < st->st_size) {
+            off_t data = lseek(src, offset, SEEK_DATA);
+            if (data < 0) {
+                if (errno == ENXIO) {
+                    // 之后全是空洞
+                    break;
+                }
+                // 文件系统不支持查找数据段，从这里开始整体复制
+                copy_from = offset;
+                sparse = false;
+                break;
+            }
+            off_t hole = lseek(src, data, SEEK_HOLE);
+            if (hole < 0) {
+                hole = st->st_size;
+            }
+            if (!fs_copy_range(src, dst, data, hole - data, ctx)) {
+                return false;
+            }
+            offset = hole;
+        }
+    }
+#else
+    sparse = false;
+#endif
+
+    if (!sparse && copy_from < st->st_size && !fs_copy_range(src, dst, copy_from, st->st_size - copy_from, ctx)) {
+        return false;
+    }
+
+    // 设置最终大小（末尾的空洞，或复制期间源文件变化）
+    if (ftruncate(dst, st->st_size) != 0) {
+        return false;
+    }
+    // 空洞不复制数据，完成时一并计入进度
+    if ((Uint64)st->st_size > ctx->reported) {
+        return fs_copy_report(ctx, (Uint64)st->st_size - ctx->reported);
+    }
+    return true;
+}
+
+// 复制文件
+bool fs_copy_file(const char *src_path, const char *dst_path) {
+    return fs_copy_file_ex(src_path, dst_path, NULL, NULL);
+}
+
+// 复制文件（保留权限和访问/修改时间）
+bool fs_copy_file_ex(const char *src_path, const char *dst_path, FSCopyProgress progress, void *user_data) {
+    return fs_copy_file_at(AT_FDCWD, src_path, AT_FDCWD, dst_path, progress, user_data);
+}
+
+// 按目录描述符复制文件（保留权限和访问/修改时间）
+bool fs_copy_file_at(int src_dir, const char *src_name, int dst_dir, const char *dst_name,
+                     FSCopyProgress progress, void *user_data) {
+    if (!src_name || !dst_name) {
+        fs_set_error(FS_ERROR_INVALID_NAME);
+        return false;
+    }
+
+    int src = openat(src_dir, src_name, O_RDONLY | O_CLOEXEC);
+    if (src < 0) {
         fs_set_error_from_errno();
-        success = false;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(src, &st) != 0) {
+        fs_set_error_from_errno();
+        close(src);
+        return false;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        fs_set_error(FS_ERROR_INVALID_NAME);
+        close(src);
+        return false;
+    }
+
+    // 目标就是源文件时截断会丢失数据
+    struct stat dst_st;
+    if (fstatat(dst_dir, dst_name, &dst_st, 0) == 0 && dst_st.st_dev == st.st_dev && dst_st.st_ino == st.st_ino) {
+        fs_set_error(FS_ERROR_ALREADY_EXISTS);
+        close(src);
+        return false;
+    }
+
+    int dst = openat(dst_dir, dst_name, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 0777);
+    if (dst < 0) {
+        fs_set_error_from_errno();
+        close(src);
+        return false;
     }
 
-    fclose(src);
-    fclose(dst);
+    FSCopyContext ctx = {
+        .method = FS_COPY_RANGE,
+        .chunk = progress ? FS_COPY_PROGRESS_CHUNK_SIZE : FS_COPY_CHUNK_SIZE,
+        .progress = progress,
+        .user_data = user_data,
+    };
+    bool success = fs_copy_contents(src, dst, &st, &ctx);
 
+    // 保留权限（创建时受 umask 影响）和时间戳
     if (success) {
-        fs_set_error(FS_ERROR_NONE);
+        struct timespec times[2] = {st.st_atim, st.st_mtim};
+        if (fchmod(dst, st.st_mode & 07777) != 0 || futimens(dst, times) != 0) {
+            success = false;
+        }
+    }
+    if (!success) {
+        fs_set_error_from_errno();
+    }
+    if (close(dst) != 0 && success) {
+        fs_set_error_from_errno();
+        success = false;
     }
+    close(src);
 
-    return success;
+    if (!success) {
+        // 不留下不完整的目标文件
+        unlinkat(dst_dir, dst_name, 0);
+        return false;
+    }
+
+    fs_set_error(FS_ERROR_NONE);
+    return true;
 }
+#endif
 
-// 移动文件
+// 移动文件或目录
 bool fs_move_file(const char *src_path, const char *dst_path) {
     // 尝试直接重命名（在同一文件系统上效率更高）
     if (fs_rename(src_path, dst_path)) {
         return true;
     }
 
-    // 如果重命名失败，尝试复制后删除
-    if (fs_copy_file(src_path, dst_path)) {
-        return fs_delete_file(src_path);
+    // 只有跨文件系统时才复制整个目录树，全部复制成功后再删除源；
+    // 其它错误（目标目录非空、移到自身之内、没有权限）直接失败，不能改为复制
+    if (fs_get_last_error() != FS_ERROR_CROSS_DEVICE) {
+        return false;
+    }
+    if (fs_tree_copy(src_path, dst_path, NULL, NULL, NULL)) {
+        return fs_tree_delete(src_path, NULL, NULL, NULL);
     }
 
     return false;
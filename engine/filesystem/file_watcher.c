@@ -1,8 +1,808 @@
 /*
  * 文件监控模块
  * 职责：
- * 1. 监控目录变化
- * 2. 发送文件变化通知
- * 3. 处理文件系统事件
- * 4. 自动刷新支持
+ * 1. 监控目录变化（Linux 下使用 inotify，在独立线程中等待事件）
+ * 2. 在短时间窗口内合并同一文件的连续事件
+ * 3. 把合并后的增删改和改名按批次通过 SDL 自定义事件发送给UI线程
+ * 4. 事件丢失或合并的变更超出预算时限频重新扫描，按批发送目录项由UI线程比对
+ *    （监控线程只保留一批目录项；列表一侧删除和改名留下的空间在每批应用后由 file_list_compact 回收）
  */
+
+#include "file_watcher.h"
+#include "file_system.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#endif
+
+// 最后一个事件之后静默多久发送（毫秒）
+#define FILE_WATCHER_QUIET_MS 50
+// 第一个事件之后最迟多久发送（持续写入的目录也能保持更新）
+#define FILE_WATCHER_MAX_DELAY_MS 250
+// UI线程尚未处理上一批时的重试间隔（毫秒）
+#define FILE_WATCHER_RETRY_MS 10
+// inotify 读取缓冲区大小
+#define FILE_WATCHER_BUFFER_SIZE (64 * 1024)
+// 两次重新扫描的最小间隔（毫秒）
+#define FILE_WATCHER_RESCAN_INTERVAL_MS 1000
+// 重新扫描时每批发送的目录项数
+#define FILE_WATCHER_RESCAN_CHUNK 4096
+
+// 变更事件类型（0 表示尚未注册）
+static SDL_AtomicInt g_event_type;
+// 下一个监控器编号
+static SDL_AtomicInt g_next_id;
+
+// 变更事件类型（首次调用时注册，失败返回0）
+Uint32 file_watcher_event_type(void) {
+    Uint32 type = (Uint32)SDL_GetAtomicInt(&g_event_type);
+    if (type != 0) {
+        return type;
+    }
+
+    // 多个线程同时注册时只保留一个（多注册的编号不再使用）
+    Uint32 registered = SDL_RegisterEvents(1);
+    if (registered == 0) {
+        printf("[ERROR] Failed to register file watcher event: %s\n", SDL_GetError());
+        return 0;
+    }
+    SDL_CompareAndSwapAtomicInt(&g_event_type, 0, (int)registered);
+    return (Uint32)SDL_GetAtomicInt(&g_event_type);
+}
+
+// 释放批次
+void file_watcher_batch_free(FileWatchBatch *batch) {
+    if (!batch) {
+        return;
+    }
+
+    free(batch->changes);
+    free(batch->names);
+    free(batch);
+}
+
+#if defined(__linux__)
+
+// 需要监听的事件
+#define FILE_WATCHER_MASK (IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | \
+                           IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
+
+// 合并窗口内单个文件的状态
+typedef struct {
+    uint32_t name_offset;    // 名称在 names 中的偏移
+    int rename_from;         // 改名来源（pending 下标，-1 表示没有）
+    bool existed;            // 本窗口第一个事件之前是否存在
+    bool exists;             // 目前是否存在
+    bool consumed;           // 已作为改名来源输出
+    DirScanEntry entry;      // 发送前读取的元数据
+} PendingChange;
+
+// 重新扫描时正在填充的一批目录项
+typedef struct {
+    FileWatchBatch *batch;       // 当前批次（名称按顺序连续存放在 batch->names 中）
+    size_t names_used;           // 名称存储区已用字节数
+    size_t names_capacity;       // 名称存储区容量
+    bool first;                  // 下一批是本轮的第一批
+    bool stopped;                // 监控器正在停止
+} RescanChunk;
+
+struct FileWatcher {
+    int id;                      // 监控器编号
+    Uint32 event_type;           // 变更事件类型
+    char *dir_path;              // 被监控目录（重新扫描使用）
+    SDL_Thread *thread;          // 监控线程
+    SDL_AtomicInt in_flight;     // 已发送但UI线程尚未处理完的批次（0或1）
+    SDL_AtomicInt event_budget;  // 合并中的变更最多保留的文件数
+    int inotify_fd;              // inotify 实例
+    int dir_fd;                  // 被监控目录（fstatat 使用）
+    int wake_pipe[2];            // 停止时唤醒监控线程
+
+    // 统计（监控线程写入，任意线程读取）
+    SDL_AtomicInt events;
+    SDL_AtomicInt coalesced_events;
+    SDL_AtomicInt dropped_events;
+    SDL_AtomicInt overflows;
+    SDL_AtomicInt rescans;
+    SDL_AtomicInt batches;
+
+    // 以下字段只由监控线程访问
+    PendingChange *pending;      // 合并中的变更（按首次出现顺序）
+    int pending_count;
+    int pending_capacity;
+    char *names;                 // 名称存储区
+    size_t names_used;
+    size_t names_capacity;
+    int *table;                  // 名称 -> pending 下标（开放寻址，-1 为空）
+    int table_capacity;
+    uint32_t last_cookie;        // 最近一次移出事件的 cookie
+    int last_moved_from;         // 最近一次移出的 pending 下标
+    bool rescan_needed;          // 事件已丢失，需要重新扫描（之后的事件由扫描覆盖）
+    Uint64 last_rescan;          // 上一次开始重新扫描的时间
+    Uint64 first_event;          // 本窗口第一个事件的时间
+    Uint64 last_event;           // 本窗口最后一个事件的时间
+};
+
+// 文件名哈希（FNV-1a）
+static uint32_t watcher_hash(const char *name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char*)name; *p; p++) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    return hash;
+}
+
+// 清空合并状态（保留缓冲区）
+static void watcher_reset_pending(FileWatcher *watcher) {
+    watcher->pending_count = 0;
+    watcher->names_used = 0;
+    watcher->last_moved_from = -1;
+    watcher->first_event = 0;
+    for (int i = 0; i < watcher->table_capacity; i++) {
+        watcher->table[i] = -1;
+    }
+}
+
+// 重建名称哈希表（负载不超过一半）
+static bool watcher_grow_table(FileWatcher *watcher) {
+    int capacity = watcher->table_capacity > 0 ? watcher->table_capacity * 2 : 256;
+    int *table = (int*)malloc(sizeof(int) * (size_t)capacity);
+    if (!table) {
+        return false;
+    }
+
+    for (int i = 0; i < capacity; i++) {
+        table[i] = -1;
+    }
+    for (int i = 0; i < watcher->pending_count; i++) {
+        int slot = (int)(watcher_hash(watcher->names + watcher->pending[i].name_offset) & (uint32_t)(capacity - 1));
+        while (table[slot] >= 0) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        table[slot] = i;
+    }
+
+    free(watcher->table);
+    watcher->table = table;
+    watcher->table_capacity = capacity;
+    return true;
+}
+
+// 查找或新建文件的合并状态（existed 为新建时第一个事件之前的存在状态）
+static PendingChange* watcher_get_pending(FileWatcher *watcher, const char *name, bool existed) {
+    if ((watcher->pending_count + 1) * 2 > watcher->table_capacity && !watcher_grow_table(watcher)) {
+        return NULL;
+    }
+
+    int mask = watcher->table_capacity - 1;
+    int slot = (int)(watcher_hash(name) & (uint32_t)mask);
+    while (watcher->table[slot] >= 0) {
+        PendingChange *change = &watcher->pending[watcher->table[slot]];
+        if (strcmp(watcher->names + change->name_offset, name) == 0) {
+            return change;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    // 新文件：复制名称并追加状态
+    size_t len = strlen(name) + 1;
+    if (watcher->names_used + len > watcher->names_capacity) {
+        size_t capacity = watcher->names_capacity > 0 ? watcher->names_capacity : 4096;
+        while (capacity < watcher->names_used + len) {
+            capacity *= 2;
+        }
+        char *names = (char*)realloc(watcher->names, capacity);
+        if (!names) {
+            return NULL;
+        }
+        watcher->names = names;
+        watcher->names_capacity = capacity;
+    }
+    if (watcher->pending_count == watcher->pending_capacity) {
+        int capacity = watcher->pending_capacity > 0 ? watcher->pending_capacity * 2 : 64;
+        PendingChange *pending = (PendingChange*)realloc(watcher->pending, sizeof(PendingChange) * (size_t)capacity);
+        if (!pending) {
+            return NULL;
+        }
+        watcher->pending = pending;
+        watcher->pending_capacity = capacity;
+    }
+
+    PendingChange *change = &watcher->pending[watcher->pending_count];
+    memset(change, 0, sizeof(PendingChange));
+    change->name_offset = (uint32_t)watcher->names_used;
+    change->rename_from = -1;
+    change->existed = existed;
+    change->exists = existed;
+    memcpy(watcher->names + watcher->names_used, name, len);
+    watcher->names_used += len;
+    watcher->table[slot] = watcher->pending_count++;
+    return change;
+}
+
+// 事件已丢失：丢弃合并中的变更（计入丢弃数），之后重新扫描
+static void watcher_overflow(FileWatcher *watcher) {
+    SDL_AddAtomicInt(&watcher->dropped_events, watcher->pending_count);
+    SDL_AddAtomicInt(&watcher->overflows, 1);
+    watcher_reset_pending(watcher);
+    watcher->rescan_needed = true;
+}
+
+// 记录一个 inotify 事件
+static void watcher_record(FileWatcher *watcher, const struct inotify_event *event) {
+    bool appeared = (event->mask & (IN_CREATE | IN_MOVED_TO)) != 0;
+    bool vanished = (event->mask & (IN_DELETE | IN_MOVED_FROM)) != 0;
+
+    // 第一个事件是出现时认为之前不存在（覆盖已有文件时按更新处理，结果相同）
+    int count = watcher->pending_count;
+    PendingChange *change = NULL;
+    if (count < SDL_GetAtomicInt(&watcher->event_budget)) {
+        change = watcher_get_pending(watcher, event->name, !appeared);
+    }
+    if (!change) {
+        // 超出预算或内存不足时放弃合并，改为重新扫描
+        SDL_AddAtomicInt(&watcher->dropped_events, 1);
+        watcher_overflow(watcher);
+        return;
+    }
+    if (watcher->pending_count == count) {
+        SDL_AddAtomicInt(&watcher->coalesced_events, 1);
+    }
+    int index = (int)(change - watcher->pending);
+
+    if (appeared) {
+        change->exists = true;
+    } else if (vanished) {
+        change->exists = false;
+    }
+
+    if (event->mask & IN_MOVED_FROM) {
+        watcher->last_cookie = event->cookie;
+        watcher->last_moved_from = index;
+    } else if ((event->mask & IN_MOVED_TO) && watcher->last_moved_from >= 0 &&
+               event->cookie == watcher->last_cookie && watcher->last_moved_from != index) {
+        // 来源本身是窗口内新建的临时文件时沿用它的来源（先写临时文件再改名）
+        PendingChange *from = &watcher->pending[watcher->last_moved_from];
+        change->rename_from = from->existed ? watcher->last_moved_from : from->rename_from;
+        watcher->last_moved_from = -1;
+    }
+
+    Uint64 now = SDL_GetTicks();
+    if (watcher->first_event == 0) {
+        watcher->first_event = now;
+    }
+    watcher->last_event = now;
+}
+
+// 读取所有可用的 inotify 事件
+static void watcher_read_events(FileWatcher *watcher, char *buffer) {
+    for (;;) {
+        ssize_t bytes = read(watcher->inotify_fd, buffer, FILE_WATCHER_BUFFER_SIZE);
+        if (bytes <= 0) {
+            break;
+        }
+
+        for (ssize_t offset = 0; offset < bytes; ) {
+            const struct inotify_event *event = (const struct inotify_event*)(buffer + offset);
+            offset += (ssize_t)(sizeof(struct inotify_event) + event->len);
+            SDL_AddAtomicInt(&watcher->events, 1);
+
+            // 事件丢失或目录本身不再可用：丢弃已合并的变更，只要求重新扫描
+            if (event->mask & (IN_Q_OVERFLOW | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT | IN_IGNORED)) {
+                watcher_overflow(watcher);
+                continue;
+            }
+            if (event->len == 0) {
+                continue;
+            }
+            if (watcher->rescan_needed) {
+                // 等待中的重新扫描会读到这个变化
+                SDL_AddAtomicInt(&watcher->dropped_events, 1);
+                continue;
+            }
+
+            watcher_record(watcher, event);
+        }
+    }
+}
+
+// 读取文件元数据，文件已不存在时返回 false
+static bool watcher_stat(FileWatcher *watcher, const char *name, DirScanEntry *entry) {
+    struct stat st;
+    if (fstatat(watcher->dir_fd, name, &st, 0) != 0 &&
+        fstatat(watcher->dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+        return false;
+    }
+
+    memset(entry, 0, sizeof(DirScanEntry));
+    entry->name_len = strlen(name);
+    entry->inode = (uint64_t)st.st_ino;
+    entry->type = get_file_type(&st);
+    entry->has_stat = true;
+    entry->is_hidden = (name[0] == '.');
+    entry->size = (size_t)st.st_size;
+    entry->modified_time = st.st_mtime;
+    entry->created_time = st.st_ctime;
+    entry->accessed_time = st.st_atime;
+    return true;
+}
+
+// 把一批变更发送给UI线程（事件队列已满时返回 false，批次仍归调用方所有）
+static bool watcher_send(FileWatcher *watcher, FileWatchBatch *batch) {
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = watcher->event_type;
+    event.user.code = watcher->id;
+    event.user.data1 = batch;
+
+    SDL_SetAtomicInt(&watcher->in_flight, 1);
+    if (!SDL_PushEvent(&event)) {
+        SDL_SetAtomicInt(&watcher->in_flight, 0);
+        return false;
+    }
+    SDL_AddAtomicInt(&watcher->batches, 1);
+    return true;
+}
+
+// 把合并结果整理成一批变更并发送，成功（或没有需要发送的内容）时清空合并状态
+static void watcher_flush(FileWatcher *watcher) {
+    FileWatchBatch *batch = (FileWatchBatch*)calloc(1, sizeof(FileWatchBatch));
+    if (!batch) {
+        return;
+    }
+
+    if (watcher->pending_count > 0) {
+        batch->changes = (FileWatchChange*)malloc(sizeof(FileWatchChange) * (size_t)watcher->pending_count);
+        batch->names = (char*)malloc(watcher->names_used);
+        if (!batch->changes || !batch->names) {
+            file_watcher_batch_free(batch);
+            return;
+        }
+        memcpy(batch->names, watcher->names, watcher->names_used);
+
+        // 1. 读取仍然存在的文件的元数据（读取失败说明已被删除）
+        for (int i = 0; i < watcher->pending_count; i++) {
+            PendingChange *change = &watcher->pending[i];
+            change->consumed = false;
+            if (change->exists && !watcher_stat(watcher, watcher->names + change->name_offset, &change->entry)) {
+                change->exists = false;
+            }
+        }
+
+        // 2. 来源已删除、目标仍存在的移入配对为改名
+        for (int i = 0; i < watcher->pending_count; i++) {
+            PendingChange *change = &watcher->pending[i];
+            if (change->exists && change->rename_from >= 0) {
+                PendingChange *from = &watcher->pending[change->rename_from];
+                if (from->existed && !from->exists && !from->consumed) {
+                    from->consumed = true;
+                } else {
+                    change->rename_from = -1;
+                }
+            } else {
+                change->rename_from = -1;
+            }
+        }
+
+        // 3. 按首次出现顺序输出
+        for (int i = 0; i < watcher->pending_count; i++) {
+            PendingChange *change = &watcher->pending[i];
+            if (change->consumed || (!change->existed && !change->exists)) {
+                continue;
+            }
+
+            FileWatchChange *out = &batch->changes[batch->count++];
+            memset(out, 0, sizeof(FileWatchChange));
+            if (change->exists) {
+                out->entry = change->entry;
+                if (change->rename_from >= 0) {
+                    out->action = FILE_WATCH_RENAMED;
+                    out->old_name = batch->names + watcher->pending[change->rename_from].name_offset;
+                } else {
+                    out->action = change->existed ? FILE_WATCH_MODIFIED : FILE_WATCH_ADDED;
+                }
+            } else {
+                out->action = FILE_WATCH_REMOVED;
+            }
+            out->entry.name = batch->names + change->name_offset;
+            out->entry.name_len = strlen(out->entry.name);
+        }
+    }
+
+    if (batch->count == 0) {
+        // 窗口内的变更相互抵消
+        file_watcher_batch_free(batch);
+        watcher_reset_pending(watcher);
+        return;
+    }
+
+    if (!watcher_send(watcher, batch)) {
+        // 事件队列已满时保留合并状态，稍后重试
+        file_watcher_batch_free(batch);
+        return;
+    }
+
+    watcher_reset_pending(watcher);
+}
+
+// 等待UI线程处理完上一批，期间继续读取事件（监控器停止时返回 false）
+static bool watcher_wait_idle(FileWatcher *watcher, char *buffer) {
+    while (SDL_GetAtomicInt(&watcher->in_flight)) {
+        struct pollfd fds[2];
+        fds[0].fd = watcher->inotify_fd;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = watcher->wake_pipe[0];
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+
+        int ready = poll(fds, 2, FILE_WATCHER_RETRY_MS);
+        if ((ready < 0 && errno != EINTR) || (ready > 0 && fds[1].revents)) {
+            return false;
+        }
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            watcher_read_events(watcher, buffer);
+        }
+    }
+    return true;
+}
+
+// 发送重新扫描填充好的一批目录项（last 为本轮最后一批），监控器停止时返回 false
+static bool watcher_send_chunk(FileWatcher *watcher, RescanChunk *chunk, char *buffer, int flags) {
+    FileWatchBatch *batch = chunk->batch;
+    chunk->batch = NULL;
+    if (!batch) {
+        batch = (FileWatchBatch*)calloc(1, sizeof(FileWatchBatch));
+        if (!batch) {
+            return true;
+        }
+    }
+    batch->flags = FILE_WATCH_BATCH_RESCAN | flags | (chunk->first ? FILE_WATCH_BATCH_FIRST : 0);
+    chunk->first = false;
+    chunk->names_used = 0;
+    chunk->names_capacity = 0;
+
+    // 名称存储区扩容后地址会变化，发送前再指向名称
+    const char *name = batch->names;
+    for (int i = 0; i < batch->count; i++) {
+        batch->changes[i].entry.name = name;
+        name += batch->changes[i].entry.name_len + 1;
+    }
+
+    for (;;) {
+        if (!watcher_wait_idle(watcher, buffer)) {
+            file_watcher_batch_free(batch);
+            return false;
+        }
+        if (watcher_send(watcher, batch)) {
+            return true;
+        }
+        SDL_Delay(FILE_WATCHER_RETRY_MS);
+    }
+}
+
+// 重新扫描的上下文
+typedef struct {
+    FileWatcher *watcher;
+    RescanChunk chunk;
+    char *buffer;                // inotify 读取缓冲区（等待UI线程时继续读取事件）
+    bool failed;                 // 内存不足，扫描没有完成
+} RescanContext;
+
+// 重新扫描回调：把目录项追加到当前批次，批次满时发送
+static bool watcher_rescan_callback(const DirScanEntry *entry, void *user_data) {
+    RescanContext *context = (RescanContext*)user_data;
+    RescanChunk *chunk = &context->chunk;
+
+    if (!chunk->batch) {
+        chunk->batch = (FileWatchBatch*)calloc(1, sizeof(FileWatchBatch));
+        if (chunk->batch) {
+            chunk->batch->changes = (FileWatchChange*)malloc(sizeof(FileWatchChange) * FILE_WATCHER_RESCAN_CHUNK);
+        }
+        if (!chunk->batch || !chunk->batch->changes) {
+            context->failed = true;
+            return false;
+        }
+    }
+
+    FileWatchBatch *batch = chunk->batch;
+    if (chunk->names_used + entry->name_len + 1 > chunk->names_capacity) {
+        size_t capacity = chunk->names_capacity > 0 ? chunk->names_capacity * 2 : 64 * 1024;
+        while (capacity < chunk->names_used + entry->name_len + 1) {
+            capacity *= 2;
+        }
+        char *names = (char*)realloc(batch->names, capacity);
+        if (!names) {
+            context->failed = true;
+            return false;
+        }
+        batch->names = names;
+        chunk->names_capacity = capacity;
+    }
+    memcpy(batch->names + chunk->names_used, entry->name, entry->name_len + 1);
+    chunk->names_used += entry->name_len + 1;
+
+    FileWatchChange *change = &batch->changes[batch->count++];
+    memset(change, 0, sizeof(FileWatchChange));
+    change->action = FILE_WATCH_MODIFIED;
+    change->entry = *entry;
+    change->entry.name = NULL;
+
+    if (batch->count == FILE_WATCHER_RESCAN_CHUNK &&
+        !watcher_send_chunk(context->watcher, chunk, context->buffer, 0)) {
+        chunk->stopped = true;
+        return false;
+    }
+    return true;
+}
+
+// 重新扫描目录：按批发送全部目录项，内存只占用一批（监控器停止时返回 false）
+static bool watcher_rescan(FileWatcher *watcher, char *buffer) {
+    // 此前的变化都由这次扫描覆盖
+    SDL_AddAtomicInt(&watcher->rescans, 1);
+    watcher->rescan_needed = false;
+    watcher->last_rescan = SDL_GetTicks();
+    watcher_reset_pending(watcher);
+
+    RescanContext context;
+    memset(&context, 0, sizeof(RescanContext));
+    context.watcher = watcher;
+    context.chunk.first = true;
+    context.buffer = buffer;
+
+    bool result = dir_scan(watcher->dir_path, DIR_SCAN_STAT, watcher_rescan_callback, &context);
+    if (context.chunk.stopped) {
+        file_watcher_batch_free(context.chunk.batch);
+        return false;
+    }
+    result = result && !context.failed;
+    if (!result) {
+        printf("[ERROR] File watcher failed to rescan %s\n", watcher->dir_path);
+    }
+
+    int flags = FILE_WATCH_BATCH_LAST | (result ? 0 : FILE_WATCH_BATCH_INCOMPLETE);
+    return watcher_send_chunk(watcher, &context.chunk, buffer, flags);
+}
+
+// 监控线程入口
+static int SDLCALL file_watcher_thread(void *data) {
+    FileWatcher *watcher = (FileWatcher*)data;
+    char *buffer = (char*)malloc(FILE_WATCHER_BUFFER_SIZE);
+    if (!buffer) {
+        return 0;
+    }
+
+    for (;;) {
+        // 需要重新扫描时等到距上一次扫描满最小间隔；有待发送的变更时等到静默期结束或达到最长延迟
+        int timeout = -1;
+        bool has_pending = watcher->pending_count > 0;
+        if (watcher->rescan_needed) {
+            Uint64 now = SDL_GetTicks();
+            Uint64 due = watcher->last_rescan + FILE_WATCHER_RESCAN_INTERVAL_MS;
+            timeout = due > now ? (int)(due - now) : 0;
+            if (SDL_GetAtomicInt(&watcher->in_flight) && timeout < FILE_WATCHER_RETRY_MS) {
+                timeout = FILE_WATCHER_RETRY_MS;
+            }
+        } else if (has_pending) {
+            Uint64 now = SDL_GetTicks();
+            Uint64 due = watcher->last_event + FILE_WATCHER_QUIET_MS;
+            if (due > watcher->first_event + FILE_WATCHER_MAX_DELAY_MS) {
+                due = watcher->first_event + FILE_WATCHER_MAX_DELAY_MS;
+            }
+            timeout = due > now ? (int)(due - now) : 0;
+            if (SDL_GetAtomicInt(&watcher->in_flight) && timeout < FILE_WATCHER_RETRY_MS) {
+                timeout = FILE_WATCHER_RETRY_MS;
+            }
+        }
+
+        struct pollfd fds[2];
+        fds[0].fd = watcher->inotify_fd;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = watcher->wake_pipe[0];
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+
+        int ready = poll(fds, 2, timeout);
+        if (ready < 0 && errno != EINTR) {
+            printf("[ERROR] File watcher poll failed: %s\n", strerror(errno));
+            break;
+        }
+        if (ready > 0 && fds[1].revents) {
+            break;
+        }
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            watcher_read_events(watcher, buffer);
+        }
+
+        // UI线程处理完上一批后才发送下一批，期间继续合并
+        if (watcher->rescan_needed) {
+            if (!SDL_GetAtomicInt(&watcher->in_flight) &&
+                SDL_GetTicks() >= watcher->last_rescan + FILE_WATCHER_RESCAN_INTERVAL_MS &&
+                !watcher_rescan(watcher, buffer)) {
+                break;
+            }
+            continue;
+        }
+
+        has_pending = watcher->pending_count > 0;
+        if (has_pending && !SDL_GetAtomicInt(&watcher->in_flight)) {
+            Uint64 now = SDL_GetTicks();
+            if (now >= watcher->last_event + FILE_WATCHER_QUIET_MS ||
+                now >= watcher->first_event + FILE_WATCHER_MAX_DELAY_MS) {
+                watcher_flush(watcher);
+            }
+        }
+    }
+
+    free(buffer);
+    return 0;
+}
+
+// 关闭文件描述符并释放监控器
+static void watcher_destroy(FileWatcher *watcher) {
+    if (watcher->inotify_fd >= 0) {
+        close(watcher->inotify_fd);
+    }
+    if (watcher->dir_fd >= 0) {
+        close(watcher->dir_fd);
+    }
+    if (watcher->wake_pipe[0] >= 0) {
+        close(watcher->wake_pipe[0]);
+        close(watcher->wake_pipe[1]);
+    }
+    free(watcher->pending);
+    free(watcher->names);
+    free(watcher->table);
+    free(watcher->dir_path);
+    free(watcher);
+}
+
+// 在后台线程开始监控目录
+FileWatcher* file_watcher_start(const char *dir_path) {
+    if (!dir_path) {
+        return NULL;
+    }
+
+    Uint32 event_type = file_watcher_event_type();
+    if (event_type == 0) {
+        return NULL;
+    }
+
+    FileWatcher *watcher = (FileWatcher*)calloc(1, sizeof(FileWatcher));
+    if (!watcher) {
+        return NULL;
+    }
+    watcher->id = SDL_AddAtomicInt(&g_next_id, 1) + 1;
+    watcher->event_type = event_type;
+    watcher->last_moved_from = -1;
+    watcher->inotify_fd = -1;
+    watcher->dir_fd = -1;
+    watcher->wake_pipe[0] = -1;
+    watcher->wake_pipe[1] = -1;
+    SDL_SetAtomicInt(&watcher->event_budget, FILE_WATCHER_DEFAULT_EVENT_BUDGET);
+
+    watcher->dir_path = strdup(dir_path);
+    watcher->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    watcher->dir_fd = open(dir_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (!watcher->dir_path || watcher->inotify_fd < 0 || watcher->dir_fd < 0 ||
+        pipe(watcher->wake_pipe) != 0) {
+        printf("[ERROR] Failed to initialize file watcher for %s: %s\n", dir_path, strerror(errno));
+        watcher_destroy(watcher);
+        return NULL;
+    }
+
+    // 达到系统监控数量上限等情况下不监控，界面仍可手动刷新
+    if (inotify_add_watch(watcher->inotify_fd, dir_path, FILE_WATCHER_MASK) < 0) {
+        printf("[ERROR] Failed to watch directory %s: %s\n", dir_path, strerror(errno));
+        watcher_destroy(watcher);
+        return NULL;
+    }
+
+    watcher->thread = SDL_CreateThread(file_watcher_thread, "file_watcher", watcher);
+    if (!watcher->thread) {
+        printf("[ERROR] Failed to create file watcher thread: %s\n", SDL_GetError());
+        watcher_destroy(watcher);
+        return NULL;
+    }
+
+    return watcher;
+}
+
+// 停止监控并释放（等待后台线程退出）
+void file_watcher_stop(FileWatcher *watcher) {
+    if (!watcher) {
+        return;
+    }
+
+    char wake = 1;
+    if (write(watcher->wake_pipe[1], &wake, 1) < 0) {
+        printf("[ERROR] Failed to wake file watcher thread\n");
+    }
+    SDL_WaitThread(watcher->thread, NULL);
+    watcher_destroy(watcher);
+}
+
+// 设置合并中的变更最多保留的文件数
+void file_watcher_set_event_budget(FileWatcher *watcher, int budget) {
+    if (watcher) {
+        SDL_SetAtomicInt(&watcher->event_budget, budget > 0 ? budget : FILE_WATCHER_DEFAULT_EVENT_BUDGET);
+    }
+}
+
+// 读取监控统计
+void file_watcher_get_stats(const FileWatcher *watcher, FileWatcherStats *stats) {
+    if (!stats) {
+        return;
+    }
+
+    memset(stats, 0, sizeof(FileWatcherStats));
+    if (!watcher) {
+        return;
+    }
+
+    // 统计只用于观察，各项分别读取
+    FileWatcher *w = (FileWatcher*)watcher;
+    stats->events = SDL_GetAtomicInt(&w->events);
+    stats->coalesced_events = SDL_GetAtomicInt(&w->coalesced_events);
+    stats->dropped_events = SDL_GetAtomicInt(&w->dropped_events);
+    stats->overflows = SDL_GetAtomicInt(&w->overflows);
+    stats->rescans = SDL_GetAtomicInt(&w->rescans);
+    stats->batches = SDL_GetAtomicInt(&w->batches);
+}
+
+#else
+
+struct FileWatcher {
+    int id;                      // 监控器编号
+};
+
+// 当前平台不支持目录监控，界面只能手动刷新
+FileWatcher* file_watcher_start(const char *dir_path) {
+    (void)dir_path;
+    return NULL;
+}
+
+// 停止监控并释放
+void file_watcher_stop(FileWatcher *watcher) {
+    free(watcher);
+}
+
+// 当前平台没有事件合并
+void file_watcher_set_event_budget(FileWatcher *watcher, int budget) {
+    (void)watcher;
+    (void)budget;
+}
+
+// 当前平台没有监控统计
+void file_watcher_get_stats(const FileWatcher *watcher, FileWatcherStats *stats) {
+    (void)watcher;
+    if (stats) {
+        memset(stats, 0, sizeof(FileWatcherStats));
+    }
+}
+
+#endif
+
+// 监控器编号（用于丢弃已停止的监控器送来的批次）
+int file_watcher_id(const FileWatcher *watcher) {
+    return watcher ? watcher->id : 0;
+}
+
+// UI线程处理完一批后调用：释放批次并允许监控线程发送下一批
+void file_watcher_batch_done(FileWatcher *watcher, FileWatchBatch *batch) {
+    file_watcher_batch_free(batch);
+#if defined(__linux__)
+    if (watcher) {
+        SDL_SetAtomicInt(&watcher->in_flight, 0);
+    }
+#else
+    (void)watcher;
+#endif
+}
@@ -0,0 +1,1675 @@
+/*
+ * 目录树操作模块
+ * 职责：
+ * 1. 并行遍历目录树：每个线程有自己的目录队列，自己的队列空了就从其它线程的队列窃取
+ * 2. 递归统计、复制、删除目录树，符号链接按链接本身处理，不跟随
+ * 3. POSIX 上通过目录描述符操作（openat、fstatat、unlinkat），不拼接完整路径
+ * 4. 各线程分批汇报进度，回调要求取消时所有线程尽快停止
+ * 5. 批量操作按源目录分组：同一目录下的小文件在一个线程中依次处理，大文件和子目录分给其它线程
+ * 6. 复制目录前按文件标识检查目标是否位于源目录之内（否则会不断进入刚创建的目标）
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "fs_tree.h"
+#include "file_system.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// 每个线程累计到这么多项目或字节时汇报一次进度
+#define FS_TREE_REPORT_ITEMS 256
+#define FS_TREE_REPORT_BYTES (16 * 1024 * 1024)
+// 目录队列的初始容量
+#define FS_TREE_DEQUE_CAPACITY 64
+// 批量复制时超过此大小的文件单独入队，由空闲线程并行复制
+#define FS_TREE_LARGE_FILE (4 * 1024 * 1024)
+// 批量操作中其余文件每多少个一批入队（同一批在一个线程中依次处理）
+#define FS_TREE_BATCH_FILES 128
+
+// 目录树操作类型
+typedef enum {
+    FS_TREE_MEASURE,
+    FS_TREE_COPY,
+    FS_TREE_DELETE
+} FSTreeOp;
+
+// 目录项类型（不跟随符号链接）
+typedef enum {
+    FS_TREE_ENTRY_FILE,      // 普通文件
+    FS_TREE_ENTRY_DIRECTORY, // 目录
+    FS_TREE_ENTRY_LINK,      // 符号链接（Windows 上为文件的重解析点）
+    FS_TREE_ENTRY_DIR_LINK,  // 目录的重解析点（只在 Windows 上出现）
+    FS_TREE_ENTRY_OTHER      // 设备、管道等
+} FSTreeEntryType;
+
+// 队列中的节点类型
+typedef enum {
+    FS_TREE_NODE_DIRECTORY,      // 目录
+    FS_TREE_NODE_GROUP,          // 批量操作中同一源目录下的源路径（不创建、不删除该目录）
+    FS_TREE_NODE_FILES           // 分组中的一批非目录源路径（父节点为分组）
+} FSTreeNodeKind;
+
+// 文件标识（POSIX 为设备号和 inode，Windows 为卷序列号和文件编号），比较目录时不依赖路径字符串
+typedef struct {
+    Uint64 device;
+    Uint64 inode;
+} FSTreeFileId;
+
+// 批量操作中源路径的类型和大小（扫描分组时读取）
+typedef struct {
+    FSTreeEntryType type;
+    Uint64 size;
+    Uint32 attributes;           // 文件属性（Windows）
+    bool valid;                  // 是否读取成功
+    bool queued;                 // 是否已单独入队（子目录、大文件）
+} FSTreeSourceInfo;
+
+// 批量操作中同一源目录下的源路径
+typedef struct {
+    char *parent;                // 源目录路径
+    const char **names;          // 源路径在目录中的名称
+    int *indices;                // 源路径序号
+    FSTreeSourceInfo *info;      // 源路径的类型和大小
+    int count;                   // 源路径数
+    Uint64 device;               // 源目录所在设备（同一设备的分组相邻）
+} FSTreeGroup;
+
+// 目录节点：子目录全部完成后才完成自身（删除时删除空目录，复制时恢复目录权限和时间）
+typedef struct FSTreeNode {
+    struct FSTreeNode *parent;   // 父目录（根为NULL）
+    FSTreeNodeKind kind;         // 节点类型
+    int index;                   // 批量操作的源路径序号（不是源路径时为-1）
+    FSTreeGroup *group;          // 分组节点的源路径
+    int first;                   // 一批文件在分组中的起始位置
+    int count;                   // 一批文件的数量
+    bool large;                  // 是否为单独入队的大文件
+    SDL_AtomicInt pending;       // 未完成的子目录数 + 1（自身的扫描）
+    SDL_AtomicInt incomplete;    // 子树中有失败或跳过的项目（删除时保留目录）
+#ifdef _WIN32
+    char *src_path;              // 源目录的完整路径
+    char *dst_path;              // 目标目录的完整路径（复制时）
+#else
+    int src_fd;                  // 源目录（扫描后保持打开，子目录通过它 openat）
+    int dst_fd;                  // 目标目录（复制时）
+    mode_t mode;                 // 源目录权限（复制完成后设置到目标）
+    struct timespec times[2];    // 源目录的访问、修改时间
+#endif
+    char name[];                 // 在父目录中的名称（根为完整路径）
+} FSTreeNode;
+
+// 线程自己的目录队列：自己从尾部取（深度优先，打开的目录少），窃取者从头部取（靠近根的大子树）
+typedef struct {
+    SDL_Mutex *mutex;
+    FSTreeNode **items;
+    int head;                    // 窃取端
+    int tail;                    // 所有者端
+    int capacity;
+} FSTreeDeque;
+
+struct FSTree;
+
+// 遍历线程
+typedef struct {
+    struct FSTree *tree;
+    FSTreeDeque deque;           // 自己的目录队列
+    SDL_Thread *thread;          // 后台线程（0号为调用线程，为NULL）
+    FSTreeStats stats;           // 本线程的统计
+    Uint64 unreported_bytes;     // 尚未汇报的字节数
+    Uint64 unreported_items;     // 尚未汇报的项目数
+} FSTreeWorker;
+
+// 一次目录树操作
+typedef struct FSTree {
+    FSTreeOp op;
+    const char *dst_root;        // 复制的目标根路径
+    FSTreeProgress progress;     // 进度回调（可为NULL）
+    FSTreeDone done;             // 批量操作中源路径完成的回调（可为NULL）
+    void *user_data;
+    Uint8 *created;              // 批量复制时各源路径是否已创建目标（取消时删除）
+    FSTreeFileId *dst_chain;     // 批量复制的目标目录及其全部上级目录
+    int dst_chain_count;
+    FSTreeWorker workers[FS_TREE_MAX_WORKERS];
+    int worker_count;
+    SDL_AtomicInt outstanding;   // 已入队但尚未扫描完的目录数（为0时遍历结束）
+    SDL_AtomicInt queued;        // 队列中的目录数
+    SDL_AtomicInt idle;          // 等待中的线程数
+    SDL_AtomicInt cancelled;     // 是否已取消
+    SDL_AtomicInt error;         // 第一个错误（FSError，0表示没有）
+    SDL_AtomicInt root_created;  // 复制时是否已创建目标根目录
+    SDL_Mutex *idle_mutex;       // 与 idle_cond 一起让空闲线程等待新目录
+    SDL_Condition *idle_cond;
+} FSTree;
+
+// 把文件标识追加到上级目录链
+static bool fs_tree_chain_add(FSTreeFileId **chain, int *count, int *capacity, FSTreeFileId id) {
+    if (*count >= *capacity) {
+        int grown_capacity = *capacity > 0 ? *capacity * 2 : 16;
+        FSTreeFileId *grown = (FSTreeFileId*)realloc(*chain, sizeof(FSTreeFileId) * (size_t)grown_capacity);
+        if (!grown) {
+            return false;
+        }
+        *chain = grown;
+        *capacity = grown_capacity;
+    }
+    (*chain)[(*count)++] = id;
+    return true;
+}
+
+// 目录是否在上级目录链中
+static bool fs_tree_chain_contains(const FSTreeFileId *chain, int count, FSTreeFileId id) {
+    for (int i = 0; i < count; i++) {
+        if (chain[i].device == id.device && chain[i].inode == id.inode) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 是否已取消
+static bool fs_tree_cancelled(FSTree *tree) {
+    return SDL_GetAtomicInt(&tree->cancelled) != 0;
+}
+
+// 汇报本线程累计的进度，返回是否继续
+static bool fs_tree_flush(FSTreeWorker *worker) {
+    FSTree *tree = worker->tree;
+    if (tree->progress && (worker->unreported_bytes > 0 || worker->unreported_items > 0)) {
+        if (!tree->progress(worker->unreported_bytes, worker->unreported_items, tree->user_data)) {
+            SDL_SetAtomicInt(&tree->cancelled, 1);
+        }
+    }
+    worker->unreported_bytes = 0;
+    worker->unreported_items = 0;
+    return !fs_tree_cancelled(tree);
+}
+
+// 累计进度，达到批量时汇报，返回是否继续
+static bool fs_tree_account(FSTreeWorker *worker, Uint64 bytes, Uint64 items) {
+    worker->unreported_bytes += bytes;
+    worker->unreported_items += items;
+    if (worker->unreported_items >= FS_TREE_REPORT_ITEMS || worker->unreported_bytes >= FS_TREE_REPORT_BYTES) {
+        return fs_tree_flush(worker);
+    }
+    return !fs_tree_cancelled(worker->tree);
+}
+
+// 记录一个失败的项目（当前线程的错误码已由失败的操作设置）
+static void fs_tree_fail(FSTreeWorker *worker, FSTreeNode *node) {
+    FSError error = fs_get_last_error();
+    if (node) {
+        SDL_SetAtomicInt(&node->incomplete, 1);
+    }
+    // 取消导致的失败不算错误
+    if (error == FS_ERROR_CANCELLED && fs_tree_cancelled(worker->tree)) {
+        return;
+    }
+    worker->stats.errors++;
+    SDL_CompareAndSwapAtomicInt(&worker->tree->error, 0, (int)(error != FS_ERROR_NONE ? error : FS_ERROR_UNKNOWN));
+}
+
+// 复制单个文件时的进度回调
+static bool fs_tree_copy_progress(Uint64 copied, void *user_data) {
+    FSTreeWorker *worker = (FSTreeWorker*)user_data;
+    worker->stats.bytes += copied;
+    return fs_tree_account(worker, copied, 0);
+}
+
+// 创建目录节点
+static FSTreeNode* fs_tree_node_new(FSTreeNode *parent, const char *name) {
+    size_t len = strlen(name);
+    FSTreeNode *node = (FSTreeNode*)calloc(1, sizeof(FSTreeNode) + len + 1);
+    if (!node) {
+        return NULL;
+    }
+    node->parent = parent;
+    node->kind = FS_TREE_NODE_DIRECTORY;
+    node->index = -1;
+    SDL_SetAtomicInt(&node->pending, 1);
+#ifndef _WIN32
+    node->src_fd = -1;
+    node->dst_fd = -1;
+#endif
+    memcpy(node->name, name, len + 1);
+    return node;
+}
+
+// 目录入队（由所有者线程调用）
+static bool fs_tree_push(FSTreeWorker *worker, FSTreeNode *node) {
+    FSTree *tree = worker->tree;
+    FSTreeDeque *deque = &worker->deque;
+
+    SDL_LockMutex(deque->mutex);
+    if (deque->tail >= deque->capacity) {
+        if (deque->head > 0) {
+            // 头部被窃取后留下的空位移到尾部
+            memmove(deque->items, deque->items + deque->head, sizeof(FSTreeNode*) * (size_t)(deque->tail - deque->head));
+            deque->tail -= deque->head;
+            deque->head = 0;
+        }
+        if (deque->tail >= deque->capacity) {
+            int capacity = deque->capacity > 0 ? deque->capacity * 2 : FS_TREE_DEQUE_CAPACITY;
+            FSTreeNode **items = (FSTreeNode**)realloc(deque->items, sizeof(FSTreeNode*) * (size_t)capacity);
+            if (!items) {
+                SDL_UnlockMutex(deque->mutex);
+                return false;
+            }
+            deque->items = items;
+            deque->capacity = capacity;
+        }
+    }
+    deque->items[deque->tail++] = node;
+    SDL_UnlockMutex(deque->mutex);
+
+    SDL_AddAtomicInt(&tree->queued, 1);
+    if (SDL_GetAtomicInt(&tree->idle) > 0) {
+        SDL_LockMutex(tree->idle_mutex);
+        SDL_SignalCondition(tree->idle_cond);
+        SDL_UnlockMutex(tree->idle_mutex);
+    }
+    return true;
+}
+
+// 从队列取一个目录（own 为真时从尾部取，否则从头部窃取）
+static FSTreeNode* fs_tree_take(FSTreeDeque *deque, bool own) {
+    FSTreeNode *node = NULL;
+    SDL_LockMutex(deque->mutex);
+    if (deque->head < deque->tail) {
+        node = own ? deque->items[--deque->tail] : deque->items[deque->head++];
+        if (deque->head == deque->tail) {
+            deque->head = 0;
+            deque->tail = 0;
+        }
+    }
+    SDL_UnlockMutex(deque->mutex);
+    return node;
+}
+
+// 先取自己的队列，再依次窃取其它线程的队列
+static FSTreeNode* fs_tree_next(FSTreeWorker *worker) {
+    FSTree *tree = worker->tree;
+    FSTreeNode *node = fs_tree_take(&worker->deque, true);
+    int self = (int)(worker - tree->workers);
+    for (int i = 1; !node && i < tree->worker_count; i++) {
+        node = fs_tree_take(&tree->workers[(self + i) % tree->worker_count].deque, false);
+    }
+    if (node) {
+        SDL_AddAtomicInt(&tree->queued, -1);
+    }
+    return node;
+}
+
+// 处理队列中的节点
+static void fs_tree_process(FSTreeWorker *worker, FSTreeNode *node);
+static void fs_tree_finish(FSTreeWorker *worker, FSTreeNode *node);
+
+// 批量操作中一个源路径完成
+static void fs_tree_done(FSTreeWorker *worker, int index, bool success) {
+    if (index >= 0 && worker->tree->done) {
+        worker->tree->done(index, success, worker->tree->user_data);
+    }
+}
+
+// 扫描完成或子目录完成时调用，计数归零的目录依次向上完成
+static void fs_tree_release(FSTreeWorker *worker, FSTreeNode *node) {
+    while (node && SDL_AddAtomicInt(&node->pending, -1) == 1) {
+        FSTreeNode *parent = node->parent;
+        fs_tree_finish(worker, node);
+        bool incomplete = SDL_GetAtomicInt(&node->incomplete) != 0;
+        if (parent && incomplete) {
+            SDL_SetAtomicInt(&parent->incomplete, 1);
+        }
+        if (node->kind == FS_TREE_NODE_DIRECTORY) {
+            fs_tree_done(worker, node->index, !incomplete && !fs_tree_cancelled(worker->tree));
+        }
+        free(node);
+        node = parent;
+    }
+}
+
+// 子节点入队（入队失败时在当前线程直接处理）
+static void fs_tree_spawn(FSTreeWorker *worker, FSTreeNode *node, FSTreeNode *child) {
+    SDL_AddAtomicInt(&node->pending, 1);
+    SDL_AddAtomicInt(&worker->tree->outstanding, 1);
+    if (!fs_tree_push(worker, child)) {
+        fs_tree_process(worker, child);
+        SDL_AddAtomicInt(&worker->tree->outstanding, -1);
+    }
+}
+
+// 子目录入队（index 为批量操作的源路径序号，目录树中的子目录为-1）
+static void fs_tree_add_child(FSTreeWorker *worker, FSTreeNode *node, const char *name, int index) {
+    FSTreeNode *child = fs_tree_node_new(node, name);
+    if (!child) {
+        fs_set_error(FS_ERROR_UNKNOWN);
+        fs_tree_fail(worker, node);
+        fs_tree_done(worker, index, false);
+        return;
+    }
+    child->index = index;
+    fs_tree_spawn(worker, node, child);
+}
+
+// 批量操作中一个非目录源路径处理完成
+static void fs_tree_source_done(FSTreeWorker *worker, FSTreeNode *group_node, int slot, bool success) {
+    FSTree *tree = worker->tree;
+    int index = group_node->group->indices[slot];
+    if (success && tree->created) {
+        tree->created[index] = 1;
+    } else if (!success) {
+        fs_tree_fail(worker, group_node);
+    }
+    fs_tree_done(worker, index, success);
+}
+
+// 处理一个非目录源路径（平台相关）
+static bool fs_tree_process_source(FSTreeWorker *worker, FSTreeNode *group_node, int slot);
+
+// 处理分组中的一批文件（large 为真时只处理单独入队的大文件，否则跳过它们）
+static void fs_tree_process_files(FSTreeWorker *worker, FSTreeNode *group_node, int first, int count, bool large) {
+    FSTreeSourceInfo *info = group_node->group->info;
+    for (int slot = first; slot < first + count && !fs_tree_cancelled(worker->tree); slot++) {
+        if (info[slot].valid && info[slot].type != FS_TREE_ENTRY_DIRECTORY && info[slot].queued == large) {
+            fs_tree_source_done(worker, group_node, slot, fs_tree_process_source(worker, group_node, slot));
+        }
+    }
+}
+
+// 一批文件入队（内存不足时在当前线程直接处理）
+static void fs_tree_add_files(FSTreeWorker *worker, FSTreeNode *group_node, int first, int count, bool large) {
+    FSTreeNode *child = fs_tree_node_new(group_node, "");
+    if (!child) {
+        fs_tree_process_files(worker, group_node, first, count, large);
+        return;
+    }
+    child->kind = FS_TREE_NODE_FILES;
+    child->first = first;
+    child->count = count;
+    child->large = large;
+    fs_tree_spawn(worker, group_node, child);
+}
+
+// 大文件排序项
+typedef struct {
+    Uint64 size;
+    int slot;
+} FSTreeLargeFile;
+
+// 按大小从大到小排序
+static int fs_tree_compare_large(const void *a, const void *b) {
+    const FSTreeLargeFile *x = (const FSTreeLargeFile*)a;
+    const FSTreeLargeFile *y = (const FSTreeLargeFile*)b;
+    if (x->size != y->size) {
+        return x->size < y->size ? 1 : -1;
+    }
+    return x->slot - y->slot;
+}
+
+// 分组中的源路径读取属性后分配给各线程：
+// 大文件先入队（从大到小，窃取者从队头先取走最大的，各自并行复制），然后是子目录，
+// 其余文件按批入队，同一批在一个线程中依次处理，共用分组打开的源目录和目标目录
+static void fs_tree_schedule_group(FSTreeWorker *worker, FSTreeNode *node) {
+    FSTree *tree = worker->tree;
+    FSTreeGroup *group = node->group;
+    FSTreeSourceInfo *info = group->info;
+
+    if (tree->op == FS_TREE_COPY) {
+        FSTreeLargeFile *large = (FSTreeLargeFile*)malloc(sizeof(FSTreeLargeFile) * (size_t)group->count);
+        if (large) {
+            int large_count = 0;
+            for (int i = 0; i < group->count; i++) {
+                if (info[i].valid && info[i].type == FS_TREE_ENTRY_FILE && info[i].size >= FS_TREE_LARGE_FILE) {
+                    large[large_count].size = info[i].size;
+                    large[large_count].slot = i;
+                    large_count++;
+                }
+            }
+            qsort(large, (size_t)large_count, sizeof(FSTreeLargeFile), fs_tree_compare_large);
+            for (int i = 0; i < large_count; i++) {
+                info[large[i].slot].queued = true;
+                fs_tree_add_files(worker, node, large[i].slot, 1, true);
+            }
+            free(large);
+        }
+    }
+
+    for (int i = 0; i < group->count; i++) {
+        if (info[i].valid && info[i].type == FS_TREE_ENTRY_DIRECTORY) {
+            info[i].queued = true;
+            fs_tree_add_child(worker, node, group->names[i], group->indices[i]);
+        }
+    }
+
+    for (int first = 0; first < group->count; first += FS_TREE_BATCH_FILES) {
+        int count = group->count - first < FS_TREE_BATCH_FILES ? group->count - first : FS_TREE_BATCH_FILES;
+        for (int i = first; i < first + count; i++) {
+            if (info[i].valid && !info[i].queued) {
+                fs_tree_add_files(worker, node, first, count, false);
+                break;
+            }
+        }
+    }
+}
+
+// 遍历线程主循环
+static void fs_tree_work(FSTreeWorker *worker) {
+    FSTree *tree = worker->tree;
+
+    for (;;) {
+        FSTreeNode *node = fs_tree_next(worker);
+        if (node) {
+            fs_tree_process(worker, node);
+            if (SDL_AddAtomicInt(&tree->outstanding, -1) == 1) {
+                // 最后一个目录扫描完成，唤醒所有空闲线程退出
+                SDL_LockMutex(tree->idle_mutex);
+                SDL_BroadcastCondition(tree->idle_cond);
+                SDL_UnlockMutex(tree->idle_mutex);
+            }
+            continue;
+        }
+        if (SDL_GetAtomicInt(&tree->outstanding) == 0) {
+            break;
+        }
+
+        // 没有可取的目录但其它线程还在扫描，等待它们发现新的子目录
+        SDL_LockMutex(tree->idle_mutex);
+        SDL_AddAtomicInt(&tree->idle, 1);
+        while (SDL_GetAtomicInt(&tree->queued) == 0 && SDL_GetAtomicInt(&tree->outstanding) > 0) {
+            SDL_WaitCondition(tree->idle_cond, tree->idle_mutex);
+        }
+        SDL_AddAtomicInt(&tree->idle, -1);
+        SDL_UnlockMutex(tree->idle_mutex);
+    }
+
+    fs_tree_flush(worker);
+}
+
+// 后台遍历线程入口
+static int SDLCALL fs_tree_worker_main(void *data) {
+    fs_tree_work((FSTreeWorker*)data);
+    return 0;
+}
+
+#ifdef _WIN32
+// 拼接路径（Windows 没有按目录句柄操作的接口）
+static char* fs_tree_join(const char *dir, const char *name) {
+    size_t dir_len = strlen(dir);
+    size_t name_len = strlen(name);
+    char *path = (char*)malloc(dir_len + name_len + 2);
+    if (!path) {
+        return NULL;
+    }
+    memcpy(path, dir, dir_len);
+    size_t pos = dir_len;
+    if (pos > 0 && path[pos - 1] != '\\' && path[pos - 1] != '/') {
+        path[pos++] = '\\';
+    }
+    memcpy(path + pos, name, name_len + 1);
+    return path;
+}
+
+// 读取文件标识（目录需要 FILE_FLAG_BACKUP_SEMANTICS 才能打开）
+static bool fs_tree_file_id(const char *path, FSTreeFileId *id) {
+    HANDLE handle = CreateFileA(path, FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    BY_HANDLE_FILE_INFORMATION info;
+    bool ok = GetFileInformationByHandle(handle, &info) != 0;
+    CloseHandle(handle);
+    if (ok) {
+        id->device = info.dwVolumeSerialNumber;
+        id->inode = ((Uint64)info.nFileIndexHigh << 32) | info.nFileIndexLow;
+    }
+    return ok;
+}
+
+// 读取目录及其全部上级目录的标识：先取得解析链接后的实际路径，再逐级去掉最后一段
+// 无法读取的上级目录及其以上不在链中
+static bool fs_tree_read_chain(const char *dir, FSTreeFileId **chain, int *count) {
+    *chain = NULL;
+    *count = 0;
+    HANDLE handle = CreateFileA(dir, FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        fs_set_error_from_win32(GetLastError());
+        return false;
+    }
+    const DWORD size = 32768;
+    char *path = (char*)malloc(size);
+    DWORD len = path ? GetFinalPathNameByHandleA(handle, path, size, FILE_NAME_NORMALIZED) : 0;
+    CloseHandle(handle);
+    if (len == 0 || len >= size) {
+        free(path);
+        fs_set_error(FS_ERROR_UNKNOWN);
+        return false;
+    }
+
+    int capacity = 0;
+    for (;;) {
+        FSTreeFileId id;
+        if (!fs_tree_file_id(path, &id)) {
+            break;
+        }
+        if (!fs_tree_chain_add(chain, count, &capacity, id)) {
+            free(*chain);
+            *chain = NULL;
+            *count = 0;
+            free(path);
+            fs_set_error(FS_ERROR_UNKNOWN);
+            return false;
+        }
+
+        // 已到盘符根目录（"\\?\C:\"）时结束，去掉最后一段时保留根目录末尾的分隔符
+        len = (DWORD)strlen(path);
+        if (len >= 2 && path[len - 1] == '\\' && path[len - 2] == ':') {
+            break;
+        }
+        char *sep = strrchr(path, '\\');
+        if (!sep) {
+            break;
+        }
+        if (sep > path && sep[-1] == ':') {
+            sep[1] = '\0';
+        } else {
+            *sep = '\0';
+        }
+    }
+    free(path);
+    return true;
+}
+
+// 由文件属性判断目录项类型（重解析点不跟随）
+static FSTreeEntryType fs_tree_entry_type(DWORD attributes) {
+    if (attributes & FILE_ATTRIBUTE_REPARSE_POINT) {
+        return (attributes & FILE_ATTRIBUTE_DIRECTORY) ? FS_TREE_ENTRY_DIR_LINK : FS_TREE_ENTRY_LINK;
+    }
+    return (attributes & FILE_ATTRIBUTE_DIRECTORY) ? FS_TREE_ENTRY_DIRECTORY : FS_TREE_ENTRY_FILE;
+}
+
+// 处理一个非目录项
+static bool fs_tree_entry(FSTreeWorker *worker, const char *src, const char *dst,
+                          FSTreeEntryType type, DWORD attributes, Uint64 size) {
+    FSTree *tree = worker->tree;
+    bool success = true;
+
+    switch (tree->op) {
+        case FS_TREE_MEASURE:
+            if (type == FS_TREE_ENTRY_FILE) {
+                worker->stats.bytes += size;
+            }
+            break;
+        case FS_TREE_DELETE:
+            if (type == FS_TREE_ENTRY_DIR_LINK) {
+                // 删除链接本身，不进入链接指向的目录
+                success = RemoveDirectoryA(src);
+            } else {
+                // 只读文件先去掉只读属性才能删除
+                if (attributes & FILE_ATTRIBUTE_READONLY) {
+                    DWORD cleared = attributes & ~FILE_ATTRIBUTE_READONLY;
+                    SetFileAttributesA(src, cleared ? cleared : FILE_ATTRIBUTE_NORMAL);
+                }
+                success = DeleteFileA(src);
+            }
+            if (!success) {
+                fs_set_error_from_win32(GetLastError());
+            }
+            break;
+        case FS_TREE_COPY:
+            if (type == FS_TREE_ENTRY_FILE) {
+                success = fs_copy_file_ex(src, dst, fs_tree_copy_progress, worker);
+            } else if (type == FS_TREE_ENTRY_LINK) {
+                success = CopyFileExA(src, dst, NULL, NULL, NULL, COPY_FILE_COPY_SYMLINK);
+                if (!success) {
+                    fs_set_error_from_win32(GetLastError());
+                }
+            } else {
+                // 目录链接需要读取重解析数据才能重建，暂不支持
+                fs_set_error(FS_ERROR_INVALID_NAME);
+                success = false;
+            }
+            break;
+    }
+
+    if (success) {
+        worker->stats.files++;
+        fs_tree_account(worker, tree->op == FS_TREE_MEASURE ? size : 0, 1);
+    }
+    return success;
+}
+
+// 打开并扫描一个目录
+static void fs_tree_process_directory(FSTreeWorker *worker, FSTreeNode *node) {
+    FSTree *tree = worker->tree;
+
+    node->src_path = node->parent ? fs_tree_join(node->parent->src_path, node->name) : _strdup(node->name);
+    if (tree->op == FS_TREE_COPY) {
+        node->dst_path = node->parent ? fs_tree_join(node->parent->dst_path, node->name) : _strdup(tree->dst_root);
+    }
+    if (!node->src_path || (tree->op == FS_TREE_COPY && !node->dst_path)) {
+        fs_set_error(FS_ERROR_UNKNOWN);
+        fs_tree_fail(worker, node);
+        fs_tree_release(worker, node);
+        return;
+    }
+    if (fs_tree_cancelled(tree)) {
+        SDL_SetAtomicInt(&node->incomplete, 1);
+        fs_tree_release(worker, node);
+        return;
+    }
+
+    // 复制时先创建目标目录（同时复制目录属性）
+    if (tree->op == FS_TREE_COPY) {
+        if (!CreateDirectoryExA(node->src_path, node->dst_path, NULL)) {
+            fs_set_error_from_win32(GetLastError());
+            fs_tree_fail(worker, node);
+            fs_tree_release(worker, node);
+            return;
+        }
+        if (!node->parent) {
+            SDL_SetAtomicInt(&tree->root_created, 1);
+        } else if (node->index >= 0 && tree->created) {
+            tree->created[node->index] = 1;
+        }
+    }
+
+    char *pattern = fs_tree_join(node->src_path, "*");
+    WIN32_FIND_DATAA data;
+    HANDLE find = pattern ? FindFirstFileExA(pattern, FindExInfoBasic, &data, FindExSearchNameMatch,
+                                             NULL, FIND_FIRST_EX_LARGE_FETCH)
+                          : INVALID_HANDLE_VALUE;
+    free(pattern);
+    if (find == INVALID_HANDLE_VALUE) {
+        fs_set_error_from_win32(GetLastError());
+        fs_tree_fail(worker, node);
+        fs_tree_release(worker, node);
+        return;
+    }
+
+    do {
+        const char *name = data.cFileName;
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+            continue;
+        }
+
+        FSTreeEntryType type = fs_tree_entry_type(data.dwFileAttributes);
+        if (type == FS_TREE_ENTRY_DIRECTORY) {
+            fs_tree_add_child(worker, node, name, -1);
+            continue;
+        }
+
+        char *src = fs_tree_join(node->src_path, name);
+        char *dst = tree->op == FS_TREE_COPY ? fs_tree_join(node->dst_path, name) : NULL;
+        Uint64 size = ((Uint64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+        if (!src || (tree->op == FS_TREE_COPY && !dst)) {
+            fs_set_error(FS_ERROR_UNKNOWN);
+            fs_tree_fail(worker, node);
+        } else if (!fs_tree_entry(worker, src, dst, type, data.dwFileAttributes, size)) {
+            fs_tree_fail(worker, node);
+        }
+        free(src);
+        free(dst);
+    } while (!fs_tree_cancelled(tree) && FindNextFileA(find, &data));
+    FindClose(find);
+
+    worker->stats.directories++;
+    fs_tree_account(worker, 0, 1);
+    fs_tree_release(worker, node);
+}
+
+// 子目录全部完成后完成目录
+static void fs_tree_finish(FSTreeWorker *worker, FSTreeNode *node) {
+    if (worker->tree->op == FS_TREE_DELETE && node->kind == FS_TREE_NODE_DIRECTORY && node->src_path &&
+        !SDL_GetAtomicInt(&node->incomplete) && !fs_tree_cancelled(worker->tree)) {
+        if (!RemoveDirectoryA(node->src_path)) {
+            fs_set_error_from_win32(GetLastError());
+            fs_tree_fail(worker, node);
+        }
+    }
+    free(node->src_path);
+    free(node->dst_path);
+}
+
+// 打开分组并读取各源路径的属性，源目录无效时返回 false
+static bool fs_tree_scan_group(FSTreeWorker *worker, FSTreeNode *node) {
+    FSTree *tree = worker->tree;
+    FSTreeGroup *group = node->group;
+
+    node->src_path = _strdup(group->parent);
+    node->dst_path = tree->op == FS_TREE_COPY ? _strdup(tree->dst_root) : NULL;
+    if (!node->src_path || (tree->op == FS_TREE_COPY && !node->dst_path)) {
+        fs_set_error(FS_ERROR_UNKNOWN);
+        return false;
+    }
+    DWORD attributes = GetFileAttributesA(node->src_path);
+    if (attributes == INVALID_FILE_ATTRIBUTES || !(attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+        fs_set_error_from_win32(attributes == INVALID_FILE_ATTRIBUTES ? GetLastError() : ERROR_DIRECTORY);
+        return false;
+    }
+
+    for (int i = 0; i < group->count && !fs_tree_cancelled(tree); i++) {
+        char *src = fs_tree_join(node->src_path, group->names[i]);
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (!src || !GetFileAttributesExA(src, GetFileExInfoStandard, &data)) {
+            if (src) {
+                fs_set_error_from_win32(GetLastError());
+            } else {
+                fs_set_error(FS_ERROR_UNKNOWN);
+            }
+            fs_tree_fail(worker, node);
+            fs_tree_done(worker, group->indices[i], false);
+            free(src);
+            continue;
+        }
+
+        FSTreeEntryType type = fs_tree_entry_type(data.dwFileAttributes);
+        FSTreeFileId id;
+        if (type == FS_TREE_ENTRY_DIRECTORY && tree->dst_chain_count > 0 && fs_tree_file_id(src, &id) &&
+            fs_tree_chain_contains(tree->dst_chain, tree->dst_chain_count, id)) {
+            fs_set_error(FS_ERROR_TARGET_INSIDE_SOURCE);
+            fs_tree_fail(worker, node);
+            fs_tree_done(worker, group->indices[i], false);
+        } else {
+            FSTreeSourceInfo *info = &group->info[i];
+            info->type = type;
+            info->size = ((Uint64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+            info->attributes = data.dwFileAttributes;
+            info->valid = true;
+        }
+        free(src);
+    }
+    return true;
+}
+
+// 处理一个非目录源路径
+static bool fs_tree_process_source(FSTreeWorker *worker, FSTreeNode *group_node, int slot) {
+    FSTreeGroup *group = group_node->group;
+    FSTreeSourceInfo *info = &group->info[slot];
+    char *src = fs_tree_join(group_node->src_path, group->names[slot]);
+    char *dst = group_node->dst_path ? fs_tree_join(group_node->dst_path, group->names[slot]) : NULL;
+
+    bool success = false;
+    if (!src || (group_node->dst_path && !dst)) {
+        fs_set_error(FS_ERROR_UNKNOWN);
+    } else {
+        success = fs_tree_entry(worker, src, dst, info->type, info->attributes, info->size);
+    }
+    free(src);
+    free(dst);
+    return success;
+}
+
+// 根路径不是目录时直接处理，返回 false 表示是目录
+static bool fs_tree_single(FSTreeWorker *worker, const char *path, bool *success) {
+    DWORD attributes = GetFileAttributesA(path);
+    if (attributes == INVALID_FILE_ATTRIBUTES) {
+        fs_set_error_from_win32(GetLastError());
+        fs_tree_fail(worker, NULL);
+        *success = false;
+        return true;
+    }
+
+    FSTreeEntryType type = fs_tree_entry_type(attributes);
+    if (type == FS_TREE_ENTRY_DIRECTORY) {
+        return false;
+    }
+
+    Uint64 size = 0;
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (type == FS_TREE_ENTRY_FILE && GetFileAttributesExA(path, GetFileExInfoStandard, &data)) {
+        size = ((Uint64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+    }
+    *success = fs_tree_entry(worker, path, worker->tree->dst_root, type, attributes, size);
+    if (!*success) {
+        fs_tree_fail(worker, NULL);
+    }
+    return true;
+}
+#else
+// 读取目录及其全部上级目录的标识（从目录本身逐级打开 ".."，符号链接和相对路径都按实际位置处理）
+// 无法打开的上级目录及其以上不在链中
+static bool fs_tree_read_chain(const char *dir, FSTreeFileId **chain, int *count) {
+#ifdef O_PATH
+    const int flags = O_PATH | O_DIRECTORY | O_CLOEXEC;
+#else
+    const int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC;
+#endif
+    *chain = NULL;
+    *count = 0;
+    int fd = open(dir, flags);
+    if (fd < 0) {
+        fs_set_error_from_errno();
+        return false;
+    }
+
+    int capacity = 0;
+    while (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            break;
+        }
+        // 根目录的上级是它自己
+        FSTreeFileId id = {(Uint64)st.st_dev, (Uint64)st.st_ino};
+        if (*count > 0 && (*chain)[*count - 1].device == id.device && (*chain)[*count - 1].inode == id.inode) {
+            break;
+        }
+        if (!fs_tree_chain_add(chain, count, &capacity, id)) {
+            close(fd);
+            free(*chain);
+            *chain = NULL;
+            *count = 0;
+            fs_set_error(FS_ERROR_UNKNOWN);
+            return false;
+        }
+        int parent = openat(fd, "..", flags);
+        close(fd);
+        fd = parent;
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    return true;
+}
+
+// 读取文件标识（不跟随符号链接）
+static bool fs_tree_file_id(const char *path, FSTreeFileId *id) {
+    struct stat st;
+    if (fstatat(AT_FDCWD, path, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+        return false;
+    }
+    id->device = (Uint64)st.st_dev;
+    id->inode = (Uint64)st.st_ino;
+    return true;
+}
+
+// 目录项类型（文件系统不提供类型时读取属性）
+static FSTreeEntryType fs_tree_entry_type(int dir_fd, const struct dirent *entry, struct stat *st, bool *have_stat) {
+    *have_stat = false;
+#ifdef DT_UNKNOWN
+    switch (entry->d_type) {
+        case DT_DIR:
+            return FS_TREE_ENTRY_DIRECTORY;
+        case DT_REG:
+            return FS_TREE_ENTRY_FILE;
+        case DT_LNK:
+            return FS_TREE_ENTRY_LINK;
+        case DT_UNKNOWN:
+            break;
+        default:
+            return FS_TREE_ENTRY_OTHER;
+    }
+#endif
+    if (fstatat(dir_fd, entry->d_name, st, AT_SYMLINK_NOFOLLOW) != 0) {
+        return FS_TREE_ENTRY_OTHER;
+    }
+    *have_stat = true;
+    if (S_ISDIR(st->st_mode)) {
+        return FS_TREE_ENTRY_DIRECTORY;
+    }
+    if (S_ISREG(st->st_mode)) {
+        return FS_TREE_ENTRY_FILE;
+    }
+    return S_ISLNK(st->st_mode) ? FS_TREE_ENTRY_LINK : FS_TREE_ENTRY_OTHER;
+}
+
+// 复制符号链接本身（链接目标原样保留）
+static bool fs_tree_copy_link(int src_dir, const char *src_name, int dst_dir, const char *dst_name,
+                              const struct stat *st) {
+    size_t size = st->st_size > 0 ? (size_t)st->st_size + 1 : 4096;
+    char *target = (char*)malloc(size);
+    if (!target) {
+        fs_set_error(FS_ERROR_UNKNOWN);
+        return false;
+    }
+
+    ssize_t len = readlinkat(src_dir, src_name, target, size);
+    if (len < 0 || (size_t)len >= size) {
+        // 链接在读取期间被修改
+        if (len >= 0) {
+            errno = EINVAL;
+        }
+        fs_set_error_from_errno();
+        free(target);
+        return false;
+    }
+    target[len] = '\0';
+
+    bool success = symlinkat(target, dst_dir, dst_name) == 0;
+    if (success) {
+        struct timespec times[2] = {st->st_atim, st->st_mtim};
+        utimensat(dst_dir, dst_name, times, AT_SYMLINK_NOFOLLOW);
+    } else {
+        fs_set_error_from_errno();
+    }
+    free(target);
+    return success;
+}
+
+// 处理一个非目录项（src_dir/dst_dir 为所在目录，根项目为 AT_FDCWD）
+static bool fs_tree_entry(FSTreeWorker *worker, int src_dir, const char *src_name, int dst_dir, const char *dst_name,
+                          FSTreeEntryType type, struct stat *st, bool have_stat) {
+    FSTree *tree = worker->tree;
+    bool success = true;
+    Uint64 size = 0;
+
+    // 统计大小和复制链接需要属性
+    bool need_stat = (tree->op == FS_TREE_MEASURE && type == FS_TREE_ENTRY_FILE) ||
+                     (tree->op == FS_TREE_COPY && type == FS_TREE_ENTRY_LINK);
+    if (need_stat && !have_stat && fstatat(src_dir, src_name, st, AT_SYMLINK_NOFOLLOW) != 0) {
+        fs_set_error_from_errno();
+        return false;
+    }
+
+    switch (tree->op) {
+        case FS_TREE_MEASURE:
+            if (type == FS_TREE_ENTRY_FILE) {
+                size = (Uint64)st->st_size;
+                worker->stats.bytes += size;
+            }
+            break;
+        case FS_TREE_DELETE:
+            // 符号链接只删除链接本身
+            success = unlinkat(src_dir, src_name, 0) == 0;
+            if (!success) {
+                fs_set_error_from_errno();
+            }
+            break;
+        case FS_TREE_COPY:
+            if (type == FS_TREE_ENTRY_FILE) {
+                success = fs_copy_file_at(src_dir, src_name, dst_dir, dst_name, fs_tree_copy_progress, worker);
+            } else if (type == FS_TREE_ENTRY_LINK) {
+                success = fs_tree_copy_link(src_dir, src_name, dst_dir, dst_name, st);
+            } else {
+                // 设备、管道等特殊文件不复制
+                fs_set_error(FS_ERROR_INVALID_NAME);
+                success = false;
+            }
+            break;
+    }
+
+    if (success) {
+        worker->stats.files++;
+        fs_tree_account(worker, size, 1);
+    }
+    return success;
+}
+
+// 打开并扫描一个目录
+static void fs_tree_process_directory(FSTreeWorker *worker, FSTreeNode *node) {
+    FSTree *tree = worker->tree;
+    if (fs_tree_cancelled(tree)) {
+        SDL_SetAtomicInt(&node->incomplete, 1);
+        fs_tree_release(worker, node);
+        return;
+    }
+
+    int parent_src = node->parent ? node->parent->src_fd : AT_FDCWD;
+    node->src_fd = openat(parent_src, node->name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (node->src_fd < 0) {
+        fs_set_error_from_errno();
+        fs_tree_fail(worker, node);
+        fs_tree_release(worker, node);
+        return;
+    }
+
+    // 复制时先创建目标目录（先允许写入，完成后再设置源目录的权限）
+    if (tree->op == FS_TREE_COPY) {
+        struct stat st;
+        int parent_dst = node->parent ? node->parent->dst_fd : AT_FDCWD;
+        const char *dst_name = node->parent ? node->name : tree->dst_root;
+        bool created = fstat(node->src_fd, &st) == 0 && mkdirat(parent_dst, dst_name, 0700) == 0;
+        if (created && !node->parent) {
+            SDL_SetAtomicInt(&tree->root_created, 1);
+        } else if (created && node->index >= 0 && tree->created) {
+            tree->created[node->index] = 1;
+        }
+        if (created) {
+            node->dst_fd = openat(parent_dst, dst_name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        }
+        if (node->dst_fd < 0) {
+            fs_set_error_from_errno();
+            fs_tree_fail(worker, node);
+            fs_tree_release(worker, node);
+            return;
+        }
+        node->mode = st.st_mode;
+        node->times[0] = st.st_atim;
+        node->times[1] = st.st_mtim;
+    }
+
+    // 扫描用复制的描述符，原描述符保持打开直到子目录全部完成
+    int scan_fd = fcntl(node->src_fd, F_DUPFD_CLOEXEC, 0);
+    DIR *dir = scan_fd >= 0 ? fdopendir(scan_fd) : NULL;
+    if (!dir) {
+        fs_set_error_from_errno();
+        if (scan_fd >= 0) {
+            close(scan_fd);
+        }
+        fs_tree_fail(worker, node);
+        fs_tree_release(worker, node);
+        return;
+    }
+
+    struct dirent *entry;
+    while (!fs_tree_cancelled(tree) && (entry = readdir(dir)) != NULL) {
+        const char *name = entry->d_name;
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+            continue;
+        }
+
+        struct stat st;
+        bool have_stat;
+        FSTreeEntryType type = fs_tree_entry_type(node->src_fd, entry, &st, &have_stat);
+        if (type == FS_TREE_ENTRY_DIRECTORY) {
+            fs_tree_add_child(worker, node, name, -1);
+        } else if (!fs_tree_entry(worker, node->src_fd, name, node->dst_fd, name, type, &st, have_stat)) {
+            fs_tree_fail(worker, node);
+        }
+    }
+    closedir(dir);
+
+    worker->stats.directories++;
+    fs_tree_account(worker, 0, 1);
+    fs_tree_release(worker, node);
+}
+
+// 子目录全部完成后完成目录
+static void fs_tree_finish(FSTreeWorker *worker, FSTreeNode *node) {
+    FSTree *tree = worker->tree;
+
+    bool directory = node->kind == FS_TREE_NODE_DIRECTORY;
+    if (node->dst_fd >= 0) {
+        // 恢复源目录的权限和时间（在目录内容写完之后，否则修改时间会被覆盖）
+        if (directory && (fchmod(node->dst_fd, node->mode & 07777) != 0 || futimens(node->dst_fd, node->times) != 0)) {
+            fs_set_error_from_errno();
+            fs_tree_fail(worker, node);
+        }
+        close(node->dst_fd);
+    }
+    if (node->src_fd < 0) {
+        return;
+    }
+    close(node->src_fd);
+
+    if (tree->op == FS_TREE_DELETE && directory && !SDL_GetAtomicInt(&node->incomplete) && !fs_tree_cancelled(tree)) {
+        int parent_src = node->parent ? node->parent->src_fd : AT_FDCWD;
+        if (unlinkat(parent_src, node->name, AT_REMOVEDIR) != 0) {
+            fs_set_error_from_errno();
+            fs_tree_fail(worker, node);
+        }
+    }
+}
+
+// 打开分组并读取各源路径的属性，源目录无效时返回 false
+static bool fs_tree_scan_group(FSTreeWorker *worker, FSTreeNode *node) {
+    FSTree *tree = worker->tree;
+    FSTreeGroup *group = node->group;
+
+    node->src_fd = open(group->parent, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (node->src_fd < 0) {
+        fs_set_error_from_errno();
+        return false;
+    }
+    if (tree->op == FS_TREE_COPY) {
+        node->dst_fd = open(tree->dst_root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (node->dst_fd < 0) {
+            fs_set_error_from_errno();
+            return false;
+        }
+    }
+
+    for (int i = 0; i < group->count && !fs_tree_cancelled(tree); i++) {
+        struct stat st;
+        if (fstatat(node->src_fd, group->names[i], &st, AT_SYMLINK_NOFOLLOW) != 0) {
+            fs_set_error_from_errno();
+            fs_tree_fail(worker, node);
+            fs_tree_done(worker, group->indices[i], false);
+            continue;
+        }
+        FSTreeFileId id = {(Uint64)st.st_dev, (Uint64)st.st_ino};
+        if (S_ISDIR(st.st_mode) && fs_tree_chain_contains(tree->dst_chain, tree->dst_chain_count, id)) {
+            fs_set_error(FS_ERROR_TARGET_INSIDE_SOURCE);
+            fs_tree_fail(worker, node);
+            fs_tree_done(worker, group->indices[i], false);
+            continue;
+        }
+        FSTreeSourceInfo *info = &group->info[i];
+        info->type = S_ISDIR(st.st_mode) ? FS_TREE_ENTRY_DIRECTORY :
+                     S_ISREG(st.st_mode) ? FS_TREE_ENTRY_FILE :
+                     S_ISLNK(st.st_mode) ? FS_TREE_ENTRY_LINK : FS_TREE_ENTRY_OTHER;
+        info->size = (Uint64)st.st_size;
+        info->valid = true;
+    }
+    return true;
+}
+
+// 处理一个非目录源路径（通过分组打开的目录操作）
+static bool fs_tree_process_source(FSTreeWorker *worker, FSTreeNode *group_node, int slot) {
+    FSTreeGroup *group = group_node->group;
+    FSTreeSourceInfo *info = &group->info[slot];
+    const char *name = group->names[slot];
+
+    // 普通文件只用到扫描时读取的大小，符号链接复制时重新读取属性
+    struct stat st;
+    memset(&st, 0, sizeof(st));
+    st.st_size = (off_t)info->size;
+    return fs_tree_entry(worker, group_node->src_fd, name, group_node->dst_fd, name,
+                         info->type, &st, info->type == FS_TREE_ENTRY_FILE);
+}
+
+// 根路径不是目录时直接处理，返回 false 表示是目录
+static bool fs_tree_single(FSTreeWorker *worker, const char *path, bool *success) {
+    struct stat st;
+    if (fstatat(AT_FDCWD, path, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+        fs_set_error_from_errno();
+        fs_tree_fail(worker, NULL);
+        *success = false;
+        return true;
+    }
+    if (S_ISDIR(st.st_mode)) {
+        return false;
+    }
+
+    FSTreeEntryType type = S_ISREG(st.st_mode) ? FS_TREE_ENTRY_FILE :
+                           S_ISLNK(st.st_mode) ? FS_TREE_ENTRY_LINK : FS_TREE_ENTRY_OTHER;
+    *success = fs_tree_entry(worker, AT_FDCWD, path, AT_FDCWD, worker->tree->dst_root, type, &st, true);
+    if (!*success) {
+        fs_tree_fail(worker, NULL);
+    }
+    return true;
+}
+#endif
+
+// 打开分组，读取属性后分配给各线程
+static void fs_tree_process_group(FSTreeWorker *worker, FSTreeNode *node) {
+    FSTreeGroup *group = node->group;
+    if (!fs_tree_cancelled(worker->tree)) {
+        if (fs_tree_scan_group(worker, node)) {
+            fs_tree_schedule_group(worker, node);
+        } else {
+            // 源目录或目标目录无法打开，分组中的源路径全部失败
+            for (int i = 0; i < group->count; i++) {
+                fs_tree_fail(worker, node);
+                fs_tree_done(worker, group->indices[i], false);
+            }
+        }
+    }
+    fs_tree_release(worker, node);
+}
+
+// 处理队列中的节点
+static void fs_tree_process(FSTreeWorker *worker, FSTreeNode *node) {
+    switch (node->kind) {
+        case FS_TREE_NODE_GROUP:
+            fs_tree_process_group(worker, node);
+            break;
+        case FS_TREE_NODE_FILES:
+            fs_tree_process_files(worker, node->parent, node->first, node->count, node->large);
+            fs_tree_release(worker, node);
+            break;
+        default:
+            fs_tree_process_directory(worker, node);
+            break;
+    }
+}
+
+// 放弃未能入队的根节点（分组中的源路径全部失败）
+static void fs_tree_abandon(FSTreeWorker *worker, FSTreeNode *node) {
+    fs_set_error(FS_ERROR_UNKNOWN);
+    if (node->kind == FS_TREE_NODE_GROUP) {
+        for (int i = 0; i < node->group->count; i++) {
+            fs_tree_fail(worker, NULL);
+            fs_tree_done(worker, node->group->indices[i], false);
+        }
+    } else {
+        fs_tree_fail(worker, NULL);
+    }
+    free(node);
+}
+
+// 启动遍历线程处理根节点，返回时全部线程已退出
+static void fs_tree_execute(FSTree *tree, FSTreeNode **roots, int root_count) {
+    // 按核心数并行遍历（目录操作以IO为主，线程数有上限）
+    // 不使用共享线程池：一次遍历可能持续几分钟，期间会占住线程池，排序只能在调用线程中执行
+    int workers = SDL_GetNumLogicalCPUCores();
+    if (workers > FS_TREE_MAX_WORKERS) {
+        workers = FS_TREE_MAX_WORKERS;
+    }
+    if (workers < 1) {
+        workers = 1;
+    }
+
+    tree->idle_mutex = SDL_CreateMutex();
+    tree->idle_cond = SDL_CreateCondition();
+    tree->worker_count = workers;
+    bool ready = tree->idle_mutex && tree->idle_cond;
+    for (int i = 0; i < workers; i++) {
+        tree->workers[i].tree = tree;
+        tree->workers[i].deque.mutex = SDL_CreateMutex();
+        ready = ready && tree->workers[i].deque.mutex;
+    }
+
+    if (!ready) {
+        for (int i = 0; i < root_count; i++) {
+            fs_tree_abandon(&tree->workers[0], roots[i]);
+        }
+    } else {
+        // 根节点全部放入0号线程的队列，其它线程启动后窃取
+        for (int i = 0; i < root_count; i++) {
+            SDL_AddAtomicInt(&tree->outstanding, 1);
+            if (!fs_tree_push(&tree->workers[0], roots[i])) {
+                SDL_AddAtomicInt(&tree->outstanding, -1);
+                fs_tree_abandon(&tree->workers[0], roots[i]);
+            }
+        }
+
+        // 线程创建失败时用已创建的线程继续（没有线程的队列始终为空）
+        for (int i = 1; i < workers; i++) {
+            tree->workers[i].thread = SDL_CreateThread(fs_tree_worker_main, "fs_tree", &tree->workers[i]);
+            if (!tree->workers[i].thread) {
+                printf("[ERROR] Failed to create tree worker: %s\n", SDL_GetError());
+                break;
+            }
+        }
+        fs_tree_work(&tree->workers[0]);
+        for (int i = 1; i < workers; i++) {
+            if (tree->workers[i].thread) {
+                SDL_WaitThread(tree->workers[i].thread, NULL);
+            }
+        }
+    }
+
+    for (int i = 0; i < workers; i++) {
+        free(tree->workers[i].deque.items);
+        if (tree->workers[i].deque.mutex) {
+            SDL_DestroyMutex(tree->workers[i].deque.mutex);
+        }
+    }
+    if (tree->idle_cond) {
+        SDL_DestroyCondition(tree->idle_cond);
+    }
+    if (tree->idle_mutex) {
+        SDL_DestroyMutex(tree->idle_mutex);
+    }
+}
+
+// 创建一次操作
+static FSTree* fs_tree_new(FSTreeOp op, const char *dst_root, FSTreeProgress progress,
+                           FSTreeDone done, void *user_data) {
+    FSTree *tree = (FSTree*)calloc(1, sizeof(FSTree));
+    if (!tree) {
+        fs_set_error(FS_ERROR_UNKNOWN);
+        return NULL;
+    }
+    tree->op = op;
+    tree->dst_root = dst_root;
+    tree->progress = progress;
+    tree->done = done;
+    tree->user_data = user_data;
+    tree->workers[0].tree = tree;
+    tree->worker_count = 1;
+    return tree;
+}
+
+// 汇总各线程的统计并释放操作，设置错误码后返回是否全部成功
+static bool fs_tree_result(FSTree *tree, bool success, FSTreeStats *stats) {
+    FSTreeStats total = {0};
+    for (int i = 0; i < tree->worker_count; i++) {
+        total.files += tree->workers[i].stats.files;
+        total.directories += tree->workers[i].stats.directories;
+        total.bytes += tree->workers[i].stats.bytes;
+        total.errors += tree->workers[i].stats.errors;
+    }
+    if (stats) {
+        *stats = total;
+    }
+
+    bool cancelled = fs_tree_cancelled(tree);
+    FSError error = (FSError)SDL_GetAtomicInt(&tree->error);
+    free(tree->dst_chain);
+    free(tree);
+
+    if (cancelled) {
+        fs_set_error(FS_ERROR_CANCELLED);
+        return false;
+    }
+    if (total.errors > 0 || !success) {
+        fs_set_error(error != FS_ERROR_NONE ? error : FS_ERROR_UNKNOWN);
+        return false;
+    }
+    fs_set_error(FS_ERROR_NONE);
+    return true;
+}
+
+// 执行一次目录树操作
+static bool fs_tree_run(FSTreeOp op, const char *path, const char *dst_root,
+                        FSTreeProgress progress, void *user_data, FSTreeStats *stats) {
+    if (stats) {
+        memset(stats, 0, sizeof(*stats));
+    }
+    if (!path || (op == FS_TREE_COPY && !dst_root)) {
+        fs_set_error(FS_ERROR_INVALID_NAME);
+        return false;
+    }
+
+    FSTree *tree = fs_tree_new(op, dst_root, progress, NULL, user_data);
+    if (!tree) {
+        return false;
+    }
+
+    bool success = true;
+    if (!fs_tree_single(&tree->workers[0], path, &success)) {
+        // 根是目录：并行遍历（复制到自身之内时拒绝，否则会不断进入刚创建的目标）
+        FSTreeNode *root = NULL;
+        if (op == FS_TREE_COPY && fs_tree_target_inside(path, dst_root)) {
+            fs_set_error(FS_ERROR_TARGET_INSIDE_SOURCE);
+            fs_tree_fail(&tree->workers[0], NULL);
+            success = false;
+        } else if ((root = fs_tree_node_new(NULL, path)) != NULL) {
+            fs_tree_execute(tree, &root, 1);
+        } else {
+            fs_set_error(FS_ERROR_UNKNOWN);
+            fs_tree_fail(&tree->workers[0], NULL);
+        }
+    } else {
+        fs_tree_flush(&tree->workers[0]);
+    }
+
+    // 取消的复制不留下不完整的目录树
+    if (fs_tree_cancelled(tree) && op == FS_TREE_COPY && SDL_GetAtomicInt(&tree->root_created)) {
+        fs_tree_run(FS_TREE_DELETE, dst_root, NULL, NULL, NULL, NULL);
+    }
+    return fs_tree_result(tree, success, stats);
+}
+
+// 批量操作的源路径（按源目录排序后分组）
+typedef struct {
+    const char *path;            // 源路径
+    const char *name;            // 路径中的名称部分
+    size_t parent_len;           // 源目录部分的长度（没有目录部分时为0）
+    int index;                   // 源路径序号
+} FSTreeSourceRef;
+
+// 是否为路径分隔符
+static bool fs_tree_is_separator(char c) {
+#ifdef _WIN32
+    return c == '/' || c == '\\';
+#else
+    return c == '/';
+#endif
+}
+
+// 拆分源路径的目录和名称（根目录、盘符根目录保留末尾的分隔符），名称为空时返回 false
+static bool fs_tree_split(const char *path, FSTreeSourceRef *ref) {
+    size_t len = strlen(path);
+    size_t sep = len;
+    while (sep > 0 && !fs_tree_is_separator(path[sep - 1])) {
+        sep--;
+    }
+    if (sep == len) {
+        return false;
+    }
+
+    ref->path = path;
+    ref->name = path + sep;
+    if (sep == 0) {
+        ref->parent_len = 0;
+    } else if (sep == 1 || path[sep - 2] == ':') {
+        ref->parent_len = sep;
+    } else {
+        ref->parent_len = sep - 1;
+    }
+    return true;
+}
+
+// 复制目录时目标是否位于源目录之内：目标尚不存在，从它的上级目录向上逐级比较文件标识
+bool fs_tree_target_inside(const char *src_dir, const char *dst_path) {
+    if (!src_dir || !dst_path) {
+        return false;
+    }
+
+    FSTreeFileId src_id;
+    if (!fs_tree_file_id(src_dir, &src_id)) {
+        return false;
+    }
+
+    // 去掉末尾的分隔符后取上级目录（没有目录部分时为当前目录）
+    size_t len = strlen(dst_path);
+    char *dst = (char*)malloc(len + 2);
+    if (!dst) {
+        return false;
+    }
+    memcpy(dst, dst_path, len + 1);
+    while (len > 1 && fs_tree_is_separator(dst[len - 1]) && dst[len - 2] != ':') {
+        dst[--len] = '\0';
+    }
+    FSTreeSourceRef ref;
+    if (!fs_tree_split(dst, &ref) || ref.parent_len == 0) {
+        strcpy(dst, ".");
+    } else {
+        dst[ref.parent_len] = '\0';
+    }
+
+    FSTreeFileId *chain = NULL;
+    int count = 0;
+    bool inside = fs_tree_read_chain(dst, &chain, &count) && fs_tree_chain_contains(chain, count, src_id);
+    free(chain);
+    free(dst);
+    return inside;
+}
+
+// 按源目录排序，同一目录内保持原顺序
+static int fs_tree_compare_source(const void *a, const void *b) {
+    const FSTreeSourceRef *x = (const FSTreeSourceRef*)a;
+    const FSTreeSourceRef *y = (const FSTreeSourceRef*)b;
+    size_t len = x->parent_len < y->parent_len ? x->parent_len : y->parent_len;
+    int result = memcmp(x->path, y->path, len);
+    if (result != 0) {
+        return result;
+    }
+    if (x->parent_len != y->parent_len) {
+        return x->parent_len < y->parent_len ? -1 : 1;
+    }
+    return x->index - y->index;
+}
+
+// 按设备排序，同一设备按源目录
+static int fs_tree_compare_group(const void *a, const void *b) {
+    const FSTreeGroup *x = (const FSTreeGroup*)a;
+    const FSTreeGroup *y = (const FSTreeGroup*)b;
+    if (x->device != y->device) {
+        return x->device < y->device ? -1 : 1;
+    }
+    return strcmp(x->parent, y->parent);
+}
+
+// 执行一次批量操作：源路径按所在目录分组，分组按设备排序
+static bool fs_tree_run_batch(FSTreeOp op, const char *const *paths, int count, const char *dst_dir,
+                              FSTreeProgress progress, FSTreeDone done, void *user_data, FSTreeStats *stats) {
+    if (stats) {
+        memset(stats, 0, sizeof(*stats));
+    }
+    if (!paths || count <= 0 || (op == FS_TREE_COPY && !dst_dir)) {
+        fs_set_error(FS_ERROR_INVALID_NAME);
+        return false;
+    }
+
+    FSTree *tree = fs_tree_new(op, dst_dir, progress, done, user_data);
+    FSTreeSourceRef *refs = (FSTreeSourceRef*)malloc(sizeof(FSTreeSourceRef) * (size_t)count);
+    const char **names = (const char**)malloc(sizeof(const char*) * (size_t)count);
+    int *indices = (int*)malloc(sizeof(int) * (size_t)count);
+    FSTreeSourceInfo *info = (FSTreeSourceInfo*)calloc((size_t)count, sizeof(FSTreeSourceInfo));
+    FSTreeGroup *groups = (FSTreeGroup*)calloc((size_t)count, sizeof(FSTreeGroup));
+    FSTreeNode **roots = (FSTreeNode**)malloc(sizeof(FSTreeNode*) * (size_t)count);
+    Uint8 *created = op == FS_TREE_COPY ? (Uint8*)calloc((size_t)count, 1) : NULL;
+    if (!tree || !refs || !names || !indices || !info || !groups || !roots || (op == FS_TREE_COPY && !created)) {
+        free(tree);
+        free(refs);
+        free(names);
+        free(indices);
+        free(info);
+        free(groups);
+        free(roots);
+        free(created);
+        fs_set_error(FS_ERROR_UNKNOWN);
+        return false;
+    }
+    tree->created = created;
+    FSTreeWorker *caller = &tree->workers[0];
+
+    // 复制时先读取目标目录的上级目录链，扫描分组时拒绝目标位于其中的源目录
+    if (op == FS_TREE_COPY && !fs_tree_read_chain(dst_dir, &tree->dst_chain, &tree->dst_chain_count)) {
+        tree->dst_chain = NULL;
+        tree->dst_chain_count = 0;
+    }
+
+    // 1. 拆分源路径并按源目录排序
+    int ref_count = 0;
+    for (int i = 0; i < count; i++) {
+        if (!paths[i] || !fs_tree_split(paths[i], &refs[ref_count])) {
+            fs_set_error(FS_ERROR_INVALID_NAME);
+            fs_tree_fail(caller, NULL);
+            fs_tree_done(caller, i, false);
+            continue;
+        }
+        refs[ref_count++].index = i;
+    }
+    qsort(refs, (size_t)ref_count, sizeof(FSTreeSourceRef), fs_tree_compare_source);
+
+    // 2. 同一目录的源路径组成一个分组
+    int group_count = 0;
+    for (int i = 0; i < ref_count;) {
+        int end = i + 1;
+        while (end < ref_count && refs[end].parent_len == refs[i].parent_len &&
+               memcmp(refs[end].path, refs[i].path, refs[i].parent_len) == 0) {
+            end++;
+        }
+
+        FSTreeGroup *group = &groups[group_count];
+        size_t parent_len = refs[i].parent_len;
+        group->parent = (char*)malloc(parent_len > 0 ? parent_len + 1 : 2);
+        group->names = names + i;
+        group->indices = indices + i;
+        group->info = info + i;
+        group->count = end - i;
+        for (int k = i; k < end; k++) {
+            names[k] = refs[k].name;
+            indices[k] = refs[k].index;
+        }
+
+        if (!group->parent) {
+            for (int k = i; k < end; k++) {
+                fs_set_error(FS_ERROR_UNKNOWN);
+                fs_tree_fail(caller, NULL);
+                fs_tree_done(caller, indices[k], false);
+            }
+        } else {
+            if (parent_len > 0) {
+                memcpy(group->parent, refs[i].path, parent_len);
+                group->parent[parent_len] = '\0';
+            } else {
+                strcpy(group->parent, ".");
+            }
+            struct stat st;
+            group->device = stat(group->parent, &st) == 0 ? (Uint64)st.st_dev : 0;
+            group_count++;
+        }
+        i = end;
+    }
+
+    // 3. 同一设备上的分组相邻，各分组作为根节点并行处理
+    qsort(groups, (size_t)group_count, sizeof(FSTreeGroup), fs_tree_compare_group);
+    int root_count = 0;
+    for (int g = 0; g < group_count; g++) {
+        FSTreeNode *root = fs_tree_node_new(NULL, "");
+        if (!root) {
+            for (int k = 0; k < groups[g].count; k++) {
+                fs_set_error(FS_ERROR_UNKNOWN);
+                fs_tree_fail(caller, NULL);
+                fs_tree_done(caller, groups[g].indices[k], false);
+            }
+            continue;
+        }
+        root->kind = FS_TREE_NODE_GROUP;
+        root->group = &groups[g];
+        roots[root_count++] = root;
+    }
+    if (root_count > 0) {
+        fs_tree_execute(tree, roots, root_count);
+    } else {
+        fs_tree_flush(caller);
+    }
+
+    // 取消的复制删除已复制的源路径
+    if (fs_tree_cancelled(tree) && op == FS_TREE_COPY) {
+        for (int i = 0; i < ref_count; i++) {
+            if (!created[refs[i].index]) {
+                continue;
+            }
+            char *dst = fs_combine_path(dst_dir, refs[i].name);
+            if (dst) {
+                fs_tree_run(FS_TREE_DELETE, dst, NULL, NULL, NULL, NULL);
+                free(dst);
+            }
+        }
+    }
+
+    for (int g = 0; g < group_count; g++) {
+        free(groups[g].parent);
+    }
+    free(refs);
+    free(names);
+    free(indices);
+    free(info);
+    free(groups);
+    free(roots);
+    free(created);
+    return fs_tree_result(tree, true, stats);
+}
+
+// 统计目录树的文件数和字节数
+bool fs_tree_measure(const char *path, FSTreeProgress progress, void *user_data, FSTreeStats *stats) {
+    return fs_tree_run(FS_TREE_MEASURE, path, NULL, progress, user_data, stats);
+}
+
+// 复制文件、符号链接或整个目录树
+bool fs_tree_copy(const char *src_path, const char *dst_path,
+                  FSTreeProgress progress, void *user_data, FSTreeStats *stats) {
+    return fs_tree_run(FS_TREE_COPY, src_path, dst_path, progress, user_data, stats);
+}
+
+// 删除文件、符号链接或整个目录树
+bool fs_tree_delete(const char *path, FSTreeProgress progress, void *user_data, FSTreeStats *stats) {
+    return fs_tree_run(FS_TREE_DELETE, path, NULL, progress, user_data, stats);
+}
+
+// 批量统计
+bool fs_tree_measure_batch(const char *const *paths, int count, FSTreeProgress progress,
+                           FSTreeDone done, void *user_data, FSTreeStats *stats) {
+    return fs_tree_run_batch(FS_TREE_MEASURE, paths, count, NULL, progress, done, user_data, stats);
+}
+
+// 批量复制到目标目录
+bool fs_tree_copy_batch(const char *const *src_paths, int count, const char *dst_dir,
+                        FSTreeProgress progress, FSTreeDone done, void *user_data, FSTreeStats *stats) {
+    return fs_tree_run_batch(FS_TREE_COPY, src_paths, count, dst_dir, progress, done, user_data, stats);
+}
+
+// 批量删除
+bool fs_tree_delete_batch(const char *const *paths, int count, FSTreeProgress progress,
+                          FSTreeDone done, void *user_data, FSTreeStats *stats) {
+    return fs_tree_run_batch(FS_TREE_DELETE, paths, count, NULL, progress, done, user_data, stats);
+}
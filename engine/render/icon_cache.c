@@ -1,8 +1,334 @@
 /*
  * 图标缓存模块
  * 职责：
- * 1. 管理文件类型图标
- * 2. 缓存常用图标
- * 3. 图标大小管理
- * 4. 自定义图标支持
+ * 1. 管理文件类型图标（按文件类型和扩展名划分图标类别，扩展名查哈希表）
+ * 2. 缓存常用图标（每个类别每种尺寸只加载一次，按引用计数共享，计数归零时释放）
+ * 3. 图标大小管理（加载时缩放到目标尺寸，绘制时不再缩放大图）
+ * 4. 自定义图标支持（images/<类别>.png 存在时优先使用，否则由通用图标着色生成）
  */
+
+#include "icon_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 图标目录
+#define ICON_DIR "images/"
+// 扩展名最大长度（更长的扩展名按普通文件处理）
+#define ICON_EXT_MAX 12
+// 扩展名哈希表容量（2的幂，大于扩展名表长度的两倍）
+#define ICON_EXT_CAPACITY 256
+
+// 一个类别的外观
+typedef struct {
+    const char *name;        // 类别名（自定义图标文件名）
+    IconClass base;          // 没有自定义图标时使用的通用图标
+    SDL_Color tint;          // 通用图标的着色（图片也加载失败时作为色块颜色）
+} IconClassInfo;
+
+static const IconClassInfo icon_class_info[ICON_CLASS_COUNT] = {
+    [ICON_CLASS_FILE]       = {"file",       ICON_CLASS_FILE,   {255, 255, 255, 255}},
+    [ICON_CLASS_FOLDER]     = {"folder",     ICON_CLASS_FOLDER, {255, 255, 255, 255}},
+    [ICON_CLASS_DRIVE]      = {"drive",      ICON_CLASS_FOLDER, {100, 150, 200, 255}},
+    [ICON_CLASS_IMAGE]      = {"image",      ICON_CLASS_FILE,   {120, 200, 120, 255}},
+    [ICON_CLASS_AUDIO]      = {"audio",      ICON_CLASS_FILE,   {230, 150, 60, 255}},
+    [ICON_CLASS_VIDEO]      = {"video",      ICON_CLASS_FILE,   {200, 100, 200, 255}},
+    [ICON_CLASS_TEXT]       = {"text",       ICON_CLASS_FILE,   {200, 200, 200, 255}},
+    [ICON_CLASS_DOCUMENT]   = {"document",   ICON_CLASS_FILE,   {100, 140, 230, 255}},
+    [ICON_CLASS_CODE]       = {"code",       ICON_CLASS_FILE,   {90, 190, 200, 255}},
+    [ICON_CLASS_ARCHIVE]    = {"archive",    ICON_CLASS_FILE,   {200, 170, 100, 255}},
+    [ICON_CLASS_EXECUTABLE] = {"executable", ICON_CLASS_FILE,   {220, 90, 90, 255}},
+};
+
+// 扩展名到图标类别的对应表（小写，不带点）
+static const struct {
+    const char *ext;
+    IconClass icon_class;
+} icon_ext_table[] = {
+    {"png", ICON_CLASS_IMAGE}, {"jpg", ICON_CLASS_IMAGE}, {"jpeg", ICON_CLASS_IMAGE},
+    {"gif", ICON_CLASS_IMAGE}, {"bmp", ICON_CLASS_IMAGE}, {"webp", ICON_CLASS_IMAGE},
+    {"tif", ICON_CLASS_IMAGE}, {"tiff", ICON_CLASS_IMAGE}, {"ico", ICON_CLASS_IMAGE},
+    {"svg", ICON_CLASS_IMAGE}, {"psd", ICON_CLASS_IMAGE},
+    {"mp3", ICON_CLASS_AUDIO}, {"wav", ICON_CLASS_AUDIO}, {"flac", ICON_CLASS_AUDIO},
+    {"ogg", ICON_CLASS_AUDIO}, {"aac", ICON_CLASS_AUDIO}, {"m4a", ICON_CLASS_AUDIO},
+    {"wma", ICON_CLASS_AUDIO}, {"opus", ICON_CLASS_AUDIO},
+    {"mp4", ICON_CLASS_VIDEO}, {"mkv", ICON_CLASS_VIDEO}, {"avi", ICON_CLASS_VIDEO},
+    {"mov", ICON_CLASS_VIDEO}, {"wmv", ICON_CLASS_VIDEO}, {"flv", ICON_CLASS_VIDEO},
+    {"webm", ICON_CLASS_VIDEO}, {"m4v", ICON_CLASS_VIDEO},
+    {"txt", ICON_CLASS_TEXT}, {"log", ICON_CLASS_TEXT}, {"md", ICON_CLASS_TEXT},
+    {"ini", ICON_CLASS_TEXT}, {"cfg", ICON_CLASS_TEXT}, {"csv", ICON_CLASS_TEXT},
+    {"json", ICON_CLASS_TEXT}, {"xml", ICON_CLASS_TEXT}, {"yaml", ICON_CLASS_TEXT},
+    {"yml", ICON_CLASS_TEXT}, {"toml", ICON_CLASS_TEXT},
+    {"pdf", ICON_CLASS_DOCUMENT}, {"doc", ICON_CLASS_DOCUMENT}, {"docx", ICON_CLASS_DOCUMENT},
+    {"xls", ICON_CLASS_DOCUMENT}, {"xlsx", ICON_CLASS_DOCUMENT}, {"ppt", ICON_CLASS_DOCUMENT},
+    {"pptx", ICON_CLASS_DOCUMENT}, {"odt", ICON_CLASS_DOCUMENT}, {"rtf", ICON_CLASS_DOCUMENT},
+    {"c", ICON_CLASS_CODE}, {"h", ICON_CLASS_CODE}, {"cpp", ICON_CLASS_CODE},
+    {"hpp", ICON_CLASS_CODE}, {"cc", ICON_CLASS_CODE}, {"cs", ICON_CLASS_CODE},
+    {"java", ICON_CLASS_CODE}, {"py", ICON_CLASS_CODE}, {"js", ICON_CLASS_CODE},
+    {"ts", ICON_CLASS_CODE}, {"go", ICON_CLASS_CODE}, {"rs", ICON_CLASS_CODE},
+    {"lua", ICON_CLASS_CODE}, {"sh", ICON_CLASS_CODE}, {"html", ICON_CLASS_CODE},
+    {"css", ICON_CLASS_CODE}, {"cmake", ICON_CLASS_CODE},
+    {"zip", ICON_CLASS_ARCHIVE}, {"rar", ICON_CLASS_ARCHIVE}, {"7z", ICON_CLASS_ARCHIVE},
+    {"tar", ICON_CLASS_ARCHIVE}, {"gz", ICON_CLASS_ARCHIVE}, {"bz2", ICON_CLASS_ARCHIVE},
+    {"xz", ICON_CLASS_ARCHIVE}, {"zst", ICON_CLASS_ARCHIVE}, {"iso", ICON_CLASS_ARCHIVE},
+    {"exe", ICON_CLASS_EXECUTABLE}, {"msi", ICON_CLASS_EXECUTABLE}, {"bat", ICON_CLASS_EXECUTABLE},
+    {"cmd", ICON_CLASS_EXECUTABLE}, {"com", ICON_CLASS_EXECUTABLE}, {"dll", ICON_CLASS_EXECUTABLE},
+    {"appimage", ICON_CLASS_EXECUTABLE},
+};
+
+// 扩展名哈希表的一个槽位
+typedef struct {
+    char ext[ICON_EXT_MAX + 1]; // 小写扩展名（空槽为空字符串）
+    IconClass icon_class;       // 图标类别
+} IconExtSlot;
+
+// 一个类别一种尺寸的图标
+typedef struct {
+    SDL_Texture *texture;    // 纹理（未加载时为NULL）
+    int refcount;            // 引用计数
+} IconEntry;
+
+struct IconCache {
+    SDL_Renderer *renderer;                              // 纹理所属的渲染器
+    TextureManager *textures;                            // 纹理管理器（可为NULL）
+    IconExtSlot ext_slots[ICON_EXT_CAPACITY];            // 扩展名哈希表（开放寻址）
+    IconEntry entries[ICON_CLASS_COUNT][ICON_SIZE_COUNT]; // 图标（数量固定，内存有上限）
+    int loads;                                           // 加载次数
+    int unloads;                                         // 释放次数
+};
+
+// 图标尺寸对应的像素大小
+int icon_cache_pixel_size(IconSize size) {
+    return (size == ICON_SIZE_LARGE) ? 32 : 16;
+}
+
+// 一个图标纹理占用的内存（加载时已缩放到目标尺寸）
+static size_t icon_cache_bytes(IconSize size) {
+    int pixels = icon_cache_pixel_size(size);
+    return (size_t)pixels * (size_t)pixels * 4;
+}
+
+// 扩展名的哈希（FNV-1a）
+static uint32_t icon_ext_hash(const char *ext) {
+    uint32_t hash = 2166136261u;
+    for (; *ext; ext++) {
+        hash ^= (unsigned char)*ext;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// 把扩展名转为小写放入 out，过长或为空时返回 false
+static bool icon_ext_normalize(const char *ext, char out[ICON_EXT_MAX + 1]) {
+    size_t len = 0;
+    for (; ext[len]; len++) {
+        if (len >= ICON_EXT_MAX) {
+            return false;
+        }
+        char c = ext[len];
+        out[len] = (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+    }
+    out[len] = '\0';
+    return len > 0;
+}
+
+// 查找扩展名所在的槽位（不存在时返回应插入的空槽）
+static IconExtSlot* icon_ext_slot(const IconCache *cache, const char *ext) {
+    uint32_t index = icon_ext_hash(ext) & (ICON_EXT_CAPACITY - 1);
+    for (;;) {
+        const IconExtSlot *slot = &cache->ext_slots[index];
+        if (slot->ext[0] == '\0' || strcmp(slot->ext, ext) == 0) {
+            return (IconExtSlot*)slot;
+        }
+        index = (index + 1) & (ICON_EXT_CAPACITY - 1);
+    }
+}
+
+// 创建图标缓存
+IconCache* icon_cache_new(SDL_Renderer *renderer, TextureManager *textures) {
+    if (!renderer) {
+        return NULL;
+    }
+
+    IconCache *cache = (IconCache*)calloc(1, sizeof(IconCache));
+    if (!cache) {
+        return NULL;
+    }
+    cache->renderer = renderer;
+    cache->textures = textures;
+
+    // 建立扩展名哈希表
+    for (size_t i = 0; i < sizeof(icon_ext_table) / sizeof(icon_ext_table[0]); i++) {
+        char ext[ICON_EXT_MAX + 1];
+        if (!icon_ext_normalize(icon_ext_table[i].ext, ext)) {
+            continue;
+        }
+        IconExtSlot *slot = icon_ext_slot(cache, ext);
+        memcpy(slot->ext, ext, sizeof(slot->ext));
+        slot->icon_class = icon_ext_table[i].icon_class;
+    }
+
+    return cache;
+}
+
+// 释放缓存及其全部纹理
+void icon_cache_free(IconCache *cache) {
+    if (!cache) {
+        return;
+    }
+
+    for (int c = 0; c < ICON_CLASS_COUNT; c++) {
+        for (int s = 0; s < ICON_SIZE_COUNT; s++) {
+            if (cache->entries[c][s].texture) {
+                SDL_DestroyTexture(cache->entries[c][s].texture);
+                texture_manager_untrack(cache->textures, TEXTURE_CATEGORY_ICONS, icon_cache_bytes((IconSize)s));
+            }
+        }
+    }
+    free(cache);
+}
+
+// 按文件名和文件类型确定图标类别
+IconClass icon_cache_classify(const IconCache *cache, const char *name, FileType type) {
+    if (type == FILE_TYPE_DIRECTORY) {
+        return ICON_CLASS_FOLDER;
+    }
+    if (!cache || !name) {
+        return ICON_CLASS_FILE;
+    }
+
+    // 隐藏文件的前导点不算扩展名
+    const char *dot = strrchr(name, '.');
+    if (!dot || dot == name) {
+        return ICON_CLASS_FILE;
+    }
+
+    char ext[ICON_EXT_MAX + 1];
+    if (!icon_ext_normalize(dot + 1, ext)) {
+        return ICON_CLASS_FILE;
+    }
+
+    const IconExtSlot *slot = icon_ext_slot(cache, ext);
+    return slot->ext[0] ? slot->icon_class : ICON_CLASS_FILE;
+}
+
+// 加载图标图片（失败返回NULL）
+static SDL_Surface* icon_cache_load_image(IconClass icon_class) {
+    char path[64];
+    snprintf(path, sizeof(path), ICON_DIR "%s.png", icon_class_info[icon_class].name);
+    return IMG_Load(path);
+}
+
+// 加载一个类别一种尺寸的图标：自定义图标 > 着色的通用图标 > 色块
+static SDL_Texture* icon_cache_load(IconCache *cache, IconClass icon_class, IconSize size) {
+    const IconClassInfo *info = &icon_class_info[icon_class];
+    int pixels = icon_cache_pixel_size(size);
+    bool tinted = false;
+
+    SDL_Surface *source = icon_cache_load_image(icon_class);
+    if (!source && info->base != icon_class) {
+        source = icon_cache_load_image(info->base);
+        tinted = (source != NULL);
+    }
+
+    SDL_Surface *surface = NULL;
+    if (source) {
+        // 加载时缩放一次，绘制时不再缩放原图
+        surface = SDL_ScaleSurface(source, pixels, pixels, SDL_SCALEMODE_LINEAR);
+        SDL_DestroySurface(source);
+    }
+    if (!surface) {
+        printf("Warning: Failed to load icon '%s', using a plain square\n", info->name);
+        surface = SDL_CreateSurface(pixels, pixels, SDL_PIXELFORMAT_RGBA32);
+        if (!surface) {
+            return NULL;
+        }
+        const SDL_PixelFormatDetails *format_details = SDL_GetPixelFormatDetails(surface->format);
+        SDL_FillSurfaceRect(surface, NULL, SDL_MapRGBA(format_details, NULL,
+                            info->tint.r, info->tint.g, info->tint.b, info->tint.a));
+    }
+
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(cache->renderer, surface);
+    SDL_DestroySurface(surface);
+    if (!texture) {
+        printf("[ERROR] Failed to create icon texture '%s': %s\n", info->name, SDL_GetError());
+        return NULL;
+    }
+    if (tinted) {
+        SDL_SetTextureColorMod(texture, info->tint.r, info->tint.g, info->tint.b);
+    }
+
+    cache->loads++;
+    texture_manager_track(cache->textures, TEXTURE_CATEGORY_ICONS, icon_cache_bytes(size));
+    return texture;
+}
+
+// 获取图标并增加引用计数
+SDL_Texture* icon_cache_acquire(IconCache *cache, IconClass icon_class, IconSize size) {
+    if (!cache || icon_class < 0 || icon_class >= ICON_CLASS_COUNT ||
+        size < 0 || size >= ICON_SIZE_COUNT) {
+        return NULL;
+    }
+
+    IconEntry *entry = &cache->entries[icon_class][size];
+    if (!entry->texture) {
+        entry->texture = icon_cache_load(cache, icon_class, size);
+        if (!entry->texture) {
+            return NULL;
+        }
+    }
+    entry->refcount++;
+    return entry->texture;
+}
+
+// 释放一次引用
+void icon_cache_release(IconCache *cache, IconClass icon_class, IconSize size) {
+    if (!cache || icon_class < 0 || icon_class >= ICON_CLASS_COUNT ||
+        size < 0 || size >= ICON_SIZE_COUNT) {
+        return;
+    }
+
+    IconEntry *entry = &cache->entries[icon_class][size];
+    if (entry->refcount <= 0) {
+        return;
+    }
+    if (--entry->refcount == 0 && entry->texture) {
+        SDL_DestroyTexture(entry->texture);
+        texture_manager_untrack(cache->textures, TEXTURE_CATEGORY_ICONS, icon_cache_bytes(size));
+        entry->texture = NULL;
+        cache->unloads++;
+    }
+}
+
+// 已获取的图标纹理
+SDL_Texture* icon_cache_texture(const IconCache *cache, IconClass icon_class, IconSize size) {
+    if (!cache || icon_class < 0 || icon_class >= ICON_CLASS_COUNT ||
+        size < 0 || size >= ICON_SIZE_COUNT) {
+        return NULL;
+    }
+    return cache->entries[icon_class][size].texture;
+}
+
+// 读取缓存统计
+void icon_cache_get_stats(const IconCache *cache, IconCacheStats *stats) {
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    if (!cache) {
+        return;
+    }
+
+    stats->loads = cache->loads;
+    stats->unloads = cache->unloads;
+    for (int c = 0; c < ICON_CLASS_COUNT; c++) {
+        for (int s = 0; s < ICON_SIZE_COUNT; s++) {
+            const IconEntry *entry = &cache->entries[c][s];
+            if (entry->texture) {
+                stats->textures++;
+                stats->bytes += icon_cache_bytes((IconSize)s);
+            }
+            stats->references += entry->refcount;
+        }
+    }
+}
@@ -0,0 +1,207 @@
+/*
+ * 纹理管理模块
+ * 职责：
+ * 1. 统计各类纹理（文字、字形图集、图标、缩略图、面板缓存）占用的内存
+ * 2. 总内存超出上限时，在可淘汰纹理的所有者之间按最近使用顺序淘汰
+ * 3. 本帧使用过的纹理不淘汰，无法降到上限以下时只记录，不影响绘制
+ * 4. 报告各类别的占用和淘汰情况
+ */
+
+#include "texture_manager.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 可淘汰纹理所有者的最大数量
+#define TEXTURE_MANAGER_MAX_OWNERS 16
+
+// 一个可淘汰纹理的所有者
+typedef struct {
+    void *owner;                 // 所有者
+    TextureCategory category;    // 纹理类别
+    TextureOldestFunc oldest;    // 最久未使用纹理的帧号
+    TextureEvictFunc evict;      // 淘汰该纹理
+} TextureOwner;
+
+struct TextureManager {
+    size_t budget;                                   // 内存上限
+    Uint64 frame;                                    // 当前帧号
+    TextureOwner owners[TEXTURE_MANAGER_MAX_OWNERS]; // 可淘汰纹理的所有者
+    int owner_count;
+    TextureManagerStats stats;                       // 统计
+};
+
+static const char *texture_category_names[TEXTURE_CATEGORY_COUNT] = {
+    [TEXTURE_CATEGORY_TEXT]       = "text",
+    [TEXTURE_CATEGORY_GLYPHS]     = "glyphs",
+    [TEXTURE_CATEGORY_ICONS]      = "icons",
+    [TEXTURE_CATEGORY_THUMBNAILS] = "thumbnails",
+    [TEXTURE_CATEGORY_LAYERS]     = "layers",
+    [TEXTURE_CATEGORY_OTHER]      = "other",
+};
+
+// 类别名称
+const char* texture_category_name(TextureCategory category) {
+    if (category < 0 || category >= TEXTURE_CATEGORY_COUNT) {
+        return "unknown";
+    }
+    return texture_category_names[category];
+}
+
+// 创建纹理管理器
+TextureManager* texture_manager_new(size_t budget) {
+    TextureManager *manager = (TextureManager*)calloc(1, sizeof(TextureManager));
+    if (!manager) {
+        return NULL;
+    }
+
+    manager->budget = budget > 0 ? budget : TEXTURE_MANAGER_DEFAULT_BUDGET;
+    // 帧号从1开始，0留给从未使用过的纹理
+    manager->frame = 1;
+    return manager;
+}
+
+// 释放纹理管理器
+void texture_manager_free(TextureManager *manager) {
+    if (!manager) {
+        return;
+    }
+
+    const TextureManagerStats *stats = &manager->stats;
+    for (int i = 0; i < TEXTURE_CATEGORY_COUNT; i++) {
+        if (stats->textures[i] != 0 || stats->bytes[i] != 0) {
+            // 所有者释放后仍有计数说明有纹理没有登记释放
+            printf("[ERROR] Texture manager: %d %s textures (%zu bytes) still tracked\n",
+                   stats->textures[i], texture_category_name((TextureCategory)i), stats->bytes[i]);
+        }
+    }
+    free(manager);
+}
+
+// 修改内存上限
+void texture_manager_set_budget(TextureManager *manager, size_t budget) {
+    if (manager) {
+        manager->budget = budget > 0 ? budget : TEXTURE_MANAGER_DEFAULT_BUDGET;
+    }
+}
+
+// 登记可淘汰纹理的所有者
+bool texture_manager_register(TextureManager *manager, TextureCategory category, void *owner,
+                              TextureOldestFunc oldest, TextureEvictFunc evict) {
+    if (!manager || !owner || !oldest || !evict ||
+        manager->owner_count >= TEXTURE_MANAGER_MAX_OWNERS) {
+        return false;
+    }
+
+    TextureOwner *entry = &manager->owners[manager->owner_count++];
+    entry->owner = owner;
+    entry->category = category;
+    entry->oldest = oldest;
+    entry->evict = evict;
+    return true;
+}
+
+// 取消登记
+void texture_manager_unregister(TextureManager *manager, void *owner) {
+    if (!manager) {
+        return;
+    }
+
+    for (int i = 0; i < manager->owner_count; i++) {
+        if (manager->owners[i].owner == owner) {
+            manager->owners[i] = manager->owners[--manager->owner_count];
+            return;
+        }
+    }
+}
+
+// 记录创建了一个纹理
+void texture_manager_track(TextureManager *manager, TextureCategory category, size_t bytes) {
+    if (!manager || category < 0 || category >= TEXTURE_CATEGORY_COUNT) {
+        return;
+    }
+
+    TextureManagerStats *stats = &manager->stats;
+    stats->bytes[category] += bytes;
+    stats->textures[category]++;
+    stats->total_bytes += bytes;
+    if (stats->total_bytes > stats->peak_bytes) {
+        stats->peak_bytes = stats->total_bytes;
+    }
+}
+
+// 记录释放了一个纹理
+void texture_manager_untrack(TextureManager *manager, TextureCategory category, size_t bytes) {
+    if (!manager || category < 0 || category >= TEXTURE_CATEGORY_COUNT) {
+        return;
+    }
+
+    TextureManagerStats *stats = &manager->stats;
+    stats->bytes[category] -= bytes;
+    stats->textures[category]--;
+    stats->total_bytes -= bytes;
+}
+
+// 当前帧号
+Uint64 texture_manager_frame(const TextureManager *manager) {
+    return manager ? manager->frame : 0;
+}
+
+// 一帧绘制结束：超出上限时淘汰本帧没有使用的纹理
+void texture_manager_end_frame(TextureManager *manager) {
+    if (!manager) {
+        return;
+    }
+
+    while (manager->stats.total_bytes > manager->budget) {
+        // 在全部所有者中找最久未使用的纹理
+        TextureOwner *victim = NULL;
+        Uint64 victim_frame = UINT64_MAX;
+        for (int i = 0; i < manager->owner_count; i++) {
+            Uint64 frame = manager->owners[i].oldest(manager->owners[i].owner);
+            if (frame < victim_frame) {
+                victim = &manager->owners[i];
+                victim_frame = frame;
+            }
+        }
+
+        // 本帧使用过的纹理不淘汰
+        if (!victim || victim_frame >= manager->frame) {
+            manager->stats.over_budget_frames++;
+            break;
+        }
+
+        size_t before = manager->stats.total_bytes;
+        victim->evict(victim->owner);
+        manager->stats.evictions[victim->category]++;
+        if (manager->stats.total_bytes >= before) {
+            // 所有者没有释放任何纹理，避免死循环
+            break;
+        }
+    }
+
+    manager->frame++;
+}
+
+// 纹理占用内存的估算
+size_t texture_manager_texture_bytes(SDL_Texture *texture) {
+    float w = 0.0f;
+    float h = 0.0f;
+    if (!texture || !SDL_GetTextureSize(texture, &w, &h)) {
+        return 0;
+    }
+    return (size_t)w * (size_t)h * 4;
+}
+
+// 读取统计
+void texture_manager_get_stats(const TextureManager *manager, TextureManagerStats *stats) {
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    if (!manager) {
+        return;
+    }
+
+    *stats = manager->stats;
+    stats->budget = manager->budget;
+}
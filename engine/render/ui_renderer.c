@@ -3,6 +3,994 @@
  * 职责：
  * 1. 处理UI元素的渲染
  * 2. 管理渲染队列
- * 3. 优化渲染性能
- * 4. 处理动画和过渡效果
+ * 3. 优化渲染性能（文字纹理按文本、字体和颜色缓存；字形光栅化一次放入图集，文字按批次提交）
+ * 4. 面板缓存：每个面板绘制到自己的目标纹理，只重绘变化的矩形，每帧只做合成
+ * 5. 处理动画和过渡效果
  */
+
+#include "ui_renderer.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 缓存项的空链接
+#define TEXT_CACHE_NONE (-1)
+
+// 一个缓存的文字纹理
+typedef struct {
+    char *text;              // 文本副本（空闲项为NULL）
+    size_t len;              // 文本长度
+    TTF_Font *font;          // 字体
+    Uint32 color;            // 颜色（RGBA 打包）
+    uint32_t hash;           // 键的哈希
+    SDL_Texture *texture;    // 纹理
+    int w;                   // 纹理宽度
+    int h;                   // 纹理高度
+    size_t bytes;            // 纹理占用的内存
+    int bucket_next;         // 同一哈希桶的下一项（空闲项为空闲链表的下一项）
+    int lru_prev;            // 更近使用的一项
+    int lru_next;            // 更早使用的一项
+    Uint64 last_used;        // 最近使用的帧号（纹理管理器）
+} TextCacheEntry;
+
+struct TextCache {
+    SDL_Renderer *renderer;  // 纹理所属的渲染器
+    TextureManager *textures; // 纹理管理器（可为NULL）
+    TextCacheEntry *entries; // 缓存项（下标稳定）
+    int entry_count;         // 已使用过的槽位数
+    int entry_capacity;      // 槽位容量
+    int free_list;           // 空闲槽位链表
+    int *buckets;            // 哈希桶（链表头）
+    int bucket_count;        // 哈希桶数量（2的幂）
+    int lru_head;            // 最近使用的一项
+    int lru_tail;            // 最久未使用的一项
+    int live;                // 当前缓存的纹理数
+    size_t bytes;            // 当前纹理占用的内存
+    size_t max_bytes;        // 内存上限
+    int hits;                // 命中次数
+    int misses;              // 未命中次数
+    int evictions;           // 淘汰次数
+};
+
+// 颜色打包为一个整数
+static Uint32 text_cache_pack_color(SDL_Color color) {
+    return ((Uint32)color.r << 24) | ((Uint32)color.g << 16) | ((Uint32)color.b << 8) | (Uint32)color.a;
+}
+
+// 键的哈希（FNV-1a，混入字体地址和颜色）
+static uint32_t text_cache_hash(TTF_Font *font, const char *text, size_t len, Uint32 color) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ (unsigned char)text[i]) * 16777619u;
+    }
+    uintptr_t font_bits = (uintptr_t)font;
+    hash = (hash ^ (uint32_t)(font_bits >> 4)) * 16777619u;
+    hash = (hash ^ color) * 16777619u;
+    return hash;
+}
+
+// 从最近使用链表中取下
+static void text_cache_lru_unlink(TextCache *cache, int index) {
+    TextCacheEntry *entry = &cache->entries[index];
+    if (entry->lru_prev != TEXT_CACHE_NONE) {
+        cache->entries[entry->lru_prev].lru_next = entry->lru_next;
+    } else {
+        cache->lru_head = entry->lru_next;
+    }
+    if (entry->lru_next != TEXT_CACHE_NONE) {
+        cache->entries[entry->lru_next].lru_prev = entry->lru_prev;
+    } else {
+        cache->lru_tail = entry->lru_prev;
+    }
+    entry->lru_prev = TEXT_CACHE_NONE;
+    entry->lru_next = TEXT_CACHE_NONE;
+}
+
+// 放到最近使用链表头部
+static void text_cache_lru_push(TextCache *cache, int index) {
+    TextCacheEntry *entry = &cache->entries[index];
+    entry->lru_prev = TEXT_CACHE_NONE;
+    entry->lru_next = cache->lru_head;
+    if (cache->lru_head != TEXT_CACHE_NONE) {
+        cache->entries[cache->lru_head].lru_prev = index;
+    } else {
+        cache->lru_tail = index;
+    }
+    cache->lru_head = index;
+}
+
+// 移除一项并释放纹理，槽位放回空闲链表
+static void text_cache_remove(TextCache *cache, int index) {
+    TextCacheEntry *entry = &cache->entries[index];
+
+    int *link = &cache->buckets[entry->hash & (uint32_t)(cache->bucket_count - 1)];
+    while (*link != index) {
+        link = &cache->entries[*link].bucket_next;
+    }
+    *link = entry->bucket_next;
+
+    text_cache_lru_unlink(cache, index);
+    SDL_DestroyTexture(entry->texture);
+    texture_manager_untrack(cache->textures, TEXTURE_CATEGORY_TEXT, entry->bytes);
+    free(entry->text);
+    cache->bytes -= entry->bytes;
+    cache->live--;
+
+    memset(entry, 0, sizeof(TextCacheEntry));
+    entry->bucket_next = cache->free_list;
+    cache->free_list = index;
+}
+
+// 哈希桶扩容（平均每桶不超过一项）
+static bool text_cache_grow_buckets(TextCache *cache) {
+    int count = cache->bucket_count > 0 ? cache->bucket_count * 2 : 256;
+    int *buckets = (int*)malloc(sizeof(int) * (size_t)count);
+    if (!buckets) {
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        buckets[i] = TEXT_CACHE_NONE;
+    }
+    for (int i = 0; i < cache->entry_count; i++) {
+        TextCacheEntry *entry = &cache->entries[i];
+        if (!entry->text) {
+            continue;
+        }
+        int bucket = (int)(entry->hash & (uint32_t)(count - 1));
+        entry->bucket_next = buckets[bucket];
+        buckets[bucket] = i;
+    }
+
+    free(cache->buckets);
+    cache->buckets = buckets;
+    cache->bucket_count = count;
+    return true;
+}
+
+// 分配一个空槽位（失败返回-1）
+static int text_cache_alloc_entry(TextCache *cache) {
+    if (cache->free_list != TEXT_CACHE_NONE) {
+        int index = cache->free_list;
+        cache->free_list = cache->entries[index].bucket_next;
+        return index;
+    }
+
+    if (cache->entry_count == cache->entry_capacity) {
+        int capacity = cache->entry_capacity > 0 ? cache->entry_capacity * 2 : 256;
+        TextCacheEntry *entries = (TextCacheEntry*)realloc(cache->entries, sizeof(TextCacheEntry) * (size_t)capacity);
+        if (!entries) {
+            return TEXT_CACHE_NONE;
+        }
+        cache->entries = entries;
+        cache->entry_capacity = capacity;
+    }
+    return cache->entry_count++;
+}
+
+// 最久未使用一项的帧号（纹理管理器回调）
+static Uint64 text_cache_oldest(void *owner) {
+    TextCache *cache = (TextCache*)owner;
+    if (cache->lru_tail == TEXT_CACHE_NONE) {
+        return UINT64_MAX;
+    }
+    return cache->entries[cache->lru_tail].last_used;
+}
+
+// 淘汰最久未使用的一项（纹理管理器回调）
+static void text_cache_evict(void *owner) {
+    TextCache *cache = (TextCache*)owner;
+    if (cache->lru_tail != TEXT_CACHE_NONE) {
+        text_cache_remove(cache, cache->lru_tail);
+        cache->evictions++;
+    }
+}
+
+// 创建文字纹理缓存
+TextCache* text_cache_new(SDL_Renderer *renderer, TextureManager *textures, size_t max_bytes) {
+    if (!renderer) {
+        return NULL;
+    }
+
+    TextCache *cache = (TextCache*)calloc(1, sizeof(TextCache));
+    if (!cache) {
+        return NULL;
+    }
+
+    cache->renderer = renderer;
+    cache->textures = textures;
+    cache->free_list = TEXT_CACHE_NONE;
+    cache->lru_head = TEXT_CACHE_NONE;
+    cache->lru_tail = TEXT_CACHE_NONE;
+    cache->max_bytes = max_bytes > 0 ? max_bytes : TEXT_CACHE_DEFAULT_BUDGET;
+    if (!text_cache_grow_buckets(cache)) {
+        free(cache);
+        return NULL;
+    }
+    texture_manager_register(textures, TEXTURE_CATEGORY_TEXT, cache, text_cache_oldest, text_cache_evict);
+    return cache;
+}
+
+// 清空缓存
+void text_cache_clear(TextCache *cache) {
+    if (!cache) {
+        return;
+    }
+
+    while (cache->lru_head != TEXT_CACHE_NONE) {
+        text_cache_remove(cache, cache->lru_head);
+    }
+}
+
+// 释放缓存及其全部纹理
+void text_cache_free(TextCache *cache) {
+    if (!cache) {
+        return;
+    }
+
+    texture_manager_unregister(cache->textures, cache);
+    text_cache_clear(cache);
+    free(cache->entries);
+    free(cache->buckets);
+    free(cache);
+}
+
+// 获取文字纹理
+SDL_Texture* text_cache_get(TextCache *cache, TTF_Font *font, const char *text, size_t len,
+                            SDL_Color color, int *w, int *h) {
+    if (!cache || !font || !text) {
+        return NULL;
+    }
+    if (len == 0) {
+        len = strlen(text);
+    }
+    if (len == 0) {
+        return NULL;
+    }
+
+    // 1. 查找
+    Uint32 packed = text_cache_pack_color(color);
+    uint32_t hash = text_cache_hash(font, text, len, packed);
+    int index = cache->buckets[hash & (uint32_t)(cache->bucket_count - 1)];
+    while (index != TEXT_CACHE_NONE) {
+        TextCacheEntry *entry = &cache->entries[index];
+        if (entry->hash == hash && entry->font == font && entry->color == packed &&
+            entry->len == len && memcmp(entry->text, text, len) == 0) {
+            break;
+        }
+        index = entry->bucket_next;
+    }
+
+    if (index != TEXT_CACHE_NONE) {
+        cache->hits++;
+        text_cache_lru_unlink(cache, index);
+        text_cache_lru_push(cache, index);
+        TextCacheEntry *entry = &cache->entries[index];
+        entry->last_used = texture_manager_frame(cache->textures);
+        if (w) *w = entry->w;
+        if (h) *h = entry->h;
+        return entry->texture;
+    }
+
+    // 2. 未命中：光栅化并上传
+    cache->misses++;
+    SDL_Surface *surface = TTF_RenderText_Blended(font, text, len, color);
+    if (!surface) {
+        return NULL;
+    }
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(cache->renderer, surface);
+    int tex_w = surface->w;
+    int tex_h = surface->h;
+    SDL_DestroySurface(surface);
+    if (!texture) {
+        printf("[ERROR] Failed to create text texture: %s\n", SDL_GetError());
+        return NULL;
+    }
+
+    // 3. 超出内存上限时从最久未使用的一端淘汰
+    size_t bytes = (size_t)tex_w * (size_t)tex_h * 4;
+    while (cache->lru_tail != TEXT_CACHE_NONE && cache->bytes + bytes > cache->max_bytes) {
+        text_cache_remove(cache, cache->lru_tail);
+        cache->evictions++;
+    }
+
+    if (cache->live + 1 > cache->bucket_count) {
+        text_cache_grow_buckets(cache);
+    }
+    char *copy = (char*)malloc(len + 1);
+    index = copy ? text_cache_alloc_entry(cache) : TEXT_CACHE_NONE;
+    if (index == TEXT_CACHE_NONE) {
+        // 内存不足时本次不绘制
+        free(copy);
+        printf("[ERROR] Failed to grow text cache\n");
+        SDL_DestroyTexture(texture);
+        return NULL;
+    }
+    memcpy(copy, text, len);
+    copy[len] = '\0';
+
+    TextCacheEntry *entry = &cache->entries[index];
+    entry->text = copy;
+    entry->len = len;
+    entry->font = font;
+    entry->color = packed;
+    entry->hash = hash;
+    entry->texture = texture;
+    entry->w = tex_w;
+    entry->h = tex_h;
+    entry->bytes = bytes;
+    entry->last_used = texture_manager_frame(cache->textures);
+
+    int bucket = (int)(hash & (uint32_t)(cache->bucket_count - 1));
+    entry->bucket_next = cache->buckets[bucket];
+    cache->buckets[bucket] = index;
+    text_cache_lru_push(cache, index);
+    cache->live++;
+    cache->bytes += bytes;
+    texture_manager_track(cache->textures, TEXTURE_CATEGORY_TEXT, bytes);
+
+    if (w) *w = tex_w;
+    if (h) *h = tex_h;
+    return texture;
+}
+
+// 读取缓存统计
+void text_cache_get_stats(const TextCache *cache, TextCacheStats *stats) {
+    if (!stats) {
+        return;
+    }
+
+    memset(stats, 0, sizeof(TextCacheStats));
+    if (!cache) {
+        return;
+    }
+
+    stats->hits = cache->hits;
+    stats->misses = cache->misses;
+    stats->evictions = cache->evictions;
+    stats->entries = cache->live;
+    stats->bytes = cache->bytes;
+    stats->max_bytes = cache->max_bytes;
+}
+
+// 图集纹理页边长
+#define GLYPH_ATLAS_PAGE_SIZE 1024
+// 最多使用的纹理页数（写满后整体重置）
+#define GLYPH_ATLAS_MAX_PAGES 4
+// 字形之间的间隔（避免线性过滤时采到相邻字形）
+#define GLYPH_ATLAS_PADDING 1
+// 一个纹理页占用的内存
+#define GLYPH_ATLAS_PAGE_BYTES ((size_t)GLYPH_ATLAS_PAGE_SIZE * GLYPH_ATLAS_PAGE_SIZE * 4)
+
+// 一个已光栅化的字形
+typedef struct {
+    Uint32 ch;               // 码点
+    int page;                // 所在纹理页（没有图像时为-1）
+    int x;                   // 在纹理页中的位置
+    int y;
+    int w;                   // 字形图像大小
+    int h;
+    int offset_x;            // 图像相对笔位置的水平偏移
+    int advance;             // 笔位置前进量
+} Glyph;
+
+// 一个图集纹理页及其待提交的四边形
+typedef struct {
+    SDL_Texture *texture;    // 纹理
+    int shelf_x;             // 当前行已用宽度
+    int shelf_y;             // 当前行顶部
+    int shelf_h;             // 当前行高度
+    SDL_Vertex *vertices;    // 待提交的顶点（每个字形4个）
+    int vertex_count;
+    int vertex_capacity;
+    int *indices;            // 待提交的下标（每个字形6个）
+    int index_count;
+    int index_capacity;
+} GlyphPage;
+
+struct GlyphAtlas {
+    SDL_Renderer *renderer;  // 纹理所属的渲染器
+    TextureManager *textures; // 纹理管理器（可为NULL）
+    TTF_Font *font;          // 字体
+    int line_height;         // 行高
+    GlyphPage pages[GLYPH_ATLAS_MAX_PAGES]; // 纹理页
+    int page_count;          // 已创建的纹理页数
+    Glyph *glyphs;           // 字形
+    int glyph_count;
+    int glyph_capacity;
+    int *table;              // 码点 -> 字形下标（开放寻址，-1 为空）
+    int table_capacity;      // 2的幂
+    int draw_calls;          // 统计
+    int quads;
+    int resets;
+};
+
+// 码点哈希
+static uint32_t glyph_hash(Uint32 ch) {
+    return ch * 2654435761u;
+}
+
+// 重建码点哈希表（负载不超过一半）
+static bool glyph_atlas_grow_table(GlyphAtlas *atlas) {
+    int capacity = atlas->table_capacity > 0 ? atlas->table_capacity * 2 : 512;
+    int *table = (int*)malloc(sizeof(int) * (size_t)capacity);
+    if (!table) {
+        return false;
+    }
+
+    for (int i = 0; i < capacity; i++) {
+        table[i] = -1;
+    }
+    uint32_t mask = (uint32_t)capacity - 1;
+    for (int i = 0; i < atlas->glyph_count; i++) {
+        uint32_t slot = glyph_hash(atlas->glyphs[i].ch) & mask;
+        while (table[slot] >= 0) {
+            slot = (slot + 1) & mask;
+        }
+        table[slot] = i;
+    }
+
+    free(atlas->table);
+    atlas->table = table;
+    atlas->table_capacity = capacity;
+    return true;
+}
+
+// 清空全部字形和纹理页的排布（纹理保留复用）
+static void glyph_atlas_reset(GlyphAtlas *atlas) {
+    for (int i = 0; i < atlas->page_count; i++) {
+        atlas->pages[i].shelf_x = 0;
+        atlas->pages[i].shelf_y = 0;
+        atlas->pages[i].shelf_h = 0;
+    }
+    atlas->glyph_count = 0;
+    for (int i = 0; i < atlas->table_capacity; i++) {
+        atlas->table[i] = -1;
+    }
+    atlas->resets++;
+}
+
+// 在纹理页中为 w x h 的图像找位置（按行排布），失败返回 false
+static bool glyph_page_place(GlyphPage *page, int w, int h, int *x, int *y) {
+    int padded_w = w + GLYPH_ATLAS_PADDING;
+    int padded_h = h + GLYPH_ATLAS_PADDING;
+    if (page->shelf_x + padded_w > GLYPH_ATLAS_PAGE_SIZE) {
+        page->shelf_y += page->shelf_h;
+        page->shelf_x = 0;
+        page->shelf_h = 0;
+    }
+    if (page->shelf_y + padded_h > GLYPH_ATLAS_PAGE_SIZE || padded_w > GLYPH_ATLAS_PAGE_SIZE) {
+        return false;
+    }
+
+    *x = page->shelf_x;
+    *y = page->shelf_y;
+    page->shelf_x += padded_w;
+    if (padded_h > page->shelf_h) {
+        page->shelf_h = padded_h;
+    }
+    return true;
+}
+
+// 为字形图像分配位置，必要时新建纹理页；全部写满时先提交批次再重置图集
+static int glyph_atlas_place(GlyphAtlas *atlas, int w, int h, int *x, int *y) {
+    if (w + GLYPH_ATLAS_PADDING > GLYPH_ATLAS_PAGE_SIZE || h + GLYPH_ATLAS_PADDING > GLYPH_ATLAS_PAGE_SIZE) {
+        return -1;
+    }
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        for (int i = 0; i < atlas->page_count; i++) {
+            if (glyph_page_place(&atlas->pages[i], w, h, x, y)) {
+                return i;
+            }
+        }
+
+        if (atlas->page_count < GLYPH_ATLAS_MAX_PAGES) {
+            GlyphPage *page = &atlas->pages[atlas->page_count];
+            page->texture = SDL_CreateTexture(atlas->renderer, SDL_PIXELFORMAT_ARGB8888,
+                                              SDL_TEXTUREACCESS_STATIC,
+                                              GLYPH_ATLAS_PAGE_SIZE, GLYPH_ATLAS_PAGE_SIZE);
+            if (page->texture) {
+                SDL_SetTextureBlendMode(page->texture, SDL_BLENDMODE_BLEND);
+                texture_manager_track(atlas->textures, TEXTURE_CATEGORY_GLYPHS, GLYPH_ATLAS_PAGE_BYTES);
+                atlas->page_count++;
+                if (glyph_page_place(page, w, h, x, y)) {
+                    return atlas->page_count - 1;
+                }
+            } else {
+                printf("[ERROR] Failed to create glyph atlas page: %s\n", SDL_GetError());
+            }
+        }
+
+        // 已排队的四边形引用旧的排布，先提交
+        glyph_atlas_flush(atlas);
+        glyph_atlas_reset(atlas);
+    }
+    return -1;
+}
+
+// 光栅化字形并放入图集，返回字形（失败返回NULL）
+static const Glyph* glyph_atlas_add(GlyphAtlas *atlas, Uint32 ch) {
+    if ((atlas->glyph_count + 1) * 2 > atlas->table_capacity && !glyph_atlas_grow_table(atlas)) {
+        return NULL;
+    }
+    if (atlas->glyph_count == atlas->glyph_capacity) {
+        int capacity = atlas->glyph_capacity > 0 ? atlas->glyph_capacity * 2 : 256;
+        Glyph *glyphs = (Glyph*)realloc(atlas->glyphs, sizeof(Glyph) * (size_t)capacity);
+        if (!glyphs) {
+            return NULL;
+        }
+        atlas->glyphs = glyphs;
+        atlas->glyph_capacity = capacity;
+    }
+
+    Glyph glyph;
+    memset(&glyph, 0, sizeof(Glyph));
+    glyph.ch = ch;
+    glyph.page = -1;
+
+    int minx = 0, maxx = 0, miny = 0, maxy = 0, advance = 0;
+    if (TTF_GetGlyphMetrics(atlas->font, ch, &minx, &maxx, &miny, &maxy, &advance)) {
+        glyph.advance = advance;
+        glyph.offset_x = minx < 0 ? minx : 0;
+    }
+
+    // 空白等没有图像的字形只记录前进量
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface *surface = maxx > minx ? TTF_RenderGlyph_Blended(atlas->font, ch, white) : NULL;
+    if (surface && surface->format != SDL_PIXELFORMAT_ARGB8888) {
+        SDL_Surface *converted = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_ARGB8888);
+        SDL_DestroySurface(surface);
+        surface = converted;
+    }
+    if (surface && surface->w > 0 && surface->h > 0) {
+        int x = 0, y = 0;
+        int page = glyph_atlas_place(atlas, surface->w, surface->h, &x, &y);
+        SDL_Rect rect = {x, y, surface->w, surface->h};
+        if (page >= 0 && SDL_UpdateTexture(atlas->pages[page].texture, &rect, surface->pixels, surface->pitch)) {
+            glyph.page = page;
+            glyph.x = x;
+            glyph.y = y;
+            glyph.w = surface->w;
+            glyph.h = surface->h;
+        }
+    }
+    SDL_DestroySurface(surface);
+
+    // 图集重置后哈希表已清空，重新插入
+    uint32_t mask = (uint32_t)atlas->table_capacity - 1;
+    uint32_t slot = glyph_hash(ch) & mask;
+    while (atlas->table[slot] >= 0) {
+        slot = (slot + 1) & mask;
+    }
+    atlas->table[slot] = atlas->glyph_count;
+    atlas->glyphs[atlas->glyph_count] = glyph;
+    return &atlas->glyphs[atlas->glyph_count++];
+}
+
+// 查找字形，没有时光栅化
+static const Glyph* glyph_atlas_get(GlyphAtlas *atlas, Uint32 ch) {
+    uint32_t mask = (uint32_t)atlas->table_capacity - 1;
+    for (uint32_t slot = glyph_hash(ch) & mask; atlas->table[slot] >= 0; slot = (slot + 1) & mask) {
+        const Glyph *glyph = &atlas->glyphs[atlas->table[slot]];
+        if (glyph->ch == ch) {
+            return glyph;
+        }
+    }
+    return glyph_atlas_add(atlas, ch);
+}
+
+// 创建字形图集
+GlyphAtlas* glyph_atlas_new(SDL_Renderer *renderer, TTF_Font *font, TextureManager *textures) {
+    if (!renderer || !font) {
+        return NULL;
+    }
+
+    GlyphAtlas *atlas = (GlyphAtlas*)calloc(1, sizeof(GlyphAtlas));
+    if (!atlas) {
+        return NULL;
+    }
+
+    atlas->renderer = renderer;
+    atlas->textures = textures;
+    atlas->font = font;
+    atlas->line_height = TTF_GetFontHeight(font);
+    if (!glyph_atlas_grow_table(atlas)) {
+        free(atlas);
+        return NULL;
+    }
+    return atlas;
+}
+
+// 释放图集
+void glyph_atlas_free(GlyphAtlas *atlas) {
+    if (!atlas) {
+        return;
+    }
+
+    for (int i = 0; i < atlas->page_count; i++) {
+        SDL_DestroyTexture(atlas->pages[i].texture);
+        texture_manager_untrack(atlas->textures, TEXTURE_CATEGORY_GLYPHS, GLYPH_ATLAS_PAGE_BYTES);
+        free(atlas->pages[i].vertices);
+        free(atlas->pages[i].indices);
+    }
+    free(atlas->glyphs);
+    free(atlas->table);
+    free(atlas);
+}
+
+// 计算文字按图集排版后的宽高
+bool glyph_atlas_measure(GlyphAtlas *atlas, const char *text, size_t len, int *w, int *h) {
+    if (!atlas || !text) {
+        return false;
+    }
+    if (len == 0) {
+        len = strlen(text);
+    }
+
+    int width = 0;
+    Uint32 previous = 0;
+    while (len > 0) {
+        Uint32 ch = SDL_StepUTF8(&text, &len);
+        const Glyph *glyph = glyph_atlas_get(atlas, ch);
+        if (!glyph) {
+            continue;
+        }
+        int kerning = 0;
+        if (previous && TTF_GetGlyphKerning(atlas->font, previous, ch, &kerning)) {
+            width += kerning;
+        }
+        width += glyph->advance;
+        previous = ch;
+    }
+
+    if (w) *w = width;
+    if (h) *h = atlas->line_height;
+    return true;
+}
+
+// 为纹理页的待提交数组预留 quads 个四边形
+static bool glyph_page_reserve(GlyphPage *page, int quads) {
+    if (page->vertex_count + quads * 4 > page->vertex_capacity) {
+        int capacity = page->vertex_capacity > 0 ? page->vertex_capacity : 1024;
+        while (capacity < page->vertex_count + quads * 4) {
+            capacity *= 2;
+        }
+        SDL_Vertex *vertices = (SDL_Vertex*)realloc(page->vertices, sizeof(SDL_Vertex) * (size_t)capacity);
+        if (!vertices) {
+            return false;
+        }
+        page->vertices = vertices;
+        page->vertex_capacity = capacity;
+    }
+    if (page->index_count + quads * 6 > page->index_capacity) {
+        int capacity = page->index_capacity > 0 ? page->index_capacity : 1536;
+        while (capacity < page->index_count + quads * 6) {
+            capacity *= 2;
+        }
+        int *indices = (int*)realloc(page->indices, sizeof(int) * (size_t)capacity);
+        if (!indices) {
+            return false;
+        }
+        page->indices = indices;
+        page->index_capacity = capacity;
+    }
+    return true;
+}
+
+// 把文字加入当前批次
+bool glyph_atlas_draw(GlyphAtlas *atlas, const char *text, size_t len, float x, float y,
+                      SDL_Color color, float max_width) {
+    if (!atlas || !text) {
+        return false;
+    }
+    if (len == 0) {
+        len = strlen(text);
+    }
+
+    SDL_FColor fcolor = {color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f};
+    float scale = 1.0f / GLYPH_ATLAS_PAGE_SIZE;
+    float limit = max_width > 0 ? x + max_width : 0;
+
+    // 对齐到整像素，图集纹素和屏幕像素一一对应
+    float pen = SDL_roundf(x);
+    float top = SDL_roundf(y);
+    Uint32 previous = 0;
+    while (len > 0) {
+        Uint32 ch = SDL_StepUTF8(&text, &len);
+        const Glyph *glyph = glyph_atlas_get(atlas, ch);
+        if (!glyph) {
+            continue;
+        }
+        int kerning = 0;
+        if (previous && TTF_GetGlyphKerning(atlas->font, previous, ch, &kerning)) {
+            pen += (float)kerning;
+        }
+        previous = ch;
+
+        if (glyph->page >= 0) {
+            float left = pen + (float)glyph->offset_x;
+            float right = left + (float)glyph->w;
+            if (limit > 0 && right > limit) {
+                break;
+            }
+
+            GlyphPage *page = &atlas->pages[glyph->page];
+            if (!glyph_page_reserve(page, 1)) {
+                return false;
+            }
+
+            float u0 = (float)glyph->x * scale;
+            float v0 = (float)glyph->y * scale;
+            float u1 = (float)(glyph->x + glyph->w) * scale;
+            float v1 = (float)(glyph->y + glyph->h) * scale;
+            float bottom = top + (float)glyph->h;
+
+            int base = page->vertex_count;
+            SDL_Vertex *v = &page->vertices[base];
+            v[0] = (SDL_Vertex){{left, top}, fcolor, {u0, v0}};
+            v[1] = (SDL_Vertex){{right, top}, fcolor, {u1, v0}};
+            v[2] = (SDL_Vertex){{right, bottom}, fcolor, {u1, v1}};
+            v[3] = (SDL_Vertex){{left, bottom}, fcolor, {u0, v1}};
+            page->vertex_count += 4;
+
+            int *index = &page->indices[page->index_count];
+            index[0] = base;
+            index[1] = base + 1;
+            index[2] = base + 2;
+            index[3] = base;
+            index[4] = base + 2;
+            index[5] = base + 3;
+            page->index_count += 6;
+        }
+        pen += (float)glyph->advance;
+    }
+    return true;
+}
+
+// 提交当前批次
+void glyph_atlas_flush(GlyphAtlas *atlas) {
+    if (!atlas) {
+        return;
+    }
+
+    for (int i = 0; i < atlas->page_count; i++) {
+        GlyphPage *page = &atlas->pages[i];
+        if (page->index_count == 0) {
+            continue;
+        }
+        if (!SDL_RenderGeometry(atlas->renderer, page->texture, page->vertices, page->vertex_count,
+                                page->indices, page->index_count)) {
+            printf("[ERROR] Failed to render glyph batch: %s\n", SDL_GetError());
+        }
+        atlas->draw_calls++;
+        atlas->quads += page->index_count / 6;
+        page->vertex_count = 0;
+        page->index_count = 0;
+    }
+}
+
+// 读取图集统计
+void glyph_atlas_get_stats(const GlyphAtlas *atlas, GlyphAtlasStats *stats) {
+    if (!stats) {
+        return;
+    }
+
+    memset(stats, 0, sizeof(GlyphAtlasStats));
+    if (!atlas) {
+        return;
+    }
+
+    stats->glyphs = atlas->glyph_count;
+    stats->pages = atlas->page_count;
+    stats->draw_calls = atlas->draw_calls;
+    stats->quads = atlas->quads;
+    stats->resets = atlas->resets;
+}
+
+// 界面文字宽高
+bool ui_text_size(struct Window *window, const char *text, size_t len, int *w, int *h) {
+    if (!window || !text) {
+        return false;
+    }
+    if (window->glyph_atlas) {
+        return glyph_atlas_measure(window->glyph_atlas, text, len, w, h);
+    }
+    return window->font && TTF_GetStringSize(window->font, text, len, w, h);
+}
+
+// 绘制界面文字
+void ui_text_draw(struct Window *window, const char *text, size_t len, float x, float y,
+                  SDL_Color color, float max_width) {
+    if (!window || !text) {
+        return;
+    }
+    // 图集取代文字纹理缓存；缓存只在图集创建失败时作为后备
+    if (window->glyph_atlas) {
+        glyph_atlas_draw(window->glyph_atlas, text, len, x, y, color, max_width);
+        return;
+    }
+
+    int text_w = 0;
+    int text_h = 0;
+    SDL_Texture *texture = text_cache_get(window->text_cache, window->font, text, len, color, &text_w, &text_h);
+    if (!texture) {
+        return;
+    }
+
+    // 超出宽度的部分裁掉（不缩放）
+    SDL_FRect src = {0, 0, (float)text_w, (float)text_h};
+    if (max_width > 0 && src.w > max_width) {
+        src.w = max_width;
+    }
+    SDL_FRect dst = {x, y, src.w, src.h};
+    SDL_RenderTexture(window->renderer, texture, &src, &dst);
+}
+
+// 提交已加入批次的界面文字
+void ui_text_flush(struct Window *window) {
+    if (window) {
+        glyph_atlas_flush(window->glyph_atlas);
+    }
+}
+
+struct UiLayer {
+    SDL_Renderer *renderer;  // 纹理所属的渲染器
+    TextureManager *textures; // 纹理管理器（可为NULL）
+    SDL_Texture *texture;    // 面板内容（大小与面板相同）
+    SDL_Rect rect;           // 面板在窗口中的区域
+    SDL_Color clear_color;   // 重绘前的填充颜色
+    SDL_Rect damage;         // 本次重绘的矩形（窗口坐标）
+    bool valid;              // 纹理内容是否完整（首次绘制前只能整体重绘）
+    UiLayerStats stats;      // 统计
+};
+
+// 创建面板缓存
+UiLayer* ui_layer_new(SDL_Renderer *renderer, TextureManager *textures, SDL_Rect rect, SDL_Color clear_color) {
+    if (!renderer || rect.w <= 0 || rect.h <= 0) {
+        return NULL;
+    }
+
+    UiLayer *layer = (UiLayer*)calloc(1, sizeof(UiLayer));
+    if (!layer) {
+        return NULL;
+    }
+
+    layer->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                                       rect.w, rect.h);
+    if (!layer->texture) {
+        printf("[ERROR] Failed to create layer texture: %s\n", SDL_GetError());
+        free(layer);
+        return NULL;
+    }
+
+    // 面板不透明，合成时直接覆盖
+    SDL_SetTextureBlendMode(layer->texture, SDL_BLENDMODE_NONE);
+    texture_manager_track(textures, TEXTURE_CATEGORY_LAYERS, (size_t)rect.w * (size_t)rect.h * 4);
+    layer->renderer = renderer;
+    layer->textures = textures;
+    layer->rect = rect;
+    layer->clear_color = clear_color;
+    return layer;
+}
+
+// 释放面板缓存
+void ui_layer_free(UiLayer *layer) {
+    if (!layer) {
+        return;
+    }
+
+    SDL_DestroyTexture(layer->texture);
+    texture_manager_untrack(layer->textures, TEXTURE_CATEGORY_LAYERS,
+                            (size_t)layer->rect.w * (size_t)layer->rect.h * 4);
+    free(layer);
+}
+
+// 开始重绘面板
+bool ui_layer_begin(UiLayer *layer, struct Window *window, const SDL_Rect *dirty) {
+    if (!layer || !window || window->active_layer) {
+        return false;
+    }
+
+    // 纹理内容不完整时（首次绘制）整体重绘
+    SDL_Rect damage = layer->rect;
+    bool partial = layer->valid && dirty && dirty->w > 0 && dirty->h > 0;
+    if (partial && !SDL_GetRectIntersection(dirty, &layer->rect, &damage)) {
+        return false;
+    }
+
+    SDL_Renderer *renderer = layer->renderer;
+    if (!SDL_SetRenderTarget(renderer, layer->texture)) {
+        printf("[ERROR] Failed to set layer render target: %s\n", SDL_GetError());
+        return false;
+    }
+
+    // 视口原点移到面板左上角的相反位置，面板内的绘制代码仍使用窗口坐标
+    SDL_Rect viewport = {
+        -layer->rect.x,
+        -layer->rect.y,
+        layer->rect.x + layer->rect.w,
+        layer->rect.y + layer->rect.h
+    };
+    SDL_SetRenderViewport(renderer, &viewport);
+    SDL_SetRenderClipRect(renderer, &damage);
+
+    // 先填充重绘区域（直接覆盖，不与旧内容混合）
+    SDL_BlendMode blend_mode = SDL_BLENDMODE_NONE;
+    SDL_GetRenderDrawBlendMode(renderer, &blend_mode);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, layer->clear_color.r, layer->clear_color.g,
+                           layer->clear_color.b, layer->clear_color.a);
+    SDL_FRect fill = {(float)damage.x, (float)damage.y, (float)damage.w, (float)damage.h};
+    SDL_RenderFillRect(renderer, &fill);
+    SDL_SetRenderDrawBlendMode(renderer, blend_mode);
+
+    layer->damage = damage;
+    layer->stats.renders++;
+    if (partial) {
+        layer->stats.partial_renders++;
+    }
+    layer->stats.pixels += (Uint64)damage.w * (Uint64)damage.h;
+    window->active_layer = layer;
+    return true;
+}
+
+// 结束重绘
+void ui_layer_end(UiLayer *layer, struct Window *window) {
+    if (!layer || !window || window->active_layer != layer) {
+        return;
+    }
+
+    // 文字批次必须在切换渲染目标之前提交
+    ui_text_flush(window);
+
+    SDL_Renderer *renderer = layer->renderer;
+    SDL_SetRenderClipRect(renderer, NULL);
+    SDL_SetRenderViewport(renderer, NULL);
+    SDL_SetRenderTarget(renderer, NULL);
+    window->active_layer = NULL;
+    layer->valid = true;
+}
+
+// 把面板纹理合成到当前渲染目标
+void ui_layer_composite(UiLayer *layer) {
+    if (!layer) {
+        return;
+    }
+
+    SDL_FRect dst = {(float)layer->rect.x, (float)layer->rect.y, (float)layer->rect.w, (float)layer->rect.h};
+    SDL_RenderTexture(layer->renderer, layer->texture, NULL, &dst);
+}
+
+// 读取面板缓存统计
+void ui_layer_get_stats(const UiLayer *layer, UiLayerStats *stats) {
+    if (!stats) {
+        return;
+    }
+
+    if (layer) {
+        *stats = layer->stats;
+    } else {
+        memset(stats, 0, sizeof(UiLayerStats));
+    }
+}
+
+// 设置裁剪区域
+void ui_set_clip_rect(struct Window *window, const SDL_Rect *rect) {
+    if (!window || !window->renderer) {
+        return;
+    }
+
+    UiLayer *layer = window->active_layer;
+    if (!layer) {
+        SDL_SetRenderClipRect(window->renderer, rect);
+        return;
+    }
+
+    // 重绘面板缓存时不能画到重绘矩形之外（那里保留着上一次的内容）
+    SDL_Rect clip = layer->damage;
+    if (rect && !SDL_GetRectIntersection(rect, &layer->damage, &clip)) {
+        clip.w = 0;
+        clip.h = 0;
+    }
+    SDL_SetRenderClipRect(window->renderer, &clip);
+}
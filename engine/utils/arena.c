@@ -0,0 +1,188 @@
+/*
+ * 线性内存分配模块
+ * 职责：
+ * 1. 为生命周期相同的大量小对象提供快速分配（指针递增）
+ * 2. 整体重置代替逐个释放
+ * 3. 重置后复用已申请的内存块，减少 malloc/free 次数
+ */
+
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 默认内存块大小
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+// 重置时最多保留的内存总量，超出部分归还系统
+#define ARENA_MAX_RETAINED (16 * 1024 * 1024)
+// 分配对齐
+#define ARENA_ALIGNMENT (sizeof(void*) > sizeof(double) ? sizeof(void*) : sizeof(double))
+
+// 内存块数据区起始地址（紧跟在块头之后）
+static char* block_data(ArenaBlock *block) {
+    return (char*)block + ((sizeof(ArenaBlock) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1));
+}
+
+// 申请新内存块
+static ArenaBlock* block_new(size_t size) {
+    size_t header = (sizeof(ArenaBlock) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+    ArenaBlock *block = (ArenaBlock*)malloc(header + size);
+    if (!block) {
+        return NULL;
+    }
+
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+// 初始化分配器（block_size 为0时使用默认大小）
+void arena_init(Arena *arena, size_t block_size) {
+    if (!arena) {
+        return;
+    }
+
+    arena->first = NULL;
+    arena->current = NULL;
+    arena->block_size = block_size > 0 ? block_size : ARENA_DEFAULT_BLOCK_SIZE;
+}
+
+// 释放分配器占用的全部内存
+void arena_destroy(Arena *arena) {
+    if (!arena) {
+        return;
+    }
+
+    ArenaBlock *block = arena->first;
+    while (block) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+
+    arena->first = NULL;
+    arena->current = NULL;
+}
+
+// 分配内存（按指针大小对齐，内容未初始化）
+void* arena_alloc(Arena *arena, size_t size) {
+    if (!arena) {
+        return NULL;
+    }
+
+    size = (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+
+    // 当前块放不下时，依次尝试重置后保留下来的块
+    ArenaBlock *block = arena->current;
+    while (block && block->size - block->used < size) {
+        block = block->next;
+        if (block) {
+            block->used = 0;
+        }
+    }
+
+    if (!block) {
+        size_t block_size = size > arena->block_size ? size : arena->block_size;
+        block = block_new(block_size);
+        if (!block) {
+            return NULL;
+        }
+
+        // 新块接在当前块之后，保持链表顺序即分配顺序
+        if (arena->current) {
+            block->next = arena->current->next;
+            arena->current->next = block;
+        } else {
+            block->next = arena->first;
+            arena->first = block;
+        }
+    }
+
+    arena->current = block;
+    void *ptr = block_data(block) + block->used;
+    block->used += size;
+    return ptr;
+}
+
+// 分配并清零
+void* arena_calloc(Arena *arena, size_t size) {
+    void *ptr = arena_alloc(arena, size);
+    if (ptr) {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+// 复制指定长度的字符串（自动补 '\0'）
+char* arena_strndup(Arena *arena, const char *str, size_t len) {
+    if (!str) {
+        return NULL;
+    }
+
+    char *copy = (char*)arena_alloc(arena, len + 1);
+    if (!copy) {
+        return NULL;
+    }
+
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+// 复制字符串
+char* arena_strdup(Arena *arena, const char *str) {
+    if (!str) {
+        return NULL;
+    }
+    return arena_strndup(arena, str, strlen(str));
+}
+
+// 已分配的字节数（含对齐填充）
+size_t arena_used(const Arena *arena) {
+    if (!arena) {
+        return 0;
+    }
+
+    // 当前块之后是重置时保留下来、尚未复用的块
+    size_t used = 0;
+    for (const ArenaBlock *block = arena->first; block; block = block->next) {
+        used += block->used;
+        if (block == arena->current) {
+            break;
+        }
+    }
+    return used;
+}
+
+// 重置分配器：之前分配的内存全部失效，保留部分内存块供复用
+void arena_reset(Arena *arena) {
+    if (!arena || !arena->first) {
+        return;
+    }
+
+    // 保留前面的内存块，超出上限的部分释放
+    size_t retained = 0;
+    ArenaBlock *block = arena->first;
+    ArenaBlock *last_kept = NULL;
+    while (block && retained + block->size <= ARENA_MAX_RETAINED) {
+        retained += block->size;
+        last_kept = block;
+        block = block->next;
+    }
+
+    while (block) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+
+    if (!last_kept) {
+        arena->first = NULL;
+        arena->current = NULL;
+        return;
+    }
+
+    last_kept->next = NULL;
+    arena->first->used = 0;
+    arena->current = arena->first;
+}
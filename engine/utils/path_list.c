@@ -0,0 +1,270 @@
+/*
+ * 路径列表模块
+ * 职责：
+ * 1. 紧凑保存大量路径（同一目录下的路径只存文件名部分）
+ * 2. 每个路径编码为与前一个路径的公共前缀长度、后缀长度和后缀
+ * 3. 定期保存完整路径作为解码起点，按序号读取时不必从头解码
+ */
+
+#include "path_list.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 每隔多少个路径保存一次完整路径
+#define PATH_LIST_RESTART_INTERVAL 16
+// 编码数据的初始容量
+#define PATH_LIST_INITIAL_CAPACITY 256
+
+// 路径列表
+struct PathList {
+    unsigned char *data;     // 编码后的路径
+    size_t size;             // 已使用字节数
+    size_t capacity;         // 容量
+    size_t *restarts;        // 每个完整路径的起始偏移
+    int restart_capacity;    // 起始偏移数组容量
+    int count;               // 路径数
+    size_t total_len;        // 全部路径的长度之和（不含结尾 '\0'）
+    char *last;              // 最后加入的路径（编码下一个路径时比较公共前缀）
+    size_t last_len;         // 最后加入的路径长度
+    size_t last_capacity;    // last 的容量
+};
+
+// 确保编码数据还能写入 extra 字节
+static bool path_list_reserve(PathList *list, size_t extra) {
+    if (list->size + extra <= list->capacity) {
+        return true;
+    }
+
+    size_t capacity = list->capacity > 0 ? list->capacity : PATH_LIST_INITIAL_CAPACITY;
+    while (capacity < list->size + extra) {
+        capacity *= 2;
+    }
+    unsigned char *data = (unsigned char*)realloc(list->data, capacity);
+    if (!data) {
+        return false;
+    }
+    list->data = data;
+    list->capacity = capacity;
+    return true;
+}
+
+// 写入变长整数（每字节7位，最高位表示后面还有字节）
+static void path_list_write_varint(PathList *list, size_t value) {
+    while (value >= 0x80) {
+        list->data[list->size++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    list->data[list->size++] = (unsigned char)value;
+}
+
+// 读取变长整数
+static size_t path_list_read_varint(const unsigned char *data, size_t *offset) {
+    size_t value = 0;
+    int shift = 0;
+    unsigned char byte;
+    do {
+        byte = data[(*offset)++];
+        value |= (size_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return value;
+}
+
+// 创建空列表
+PathList* path_list_new(void) {
+    return (PathList*)calloc(1, sizeof(PathList));
+}
+
+// 释放列表
+void path_list_free(PathList *list) {
+    if (!list) {
+        return;
+    }
+    free(list->data);
+    free(list->restarts);
+    free(list->last);
+    free(list);
+}
+
+// 复制列表
+PathList* path_list_copy(const PathList *list) {
+    if (!list) {
+        return NULL;
+    }
+
+    PathList *copy = path_list_new();
+    if (!copy) {
+        return NULL;
+    }
+    int restart_count = (list->count + PATH_LIST_RESTART_INTERVAL - 1) / PATH_LIST_RESTART_INTERVAL;
+    copy->data = list->size > 0 ? (unsigned char*)malloc(list->size) : NULL;
+    copy->restarts = restart_count > 0 ? (size_t*)malloc(sizeof(size_t) * (size_t)restart_count) : NULL;
+    copy->last = list->last ? (char*)malloc(list->last_len + 1) : NULL;
+    if ((list->size > 0 && !copy->data) || (restart_count > 0 && !copy->restarts) || (list->last && !copy->last)) {
+        path_list_free(copy);
+        return NULL;
+    }
+
+    if (list->size > 0) {
+        memcpy(copy->data, list->data, list->size);
+    }
+    if (restart_count > 0) {
+        memcpy(copy->restarts, list->restarts, sizeof(size_t) * (size_t)restart_count);
+    }
+    if (list->last) {
+        memcpy(copy->last, list->last, list->last_len + 1);
+    }
+    copy->size = list->size;
+    copy->capacity = list->size;
+    copy->restart_capacity = restart_count;
+    copy->count = list->count;
+    copy->total_len = list->total_len;
+    copy->last_len = list->last_len;
+    copy->last_capacity = list->last ? list->last_len + 1 : 0;
+    return copy;
+}
+
+// 追加路径
+bool path_list_add(PathList *list, const char *path) {
+    if (!list || !path) {
+        return false;
+    }
+
+    size_t len = strlen(path);
+    bool restart = list->count % PATH_LIST_RESTART_INTERVAL == 0;
+
+    // 与前一个路径的公共前缀（解码起点保存完整路径）
+    size_t prefix = 0;
+    if (!restart) {
+        size_t limit = len < list->last_len ? len : list->last_len;
+        while (prefix < limit && list->last[prefix] == path[prefix]) {
+            prefix++;
+        }
+    }
+
+    // 先申请全部内存，失败时列表保持不变
+    if (restart && list->count / PATH_LIST_RESTART_INTERVAL >= list->restart_capacity) {
+        int capacity = list->restart_capacity > 0 ? list->restart_capacity * 2 : 16;
+        size_t *restarts = (size_t*)realloc(list->restarts, sizeof(size_t) * (size_t)capacity);
+        if (!restarts) {
+            return false;
+        }
+        list->restarts = restarts;
+        list->restart_capacity = capacity;
+    }
+    if (len + 1 > list->last_capacity) {
+        size_t capacity = list->last_capacity > 0 ? list->last_capacity : 64;
+        while (capacity < len + 1) {
+            capacity *= 2;
+        }
+        char *last = (char*)realloc(list->last, capacity);
+        if (!last) {
+            return false;
+        }
+        list->last = last;
+        list->last_capacity = capacity;
+    }
+    // 两个变长整数最多各占 (sizeof(size_t) * 8 + 6) / 7 字节
+    if (!path_list_reserve(list, (len - prefix) + 2 * ((sizeof(size_t) * 8 + 6) / 7))) {
+        return false;
+    }
+
+    if (restart) {
+        list->restarts[list->count / PATH_LIST_RESTART_INTERVAL] = list->size;
+    }
+    path_list_write_varint(list, prefix);
+    path_list_write_varint(list, len - prefix);
+    memcpy(list->data + list->size, path + prefix, len - prefix);
+    list->size += len - prefix;
+
+    memcpy(list->last + prefix, path + prefix, len - prefix + 1);
+    list->last_len = len;
+    list->total_len += len;
+    list->count++;
+    return true;
+}
+
+// 清空列表
+void path_list_clear(PathList *list) {
+    if (!list) {
+        return;
+    }
+    list->size = 0;
+    list->count = 0;
+    list->total_len = 0;
+    list->last_len = 0;
+}
+
+// 路径数
+int path_list_count(const PathList *list) {
+    return list ? list->count : 0;
+}
+
+// 编码后占用的字节数
+size_t path_list_encoded_size(const PathList *list) {
+    return list ? list->size : 0;
+}
+
+// 读取第 index 个路径
+size_t path_list_get(const PathList *list, int index, char *buffer, size_t size) {
+    if (!list || index < 0 || index >= list->count) {
+        if (buffer && size > 0) {
+            buffer[0] = '\0';
+        }
+        return 0;
+    }
+
+    // 从所在区段的完整路径开始解码；buffer 只保留前 size-1 个字节，
+    // 后面的路径按位置取前一个路径的前缀或自己的后缀，截断不影响已保留的部分
+    size_t keep = buffer && size > 0 ? size - 1 : 0;
+    size_t offset = list->restarts[index / PATH_LIST_RESTART_INTERVAL];
+    size_t len = 0;
+    for (int i = index - index % PATH_LIST_RESTART_INTERVAL; i <= index; i++) {
+        size_t prefix = path_list_read_varint(list->data, &offset);
+        size_t suffix = path_list_read_varint(list->data, &offset);
+        if (prefix < keep) {
+            size_t copy = suffix < keep - prefix ? suffix : keep - prefix;
+            memcpy(buffer + prefix, list->data + offset, copy);
+        }
+        offset += suffix;
+        len = prefix + suffix;
+    }
+
+    if (buffer && size > 0) {
+        buffer[len < keep ? len : keep] = '\0';
+    }
+    return len;
+}
+
+// 展开为路径数组
+char** path_list_expand(const PathList *list) {
+    if (!list) {
+        return NULL;
+    }
+
+    size_t pointers = sizeof(char*) * (size_t)(list->count > 0 ? list->count : 1);
+    char **paths = (char**)malloc(pointers + list->total_len + (size_t)list->count);
+    if (!paths) {
+        return NULL;
+    }
+
+    // 按顺序解码，前缀从紧挨着的前一个路径复制
+    char *text = (char*)paths + pointers;
+    const char *previous = NULL;
+    size_t offset = 0;
+    for (int i = 0; i < list->count; i++) {
+        size_t prefix = path_list_read_varint(list->data, &offset);
+        size_t suffix = path_list_read_varint(list->data, &offset);
+        if (prefix > 0) {
+            memcpy(text, previous, prefix);
+        }
+        memcpy(text + prefix, list->data + offset, suffix);
+        offset += suffix;
+        text[prefix + suffix] = '\0';
+
+        paths[i] = text;
+        previous = text;
+        text += prefix + suffix + 1;
+    }
+    return paths;
+}
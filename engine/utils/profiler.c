@@ -0,0 +1,190 @@
+/*
+ * 性能计时模块
+ * 职责：
+ * 1. 记录关键路径（事件处理、各面板绘制、目录扫描、排序等）的耗时
+ * 2. 样本写入固定大小的环形缓冲区，不分配内存，可在任意线程调用
+ * 3. 按帧汇总各区段耗时，保留最近的帧耗时用于直方图
+ * 4. 导出 Chrome trace JSON，供离线分析
+ */
+
+#include "profiler.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 一个计时样本
+typedef struct {
+    Uint64 start_ns;         // 开始时间
+    Uint64 duration_ns;      // 耗时
+    SDL_ThreadID thread;     // 所在线程
+    ProfileSection section;  // 区段
+} ProfileSample;
+
+// 计时数据（全局，自旋锁保护；临界区只有几次赋值）
+static struct {
+    SDL_SpinLock lock;
+    ProfileSample samples[PROFILER_RING_CAPACITY]; // 环形缓冲区
+    Uint64 sample_count;                           // 累计写入的样本数
+    ProfileSectionStats sections[PROFILE_SECTION_COUNT];
+    Uint64 frame_accum[PROFILE_SECTION_COUNT];     // 当前帧内完成的计时之和
+    Uint64 frame_history[PROFILER_FRAME_HISTORY];  // 帧耗时历史
+    Uint64 frame_count;                            // 累计帧数
+    SDL_ThreadID ui_thread;                        // UI线程（导出时命名）
+} g_profiler;
+
+static const char *profile_section_names[PROFILE_SECTION_COUNT] = {
+    [PROFILE_FRAME]            = "frame",
+    [PROFILE_EVENTS]           = "events",
+    [PROFILE_UPDATE]           = "update",
+    [PROFILE_FILE_LIST_DRAW]   = "file_list_draw",
+    [PROFILE_SIDEBAR_DRAW]     = "sidebar_draw",
+    [PROFILE_TOOLBAR_DRAW]     = "toolbar_draw",
+    [PROFILE_PRESENT]          = "present",
+    [PROFILE_DIR_SCAN]         = "dir_scan",
+    [PROFILE_SORT]             = "sort",
+    [PROFILE_THUMBNAIL_DECODE] = "thumbnail_decode",
+};
+
+// 区段名称
+const char* profiler_section_name(ProfileSection section) {
+    if (section < 0 || section >= PROFILE_SECTION_COUNT) {
+        return "unknown";
+    }
+    return profile_section_names[section];
+}
+
+// 开始计时
+Uint64 profiler_begin(void) {
+    return SDL_GetTicksNS();
+}
+
+// 结束计时并记录一个样本
+void profiler_end(ProfileSection section, Uint64 start) {
+    if (section < 0 || section >= PROFILE_SECTION_COUNT) {
+        return;
+    }
+
+    Uint64 now = SDL_GetTicksNS();
+    Uint64 duration = now > start ? now - start : 0;
+    SDL_ThreadID thread = SDL_GetCurrentThreadID();
+
+    SDL_LockSpinlock(&g_profiler.lock);
+    ProfileSample *sample = &g_profiler.samples[g_profiler.sample_count % PROFILER_RING_CAPACITY];
+    sample->start_ns = start;
+    sample->duration_ns = duration;
+    sample->thread = thread;
+    sample->section = section;
+    g_profiler.sample_count++;
+
+    ProfileSectionStats *stats = &g_profiler.sections[section];
+    stats->calls++;
+    stats->total_ns += duration;
+    stats->last_ns = duration;
+    if (duration > stats->max_ns) {
+        stats->max_ns = duration;
+    }
+    g_profiler.frame_accum[section] += duration;
+    SDL_UnlockSpinlock(&g_profiler.lock);
+}
+
+// 一帧结束
+void profiler_end_frame(void) {
+    SDL_LockSpinlock(&g_profiler.lock);
+    g_profiler.ui_thread = SDL_GetCurrentThreadID();
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        g_profiler.sections[i].frame_ns = g_profiler.frame_accum[i];
+        g_profiler.frame_accum[i] = 0;
+    }
+    g_profiler.frame_history[g_profiler.frame_count % PROFILER_FRAME_HISTORY] =
+        g_profiler.sections[PROFILE_FRAME].frame_ns;
+    g_profiler.frame_count++;
+    SDL_UnlockSpinlock(&g_profiler.lock);
+}
+
+// 读取区段统计
+void profiler_get_section_stats(ProfileSection section, ProfileSectionStats *stats) {
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    if (section < 0 || section >= PROFILE_SECTION_COUNT) {
+        return;
+    }
+
+    SDL_LockSpinlock(&g_profiler.lock);
+    *stats = g_profiler.sections[section];
+    SDL_UnlockSpinlock(&g_profiler.lock);
+}
+
+// 读取最近的帧耗时
+int profiler_get_frame_history(Uint64 *frame_ns, int max_count) {
+    if (!frame_ns || max_count <= 0) {
+        return 0;
+    }
+
+    SDL_LockSpinlock(&g_profiler.lock);
+    Uint64 available = g_profiler.frame_count < PROFILER_FRAME_HISTORY ? g_profiler.frame_count : PROFILER_FRAME_HISTORY;
+    int count = (Uint64)max_count < available ? max_count : (int)available;
+    Uint64 first = g_profiler.frame_count - (Uint64)count;
+    for (int i = 0; i < count; i++) {
+        frame_ns[i] = g_profiler.frame_history[(first + (Uint64)i) % PROFILER_FRAME_HISTORY];
+    }
+    SDL_UnlockSpinlock(&g_profiler.lock);
+    return count;
+}
+
+// 导出 Chrome trace JSON（时间单位为微秒）
+bool profiler_export_chrome_trace(const char *path) {
+    if (!path) {
+        return false;
+    }
+
+    // 先复制样本再写文件，写文件期间不阻塞其它线程计时
+    ProfileSample *samples = (ProfileSample*)malloc(sizeof(ProfileSample) * PROFILER_RING_CAPACITY);
+    if (!samples) {
+        return false;
+    }
+    SDL_LockSpinlock(&g_profiler.lock);
+    Uint64 total = g_profiler.sample_count;
+    int count = total < PROFILER_RING_CAPACITY ? (int)total : PROFILER_RING_CAPACITY;
+    Uint64 first = total - (Uint64)count;
+    for (int i = 0; i < count; i++) {
+        samples[i] = g_profiler.samples[(first + (Uint64)i) % PROFILER_RING_CAPACITY];
+    }
+    SDL_ThreadID ui_thread = g_profiler.ui_thread;
+    SDL_UnlockSpinlock(&g_profiler.lock);
+
+    SDL_IOStream *io = SDL_IOFromFile(path, "w");
+    if (!io) {
+        printf("[ERROR] Failed to create trace file %s: %s\n", path, SDL_GetError());
+        free(samples);
+        return false;
+    }
+
+    bool ok = SDL_IOprintf(io, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n") > 0;
+    if (ui_thread != 0) {
+        ok = ok && SDL_IOprintf(io, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%llu,"
+                                    "\"args\":{\"name\":\"ui\"}},\n",
+                                (unsigned long long)ui_thread) > 0;
+    }
+    for (int i = 0; i < count && ok; i++) {
+        const ProfileSample *sample = &samples[i];
+        ok = SDL_IOprintf(io, "{\"name\":\"%s\",\"cat\":\"filescope\",\"ph\":\"X\",\"pid\":1,\"tid\":%llu,"
+                              "\"ts\":%.3f,\"dur\":%.3f}%s\n",
+                          profiler_section_name(sample->section),
+                          (unsigned long long)sample->thread,
+                          sample->start_ns / 1000.0, sample->duration_ns / 1000.0,
+                          i + 1 < count ? "," : "") > 0;
+    }
+    ok = ok && SDL_IOprintf(io, "]}\n") > 0;
+    if (!SDL_CloseIO(io)) {
+        ok = false;
+    }
+    free(samples);
+
+    if (!ok) {
+        printf("[ERROR] Failed to write trace file %s: %s\n", path, SDL_GetError());
+        return false;
+    }
+    printf("[DEBUG] Exported %d profiler samples to %s\n", count, path);
+    return true;
+}
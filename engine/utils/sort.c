@@ -6,3 +6,770 @@
  * 3. 排序性能优化
  * 4. 多字段排序支持
  */
+
+#include "sort.h"
+#include "thread_pool.h"
+#include "profiler.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 小于该长度的区间直接插入排序
+#define SORT_INSERTION_RUN 32
+
+// 记录数达到该值才使用线程池并行排序
+#define SORT_PARALLEL_THRESHOLD 65536
+
+// 并行排序最多分成的块数
+#define SORT_MAX_PARTS 64
+
+// 增量插入超过该数量时先排序再一次合并，否则逐个二分插入
+#define SORT_INSERT_BATCH 8
+
+// 主关键字可用位数（最高位留给“是否目录”）
+#define SORT_PRIMARY_MASK 0x7FFFFFFFFFFFFFFFull
+
+// 排序记录：整数关键字覆盖绝大多数比较，只有相同时才比较字符串
+typedef struct {
+    uint64_t k0;           // 是否目录 + 主关键字
+    uint32_t k1;           // 次关键字（名称排名，名称排序时为键的第8~11字节）
+    uint32_t index;        // 文件项下标
+} SortRecord;
+
+// 排序上下文
+typedef struct {
+    const FileList *list;
+    SortKey key;
+    bool descending;
+} SortContext;
+
+// 生成名称排序键：ASCII 字母转小写，数字串按数值编码，键之间用 strcmp 比较即为自然顺序
+size_t sort_make_name_key(const char *name, char *key, size_t *ext_offset) {
+    const unsigned char *src = (const unsigned char*)name;
+    unsigned char *dst = (unsigned char*)key;
+    size_t len = 0;
+    size_t ext = (size_t)-1;
+
+    while (*src) {
+        if (*src >= '0' && *src <= '9') {
+            // 数字串：跳过前导零（至少保留一位），编码为 '0' + 位数 + 数字
+            // '0' 保持数字与其它字符的相对顺序，位数保证 2 < 10
+            while (src[0] == '0' && src[1] >= '0' && src[1] <= '9') {
+                src++;
+            }
+            size_t digits = 0;
+            while (src[digits] >= '0' && src[digits] <= '9') {
+                digits++;
+            }
+            dst[len++] = '0';
+            dst[len++] = (unsigned char)(digits < 255 ? digits : 255);
+            memcpy(dst + len, src, digits);
+            len += digits;
+            src += digits;
+            continue;
+        }
+
+        unsigned char c = *src++;
+        if (c >= 'A' && c <= 'Z') {
+            c = (unsigned char)(c - 'A' + 'a');
+        }
+        // 以 . 开头的隐藏文件不算扩展名
+        if (c == '.' && len > 0) {
+            ext = len + 1;
+        }
+        dst[len++] = c;
+    }
+    dst[len] = '\0';
+
+    if (ext_offset) {
+        *ext_offset = (ext == (size_t)-1) ? len : ext;
+    }
+    return len;
+}
+
+// 取键的前8个字节作为整数（大端序，比较结果与 strcmp 一致）
+uint64_t sort_key_prefix(const char *key) {
+    uint64_t prefix = 0;
+    int i = 0;
+    for (; i < 8 && key[i]; i++) {
+        prefix = (prefix << 8) | (unsigned char)key[i];
+    }
+    return i > 0 ? prefix << (8 * (8 - i)) : 0;
+}
+
+// 排序键
+static const char* record_key(const SortContext *ctx, uint32_t index) {
+    return ctx->list->columns.key_pool + ctx->list->columns.key_offset[index];
+}
+
+// 比较两条记录（整数关键字相同时回退到字符串，最后按下标保证稳定）
+static inline int compare_records(const SortContext *ctx, const SortRecord *a, const SortRecord *b) {
+    if (a->k0 != b->k0) {
+        return a->k0 < b->k0 ? -1 : 1;
+    }
+
+    const FileColumns *cols = &ctx->list->columns;
+
+    // 扩展名超过7字节时前缀不能区分，比较完整扩展名（k0 相同则两者标记相同）
+    if (ctx->key == SORT_KEY_TYPE && (a->k0 & 1) != (uint64_t)ctx->descending) {
+        int result = strcmp(record_key(ctx, a->index) + cols->ext_offset[a->index],
+                            record_key(ctx, b->index) + cols->ext_offset[b->index]);
+        if (result != 0) {
+            return ctx->descending ? -result : result;
+        }
+    }
+
+    if (a->k1 != b->k1) {
+        return a->k1 < b->k1 ? -1 : 1;
+    }
+
+    // 只有按名称排序时 k1 可能相同：比较完整名称键，再比较原始名称
+    int result = 0;
+    if (ctx->key == SORT_KEY_NAME) {
+        result = strcmp(record_key(ctx, a->index), record_key(ctx, b->index));
+        if (result == 0) {
+            // 仅大小写或前导零不同的名称按原始字节排序
+            result = strcmp(cols->name_pool + cols->name_offset[a->index],
+                            cols->name_pool + cols->name_offset[b->index]);
+        }
+    }
+    if (result == 0) {
+        result = (a->index < b->index) ? -1 : (a->index > b->index);
+    }
+    return result;
+}
+
+// 生成排序记录（名称以外的关键字用名称排名作为次关键字）
+static void build_record(const SortContext *ctx, uint32_t index, SortRecord *record) {
+    const FileColumns *cols = &ctx->list->columns;
+    uint64_t dir_bit = (cols->type[index] == FILE_TYPE_DIRECTORY) ? 0 : (1ull << 63);
+    uint64_t primary = 0;
+    uint32_t secondary = (ctx->key == SORT_KEY_NAME) ? 0 : cols->name_rank[index];
+
+    switch (ctx->key) {
+        case SORT_KEY_NAME: {
+            // 键的前11字节（k0 放不下的最低位移到 k1），降序由名称排名直接得到
+            uint64_t prefix = cols->key_prefix[index];
+            uint64_t next = (prefix & 0xFF) ? sort_key_prefix(record_key(ctx, index) + 8) : 0;
+            primary = prefix >> 1;
+            secondary = (uint32_t)(((prefix & 1) << 31) | (next >> 33));
+            break;
+        }
+        case SORT_KEY_SIZE:
+            primary = cols->size[index] & SORT_PRIMARY_MASK;
+            break;
+        case SORT_KEY_TYPE: {
+            // 扩展名前7字节 + 是否更长的标记位
+            uint64_t ext_prefix = sort_key_prefix(record_key(ctx, index) + cols->ext_offset[index]);
+            bool ext_long = (ext_prefix & 0xFF) != 0;
+            primary = ((ext_prefix >> 8) << 7) | (ext_long ? 1 : 0);
+            break;
+        }
+        case SORT_KEY_DATE: {
+            // 有符号时间偏移到无符号区间
+            int64_t mtime = (int64_t)cols->modified_time[index];
+            primary = ((uint64_t)mtime + (1ull << 62)) & SORT_PRIMARY_MASK;
+            break;
+        }
+    }
+
+    if (ctx->descending) {
+        primary = ~primary & SORT_PRIMARY_MASK;
+    }
+
+    record->k0 = dir_bit | primary;
+    record->k1 = secondary;
+    record->index = index;
+}
+
+// 插入排序（短区间）
+static void insertion_sort(const SortContext *ctx, SortRecord *records, size_t count) {
+    for (size_t i = 1; i < count; i++) {
+        SortRecord value = records[i];
+        size_t j = i;
+        while (j > 0 && compare_records(ctx, &value, &records[j - 1]) < 0) {
+            records[j] = records[j - 1];
+            j--;
+        }
+        records[j] = value;
+    }
+}
+
+// 合并 src[lo, mid) 和 src[mid, hi) 到 dst[lo, hi)
+static void merge_runs(const SortContext *ctx, const SortRecord *src, SortRecord *dst,
+                       size_t lo, size_t mid, size_t hi) {
+    // 两段本来就有序时直接复制
+    if (mid == hi || compare_records(ctx, &src[mid - 1], &src[mid]) <= 0) {
+        memcpy(dst + lo, src + lo, (hi - lo) * sizeof(SortRecord));
+        return;
+    }
+
+    size_t i = lo;
+    size_t j = mid;
+    size_t k = lo;
+    while (i < mid && j < hi) {
+        // 相等时取左边，保证稳定
+        if (compare_records(ctx, &src[j], &src[i]) < 0) {
+            dst[k++] = src[j++];
+        } else {
+            dst[k++] = src[i++];
+        }
+    }
+    if (i < mid) {
+        memcpy(dst + k, src + i, (mid - i) * sizeof(SortRecord));
+    } else if (j < hi) {
+        memcpy(dst + k, src + j, (hi - j) * sizeof(SortRecord));
+    }
+}
+
+// 自底向上归并排序，结果留在 records 中
+static void merge_sort(const SortContext *ctx, SortRecord *records, SortRecord *temp, size_t count) {
+    for (size_t lo = 0; lo < count; lo += SORT_INSERTION_RUN) {
+        size_t n = count - lo < SORT_INSERTION_RUN ? count - lo : SORT_INSERTION_RUN;
+        insertion_sort(ctx, records + lo, n);
+    }
+
+    SortRecord *src = records;
+    SortRecord *dst = temp;
+    for (size_t width = SORT_INSERTION_RUN; width < count; width *= 2) {
+        for (size_t lo = 0; lo < count; lo += 2 * width) {
+            size_t mid = lo + width < count ? lo + width : count;
+            size_t hi = lo + 2 * width < count ? lo + 2 * width : count;
+            merge_runs(ctx, src, dst, lo, mid, hi);
+        }
+        SortRecord *swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != records) {
+        memcpy(records, src, count * sizeof(SortRecord));
+    }
+}
+
+// 并行排序的共享状态
+typedef struct {
+    const SortContext *ctx;
+    SortRecord *records;          // 待排序记录
+    SortRecord *temp;             // 同样大小的临时区
+    size_t count;                 // 记录数
+    int parts;                    // 分块数
+    size_t bounds[SORT_MAX_PARTS + 1]; // 分块（或有序段）边界
+
+    // 归并轮次
+    const SortRecord *src;
+    SortRecord *dst;
+    int run_count;                // 当前有序段数量
+    int segments;                 // 每对有序段拆成的输出段数
+
+    // 基数排序
+    int byte;                     // 当前处理的字节
+    size_t (*counts)[256];        // 每块的计数（parts x 256），散射前转换为写入位置
+} ParallelSort;
+
+// 归并路径划分：合并 a[0,n) 与 b[0,m) 时，输出前 k 项中来自 a 的数量
+// 比较结果不会相等（最后按下标区分），因此划分唯一，合并结果与单线程一致
+static size_t merge_split(const SortContext *ctx, const SortRecord *a, size_t n,
+                          const SortRecord *b, size_t m, size_t k) {
+    size_t lo = k > m ? k - m : 0;
+    size_t hi = k < n ? k : n;
+    while (lo < hi) {
+        size_t i = lo + (hi - lo) / 2;
+        size_t j = k - i;
+        if (j > 0 && compare_records(ctx, &b[j - 1], &a[i]) > 0) {
+            lo = i + 1;
+        } else {
+            hi = i;
+        }
+    }
+    return lo;
+}
+
+// 合并两段有序记录到 dst
+static void merge_into(const SortContext *ctx, const SortRecord *a, size_t n,
+                       const SortRecord *b, size_t m, SortRecord *dst) {
+    size_t i = 0;
+    size_t j = 0;
+    while (i < n && j < m) {
+        if (compare_records(ctx, &b[j], &a[i]) < 0) {
+            *dst++ = b[j++];
+        } else {
+            *dst++ = a[i++];
+        }
+    }
+    memcpy(dst, a + i, (n - i) * sizeof(SortRecord));
+    memcpy(dst + (n - i), b + j, (m - j) * sizeof(SortRecord));
+}
+
+// 任务：单独排序一块
+static void parallel_sort_chunk(void *data, int index) {
+    ParallelSort *job = (ParallelSort*)data;
+    size_t lo = job->bounds[index];
+    size_t hi = job->bounds[index + 1];
+    merge_sort(job->ctx, job->records + lo, job->temp + lo, hi - lo);
+}
+
+// 任务：合并一对有序段中的一个输出段
+static void parallel_merge_segment(void *data, int index) {
+    ParallelSort *job = (ParallelSort*)data;
+    int pair = index / job->segments;
+    int segment = index % job->segments;
+
+    size_t lo = job->bounds[2 * pair];
+    size_t mid = (2 * pair + 1 < job->run_count) ? job->bounds[2 * pair + 1] : job->bounds[job->run_count];
+    size_t hi = (2 * pair + 2 <= job->run_count) ? job->bounds[2 * pair + 2] : job->bounds[job->run_count];
+
+    const SortRecord *a = job->src + lo;
+    const SortRecord *b = job->src + mid;
+    size_t n = mid - lo;
+    size_t m = hi - mid;
+    size_t total = n + m;
+    size_t k0 = total * (size_t)segment / (size_t)job->segments;
+    size_t k1 = total * (size_t)(segment + 1) / (size_t)job->segments;
+    size_t i0 = merge_split(job->ctx, a, n, b, m, k0);
+    size_t i1 = merge_split(job->ctx, a, n, b, m, k1);
+
+    merge_into(job->ctx, a + i0, i1 - i0, b + (k0 - i0), (k1 - i1) - (k0 - i0), job->dst + lo + k0);
+}
+
+// 并行归并排序：各块分别排序，再逐轮两两合并，每次合并按归并路径拆给所有线程
+static void parallel_merge_sort(const SortContext *ctx, SortRecord *records, SortRecord *temp,
+                                size_t count, ThreadPool *pool) {
+    ParallelSort job;
+    memset(&job, 0, sizeof(job));
+    job.ctx = ctx;
+    job.records = records;
+    job.temp = temp;
+    job.count = count;
+    job.parts = thread_pool_concurrency(pool);
+    if (job.parts > SORT_MAX_PARTS) {
+        job.parts = SORT_MAX_PARTS;
+    }
+    for (int i = 0; i <= job.parts; i++) {
+        job.bounds[i] = count * (size_t)i / (size_t)job.parts;
+    }
+
+    thread_pool_run(pool, job.parts, parallel_sort_chunk, &job);
+
+    job.run_count = job.parts;
+    job.src = records;
+    job.dst = temp;
+    while (job.run_count > 1) {
+        int pairs = (job.run_count + 1) / 2;
+        job.segments = job.parts / pairs > 0 ? job.parts / pairs : 1;
+        thread_pool_run(pool, pairs * job.segments, parallel_merge_segment, &job);
+
+        // 合并后的有序段边界
+        for (int p = 0; p < pairs; p++) {
+            job.bounds[p] = job.bounds[2 * p];
+        }
+        job.bounds[pairs] = count;
+        job.run_count = pairs;
+
+        SortRecord *swap = (SortRecord*)job.src;
+        job.src = job.dst;
+        job.dst = swap;
+    }
+
+    if (job.src != records) {
+        memcpy(records, job.src, count * sizeof(SortRecord));
+    }
+}
+
+// 任务：统计一块在当前字节上的分布
+static void parallel_radix_count(void *data, int index) {
+    ParallelSort *job = (ParallelSort*)data;
+    size_t *counts = job->counts[index];
+    int shift = 8 * job->byte;
+    memset(counts, 0, sizeof(size_t) * 256);
+    for (size_t i = job->bounds[index]; i < job->bounds[index + 1]; i++) {
+        counts[(job->src[i].k0 >> shift) & 0xFF]++;
+    }
+}
+
+// 任务：按写入位置散射一块（块内保持原顺序，因此整体稳定）
+static void parallel_radix_scatter(void *data, int index) {
+    ParallelSort *job = (ParallelSort*)data;
+    size_t *offsets = job->counts[index];
+    int shift = 8 * job->byte;
+    for (size_t i = job->bounds[index]; i < job->bounds[index + 1]; i++) {
+        job->dst[offsets[(job->src[i].k0 >> shift) & 0xFF]++] = job->src[i];
+    }
+}
+
+// 并行基数排序：每个字节先分块计数，再按 (数字, 块) 顺序分配写入位置后并行散射
+static bool parallel_radix_sort(SortRecord *records, SortRecord *temp, size_t count, ThreadPool *pool) {
+    ParallelSort job;
+    memset(&job, 0, sizeof(job));
+    job.count = count;
+    job.parts = thread_pool_concurrency(pool);
+    if (job.parts > SORT_MAX_PARTS) {
+        job.parts = SORT_MAX_PARTS;
+    }
+    for (int i = 0; i <= job.parts; i++) {
+        job.bounds[i] = count * (size_t)i / (size_t)job.parts;
+    }
+
+    job.counts = (size_t(*)[256])malloc(sizeof(size_t) * 256 * (size_t)job.parts);
+    if (!job.counts) {
+        return false;
+    }
+
+    job.src = records;
+    job.dst = temp;
+    for (job.byte = 0; job.byte < 8; job.byte++) {
+        thread_pool_run(pool, job.parts, parallel_radix_count, &job);
+
+        // 所有记录在该字节上相同时跳过
+        int shift = 8 * job.byte;
+        size_t same = 0;
+        int first_digit = (int)((job.src[0].k0 >> shift) & 0xFF);
+        for (int i = 0; i < job.parts; i++) {
+            same += job.counts[i][first_digit];
+        }
+        if (same == count) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (int d = 0; d < 256; d++) {
+            for (int i = 0; i < job.parts; i++) {
+                size_t n = job.counts[i][d];
+                job.counts[i][d] = offset;
+                offset += n;
+            }
+        }
+
+        thread_pool_run(pool, job.parts, parallel_radix_scatter, &job);
+
+        SortRecord *swap = (SortRecord*)job.src;
+        job.src = job.dst;
+        job.dst = swap;
+    }
+
+    if (job.src != records) {
+        memcpy(records, job.src, count * sizeof(SortRecord));
+    }
+    free(job.counts);
+    return true;
+}
+
+// 按 k0 做 LSD 基数排序（稳定），所有记录都相同的字节直接跳过，结果留在 records 中
+static void radix_sort(SortRecord *records, SortRecord *temp, size_t count) {
+    size_t histogram[8][256];
+    memset(histogram, 0, sizeof(histogram));
+    for (size_t i = 0; i < count; i++) {
+        uint64_t k = records[i].k0;
+        for (int b = 0; b < 8; b++) {
+            histogram[b][(k >> (8 * b)) & 0xFF]++;
+        }
+    }
+
+    SortRecord *src = records;
+    SortRecord *dst = temp;
+    for (int b = 0; b < 8; b++) {
+        size_t *counts = histogram[b];
+        if (counts[(src[0].k0 >> (8 * b)) & 0xFF] == count) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (int d = 0; d < 256; d++) {
+            size_t n = counts[d];
+            counts[d] = offset;
+            offset += n;
+        }
+        for (size_t i = 0; i < count; i++) {
+            dst[counts[(src[i].k0 >> (8 * b)) & 0xFF]++] = src[i];
+        }
+
+        SortRecord *swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != records) {
+        memcpy(records, src, count * sizeof(SortRecord));
+    }
+}
+
+// 对 [first, count) 的文件项排序，结果写入 list->order
+static bool sort_range(FileList *list, SortKey key, bool descending, int first) {
+    size_t count = list->count > first ? (size_t)(list->count - first) : 0;
+    for (int i = 0; i < first && i < list->count; i++) {
+        list->order[i] = i;
+    }
+    if (count == 0) {
+        return true;
+    }
+
+    SortRecord *records = (SortRecord*)malloc(sizeof(SortRecord) * count * 2);
+    if (!records) {
+        printf("[ERROR] Failed to allocate sort buffer for %zu items\n", count);
+        return false;
+    }
+
+    // 大列表使用共享线程池，结果与单线程完全相同
+    ThreadPool *pool = NULL;
+    if (count >= SORT_PARALLEL_THRESHOLD) {
+        pool = thread_pool_shared();
+        if (thread_pool_concurrency(pool) < 2) {
+            pool = NULL;
+        }
+    }
+
+    SortContext ctx = { list, key, descending };
+    if (key == SORT_KEY_NAME) {
+        for (size_t i = 0; i < count; i++) {
+            build_record(&ctx, (uint32_t)(i + first), &records[i]);
+        }
+        if (pool) {
+            parallel_merge_sort(&ctx, records, records + count, count, pool);
+        } else {
+            merge_sort(&ctx, records, records + count, count);
+        }
+    } else {
+        // 输入按名称顺序排列，稳定的基数排序保证主关键字相同时仍按名称排列
+        for (size_t i = 0; i < count; i++) {
+            build_record(&ctx, (uint32_t)list->order[first + i], &records[i]);
+        }
+        if (!pool || !parallel_radix_sort(records, records + count, count, pool)) {
+            radix_sort(records, records + count, count);
+        }
+
+        // 扩展名前缀相同且都超过7字节的区间需要比较完整扩展名
+        if (key == SORT_KEY_TYPE) {
+            size_t lo = 0;
+            while (lo < count) {
+                size_t hi = lo + 1;
+                while (hi < count && records[hi].k0 == records[lo].k0) {
+                    hi++;
+                }
+                if (hi - lo > 1 && (records[lo].k0 & 1) != (uint64_t)descending) {
+                    merge_sort(&ctx, records + lo, records + count + lo, hi - lo);
+                }
+                lo = hi;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        list->order[first + i] = (int)records[i].index;
+    }
+
+    free(records);
+    return true;
+}
+
+// 按名称升序排序并记录每项的名称排名
+static bool sort_by_name_rank(FileList *list, int first) {
+    if (!sort_range(list, SORT_KEY_NAME, false, first)) {
+        return false;
+    }
+
+    // 名称排序是其它关键字的次序依据，按名称升序的位置记录排名（目录和文件分别连续，不影响比较）
+    uint32_t *rank = list->columns.name_rank;
+    for (int i = 0; i < list->count; i++) {
+        rank[list->order[i]] = (uint32_t)i;
+    }
+    list->name_rank_valid = true;
+    return true;
+}
+
+// 名称排名有效时直接按排名放置，降序时目录和文件各自反转（O(N)，不需要比较）
+static void order_by_name_rank(FileList *list, bool descending, int first) {
+    const uint32_t *rank = list->columns.name_rank;
+    for (int i = 0; i < list->count; i++) {
+        list->order[rank[i]] = i;
+    }
+    if (!descending) {
+        return;
+    }
+
+    // 排名中目录在前，找到目录与文件的分界后分别反转
+    int split = first;
+    while (split < list->count && list->columns.type[list->order[split]] == FILE_TYPE_DIRECTORY) {
+        split++;
+    }
+    for (int lo = first, hi = split - 1; lo < hi; lo++, hi--) {
+        int swap = list->order[lo];
+        list->order[lo] = list->order[hi];
+        list->order[hi] = swap;
+    }
+    for (int lo = split, hi = list->count - 1; lo < hi; lo++, hi--) {
+        int swap = list->order[lo];
+        list->order[lo] = list->order[hi];
+        list->order[hi] = swap;
+    }
+}
+
+// 按关键字对文件列表排序：目录在前，然后按关键字，最后按名称
+bool sort_file_list(FileList *list, SortKey key, bool descending) {
+    if (!list) {
+        return false;
+    }
+
+    Uint64 sort_start = profiler_begin();
+    // ".." 固定在最前面
+    int first = list->has_parent_item ? 1 : 0;
+    bool result = true;
+
+    // 名称排名每次加载只需计算一次，之后按名称排序不再比较字符串，其它关键字用它作次关键字
+    if (!list->name_rank_valid) {
+        result = sort_by_name_rank(list, first);
+    }
+    if (result) {
+        // 先按名称排列，其它关键字在此基础上稳定排序
+        order_by_name_rank(list, key == SORT_KEY_NAME && descending, first);
+        if (key != SORT_KEY_NAME) {
+            result = sort_range(list, key, descending, first);
+        }
+    }
+
+    if (result) {
+        list->sort_key = (int)key;
+        list->sort_descending = descending;
+        list->is_sorted = true;
+    }
+    file_list_rebuild_visible(list);
+    profiler_end(PROFILE_SORT, sort_start);
+    return result;
+}
+
+// 比较两个文件项在最近一次排序下的先后（结果与 sort_file_list 一致）
+int sort_compare_items(const FileList *list, int a, int b) {
+    const FileColumns *cols = &list->columns;
+    bool a_dir = cols->type[a] == FILE_TYPE_DIRECTORY;
+    bool b_dir = cols->type[b] == FILE_TYPE_DIRECTORY;
+    if (a_dir != b_dir) {
+        return a_dir ? -1 : 1;
+    }
+
+    const char *key_a = cols->key_pool + cols->key_offset[a];
+    const char *key_b = cols->key_pool + cols->key_offset[b];
+    int result = 0;
+    switch ((SortKey)list->sort_key) {
+        case SORT_KEY_SIZE: {
+            uint64_t size_a = cols->size[a] & SORT_PRIMARY_MASK;
+            uint64_t size_b = cols->size[b] & SORT_PRIMARY_MASK;
+            result = (size_a > size_b) - (size_a < size_b);
+            break;
+        }
+        case SORT_KEY_TYPE:
+            result = strcmp(key_a + cols->ext_offset[a], key_b + cols->ext_offset[b]);
+            break;
+        case SORT_KEY_DATE:
+            result = (cols->modified_time[a] > cols->modified_time[b]) -
+                     (cols->modified_time[a] < cols->modified_time[b]);
+            break;
+        case SORT_KEY_NAME:
+        default:
+            break;
+    }
+    if (result != 0) {
+        return list->sort_descending ? -result : result;
+    }
+
+    // 次序与名称排名相同：名称键、原始名称、下标
+    result = strcmp(key_a, key_b);
+    if (result == 0) {
+        result = strcmp(cols->name_pool + cols->name_offset[a], cols->name_pool + cols->name_offset[b]);
+    }
+    if (result == 0) {
+        result = (a > b) - (a < b);
+    }
+
+    // 按名称降序时名称排名整体反转
+    if (list->sort_key == SORT_KEY_NAME && list->sort_descending) {
+        result = -result;
+    }
+    return result;
+}
+
+// 供 SDL_qsort_r 使用的比较函数
+static int SDLCALL compare_item_indices(void *user_data, const void *a, const void *b) {
+    return sort_compare_items((const FileList*)user_data, *(const int*)a, *(const int*)b);
+}
+
+// 在 order[lo, hi) 中二分查找第一个排在 index 之后的位置
+static int order_upper_bound(const FileList *list, int lo, int hi, int index) {
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (sort_compare_items(list, list->order[mid], index) > 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+// 按名称排序时直接从 order 恢复名称排名，否则让其失效（下次排序时重新计算）
+static void update_name_rank(FileList *list, int first) {
+    if (list->sort_key != SORT_KEY_NAME) {
+        list->name_rank_valid = false;
+        return;
+    }
+
+    uint32_t *rank = list->columns.name_rank;
+    int count = list->count;
+    if (!list->sort_descending) {
+        for (int i = 0; i < count; i++) {
+            rank[list->order[i]] = (uint32_t)i;
+        }
+    } else {
+        // 降序时目录和文件各自反转，反推升序位置
+        int split = first;
+        while (split < count && list->columns.type[list->order[split]] == FILE_TYPE_DIRECTORY) {
+            split++;
+        }
+        for (int i = 0; i < first; i++) {
+            rank[list->order[i]] = (uint32_t)i;
+        }
+        for (int i = first; i < split; i++) {
+            rank[list->order[i]] = (uint32_t)(first + split - 1 - i);
+        }
+        for (int i = split; i < count; i++) {
+            rank[list->order[i]] = (uint32_t)(split + count - 1 - i);
+        }
+    }
+    list->name_rank_valid = true;
+}
+
+// 把 indices 中的文件项插入已排序的 order[0, sorted_count)，完成后更新名称排名（不重建可见数组）
+bool sort_insert_indices(FileList *list, int sorted_count, int *indices, int count) {
+    if (!list || sorted_count + count != list->count) {
+        return false;
+    }
+
+    Uint64 sort_start = profiler_begin();
+    int first = list->has_parent_item ? 1 : 0;
+    int *order = list->order;
+    if (sorted_count < first) {
+        first = sorted_count;
+    }
+
+    if (count <= SORT_INSERT_BATCH) {
+        // 少量变更：每项二分查找 O(log N) 次比较后插入
+        int n = sorted_count;
+        for (int i = 0; i < count; i++) {
+            int pos = order_upper_bound(list, first, n, indices[i]);
+            memmove(order + pos + 1, order + pos, (size_t)(n - pos) * sizeof(int));
+            order[pos] = indices[i];
+            n++;
+        }
+    } else {
+        // 批量变更：先排序新项，再从尾部向前合并，每段原有项整体移动一次
+        SDL_qsort_r(indices, (size_t)count, sizeof(int), compare_item_indices, list);
+        int end = sorted_count;
+        for (int j = count - 1; j >= 0; j--) {
+            int pos = order_upper_bound(list, first, end, indices[j]);
+            memmove(order + pos + j + 1, order + pos, (size_t)(end - pos) * sizeof(int));
+            order[pos + j] = indices[j];
+            end = pos;
+        }
+    }
+
+    update_name_rank(list, first);
+    profiler_end(PROFILE_SORT, sort_start);
+    return true;
+}
@@ -0,0 +1,215 @@
+/*
+ * 线程池模块
+ * 职责：
+ * 1. 按CPU核心数维护一组常驻工作线程
+ * 2. 把一批相互独立的任务分给工作线程并行执行
+ * 3. 调用线程同时参与执行，等待整批任务完成
+ */
+
+#include "thread_pool.h"
+#include <stdlib.h>
+
+// 共享线程池最多使用的后台线程数
+#define THREAD_POOL_MAX_SHARED_WORKERS 15
+
+struct ThreadPool {
+    SDL_Thread **threads;        // 后台线程
+    int worker_count;            // 后台线程数
+    SDL_Mutex *mutex;            // 保护以下状态
+    SDL_Condition *work_ready;   // 有新批次或需要退出
+    SDL_Condition *work_done;    // 批次完成
+    SDL_Mutex *run_mutex;        // 同一时间只执行一个批次
+    Uint64 generation;           // 批次编号
+    bool shutdown;               // 是否退出
+
+    // 当前批次
+    ThreadPoolTask task;
+    void *data;
+    int count;
+    SDL_AtomicInt next;          // 下一个待领取的任务
+    SDL_AtomicInt finished;      // 已完成的任务数
+    int active;                  // 仍在领取任务的后台线程数
+};
+
+// 共享线程池（原子访问）
+static void *g_shared_pool = NULL;
+
+// 领取并执行任务直到当前批次领完
+static void thread_pool_drain(ThreadPool *pool) {
+    for (;;) {
+        int index = SDL_AddAtomicInt(&pool->next, 1);
+        if (index >= pool->count) {
+            break;
+        }
+        pool->task(pool->data, index);
+        SDL_AddAtomicInt(&pool->finished, 1);
+    }
+}
+
+// 工作线程入口
+static int SDLCALL thread_pool_worker(void *data) {
+    ThreadPool *pool = (ThreadPool*)data;
+    Uint64 seen = 0;
+
+    SDL_LockMutex(pool->mutex);
+    for (;;) {
+        while (!pool->shutdown && pool->generation == seen) {
+            SDL_WaitCondition(pool->work_ready, pool->mutex);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+        seen = pool->generation;
+        pool->active++;
+        SDL_UnlockMutex(pool->mutex);
+
+        thread_pool_drain(pool);
+
+        SDL_LockMutex(pool->mutex);
+        pool->active--;
+        SDL_BroadcastCondition(pool->work_done);
+    }
+    SDL_UnlockMutex(pool->mutex);
+    return 0;
+}
+
+// 创建线程池（worker_count 为后台线程数，可以为0）
+ThreadPool* thread_pool_new(int worker_count) {
+    ThreadPool *pool = (ThreadPool*)calloc(1, sizeof(ThreadPool));
+    if (!pool) {
+        return NULL;
+    }
+
+    pool->mutex = SDL_CreateMutex();
+    pool->run_mutex = SDL_CreateMutex();
+    pool->work_ready = SDL_CreateCondition();
+    pool->work_done = SDL_CreateCondition();
+    if (!pool->mutex || !pool->run_mutex || !pool->work_ready || !pool->work_done) {
+        thread_pool_free(pool);
+        return NULL;
+    }
+
+    if (worker_count > 0) {
+        pool->threads = (SDL_Thread**)calloc((size_t)worker_count, sizeof(SDL_Thread*));
+        if (!pool->threads) {
+            thread_pool_free(pool);
+            return NULL;
+        }
+    }
+
+    // 线程创建失败时用已创建的线程继续工作
+    for (int i = 0; i < worker_count; i++) {
+        pool->threads[i] = SDL_CreateThread(thread_pool_worker, "pool_worker", pool);
+        if (!pool->threads[i]) {
+            printf("[ERROR] Failed to create pool worker: %s\n", SDL_GetError());
+            break;
+        }
+        pool->worker_count++;
+    }
+
+    return pool;
+}
+
+// 销毁线程池（等待后台线程退出）
+void thread_pool_free(ThreadPool *pool) {
+    if (!pool) {
+        return;
+    }
+
+    if (pool->mutex) {
+        SDL_LockMutex(pool->mutex);
+        pool->shutdown = true;
+        SDL_BroadcastCondition(pool->work_ready);
+        SDL_UnlockMutex(pool->mutex);
+    }
+
+    for (int i = 0; i < pool->worker_count; i++) {
+        SDL_WaitThread(pool->threads[i], NULL);
+    }
+    free(pool->threads);
+
+    SDL_DestroyCondition(pool->work_done);
+    SDL_DestroyCondition(pool->work_ready);
+    SDL_DestroyMutex(pool->run_mutex);
+    SDL_DestroyMutex(pool->mutex);
+    free(pool);
+}
+
+// 参与执行任务的线程数（后台线程 + 调用线程）
+int thread_pool_concurrency(ThreadPool *pool) {
+    return pool ? pool->worker_count + 1 : 1;
+}
+
+// 并行执行 count 个任务，调用线程也参与执行，全部完成后返回
+void thread_pool_run(ThreadPool *pool, int count, ThreadPoolTask task, void *data) {
+    if (!task || count <= 0) {
+        return;
+    }
+
+    // 没有后台线程或只有一个任务时直接在当前线程执行
+    if (!pool || pool->worker_count == 0 || count == 1) {
+        for (int i = 0; i < count; i++) {
+            task(data, i);
+        }
+        return;
+    }
+
+    SDL_LockMutex(pool->run_mutex);
+
+    SDL_LockMutex(pool->mutex);
+    pool->task = task;
+    pool->data = data;
+    pool->count = count;
+    SDL_SetAtomicInt(&pool->next, 0);
+    SDL_SetAtomicInt(&pool->finished, 0);
+    pool->generation++;
+    SDL_BroadcastCondition(pool->work_ready);
+    SDL_UnlockMutex(pool->mutex);
+
+    thread_pool_drain(pool);
+
+    // 等待所有任务完成，并且没有后台线程还在访问本批次
+    SDL_LockMutex(pool->mutex);
+    while (SDL_GetAtomicInt(&pool->finished) < count || pool->active > 0) {
+        SDL_WaitCondition(pool->work_done, pool->mutex);
+    }
+    pool->task = NULL;
+    pool->data = NULL;
+    SDL_UnlockMutex(pool->mutex);
+
+    SDL_UnlockMutex(pool->run_mutex);
+}
+
+// 获取共享线程池（首次调用时按CPU核心数创建）
+ThreadPool* thread_pool_shared(void) {
+    ThreadPool *pool = (ThreadPool*)SDL_GetAtomicPointer(&g_shared_pool);
+    if (pool) {
+        return pool;
+    }
+
+    int workers = SDL_GetNumLogicalCPUCores() - 1;
+    if (workers > THREAD_POOL_MAX_SHARED_WORKERS) {
+        workers = THREAD_POOL_MAX_SHARED_WORKERS;
+    }
+    if (workers < 0) {
+        workers = 0;
+    }
+
+    pool = thread_pool_new(workers);
+    if (!pool) {
+        return NULL;
+    }
+
+    // 多个线程同时创建时只保留一个
+    if (!SDL_CompareAndSwapAtomicPointer(&g_shared_pool, NULL, pool)) {
+        thread_pool_free(pool);
+        pool = (ThreadPool*)SDL_GetAtomicPointer(&g_shared_pool);
+    }
+    return pool;
+}
+
+// 销毁共享线程池（程序退出时调用）
+void thread_pool_shared_shutdown(void) {
+    ThreadPool *pool = (ThreadPool*)SDL_SetAtomicPointer(&g_shared_pool, NULL);
+    thread_pool_free(pool);
+}
@@ -5,13 +5,31 @@
 #include "window.h"
 #include "main_window.h"
 
+// 主循环统计（从启动开始累计）
+typedef struct {
+    Uint64 frames;               // 实际绘制的帧数
+    Uint64 wakeups;              // 主循环阻塞等待后被唤醒的次数（事件或定时任务）
+    Uint64 idle_wakeups;         // 唤醒后没有任何区域需要重绘的次数
+    Uint64 last_frame_time_ns;   // 最近一帧的绘制耗时（纳秒，含 present）
+    Uint64 total_frame_time_ns;  // 绘制耗时累计
+    Uint64 max_frame_time_ns;    // 最长一帧的绘制耗时
+} AppFrameStats;
+
 /**
  * 应用程序主循环
  * 负责处理事件、更新界面和控制帧率
+ * 没有组件标记需要重绘时阻塞等待事件，输入到达后立即处理并绘制
  * 
  * @param window 应用程序窗口
  * @param main_window 主窗口界面
  */
 void app_run(struct Window *window, MainWindow *main_window);
 
-#endif // APP_H
\ No newline at end of file
+/**
+ * 读取主循环统计
+ *
+ * @param stats 输出统计
+ */
+void app_get_frame_stats(AppFrameStats *stats);
+
+#endif // APP_H
@@ -0,0 +1,45 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// 内存块（块内按顺序分配）
+typedef struct ArenaBlock {
+    struct ArenaBlock *next; // 下一个内存块
+    size_t size;             // 可用字节数
+    size_t used;             // 已使用字节数
+} ArenaBlock;
+
+// 线性分配器：逐个分配，整体释放
+typedef struct {
+    ArenaBlock *first;       // 第一个内存块
+    ArenaBlock *current;     // 当前分配所在的内存块
+    size_t block_size;       // 默认内存块大小
+} Arena;
+
+// 初始化分配器（block_size 为0时使用默认大小）
+void arena_init(Arena *arena, size_t block_size);
+
+// 释放分配器占用的全部内存
+void arena_destroy(Arena *arena);
+
+// 分配内存（按指针大小对齐，内容未初始化）
+void* arena_alloc(Arena *arena, size_t size);
+
+// 分配并清零
+void* arena_calloc(Arena *arena, size_t size);
+
+// 复制字符串
+char* arena_strdup(Arena *arena, const char *str);
+
+// 复制指定长度的字符串（自动补 '\0'）
+char* arena_strndup(Arena *arena, const char *str, size_t len);
+
+// 已分配的字节数（含对齐填充）
+size_t arena_used(const Arena *arena);
+
+// 重置分配器：之前分配的内存全部失效，保留部分内存块供复用
+void arena_reset(Arena *arena);
+
+#endif // ARENA_H
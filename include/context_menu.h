@@ -46,6 +46,7 @@ typedef struct {
     int width, height;     // 菜单尺寸
     bool visible;          // 是否可见
     FileItem *target_item; // 目标文件项（如果有）
+    unsigned int target_generation; // 记录目标文件项时文件列表的 generation
     char *current_dir;     // 当前目录路径
     struct FileListView *file_list_view; // 文件列表视图引用
 } ContextMenu;
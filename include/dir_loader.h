@@ -0,0 +1,40 @@
+#ifndef DIR_LOADER_H
+#define DIR_LOADER_H
+
+#include "main.h"
+#include "dir_scanner.h"
+#include <stdbool.h>
+
+// 一批目录项（entries[i].name 指向 names 缓冲区）
+typedef struct DirLoadBatch {
+    DirScanEntry *entries;   // 目录项数组
+    int count;               // 目录项数量
+    int capacity;            // 数组容量
+    char *names;             // 名称存储区
+    size_t names_used;       // 已使用字节数
+    size_t names_capacity;   // 名称存储区容量
+} DirLoadBatch;
+
+// 后台目录加载器（不透明类型）
+typedef struct DirLoader DirLoader;
+
+// 唤醒事件类型（首次调用时注册，失败返回0）
+// 后台线程发布批次或扫描结束时发送，不携带数据，UI线程收到后调用 dir_loader_pop 取出目录项
+Uint32 dir_loader_event_type(void);
+
+// 在后台线程开始扫描目录
+DirLoader* dir_loader_start(const char *dir_path);
+
+// 取出下一批目录项（仅UI线程调用，没有数据时返回NULL）
+DirLoadBatch* dir_loader_pop(DirLoader *loader);
+
+// 释放一批目录项
+void dir_loader_batch_free(DirLoadBatch *batch);
+
+// 扫描是否已结束且队列已取空
+bool dir_loader_is_done(DirLoader *loader, bool *success);
+
+// 取消扫描并释放UI线程持有的引用（后台线程结束后自动回收）
+void dir_loader_cancel(DirLoader *loader);
+
+#endif // DIR_LOADER_H
@@ -0,0 +1,38 @@
+#ifndef DIR_SCANNER_H
+#define DIR_SCANNER_H
+
+#include "main.h"
+#include "file_item.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+// 扫描选项
+typedef enum {
+    DIR_SCAN_TYPE_ONLY = 0,        // 只需要文件类型（d_type 可用时跳过 stat）
+    DIR_SCAN_STAT      = 1 << 0,   // 需要大小、时间等完整元数据
+    DIR_SCAN_NO_FOLLOW = 1 << 1    // 不跟随符号链接（按 lstat 语义返回类型）
+} DirScanFlags;
+
+// 扫描得到的目录项（name 只在回调期间有效）
+typedef struct DirScanEntry {
+    const char *name;        // 文件名（不含路径）
+    size_t name_len;         // 文件名长度
+    uint64_t inode;          // inode 编号（平台不支持时为0）
+    FileType type;           // 文件类型
+    bool has_stat;           // 下面的元数据是否有效
+    bool is_hidden;          // 是否隐藏
+    size_t size;             // 文件大小
+    time_t modified_time;    // 修改时间
+    time_t created_time;     // 创建时间
+    time_t accessed_time;    // 访问时间
+} DirScanEntry;
+
+// 扫描回调，返回 false 时提前结束扫描
+typedef bool (*DirScanCallback)(const DirScanEntry *entry, void *user_data);
+
+// 扫描目录：一次打开、一次遍历，跳过 . 和 ..
+// Linux 下按批读取 getdents64 并用 fstatat 相对目录 fd 获取元数据
+bool dir_scan(const char *dir_path, int flags, DirScanCallback callback, void *user_data);
+
+#endif // DIR_SCANNER_H
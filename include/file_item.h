@@ -2,7 +2,9 @@
 #define FILE_ITEM_H
 
 #include "main.h"
+#include "arena.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include <time.h>
 #include <sys/stat.h>
 
@@ -19,9 +21,9 @@ typedef enum {
 
 // 文件项数据结构
 typedef struct FileItem {
-    char *name;              // 文件名
+    char *name;              // 文件名（通常指向 path 中的文件名部分）
     char *path;              // 完整路径
-    char *display_name;      // 显示名称
+    char *display_name;      // 显示名称（通常与 name 相同）
     FileType type;           // 文件类型
     size_t size;             // 文件大小
     time_t modified_time;    // 修改时间
@@ -29,18 +31,81 @@ typedef struct FileItem {
     time_t accessed_time;    // 访问时间
     bool is_hidden;          // 是否隐藏
     bool is_selected;        // 是否选中
-    SDL_Texture *icon;       // 文件图标
-    struct FileItem *next;   // 链表下一项
+    SDL_Texture *icon;       // 文件图标（属于图标缓存，文件项不拥有该纹理）
+    int index;               // 在所属列表中的下标（不在列表中时为-1）
 } FileItem;
 
-// 文件列表数据结构
+// 文件列表元数据列（与 items 下标一一对应，排序和过滤时顺序遍历，不访问文件项）
 typedef struct {
-    FileItem *head;          // 链表头
-    FileItem *tail;          // 链表尾
+    uint64_t *size;          // 文件大小
+    time_t *modified_time;   // 修改时间
+    uint8_t *type;           // 文件类型（FileType）
+    uint8_t *hidden;         // 是否隐藏（0/1）
+    uint32_t *name_offset;   // 文件名在名称池中的偏移
+    int *visible_pos;        // 在可见数组中的位置（不可见时为-1）
+    uint32_t *key_offset;    // 排序键在键池中的偏移
+    uint16_t *ext_offset;    // 扩展名在排序键中的起始位置
+    uint64_t *key_prefix;    // 排序键前8字节
+    uint32_t *name_rank;     // 按名称升序的排名（name_rank_valid 为真时有效）
+    uint8_t *mark;           // 增量变更时的临时标记（平时为0）
+    uint64_t *inode;         // inode 编号（平台不支持时为0，重新扫描时识别改名）
+    char *name_pool;         // 名称池（按加载顺序连续存放文件名）
+    size_t name_pool_used;   // 名称池已用字节数
+    size_t name_pool_capacity; // 名称池容量
+    size_t name_pool_dead;   // 名称池中已删除文件项的字节数（压缩时回收）
+    char *key_pool;          // 键池（加载时一次生成的排序键）
+    size_t key_pool_used;    // 键池已用字节数
+    size_t key_pool_capacity; // 键池容量
+    size_t key_pool_dead;    // 键池中已删除文件项的字节数（压缩时回收）
+} FileColumns;
+
+// 分批重新扫描的状态（file_item.c 内部使用）
+struct FileListRescan;
+
+// 文件列表数据结构（连续数组，按下标随机访问）
+typedef struct {
+    FileItem **items;        // 文件项数组（按加载顺序）
     int count;               // 文件数量
+    int capacity;            // 数组容量（items、order、visible 和各元数据列共用）
+    int *order;              // 显示顺序（items 下标，排序后更新）
+    int *visible;            // 可见项在 items 中的下标（按显示顺序）
+    int visible_count;       // 可见项数量
+    FileColumns columns;     // 元数据列
+    bool show_hidden;        // 可见数组是否包含隐藏文件
+    bool has_parent_item;    // 第一项是否为 ".."（排序时固定在最前）
+    bool name_rank_valid;    // 名称排名是否有效（新增文件项后失效）
+    bool is_sorted;          // order 是否按最近一次排序排列（增量变更据此二分插入）
+    int sort_key;            // 最近一次排序的关键字（SortKey）
+    bool sort_descending;    // 最近一次排序是否降序
+    int *name_index;         // 文件名哈希索引（开放寻址，存放 items 下标）
+    int name_index_capacity; // 哈希索引容量（2的幂）
+    int name_index_used;     // 已占用的槽位（含删除标记）
+    bool name_index_valid;   // 哈希索引是否可用（首次查找时建立）
+    struct FileListRescan *rescan; // 进行中的分批重新扫描（没有时为NULL）
     char *current_dir;       // 当前目录
+    Arena arena;             // 文件项及其字符串的分配器（清空时整体重置）
+    size_t arena_dead;       // 分配器中已删除文件项占用的字节数（压缩时回收）
+    unsigned int generation; // 文件项对象重新分配时递增（清空、压缩），持有文件项指针的一方据此判断是否失效
 } FileList;
 
+// 前向声明
+struct DirScanEntry;
+
+// 增量变更类型
+typedef enum {
+    FILE_LIST_DELTA_INSERT,  // 新建（已存在时按更新处理）
+    FILE_LIST_DELTA_REMOVE,  // 删除（只使用名称）
+    FILE_LIST_DELTA_UPDATE,  // 元数据变化（不存在时按新建处理）
+    FILE_LIST_DELTA_RENAME   // 改名（文件项对象保持不变，原名称不存在时按新建处理）
+} FileListDeltaType;
+
+// 增量变更
+typedef struct {
+    FileListDeltaType type;              // 变更类型
+    const struct DirScanEntry *entry;    // 变更后的目录项
+    const char *old_name;                // 改名前的名称（仅 FILE_LIST_DELTA_RENAME）
+} FileListDelta;
+
 // 创建文件项
 FileItem* file_item_new(const char *path);
 
@@ -56,12 +121,66 @@ void file_list_free(FileList *list);
 // 加载目录内容
 bool file_list_load_directory(FileList *list, const char *dir_path);
 
-// 添加文件项到列表
+// 开始加载目录（清空列表并设置当前目录，不读取目录内容）
+bool file_list_begin_load(FileList *list, const char *dir_path);
+
+// 将扫描得到的目录项追加到列表
+bool file_list_add_entry(FileList *list, const struct DirScanEntry *entry);
+
+// 在列表的分配器中创建文件项（name 为NULL时取路径中的文件名，display_name 为NULL时与 name 相同）
+// 文件项随列表清空一起释放，不能调用 file_item_free
+FileItem* file_list_alloc_item(FileList *list, const char *path, const char *name, const char *display_name);
+
+// 添加文件项到列表（文件项由 file_list_alloc_item 分配）
 void file_list_add_item(FileList *list, FileItem *item);
 
 // 清空文件列表
 void file_list_clear(FileList *list);
 
+// 按下标获取文件项（越界返回NULL）
+FileItem* file_list_get(const FileList *list, int index);
+
+// 按可见下标获取文件项（越界返回NULL）
+FileItem* file_list_get_visible(const FileList *list, int visible_index);
+
+// 获取文件项的可见下标（不可见时返回-1）
+int file_list_visible_index_of(const FileList *list, const FileItem *item);
+
+// 按下标获取名称池中的文件名（越界返回NULL）
+const char* file_list_column_name(const FileList *list, int index);
+
+// 设置是否显示隐藏文件并重建可见数组
+void file_list_set_show_hidden(FileList *list, bool show_hidden);
+
+// 按 order 重建可见数组
+void file_list_rebuild_visible(FileList *list);
+
+// 按文件名查找文件项下标（不存在返回-1，首次调用时建立哈希索引）
+int file_list_find(FileList *list, const char *name);
+
+// 批量应用增量变更：已排序时变更项按当前排序二分插入，较多时排序后一次合并
+// 未变化的文件项对象和指针保持不变，被删除的文件项 index 置为-1
+bool file_list_apply_deltas(FileList *list, const FileListDelta *deltas, int count);
+
+// 删除留下的空间超过已用空间一半时，按存活文件项重建分配器和字符串池，返回是否重新分配了文件项
+// 文件项对象会移动（下标和顺序不变，generation 递增），调用时不能持有文件项指针
+bool file_list_compact(FileList *list);
+
+// 重新扫描当前目录，只把与列表的差异作为增量变更应用
+bool file_list_rescan_directory(FileList *list);
+
+// 开始分批重新扫描：之后用 file_list_rescan_add 送入目录项，最后调用 file_list_rescan_end
+void file_list_rescan_begin(FileList *list);
+
+// 记录一项重新扫描得到的目录项（inode、修改时间等都相同时跳过，不立即提交）
+void file_list_rescan_add(FileList *list, const struct DirScanEntry *entry);
+
+// 提交已记录的变化（每批目录项之后调用）
+void file_list_rescan_commit(FileList *list);
+
+// 结束重新扫描：complete 为真时删除本轮没有出现的文件项，inode 相同的新名称按改名处理
+void file_list_rescan_end(FileList *list, bool complete);
+
 // 获取文件类型
 FileType get_file_type(const struct stat *st);
 
@@ -0,0 +1,93 @@
+#ifndef FILE_JOBS_H
+#define FILE_JOBS_H
+
+#include "main.h"
+#include "path_list.h"
+#include <stdbool.h>
+
+// 同时执行的文件操作任务数（其余任务排队）
+#define FILE_JOB_WORKERS 2
+
+// 文件操作类型
+typedef enum {
+    FILE_JOB_COPY,           // 复制到目标目录
+    FILE_JOB_MOVE,           // 移动到目标目录（同一文件系统上直接重命名，否则复制后删除）
+    FILE_JOB_DELETE          // 删除（目录连同其中的内容）
+} FileJobType;
+
+// 任务状态
+typedef enum {
+    FILE_JOB_QUEUED,         // 排队等待
+    FILE_JOB_RUNNING,        // 执行中
+    FILE_JOB_PAUSED,         // 已暂停（执行到下一个数据块时停下）
+    FILE_JOB_DONE,           // 全部完成
+    FILE_JOB_FAILED,         // 结束，有文件失败
+    FILE_JOB_CANCELLED       // 已取消
+} FileJobState;
+
+// 任务进度快照（由 file_job_get_progress 读取）
+typedef struct {
+    FileJobState state;      // 状态
+    bool paused;             // 是否请求暂停（执行中的任务到下一个数据块才进入暂停状态）
+    Uint64 bytes_done;       // 已处理的字节数
+    Uint64 bytes_total;      // 总字节数（开始执行后才确定，跨文件系统移动目录时逐步增加）
+    Uint64 items_done;       // 已处理的文件和目录数（包括目录树中的）
+    int files_done;          // 已处理的源路径数（包括失败的）
+    int files_total;         // 源路径总数
+    int errors;              // 失败的源路径数
+    int current;             // 最近完成的源路径序号（file_job_source 取路径）
+} FileJobProgress;
+
+// 文件操作任务（不透明类型，归任务队列所有）
+typedef struct FileJob FileJob;
+
+// 文件操作任务队列（不透明类型）
+typedef struct FileJobQueue FileJobQueue;
+
+// 唤醒事件类型（首次调用时注册，失败返回0）
+// 任务结束时由后台线程发送，不携带数据，UI线程收到后调用 file_job_queue_collect
+Uint32 file_job_event_type(void);
+
+// 创建任务队列并启动后台线程
+FileJobQueue* file_job_queue_new(void);
+
+// 取消全部任务，等待后台线程退出后释放队列
+void file_job_queue_free(FileJobQueue *queue);
+
+// 提交任务（复制源路径，target_dir 对删除任务无效），返回的任务在 collect 取走之前有效
+// 全部源路径作为一批执行，同一目录下的小文件分批处理，大文件和目录并行处理
+FileJob* file_job_queue_submit(FileJobQueue *queue, FileJobType type,
+                               const char *const *sources, int count, const char *target_dir);
+
+// 提交任务（源路径取自路径列表）
+FileJob* file_job_queue_submit_list(FileJobQueue *queue, FileJobType type,
+                                    const PathList *sources, const char *target_dir);
+
+// 队列中的任务数（包括已结束但尚未取走的）
+int file_job_queue_count(FileJobQueue *queue);
+
+// 第 index 个任务（按提交顺序，只在UI线程调用）
+FileJob* file_job_queue_get(FileJobQueue *queue, int index);
+
+// 是否有排队或执行中的任务
+bool file_job_queue_is_busy(FileJobQueue *queue);
+
+// 释放已结束的任务（只在UI线程调用），返回释放的数量
+int file_job_queue_collect(FileJobQueue *queue);
+
+// 暂停或继续任务
+void file_job_set_paused(FileJob *job, bool paused);
+
+// 取消任务（排队中的任务不再执行，执行中的任务在下一个数据块停止并删除不完整的文件）
+void file_job_cancel(FileJob *job);
+
+// 任务类型
+FileJobType file_job_type(const FileJob *job);
+
+// 读取第 index 个源路径到 buffer（超出时截断），返回路径长度，index 无效时返回0
+size_t file_job_source(const FileJob *job, int index, char *buffer, size_t size);
+
+// 读取任务进度
+void file_job_get_progress(const FileJob *job, FileJobProgress *progress);
+
+#endif // FILE_JOBS_H
@@ -5,6 +5,8 @@
 #include "window.h"
 #include "file_item.h"
 #include "file_system.h"
+#include "icon_cache.h"
+#include "selection.h"
 
 // 文件列表视图模式
 typedef enum {
@@ -24,6 +26,9 @@ typedef enum {
 // 前向声明
 struct FileListView;
 struct FileItem;
+struct DirLoader;
+struct FileWatcher;
+struct FileWatchBatch;
 
 // 右键点击回调函数类型
 typedef void (*RightClickCallback)(struct FileListView *view, int x, int y, struct FileItem *item);
@@ -42,12 +47,18 @@ typedef struct FileListView {
     int scroll_offset_y;         // 垂直滚动偏移
     int item_width;              // 项目宽度
     int item_height;             // 项目高度
-    int selected_index;          // 当前选中的索引
+    int selected_index;          // 当前项的索引（最近点击或键盘移动到的项）
+    Selection selection;         // 选中的项（按可见下标）
+    bool selection_saved;        // 选中状态已暂存到文件项（列表重排期间，嵌套保存时不再重复记录）
     SDL_Rect viewport;           // 视口区域
-    SDL_Texture *folder_icon;    // 文件夹图标
-    SDL_Texture *file_icon;      // 文件图标
+    Uint32 icon_refs[ICON_SIZE_COUNT]; // 已在图标缓存中持有引用的图标类别（每种尺寸一个位掩码）
+    int thumbnail_first;         // 上一轮请求缩略图时的可见范围（thumbnail_first 为-1时需要重新请求）
+    int thumbnail_end;
     RightClickCallback on_right_click;                  // 右键点击回调
     DirectoryChangedCallback on_directory_changed;      // 目录变更回调
+    struct DirLoader *loader;    // 后台目录加载器（加载中时非空）
+    struct FileWatcher *watcher; // 当前目录的监控器（不支持时为NULL）
+    struct FileWatchBatch *deferred_changes; // 加载完成前收到的目录变更（加载完成后应用）
     
     // 内联编辑相关
     bool is_editing;             // 是否正在编辑
@@ -55,8 +66,9 @@ typedef struct FileListView {
     char *edit_buffer;           // 编辑缓冲区
     size_t edit_buffer_size;     // 编辑缓冲区大小
     size_t edit_cursor_pos;      // 光标位置
-    Uint32 last_blink_time;      // 上次光标闪烁时间
+    Uint64 last_blink_time;      // 上次光标闪烁时间
     bool cursor_visible;         // 光标是否可见
+    SDL_Rect edit_rect;          // 上一次绘制的编辑框区域（光标闪烁和输入时只重绘这里）
 } FileListView;
 
 // 创建文件列表视图
@@ -68,6 +80,21 @@ void file_list_view_free(FileListView *view);
 // 加载目录
 bool file_list_view_load_directory(FileListView *view, const char *path);
 
+// 主循环每次唤醒时调用：合并后台加载线程送来的目录项，推进光标闪烁
+void file_list_view_update(FileListView *view);
+
+// 距下一次定时更新的毫秒数（没有定时任务时返回-1，主循环据此决定等待时长）
+int file_list_view_next_timeout(FileListView *view);
+
+// 是否正在后台加载目录
+bool file_list_view_is_loading(FileListView *view);
+
+// 取消正在进行的后台加载
+void file_list_view_cancel_loading(FileListView *view);
+
+// 处理目录监控送来的变更事件（不是监控事件时返回 false）
+bool file_list_view_handle_watch_event(FileListView *view, SDL_Event *event);
+
 // 加载驱动器列表
 void file_list_view_load_drives(FileListView *view);
 
@@ -92,10 +119,22 @@ bool file_list_view_handle_event(FileListView *view, SDL_Event *event);
 // 绘制文件列表
 void file_list_view_draw(FileListView *view);
 
-// 选择文件项
+// 选择文件项（只选中这一项，-1 取消全部选择）
 void file_list_view_select_item(FileListView *view, int index);
 
-// 获取选中的文件项
+// 全选
+void file_list_view_select_all(FileListView *view);
+
+// 文件项是否选中
+bool file_list_view_is_selected(FileListView *view, int index);
+
+// 选中的项目数
+int file_list_view_get_selection_count(FileListView *view);
+
+// 获取全部选中的文件项（按显示顺序，不含 ".."），调用者释放数组，失败或没有选中项时返回NULL
+FileItem** file_list_view_get_selected_items(FileListView *view, int *count);
+
+// 获取当前项
 FileItem* file_list_view_get_selected_item(FileListView *view);
 
 // 打开选中的文件或目录
@@ -107,7 +146,7 @@ void file_list_view_go_up(FileListView *view);
 // 滚动文件列表
 void file_list_view_scroll(FileListView *view, int delta);
 
-// 加载图标
+// 加载图标（预先获取文件夹和普通文件图标，其他类别在第一次绘制时获取）
 bool file_list_view_load_icons(FileListView *view);
 
 // 设置右键点击回调
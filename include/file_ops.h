@@ -3,20 +3,35 @@
 
 #include <stdbool.h>
 
+// 前向声明
+struct FileJobQueue;
+
 // 文件操作函数声明
 
+// 设置后台任务队列（设置后粘贴和删除提交到队列异步执行，为NULL时同步执行）
+void file_ops_set_job_queue(struct FileJobQueue *queue);
+
 // 复制文件到剪贴板
 bool file_ops_copy(const char *file_path);
 
 // 剪切文件到剪贴板
 bool file_ops_cut(const char *file_path);
 
-// 粘贴文件从剪贴板
+// 复制一组文件到剪贴板（替换原有内容）
+bool file_ops_copy_paths(const char *const *paths, int count);
+
+// 剪切一组文件到剪贴板（替换原有内容）
+bool file_ops_cut_paths(const char *const *paths, int count);
+
+// 粘贴剪贴板中的全部文件（异步执行时作为一个任务提交，返回是否已提交）
 bool file_ops_paste(const char *target_dir);
 
-// 删除文件
+// 删除文件（异步执行时返回是否已提交）
 bool file_ops_delete(const char *file_path);
 
+// 删除一组文件（异步执行时作为一个任务提交，返回是否已提交）
+bool file_ops_delete_paths(const char *const *paths, int count);
+
 // 重命名文件
 bool file_ops_rename(const char *old_path, const char *new_name);
 
@@ -26,4 +41,10 @@ bool file_ops_has_clipboard_data(void);
 // 获取剪贴板操作类型
 int file_ops_get_clipboard_operation(void);
 
+// 剪贴板中的文件数
+int file_ops_get_clipboard_count(void);
+
+// 清空剪贴板并释放内存（退出时调用）
+void file_ops_clear_clipboard(void);
+
 #endif // FILE_OPS_H
\ No newline at end of file
@@ -14,6 +14,9 @@ typedef enum {
     FS_ERROR_ALREADY_EXISTS,
     FS_ERROR_DISK_FULL,
     FS_ERROR_INVALID_NAME,
+    FS_ERROR_CANCELLED,
+    FS_ERROR_CROSS_DEVICE,       // 源和目标不在同一文件系统（不能重命名，需要复制后删除）
+    FS_ERROR_TARGET_INSIDE_SOURCE, // 复制或移动目录时目标位于源目录之内
     FS_ERROR_UNKNOWN
 } FSError;
 
@@ -23,6 +26,17 @@ FSError fs_get_last_error(void);
 // 获取错误描述
 const char* fs_get_error_string(FSError error);
 
+// 设置当前线程的错误码（供目录树操作等文件系统模块使用）
+void fs_set_error(FSError error);
+
+// 根据 errno 设置错误码
+void fs_set_error_from_errno(void);
+
+#ifdef _WIN32
+// 根据 GetLastError 的返回值设置错误码
+void fs_set_error_from_win32(unsigned long code);
+#endif
+
 // 获取当前工作目录
 char* fs_get_current_directory(void);
 
@@ -80,7 +94,19 @@ bool fs_rename(const char *old_path, const char *new_path);
 // 复制文件
 bool fs_copy_file(const char *src_path, const char *dst_path);
 
-// 移动文件
+// 复制进度回调（copied 为本次新复制的字节数，在复制线程中调用；返回 false 取消复制）
+typedef bool (*FSCopyProgress)(Uint64 copied, void *user_data);
+
+// 复制文件并报告进度（取消时删除不完整的目标文件，错误码为 FS_ERROR_CANCELLED）
+bool fs_copy_file_ex(const char *src_path, const char *dst_path, FSCopyProgress progress, void *user_data);
+
+#ifndef _WIN32
+// 按目录描述符复制文件（目录为 AT_FDCWD 时按路径），供目录树复制使用
+bool fs_copy_file_at(int src_dir, const char *src_name, int dst_dir, const char *dst_name,
+                     FSCopyProgress progress, void *user_data);
+#endif
+
+// 移动文件或目录（跨文件系统时复制后删除）
 bool fs_move_file(const char *src_path, const char *dst_path);
 
 // 获取文件扩展名
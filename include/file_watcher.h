@@ -0,0 +1,80 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include "main.h"
+#include "dir_scanner.h"
+#include <stdbool.h>
+
+// 文件变更类型
+typedef enum {
+    FILE_WATCH_ADDED,        // 新建
+    FILE_WATCH_REMOVED,      // 删除
+    FILE_WATCH_MODIFIED,     // 内容或属性变化
+    FILE_WATCH_RENAMED       // 目录内改名（old_name -> entry.name）
+} FileWatchAction;
+
+// 一条合并后的变更（同一文件在一批中只出现一次）
+typedef struct {
+    FileWatchAction action;  // 变更类型
+    DirScanEntry entry;      // 变更后的目录项（删除时只有名称有效）
+    const char *old_name;    // 改名前的名称（仅 FILE_WATCH_RENAMED）
+} FileWatchChange;
+
+// 批次标志
+enum {
+    FILE_WATCH_BATCH_RESCAN     = 1 << 0, // 事件丢失后重新扫描得到的目录项（全部为 FILE_WATCH_MODIFIED）
+    FILE_WATCH_BATCH_FIRST      = 1 << 1, // 本轮重新扫描的第一批
+    FILE_WATCH_BATCH_LAST       = 1 << 2, // 本轮重新扫描的最后一批
+    FILE_WATCH_BATCH_INCOMPLETE = 1 << 3  // 重新扫描没有完成（不能据此判断删除）
+};
+
+// 一批变更（名称都指向 names 缓冲区）
+typedef struct FileWatchBatch {
+    FileWatchChange *changes; // 变更数组
+    int count;                // 变更数量
+    char *names;              // 名称存储区
+    int flags;                // 批次标志（FILE_WATCH_BATCH_*）
+} FileWatchBatch;
+
+// 监控统计（从启动开始累计）
+typedef struct {
+    int events;               // 收到的事件
+    int coalesced_events;     // 合并到同一文件已有变更中的事件
+    int dropped_events;       // 因队列溢出或超出预算而丢弃的事件和变更
+    int overflows;            // 事件丢失次数（内核队列溢出、超出预算或目录本身被删除/移走）
+    int rescans;              // 重新扫描次数
+    int batches;              // 发送的批次
+} FileWatcherStats;
+
+// 合并中的变更默认最多保留的文件数，超出后丢弃并改为重新扫描
+#define FILE_WATCHER_DEFAULT_EVENT_BUDGET 16384
+
+// 目录监控器（不透明类型）
+typedef struct FileWatcher FileWatcher;
+
+// 变更事件类型（首次调用时注册，失败返回0）
+// 事件的 user.code 为监控器编号，user.data1 为 FileWatchBatch*，由接收方释放
+Uint32 file_watcher_event_type(void);
+
+// 在后台线程开始监控目录（不支持的平台或失败时返回NULL）
+FileWatcher* file_watcher_start(const char *dir_path);
+
+// 停止监控并释放（等待后台线程退出）
+void file_watcher_stop(FileWatcher *watcher);
+
+// 监控器编号（用于丢弃已停止的监控器送来的批次）
+int file_watcher_id(const FileWatcher *watcher);
+
+// 设置合并中的变更最多保留的文件数（小于1时使用默认值）
+void file_watcher_set_event_budget(FileWatcher *watcher, int budget);
+
+// 读取监控统计（可在任意线程调用）
+void file_watcher_get_stats(const FileWatcher *watcher, FileWatcherStats *stats);
+
+// UI线程处理完一批后调用：释放批次并允许监控线程发送下一批
+void file_watcher_batch_done(FileWatcher *watcher, FileWatchBatch *batch);
+
+// 释放批次
+void file_watcher_batch_free(FileWatchBatch *batch);
+
+#endif // FILE_WATCHER_H
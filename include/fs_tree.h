@@ -0,0 +1,53 @@
+#ifndef FS_TREE_H
+#define FS_TREE_H
+
+#include "main.h"
+#include <stdbool.h>
+
+// 遍历线程数上限（包括调用线程）
+#define FS_TREE_MAX_WORKERS 8
+
+// 目录树操作统计
+typedef struct {
+    Uint64 files;            // 处理的文件数（包括符号链接）
+    Uint64 directories;      // 处理的目录数
+    Uint64 bytes;            // 普通文件的字节数
+    int errors;              // 失败的项目数
+} FSTreeStats;
+
+// 目录树进度回调（bytes、items 为本次新处理的字节数和项目数，在遍历线程中并发调用；返回 false 取消操作）
+typedef bool (*FSTreeProgress)(Uint64 bytes, Uint64 items, void *user_data);
+
+// 批量操作中一个源路径完成时的回调（index 为源路径序号，在遍历线程中并发调用）
+typedef void (*FSTreeDone)(int index, bool success, void *user_data);
+
+// 统计目录树的文件数和字节数（不跟随符号链接）
+bool fs_tree_measure(const char *path, FSTreeProgress progress, void *user_data, FSTreeStats *stats);
+
+// 复制文件、符号链接或整个目录树（符号链接按链接本身复制；目录已存在时失败，普通文件覆盖目标）
+// 单个项目失败时继续复制其余项目并返回 false；取消时删除已复制的部分
+// 目标位于源目录之内时不复制，错误码为 FS_ERROR_TARGET_INSIDE_SOURCE
+bool fs_tree_copy(const char *src_path, const char *dst_path,
+                  FSTreeProgress progress, void *user_data, FSTreeStats *stats);
+
+// 删除文件、符号链接或整个目录树（不跟随符号链接）
+bool fs_tree_delete(const char *path, FSTreeProgress progress, void *user_data, FSTreeStats *stats);
+
+// 批量操作：源路径按所在目录分组，同一目录下的文件共用打开的目录分批处理，
+// 大文件和子目录分给其它线程并行处理；每个源路径完成时调用 done（可为NULL）
+bool fs_tree_measure_batch(const char *const *paths, int count, FSTreeProgress progress,
+                           FSTreeDone done, void *user_data, FSTreeStats *stats);
+
+// 批量复制到目标目录（目标名称与源路径的名称相同；取消时删除已复制的源路径）
+// 目标目录就是某个源目录或位于其中时，该源路径失败（FS_ERROR_TARGET_INSIDE_SOURCE）
+bool fs_tree_copy_batch(const char *const *src_paths, int count, const char *dst_dir,
+                        FSTreeProgress progress, FSTreeDone done, void *user_data, FSTreeStats *stats);
+
+// 目标路径是否就是源目录或位于其中（按文件标识从目标的上级目录逐级向上比较，不比较路径字符串）
+bool fs_tree_target_inside(const char *src_dir, const char *dst_path);
+
+// 批量删除
+bool fs_tree_delete_batch(const char *const *paths, int count, FSTreeProgress progress,
+                          FSTreeDone done, void *user_data, FSTreeStats *stats);
+
+#endif // FS_TREE_H
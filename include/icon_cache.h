@@ -0,0 +1,69 @@
+#ifndef ICON_CACHE_H
+#define ICON_CACHE_H
+
+#include "main.h"
+#include "file_item.h"
+#include "texture_manager.h"
+#include <stdbool.h>
+
+// 图标类别（按文件类型和扩展名划分，每个类别每种尺寸只加载一次）
+typedef enum {
+    ICON_CLASS_FILE,         // 普通文件（未识别的扩展名）
+    ICON_CLASS_FOLDER,       // 文件夹
+    ICON_CLASS_DRIVE,        // 驱动器
+    ICON_CLASS_IMAGE,        // 图片
+    ICON_CLASS_AUDIO,        // 音频
+    ICON_CLASS_VIDEO,        // 视频
+    ICON_CLASS_TEXT,         // 文本
+    ICON_CLASS_DOCUMENT,     // 文档
+    ICON_CLASS_CODE,         // 源代码
+    ICON_CLASS_ARCHIVE,      // 压缩包
+    ICON_CLASS_EXECUTABLE,   // 可执行文件
+    ICON_CLASS_COUNT
+} IconClass;
+
+// 图标尺寸
+typedef enum {
+    ICON_SIZE_SMALL,         // 16像素（列表和详细信息视图、侧边栏）
+    ICON_SIZE_LARGE,         // 32像素（图标视图）
+    ICON_SIZE_COUNT
+} IconSize;
+
+// 图标缓存（不透明类型）
+typedef struct IconCache IconCache;
+
+// 图标缓存统计（从创建开始累计）
+typedef struct {
+    int loads;               // 加载（缩放并上传）纹理的次数
+    int unloads;             // 引用计数归零后释放纹理的次数
+    int textures;            // 当前加载的纹理数
+    int references;          // 当前持有的引用数
+    size_t bytes;            // 当前纹理占用的内存
+} IconCacheStats;
+
+// 创建图标缓存（纹理在第一次获取时加载，并计入纹理管理器 textures）
+IconCache* icon_cache_new(SDL_Renderer *renderer, TextureManager *textures);
+
+// 释放缓存及其全部纹理（需在渲染器销毁之前调用）
+void icon_cache_free(IconCache *cache);
+
+// 按文件名和文件类型确定图标类别（扩展名查哈希表，不区分大小写）
+IconClass icon_cache_classify(const IconCache *cache, const char *name, FileType type);
+
+// 获取图标并增加引用计数（第一次获取时加载），失败返回NULL
+// 纹理归缓存所有，调用方不要释放，用完后调用 icon_cache_release
+SDL_Texture* icon_cache_acquire(IconCache *cache, IconClass icon_class, IconSize size);
+
+// 释放一次引用，引用计数归零时释放纹理
+void icon_cache_release(IconCache *cache, IconClass icon_class, IconSize size);
+
+// 已获取的图标纹理（未持有引用时返回NULL，不改变引用计数）
+SDL_Texture* icon_cache_texture(const IconCache *cache, IconClass icon_class, IconSize size);
+
+// 图标尺寸对应的像素大小
+int icon_cache_pixel_size(IconSize size);
+
+// 读取缓存统计
+void icon_cache_get_stats(const IconCache *cache, IconCacheStats *stats);
+
+#endif // ICON_CACHE_H
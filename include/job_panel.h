@@ -0,0 +1,49 @@
+#ifndef JOB_PANEL_H
+#define JOB_PANEL_H
+
+#include "main.h"
+#include "window.h"
+#include "file_jobs.h"
+
+// 面板样式常量
+#define JOB_PANEL_WIDTH 380
+#define JOB_PANEL_PADDING 8
+#define JOB_PANEL_BAR_HEIGHT 6
+#define JOB_PANEL_BUTTON_WIDTH 60
+// 最多显示的任务数（其余任务合并为一行）
+#define JOB_PANEL_MAX_ROWS 3
+// 有任务执行时的进度刷新间隔（毫秒）
+#define JOB_PANEL_REFRESH_INTERVAL 100
+// 任务结束后结果摘要的显示时间（毫秒）
+#define JOB_PANEL_STATUS_DURATION 4000
+
+// 前向声明
+struct Window;
+
+// 文件操作进度面板：窗口右下角显示各任务的进度，可暂停、继续和取消
+typedef struct JobPanel {
+    struct Window *app;        // 应用程序窗口
+    FileJobQueue *queue;       // 任务队列（不归面板所有）
+    Uint64 last_refresh;       // 上次刷新的时间
+    bool shown;                // 上一帧是否显示
+    char status[128];          // 最近结束的任务摘要
+    Uint64 status_time;        // 摘要的显示时间（0表示没有摘要）
+} JobPanel;
+
+// 文件操作进度面板函数声明
+JobPanel* job_panel_new(struct Window *app, FileJobQueue *queue);
+void job_panel_free(JobPanel *panel);
+
+// 处理任务结束事件和面板上的点击
+bool job_panel_handle_event(JobPanel *panel, SDL_Event *event);
+
+// 有任务执行时按刷新间隔标记重绘
+void job_panel_update(JobPanel *panel);
+
+// 距下一次刷新的毫秒数（没有任务和摘要时返回-1）
+int job_panel_next_timeout(JobPanel *panel);
+
+// 绘制面板（在文件列表之上）
+void job_panel_draw(JobPanel *panel);
+
+#endif // JOB_PANEL_H
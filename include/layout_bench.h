@@ -0,0 +1,7 @@
+#ifndef LAYOUT_BENCH_H
+#define LAYOUT_BENCH_H
+
+// 基准测试：比较逐项结构体与元数据列两种布局（count 个合成目录项，FILESCOPE_BENCH 选项打开时编译）
+void layout_bench_run(int count);
+
+#endif // LAYOUT_BENCH_H
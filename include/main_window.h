@@ -14,6 +14,10 @@ typedef struct Toolbar Toolbar;
 struct Sidebar;
 typedef struct Sidebar Sidebar;
 struct ContextMenu;
+struct UiLayer;
+struct ProfilerOverlay;
+struct FileJobQueue;
+struct JobPanel;
 
 // 主窗口结构体
 typedef struct MainWindow {
@@ -22,12 +26,20 @@ typedef struct MainWindow {
     ContextMenu *context_menu;      // 右键菜单
     Toolbar *toolbar;               // 工具栏
     Sidebar *sidebar;               // 侧边栏
+    struct UiLayer *file_list_layer; // 文件列表的面板缓存（创建失败时为NULL，每帧直接绘制）
+    struct UiLayer *toolbar_layer;   // 工具栏的面板缓存
+    struct UiLayer *sidebar_layer;   // 侧边栏的面板缓存
+    struct ProfilerOverlay *profiler_overlay; // 性能计时浮层（F12 显示）
+    struct FileJobQueue *job_queue;  // 文件操作任务队列（创建失败时为NULL，文件操作同步执行）
+    struct JobPanel *job_panel;      // 文件操作进度面板
 } MainWindow;
 
 // 主窗口函数声明
 MainWindow* main_window_new(struct Window *app);
 void main_window_free(MainWindow *window);
 bool main_window_handle_event(MainWindow *window, SDL_Event *event);
+void main_window_update(MainWindow *window);
+int main_window_next_timeout(MainWindow *window);
 void main_window_draw(MainWindow *window);
 
 #endif // MAIN_WINDOW_H
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef PATH_LIST_H
+#define PATH_LIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// 路径列表（按加入顺序保存，每个路径只存与前一个路径不同的后缀）
+typedef struct PathList PathList;
+
+// 创建空列表
+PathList* path_list_new(void);
+
+// 释放列表
+void path_list_free(PathList *list);
+
+// 复制列表
+PathList* path_list_copy(const PathList *list);
+
+// 追加路径
+bool path_list_add(PathList *list, const char *path);
+
+// 清空列表（保留已申请的内存）
+void path_list_clear(PathList *list);
+
+// 路径数
+int path_list_count(const PathList *list);
+
+// 编码后占用的字节数
+size_t path_list_encoded_size(const PathList *list);
+
+// 读取第 index 个路径到 buffer（超出时截断），返回路径的完整长度，index 无效时返回0
+size_t path_list_get(const PathList *list, int index, char *buffer, size_t size);
+
+// 展开为路径数组（指针和字符串在同一块内存中，用 free 释放），失败返回NULL
+char** path_list_expand(const PathList *list);
+
+#endif // PATH_LIST_H
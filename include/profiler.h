@@ -0,0 +1,57 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "main.h"
+#include <stdbool.h>
+
+// 最近记录的计时样本数（环形缓冲区，写满后覆盖最早的样本）
+#define PROFILER_RING_CAPACITY 16384
+// 保留的帧耗时历史（帧耗时直方图）
+#define PROFILER_FRAME_HISTORY 120
+
+// 计时区段
+typedef enum {
+    PROFILE_FRAME,            // 绘制一帧（含 present）
+    PROFILE_EVENTS,           // 主窗口处理事件
+    PROFILE_UPDATE,           // 主窗口更新（合并目录项、上传缩略图）
+    PROFILE_FILE_LIST_DRAW,   // 绘制文件列表
+    PROFILE_SIDEBAR_DRAW,     // 绘制侧边栏
+    PROFILE_TOOLBAR_DRAW,     // 绘制工具栏
+    PROFILE_PRESENT,          // 呈现渲染结果
+    PROFILE_DIR_SCAN,         // 扫描目录（后台线程）
+    PROFILE_SORT,             // 排序文件列表
+    PROFILE_THUMBNAIL_DECODE, // 解码缩略图（后台线程）
+    PROFILE_SECTION_COUNT
+} ProfileSection;
+
+// 一个区段的统计（从启动开始累计）
+typedef struct {
+    Uint64 calls;            // 计时次数
+    Uint64 total_ns;         // 累计耗时
+    Uint64 max_ns;           // 最长一次耗时
+    Uint64 last_ns;          // 最近一次耗时
+    Uint64 frame_ns;         // 上一帧内完成的计时之和
+} ProfileSectionStats;
+
+// 开始计时，返回开始时间（传给 profiler_end，可在任意线程调用）
+Uint64 profiler_begin(void);
+
+// 结束计时并记录一个样本
+void profiler_end(ProfileSection section, Uint64 start);
+
+// 一帧结束（只在UI线程调用）：本帧各区段的耗时之和计入 frame_ns，帧耗时计入历史
+void profiler_end_frame(void);
+
+// 区段名称
+const char* profiler_section_name(ProfileSection section);
+
+// 读取区段统计
+void profiler_get_section_stats(ProfileSection section, ProfileSectionStats *stats);
+
+// 读取最近的帧耗时（纳秒，从早到晚），返回写入的数量
+int profiler_get_frame_history(Uint64 *frame_ns, int max_count);
+
+// 把环形缓冲区中的样本导出为 Chrome trace JSON（chrome://tracing 或 Perfetto 中打开）
+bool profiler_export_chrome_trace(const char *path);
+
+#endif // PROFILER_H
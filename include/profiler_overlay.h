@@ -0,0 +1,40 @@
+#ifndef PROFILER_OVERLAY_H
+#define PROFILER_OVERLAY_H
+
+#include "main.h"
+#include "window.h"
+
+// 浮层样式常量
+#define PROFILER_OVERLAY_WIDTH 420
+#define PROFILER_OVERLAY_PADDING 8
+#define PROFILER_OVERLAY_HISTOGRAM_HEIGHT 60
+// 显示时的刷新间隔（毫秒）
+#define PROFILER_OVERLAY_REFRESH_INTERVAL 250
+// 导出的 Chrome trace 文件（当前工作目录）
+#define PROFILER_OVERLAY_TRACE_PATH "filescope-trace.json"
+
+// 前向声明
+struct Window;
+
+// 性能计时浮层：F12 显示/隐藏，Shift+F12 导出 Chrome trace
+typedef struct ProfilerOverlay {
+    struct Window *app;        // 应用程序窗口
+    bool visible;              // 是否显示
+    Uint64 last_refresh;       // 上次刷新的时间
+} ProfilerOverlay;
+
+// 性能计时浮层函数声明
+ProfilerOverlay* profiler_overlay_new(struct Window *app);
+void profiler_overlay_free(ProfilerOverlay *overlay);
+bool profiler_overlay_handle_event(ProfilerOverlay *overlay, SDL_Event *event);
+
+// 显示时按刷新间隔标记重绘
+void profiler_overlay_update(ProfilerOverlay *overlay);
+
+// 距下一次刷新的毫秒数（隐藏时返回-1）
+int profiler_overlay_next_timeout(ProfilerOverlay *overlay);
+
+// 绘制浮层（在全部面板之上）
+void profiler_overlay_draw(ProfilerOverlay *overlay);
+
+#endif // PROFILER_OVERLAY_H
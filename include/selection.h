@@ -0,0 +1,49 @@
+#ifndef SELECTION_H
+#define SELECTION_H
+
+#include "main.h"
+#include <stdbool.h>
+
+// 多选集合：每个可见下标一位，范围选择、全选和清空按64位字处理
+typedef struct {
+    Uint64 *words;           // 选中位图（第 i 位对应可见下标 i）
+    int word_capacity;       // 位图容量（字数）
+    int count;               // 项目数（有效位数）
+    int selected;            // 选中的项目数
+    int anchor;              // 范围选择的起点（Shift 选择时使用，-1 表示没有）
+} Selection;
+
+// 初始化（没有项目）
+void selection_init(Selection *sel);
+
+// 释放位图
+void selection_destroy(Selection *sel);
+
+// 设置项目数（新增的项目未选中，超出的部分丢弃）
+bool selection_resize(Selection *sel, int count);
+
+// 取消全部选择
+void selection_clear(Selection *sel);
+
+// 全选
+void selection_select_all(Selection *sel);
+
+// 是否选中（越界返回 false）
+bool selection_contains(const Selection *sel, int index);
+
+// 设置单个项目的选中状态
+void selection_set(Selection *sel, int index, bool selected);
+
+// 切换单个项目的选中状态
+void selection_toggle(Selection *sel, int index);
+
+// 设置 first 到 last（包含两端，顺序不限）之间项目的选中状态
+void selection_set_range(Selection *sel, int first, int last, bool selected);
+
+// 选中的项目数
+int selection_count(const Selection *sel);
+
+// 从 from 开始的第一个选中项（没有时返回-1），用于遍历选中项
+int selection_next(const Selection *sel, int from);
+
+#endif // SELECTION_H
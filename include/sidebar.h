@@ -53,7 +53,7 @@ typedef struct SidebarItem {
     SidebarItemType type;       // 项目类型
     char *name;                 // 显示名称
     char *path;                 // 路径
-    SDL_Texture *icon;          // 图标
+    SDL_Texture *icon;          // 图标（属于图标缓存，项目持有一次引用）
     SDL_Rect rect;              // 项目区域
     SidebarState state;         // 项目状态
 } SidebarItem;
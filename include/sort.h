@@ -0,0 +1,39 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include "file_item.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// 排序关键字
+typedef enum {
+    SORT_KEY_NAME,         // 名称（自然排序，忽略大小写）
+    SORT_KEY_SIZE,         // 大小
+    SORT_KEY_TYPE,         // 类型（扩展名）
+    SORT_KEY_DATE          // 修改日期
+} SortKey;
+
+// 生成名称排序键所需的最大字节数（含 '\0'）
+#define SORT_NAME_KEY_MAX(name_len) ((name_len) * 3 + 1)
+
+// 生成名称排序键：ASCII 字母转小写，数字串按数值编码，键之间用 strcmp 比较即为自然顺序
+// key 至少需要 SORT_NAME_KEY_MAX(strlen(name)) 字节，返回键长度（不含 '\0'）
+// ext_offset 非空时返回扩展名在键中的起始位置（没有扩展名时指向键末尾）
+size_t sort_make_name_key(const char *name, char *key, size_t *ext_offset);
+
+// 取键的前8个字节作为整数（大端序，比较结果与 strcmp 一致）
+uint64_t sort_key_prefix(const char *key);
+
+// 按关键字对文件列表排序：目录在前，然后按关键字，最后按名称
+// 排序稳定，结果写入 list->order 并重建可见数组
+bool sort_file_list(FileList *list, SortKey key, bool descending);
+
+// 比较两个文件项在最近一次排序下的先后（结果与 sort_file_list 一致）
+int sort_compare_items(const FileList *list, int a, int b);
+
+// 把 indices 中的文件项插入已排序的 order[0, sorted_count)，完成后更新名称排名（不重建可见数组）
+// 少量时逐个二分插入，较多时先排序再一次合并；indices 可能被重新排列
+bool sort_insert_indices(FileList *list, int sorted_count, int *indices, int count);
+
+#endif // SORT_H
@@ -0,0 +1,78 @@
+#ifndef TEXTURE_MANAGER_H
+#define TEXTURE_MANAGER_H
+
+#include "main.h"
+#include <stdbool.h>
+
+// 纹理总内存默认上限（按纹理像素 RGBA 估算）
+#define TEXTURE_MANAGER_DEFAULT_BUDGET (64 * 1024 * 1024)
+
+// 纹理类别
+typedef enum {
+    TEXTURE_CATEGORY_TEXT,       // 文字纹理缓存
+    TEXTURE_CATEGORY_GLYPHS,     // 字形图集页
+    TEXTURE_CATEGORY_ICONS,      // 文件类型图标
+    TEXTURE_CATEGORY_THUMBNAILS, // 图片缩略图
+    TEXTURE_CATEGORY_LAYERS,     // 面板缓存
+    TEXTURE_CATEGORY_OTHER,      // 其他（窗口背景等）
+    TEXTURE_CATEGORY_COUNT
+} TextureCategory;
+
+// 纹理管理器（不透明类型）：统计各类纹理占用的内存，超出上限时按最近使用顺序淘汰
+typedef struct TextureManager TextureManager;
+
+// 可淘汰纹理的所有者（文字缓存、缩略图缓存等）
+// oldest 返回所有者中最久未使用的可淘汰纹理的使用帧号（没有可淘汰的纹理时返回 UINT64_MAX）
+// evict 淘汰该纹理（所有者负责调用 texture_manager_untrack）
+typedef Uint64 (*TextureOldestFunc)(void *owner);
+typedef void (*TextureEvictFunc)(void *owner);
+
+// 纹理管理器统计
+typedef struct {
+    size_t bytes[TEXTURE_CATEGORY_COUNT];     // 各类别当前占用的内存
+    int textures[TEXTURE_CATEGORY_COUNT];     // 各类别当前的纹理数
+    int evictions[TEXTURE_CATEGORY_COUNT];    // 各类别因超出上限淘汰的纹理数（累计）
+    size_t total_bytes;                       // 当前占用的内存
+    size_t peak_bytes;                        // 占用内存的峰值
+    size_t budget;                            // 内存上限
+    int over_budget_frames;                   // 没有可淘汰的纹理、仍超出上限的帧数（累计）
+} TextureManagerStats;
+
+// 创建纹理管理器（budget 为0时使用默认上限）
+TextureManager* texture_manager_new(size_t budget);
+
+// 释放纹理管理器（所有者释放之后调用）
+void texture_manager_free(TextureManager *manager);
+
+// 修改内存上限（下一帧结束时生效）
+void texture_manager_set_budget(TextureManager *manager, size_t budget);
+
+// 登记可淘汰纹理的所有者
+bool texture_manager_register(TextureManager *manager, TextureCategory category, void *owner,
+                              TextureOldestFunc oldest, TextureEvictFunc evict);
+
+// 取消登记（所有者释放前调用）
+void texture_manager_unregister(TextureManager *manager, void *owner);
+
+// 记录创建了一个纹理（manager 为NULL时不做任何事）
+void texture_manager_track(TextureManager *manager, TextureCategory category, size_t bytes);
+
+// 记录释放了一个纹理
+void texture_manager_untrack(TextureManager *manager, TextureCategory category, size_t bytes);
+
+// 当前帧号（所有者用来记录纹理最近使用的时间，manager 为NULL时返回0）
+Uint64 texture_manager_frame(const TextureManager *manager);
+
+// 一帧绘制结束：超出上限时淘汰本帧没有使用的纹理，然后进入下一帧
+void texture_manager_end_frame(TextureManager *manager);
+
+// 纹理占用内存的估算（宽 x 高 x 4）
+size_t texture_manager_texture_bytes(SDL_Texture *texture);
+
+// 类别名称
+const char* texture_category_name(TextureCategory category);
+
+// 读取统计
+void texture_manager_get_stats(const TextureManager *manager, TextureManagerStats *stats);
+
+#endif // TEXTURE_MANAGER_H
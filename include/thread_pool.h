@@ -0,0 +1,31 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "main.h"
+#include <stdbool.h>
+
+// 并行任务函数（index 为任务序号，0 ~ count-1）
+typedef void (*ThreadPoolTask)(void *data, int index);
+
+// 线程池（不透明类型）
+typedef struct ThreadPool ThreadPool;
+
+// 创建线程池（worker_count 为后台线程数，可以为0）
+ThreadPool* thread_pool_new(int worker_count);
+
+// 销毁线程池（等待后台线程退出）
+void thread_pool_free(ThreadPool *pool);
+
+// 参与执行任务的线程数（后台线程 + 调用线程）
+int thread_pool_concurrency(ThreadPool *pool);
+
+// 并行执行 count 个任务，调用线程也参与执行，全部完成后返回
+void thread_pool_run(ThreadPool *pool, int count, ThreadPoolTask task, void *data);
+
+// 获取共享线程池（首次调用时按CPU核心数创建）
+ThreadPool* thread_pool_shared(void);
+
+// 销毁共享线程池（程序退出时调用）
+void thread_pool_shared_shutdown(void);
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,71 @@
+#ifndef THUMBNAIL_H
+#define THUMBNAIL_H
+
+#include "main.h"
+#include "texture_manager.h"
+#include <stdbool.h>
+
+// 缩略图默认最大边长（像素）
+#define THUMBNAIL_DEFAULT_SIZE 64
+// 默认最多缓存的缩略图数（包括排队中和解码失败的项）
+#define THUMBNAIL_DEFAULT_CAPACITY 512
+// 磁盘缓存默认大小上限（超出后按最近使用时间压缩到四分之三）
+#define THUMBNAIL_DISK_DEFAULT_BUDGET (256 * 1024 * 1024)
+
+// 缩略图缓存（不透明类型）
+typedef struct ThumbnailCache ThumbnailCache;
+
+// 缩略图缓存统计（从创建开始累计）
+typedef struct {
+    int requests;            // 新加入队列的请求数
+    int cancelled;           // 离开视口后取消的排队请求数
+    int decoded;             // 后台解码完成数
+    int failed;              // 解码失败数
+    int uploads;             // 上传为纹理的缩略图数
+    int evictions;           // 超出容量淘汰的缩略图数
+    int entries;             // 当前缓存项数
+    int queued;              // 当前排队等待解码的请求数
+    int ready;               // 已解码等待上传的缩略图数
+    size_t bytes;            // 当前纹理占用的内存
+    int disk_hits;           // 从磁盘缓存读取（不需要解码）的次数
+    int disk_writes;         // 写入磁盘缓存的缩略图数
+    int disk_compactions;    // 磁盘缓存压缩次数
+    size_t disk_bytes;       // 磁盘缓存文件大小
+} ThumbnailStats;
+
+// 唤醒事件类型（首次调用时注册，失败返回0）
+// 后台线程解码完成时发送，不携带数据，UI线程收到后调用 thumbnail_cache_upload 上传纹理
+Uint32 thumbnail_event_type(void);
+
+// 创建缩略图缓存并启动解码线程（参数为0时使用默认值）
+// 缩略图同时保存在用户缓存目录的打包文件中，disk_budget 为其大小上限
+// 纹理计入纹理管理器 textures，总内存超出上限时不在视口附近的缩略图可被淘汰
+ThumbnailCache* thumbnail_cache_new(SDL_Renderer *renderer, TextureManager *textures,
+                                    int size, int capacity, size_t disk_budget);
+
+// 停止解码线程并释放全部缩略图（需在渲染器销毁之前调用）
+void thumbnail_cache_free(ThumbnailCache *cache);
+
+// 开始一轮请求（只在UI线程调用），之后对视口内和附近的每个项目调用 thumbnail_cache_request
+void thumbnail_cache_begin_requests(ThumbnailCache *cache);
+
+// 请求一张缩略图（priority 越小越先解码，通常为与视口的距离）
+void thumbnail_cache_request(ThumbnailCache *cache, const char *path, int priority);
+
+// 结束一轮请求：本轮没有再次请求的排队项被取消
+void thumbnail_cache_end_requests(ThumbnailCache *cache);
+
+// 把后台解码完成的缩略图上传为纹理（只在UI线程调用，最多 max_count 张），返回上传数量
+int thumbnail_cache_upload(ThumbnailCache *cache, int max_count);
+
+// 是否有已解码但尚未上传的缩略图
+bool thumbnail_cache_has_pending_uploads(ThumbnailCache *cache);
+
+// 获取已上传的缩略图（只在UI线程调用，尚未完成或解码失败时返回NULL）
+// 纹理归缓存所有，调用方不要释放
+SDL_Texture* thumbnail_cache_get(ThumbnailCache *cache, const char *path, int *w, int *h);
+
+// 读取缓存统计
+void thumbnail_cache_get_stats(ThumbnailCache *cache, ThumbnailStats *stats);
+
+#endif // THUMBNAIL_H
@@ -0,0 +1,116 @@
+#ifndef UI_RENDERER_H
+#define UI_RENDERER_H
+
+#include "main.h"
+#include "window.h"
+#include "texture_manager.h"
+#include <stdbool.h>
+
+// 文字纹理缓存默认内存上限（按纹理像素 RGBA 估算）
+#define TEXT_CACHE_DEFAULT_BUDGET (16 * 1024 * 1024)
+
+// 文字纹理缓存（不透明类型）
+typedef struct TextCache TextCache;
+
+// 文字纹理缓存统计（从创建开始累计）
+typedef struct {
+    int hits;                // 命中次数
+    int misses;              // 未命中（重新光栅化并上传）次数
+    int evictions;           // 因超出内存上限淘汰的纹理数
+    int entries;             // 当前缓存的纹理数
+    size_t bytes;            // 当前纹理占用的内存
+    size_t max_bytes;        // 内存上限
+} TextCacheStats;
+
+// 创建文字纹理缓存（max_bytes 为0时使用默认上限）
+// textures 不为NULL时纹理计入纹理管理器，总内存超出上限时最久未使用的文字纹理可被淘汰
+TextCache* text_cache_new(SDL_Renderer *renderer, TextureManager *textures, size_t max_bytes);
+
+// 释放缓存及其全部纹理（需在渲染器销毁之前调用）
+void text_cache_free(TextCache *cache);
+
+// 清空缓存（字体重新加载等情况下调用）
+void text_cache_clear(TextCache *cache);
+
+// 获取文字纹理（按文本、字体和颜色缓存，最近最少使用的先淘汰）
+// len 为0时按字符串长度计算；纹理归缓存所有，调用方不要释放，只在下一次获取之前保证有效
+SDL_Texture* text_cache_get(TextCache *cache, TTF_Font *font, const char *text, size_t len,
+                            SDL_Color color, int *w, int *h);
+
+// 读取缓存统计
+void text_cache_get_stats(const TextCache *cache, TextCacheStats *stats);
+
+// 字形图集（不透明类型）
+typedef struct GlyphAtlas GlyphAtlas;
+
+// 字形图集统计（从创建开始累计）
+typedef struct {
+    int glyphs;              // 当前缓存的字形数
+    int pages;               // 图集纹理页数
+    int draw_calls;          // 提交的 SDL_RenderGeometry 次数
+    int quads;               // 提交的字形四边形数
+    int resets;              // 图集写满后重置的次数
+} GlyphAtlasStats;
+
+// 创建字形图集：字形按需光栅化一次（白色），绘制时由顶点颜色着色
+GlyphAtlas* glyph_atlas_new(SDL_Renderer *renderer, TTF_Font *font, TextureManager *textures);
+
+// 释放图集（需在渲染器和字体释放之前调用）
+void glyph_atlas_free(GlyphAtlas *atlas);
+
+// 计算文字按图集排版后的宽高（len 为0时按字符串长度计算）
+bool glyph_atlas_measure(GlyphAtlas *atlas, const char *text, size_t len, int *w, int *h);
+
+// 把文字加入当前批次（左上角为 x, y；max_width 大于0时超出部分的字形不绘制）
+bool glyph_atlas_draw(GlyphAtlas *atlas, const char *text, size_t len, float x, float y,
+                      SDL_Color color, float max_width);
+
+// 提交当前批次（每个图集页一次 SDL_RenderGeometry），改变裁剪区域或绘制上层内容之前调用
+void glyph_atlas_flush(GlyphAtlas *atlas);
+
+// 读取图集统计
+void glyph_atlas_get_stats(const GlyphAtlas *atlas, GlyphAtlasStats *stats);
+
+// 界面文字宽高（有字形图集时按图集排版，否则按字体计算）
+bool ui_text_size(struct Window *window, const char *text, size_t len, int *w, int *h);
+
+// 绘制界面文字：有字形图集时加入批次，否则通过文字纹理缓存立即绘制
+void ui_text_draw(struct Window *window, const char *text, size_t len, float x, float y,
+                  SDL_Color color, float max_width);
+
+// 提交已加入批次的界面文字（每个面板绘制结束和改变裁剪区域之前调用）
+void ui_text_flush(struct Window *window);
+
+// 面板缓存（不透明类型）：面板绘制到自己的目标纹理中，之后只重绘变化的矩形
+typedef struct UiLayer UiLayer;
+
+// 面板缓存统计（从创建开始累计）
+typedef struct {
+    int renders;             // 重绘次数
+    int partial_renders;     // 只重绘部分矩形的次数
+    Uint64 pixels;           // 累计重绘的像素数
+} UiLayerStats;
+
+// 创建面板缓存（rect 为面板在窗口中的区域，重绘前先用 clear_color 填充，纹理计入 textures）
+UiLayer* ui_layer_new(SDL_Renderer *renderer, TextureManager *textures, SDL_Rect rect, SDL_Color clear_color);
+
+// 释放面板缓存（需在渲染器销毁之前调用）
+void ui_layer_free(UiLayer *layer);
+
+// 开始重绘面板：之后的绘制进入面板纹理并裁剪到 dirty（为NULL时重绘整个面板）
+// 绘制代码仍使用窗口坐标；返回 false 时不需要（或无法）重绘
+bool ui_layer_begin(UiLayer *layer, struct Window *window, const SDL_Rect *dirty);
+
+// 结束重绘，恢复窗口为渲染目标
+void ui_layer_end(UiLayer *layer, struct Window *window);
+
+// 把面板纹理合成到当前渲染目标
+void ui_layer_composite(UiLayer *layer);
+
+// 读取面板缓存统计
+void ui_layer_get_stats(const UiLayer *layer, UiLayerStats *stats);
+
+// 设置裁剪区域（重绘面板缓存时与重绘矩形取交集，rect 为NULL时只保留重绘矩形）
+void ui_set_clip_rect(struct Window *window, const SDL_Rect *rect);
+
+#endif // UI_RENDERER_H
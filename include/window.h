@@ -3,8 +3,27 @@
 
 #include "main.h"
 
+// 界面面板编号
+enum {
+    UI_PANEL_FILE_LIST,     // 文件列表
+    UI_PANEL_SIDEBAR,       // 侧边栏
+    UI_PANEL_TOOLBAR,       // 工具栏
+    UI_PANEL_CONTEXT_MENU,  // 右键菜单
+    UI_PANEL_JOBS,          // 文件操作进度面板
+    UI_PANEL_OVERLAY,       // 性能计时浮层
+    UI_PANEL_COUNT
+};
 
-
+// 需要重绘的界面区域（Window.dirty 标志位）
+enum {
+    UI_DIRTY_FILE_LIST    = 1 << UI_PANEL_FILE_LIST,
+    UI_DIRTY_SIDEBAR      = 1 << UI_PANEL_SIDEBAR,
+    UI_DIRTY_TOOLBAR      = 1 << UI_PANEL_TOOLBAR,
+    UI_DIRTY_CONTEXT_MENU = 1 << UI_PANEL_CONTEXT_MENU,
+    UI_DIRTY_JOBS         = 1 << UI_PANEL_JOBS,
+    UI_DIRTY_OVERLAY      = 1 << UI_PANEL_OVERLAY,
+    UI_DIRTY_ALL          = (1 << UI_PANEL_COUNT) - 1 // 整个窗口
+};
  
 typedef struct Window {
     // SDL窗口
@@ -17,10 +36,26 @@ typedef struct Window {
     SDL_Texture *background;
     // SDL文字纹理
     SDL_Texture *text_image ;
+    // 纹理管理器（统计各缓存的纹理内存，超出上限时淘汰最久未使用的纹理）
+    struct TextureManager *textures;
+    // 文字纹理缓存（各界面模块共用）
+    struct TextCache *text_cache;
+    // 字形图集（界面文字批量绘制，创建失败时使用文字纹理缓存）
+    struct GlyphAtlas *glyph_atlas;
+    // 文件类型图标缓存（各界面模块共用，按引用计数共享纹理）
+    struct IconCache *icon_cache;
+    // 图片缩略图缓存（后台线程解码，创建失败时为NULL，只显示图标）
+    struct ThumbnailCache *thumbnails;
     // SDL事件
     SDL_Event event;
     // 是否关闭
     bool is_running;
+    // 需要重绘的界面区域（UI_DIRTY_* 标志，主循环绘制后清零）
+    int dirty;
+    // 各面板需要重绘的矩形（窗口坐标，宽为0表示整个面板，只在 dirty 对应位置位时有效）
+    SDL_Rect dirty_rects[UI_PANEL_COUNT];
+    // 正在重绘的面板缓存（ui_layer_begin 和 ui_layer_end 之间非空）
+    struct UiLayer *active_layer;
     // 用户数据指针
     void *user_data;
 
@@ -30,5 +65,14 @@ bool window_new( Window **window);//
 void window_free( Window **window);
 void window_run( Window *w);
 
+// 标记需要重绘的界面区域（只在UI线程调用，后台线程通过SDL事件唤醒主循环）
+void window_invalidate(Window *w, int flags);
+
+// 只标记面板中的一个矩形需要重绘（窗口坐标，与已标记的矩形合并）
+void window_invalidate_rect(Window *w, int flags, const SDL_Rect *rect);
+
+// 面板需要重绘的矩形（整个面板需要重绘时返回NULL）
+const SDL_Rect* window_dirty_rect(const Window *w, int panel);
+
 
 #endif  //WINDOW_H
\ No newline at end of file
@@ -6,11 +6,24 @@
 #include "event.h"
 #include "file_system.h"
 #include "app.h" // 添加app.h头文件
+#include "thread_pool.h"
+#ifdef FILESCOPE_BENCH
+#include "layout_bench.h"
+#endif
 
 #include <SDL3/SDL_main.h>
+#include <string.h>
 
 int main(int argc, char* argv[]) {
     printf("[DEBUG] Program started\n");
+
+#ifdef FILESCOPE_BENCH
+    // 基准测试模式：FileScope --bench-layout [条目数]
+    if (argc > 1 && strcmp(argv[1], "--bench-layout") == 0) {
+        layout_bench_run(argc > 2 ? atoi(argv[2]) : 1000000);
+        return EXIT_SUCCESS;
+    }
+#endif
     
     bool exit_status = EXIT_FAILURE;
     struct Window *window = NULL;
@@ -52,6 +65,8 @@ int main(int argc, char* argv[]) {
         } else {
             printf("[ERROR] Failed to create main window\n");
         }
+        // 停止后台工作线程
+        thread_pool_shared_shutdown();
         printf("[DEBUG] Freeing window\n");
         window_free(&window);
     } else {
@@ -26,6 +26,10 @@ bool window_init_sdl(struct Window *a){
         fprintf(stderr, "Unable to create renderer: %s\n", SDL_GetError());
         return false;
     }
+    // 开启垂直同步，连续重绘（拖动、滚动）时帧率不超过刷新率
+    if (!SDL_SetRenderVSync(a->renderer, 1)) {
+        fprintf(stderr, "Unable to enable vsync: %s\n", SDL_GetError());
+    }
 
     //软件图标
     SDL_Surface *icon = IMG_Load("images/icon.png"); //贴图1
@@ -10,6 +10,10 @@
 #include "window.h"
 #include "init_sdl.h"
 #include "renderer.h"
+#include "ui_renderer.h"
+#include "icon_cache.h"
+#include "thumbnail.h"
+#include "texture_manager.h"
  
 
 
@@ -23,6 +27,20 @@ void window_free(struct Window **app) {
             SDL_DestroyTexture(a->text_image);
             a->text_image = NULL;
         }  
+        // 释放字形图集和文字纹理缓存（纹理属于渲染器，字体关闭前释放）
+        glyph_atlas_free(a->glyph_atlas);
+        a->glyph_atlas = NULL;
+        text_cache_free(a->text_cache);
+        a->text_cache = NULL;
+        // 停止缩略图解码线程并释放缩略图纹理
+        thumbnail_cache_free(a->thumbnails);
+        a->thumbnails = NULL;
+        // 释放图标缓存（纹理属于渲染器）
+        icon_cache_free(a->icon_cache);
+        a->icon_cache = NULL;
+        // 释放纹理管理器（各缓存释放之后，报告未登记释放的纹理）
+        texture_manager_free(a->textures);
+        a->textures = NULL;
         // 释放SDL字体
         if (a->font) {
             TTF_CloseFont(a->font);
@@ -74,13 +92,89 @@ bool window_new(struct Window **app) {
     if (!window_load_media(a)){
         return false;
     }
+    // 创建纹理管理器（各纹理缓存共用一个内存上限）
+    a->textures = texture_manager_new(TEXTURE_MANAGER_DEFAULT_BUDGET);
+    if (!a->textures) {
+        fprintf(stderr,"ERROR creating texture manager\n");
+        return false;
+    }
+    // 创建文字纹理缓存
+    a->text_cache = text_cache_new(a->renderer, a->textures, TEXT_CACHE_DEFAULT_BUDGET);
+    if (!a->text_cache) {
+        fprintf(stderr,"ERROR creating text cache\n");
+        return false;
+    }
+    // 创建字形图集（失败时界面文字逐段使用文字纹理缓存）
+    a->glyph_atlas = glyph_atlas_new(a->renderer, a->font, a->textures);
+    if (!a->glyph_atlas) {
+        fprintf(stderr,"ERROR creating glyph atlas, falling back to text cache\n");
+    }
+    // 创建图标缓存
+    a->icon_cache = icon_cache_new(a->renderer, a->textures);
+    if (!a->icon_cache) {
+        fprintf(stderr,"ERROR creating icon cache\n");
+        return false;
+    }
+    // 创建缩略图缓存（失败时图片文件只显示图标）
+    a->thumbnails = thumbnail_cache_new(a->renderer, a->textures, THUMBNAIL_DEFAULT_SIZE,
+                                        THUMBNAIL_DEFAULT_CAPACITY, THUMBNAIL_DISK_DEFAULT_BUDGET);
+    if (!a->thumbnails) {
+        fprintf(stderr,"ERROR creating thumbnail cache, showing icons only\n");
+    }
 
     a->is_running = true;
+    // 第一帧需要完整绘制
+    a->dirty = UI_DIRTY_ALL;
 
 
     return true;
 }
 
+// 标记需要重绘的界面区域
+void window_invalidate(struct Window *a, int flags) {
+    if (!a) {
+        return;
+    }
+
+    for (int i = 0; i < UI_PANEL_COUNT; i++) {
+        if (flags & (1 << i)) {
+            a->dirty_rects[i] = (SDL_Rect){0, 0, 0, 0};
+        }
+    }
+    a->dirty |= flags;
+}
+
+// 只标记面板中的一个矩形需要重绘
+void window_invalidate_rect(struct Window *a, int flags, const SDL_Rect *rect) {
+    if (!a || !rect || rect->w <= 0 || rect->h <= 0) {
+        return;
+    }
+
+    for (int i = 0; i < UI_PANEL_COUNT; i++) {
+        if (!(flags & (1 << i))) {
+            continue;
+        }
+        SDL_Rect *dirty = &a->dirty_rects[i];
+        if (!(a->dirty & (1 << i))) {
+            *dirty = *rect;
+        } else if (dirty->w > 0) {
+            // 已标记整个面板时保持不变
+            SDL_Rect merged;
+            SDL_GetRectUnion(dirty, rect, &merged);
+            *dirty = merged;
+        }
+    }
+    a->dirty |= flags;
+}
+
+// 面板需要重绘的矩形
+const SDL_Rect* window_dirty_rect(const struct Window *a, int panel) {
+    if (!a || panel < 0 || panel >= UI_PANEL_COUNT || a->dirty_rects[panel].w <= 0) {
+        return NULL;
+    }
+    return &a->dirty_rects[panel];
+}
+
 void window_run(struct Window *a)
 {
     // 这个函数现在只是一个占位符，实际的主循环已移至app.c